@@ -0,0 +1,50 @@
+#ifndef _INC_BITATOMIC_H
+#define _INC_BITATOMIC_H
+
+#include <stdint.h>
+#include <stdlib.h>
+#include "bitops.h"
+
+/*
+ * Lock-free bit operations on words shared between threads. Where twiggle_bit returns a
+ * changed copy, atomic_twiggle_bit changes the word in place with one __atomic_fetch_or,
+ * __atomic_fetch_and or __atomic_fetch_xor and reports the bit as it was, so SET is a
+ * test-and-set and CLEAR a test-and-clear. Each call takes the memory order of the
+ * operation: one of __ATOMIC_RELAXED, __ATOMIC_CONSUME, __ATOMIC_ACQUIRE, __ATOMIC_RELEASE,
+ * __ATOMIC_ACQ_REL or __ATOMIC_SEQ_CST (loads take the orders valid for a load).
+ *
+ * atomic_bitmap_t lays a bitmap out in shards, each starting on its own 64-byte cache line.
+ * Bit b lives in shard b / shard_bits, so with shard_bits of 64 every 64 bits own a line and
+ * threads working on different shards never share one; with shard_bits of 512 the bitmap is
+ * dense. atomic_bitmap_acquire finds and sets a clear bit, starting at a shard the caller
+ * picks (one per thread, say), for ID and slot allocation.
+ */
+
+#define ATOMIC_BITMAP_LINE_BYTES (64)
+#define ATOMIC_BITMAP_MAX_SHARD_BITS (ATOMIC_BITMAP_LINE_BYTES * 8)
+#define ATOMIC_BITMAP_FULL ((size_t)-1)
+
+typedef struct {
+	uint64_t* words;		///< Shard s starts at words[s * words_per_shard], on a cache line boundary
+	size_t nbits;
+	size_t shard_bits;		///< Bits per shard: 64, 128, 256 or 512
+	size_t nshards;
+	size_t words_per_shard;		///< A whole number of cache lines of words
+} atomic_bitmap_t;
+
+int atomic_twiggle_bit(uint32_t* word, int bit, operation_t operation, int memorder);
+int atomic_test_and_set_bit(uint32_t* word, int bit, int memorder);
+int atomic_test_and_clear_bit(uint32_t* word, int bit, int memorder);
+int atomic_test_bit(const uint32_t* word, int bit, int memorder);
+int atomic_twiggle_range(uint32_t* words, size_t start, size_t count, operation_t operation, int memorder, size_t* were_set);
+
+int atomic_bitmap_init(atomic_bitmap_t* bm, size_t nbits, size_t shard_bits);
+void atomic_bitmap_free(atomic_bitmap_t* bm);
+int atomic_bitmap_twiggle(atomic_bitmap_t* bm, size_t bit, operation_t operation, int memorder);
+int atomic_bitmap_test(const atomic_bitmap_t* bm, size_t bit, int memorder);
+size_t atomic_bitmap_acquire(atomic_bitmap_t* bm, size_t first_shard, int memorder);
+size_t atomic_bitmap_count(const atomic_bitmap_t* bm);
+
+int test_atomic(void);
+
+#endif
@@ -0,0 +1,57 @@
+#ifndef _INC_BITDIFF_H
+#define _INC_BITDIFF_H
+
+#include <stdint.h>
+#include <stdlib.h>
+#include "bitops.h"
+
+/*
+ * Bit-level diff of two equally sized buffers, such as register or memory snapshots. The
+ * buffers are compared 64 bytes at a time with the widest vector compare the ISA tier
+ * allows, so identical stretches cost one load pair and one test per block. Inside a block
+ * that differs, the XOR of each 64-bit word is walked with ctz, one changed bit per step.
+ *
+ * Bit positions count from the start of the buffers: bit p is bit (p % 8) of byte p / 8,
+ * bit 0 being the least significant. Rendering treats the buffers as arrays of 32-bit
+ * little-endian words (a short last word is padded with zero bytes) and prints one line per
+ * changed word with the existing uint_to_hexstr / uint_to_binstr formatters:
+ *
+ *	 OOOOOOOO  0xAAAAAAAA 0xBBBBBBBB  0bAAAA...AAAA 0bBBBB...BBBB  ...^....^
+ *
+ * The offset is the byte offset of the word and the last field marks each changed bit,
+ * most significant first, under the binary columns. Words past 4 GiB print a 16-digit offset,
+ * as HEXDUMP_LAYOUT_OFFSET64 does, so their lines are BITDIFF_LINE64_CHARS long.
+ */
+
+#define BITDIFF_NONE ((size_t)-1)
+#define BITDIFF_BLOCK_BYTES (64)
+#define BITDIFF_WORD_BYTES (4)
+///< "OOOOOOOO  0xAAAAAAAA 0xBBBBBBBB  0b<32> 0b<32>  <32>\n"
+#define BITDIFF_LINE_CHARS (8 + 2 + 10 + 1 + 10 + 2 + 34 + 1 + 34 + 2 + 32 + 1)
+#define BITDIFF_LINE64_CHARS (BITDIFF_LINE_CHARS + 8)	///< A line whose offset does not fit in 32 bits
+
+typedef size_t (*bitdiff_scan_fn)(const uint8_t* a, const uint8_t* b, size_t block, size_t nblocks);
+
+///< Position of a walk over the changed bits. Set up with bitdiff_init; the buffers must stay unchanged while it is used
+typedef struct {
+	const uint8_t* a;
+	const uint8_t* b;
+	size_t nbytes;
+	size_t nblocks;			///< Complete 64-byte blocks; the bytes after them are compared as one zero-padded tail
+	size_t next_block;		///< First block not yet loaded into diff
+	size_t word_index;		///< Index (in 64-bit words) of diff[0]
+	size_t nwords;			///< Words of diff still to walk, diff[0] included
+	uint64_t diff[BITDIFF_BLOCK_BYTES / 8];	///< a ^ b for the block being walked; bits already reported are cleared
+	bitdiff_scan_fn scan;		///< Block scanner picked for the ISA tier when the walk started
+} bitdiff_iter_t;
+
+void bitdiff_init(bitdiff_iter_t* it, const void* a, const void* b, size_t nbytes);
+size_t bitdiff_next(bitdiff_iter_t* it);
+size_t bitdiff_count(const void* a, const void* b, size_t nbytes);
+void bitdiff_xor(void* dst, const void* a, const void* b, size_t nbytes);
+size_t bitdiff_render_emit(bitdiff_iter_t* it, char* str, size_t size);
+char* bitdiff_render(char* str, size_t size, const void* a, const void* b, size_t nbytes);
+
+int test_diff(void);
+
+#endif
@@ -0,0 +1,74 @@
+#ifndef _INC_BITGENERIC_H
+#define _INC_BITGENERIC_H
+
+#include <stdint.h>
+#include <stdlib.h>
+#include "bitops.h"
+
+/*
+ * Width-specific versions of the scalar API for 8, 16, 64 and (where the compiler has it)
+ * 128-bit integers, plus _Generic front ends that pick the version from the type of the
+ * value argument. 32-bit values go to the original functions, except bitops_uint_to_hexstr,
+ * which uses uint_to_hexstr_u32 because uint_to_hexstr keeps only the low nbits of num. At
+ * every width, a value wider than nbits is refused, and hex takes any nbits that is a
+ * multiple of 4. Each width is generated from one template in bitgeneric.c and shifts and
+ * masks in its own type, so a 64-bit or 128-bit value is one call rather than several 32-bit
+ * ones.
+ *
+ * _Generic sees the type after the usual conversions of the argument expression, so pass
+ * the variable itself: (uint8_t)x selects the 8-bit version, but x + 1 is an int. Any
+ * integer type not listed (plain int, unsigned long long where uint64_t is unsigned long)
+ * goes to the 64-bit version.
+ */
+
+#if defined(__SIZEOF_INT128__)
+#define BITOPS_HAVE_INT128 (1)
+typedef unsigned __int128 bitops_u128_t;
+typedef __int128 bitops_s128_t;
+#endif
+
+#define BITOPS_DECLARE_GENERIC_WIDTH(suffix, ssuffix, utype, stype) \
+int uint_to_binstr_##suffix(char* str, size_t size, utype num, uint8_t nbits); \
+int int_to_binstr_##ssuffix(char* str, size_t size, stype num, uint8_t nbits); \
+int uint_to_hexstr_##suffix(char* str, size_t size, utype num, uint8_t nbits); \
+utype twiggle_bit_##suffix(utype input, int bit, operation_t operation); \
+utype grab_three_bits_##suffix(utype input, int start_bit);
+
+BITOPS_DECLARE_GENERIC_WIDTH(u8, s8, uint8_t, int8_t)
+BITOPS_DECLARE_GENERIC_WIDTH(u16, s16, uint16_t, int16_t)
+BITOPS_DECLARE_GENERIC_WIDTH(u64, s64, uint64_t, int64_t)
+int uint_to_hexstr_u32(char* str, size_t size, uint32_t num, uint8_t nbits);
+#ifdef BITOPS_HAVE_INT128
+BITOPS_DECLARE_GENERIC_WIDTH(u128, s128, bitops_u128_t, bitops_s128_t)
+#define BITOPS_GENERIC_U128(fn) , bitops_u128_t: fn##_u128
+#define BITOPS_GENERIC_S128(fn) , bitops_s128_t: fn##_s128
+#else
+#define BITOPS_GENERIC_U128(fn)
+#define BITOPS_GENERIC_S128(fn)
+#endif
+
+#define BITOPS_GENERIC_UNSIGNED(num, fn, fn32) _Generic((num), \
+	uint8_t: fn##_u8, \
+	uint16_t: fn##_u16, \
+	uint32_t: fn32, \
+	uint64_t: fn##_u64 \
+	BITOPS_GENERIC_U128(fn), \
+	default: fn##_u64)
+
+#define BITOPS_GENERIC_SIGNED(num, fn) _Generic((num), \
+	int8_t: fn##_s8, \
+	int16_t: fn##_s16, \
+	int32_t: fn, \
+	int64_t: fn##_s64 \
+	BITOPS_GENERIC_S128(fn), \
+	default: fn##_s64)
+
+#define bitops_uint_to_binstr(str, size, num, nbits) BITOPS_GENERIC_UNSIGNED((num), uint_to_binstr, uint_to_binstr)((str), (size), (num), (nbits))
+#define bitops_int_to_binstr(str, size, num, nbits) BITOPS_GENERIC_SIGNED((num), int_to_binstr)((str), (size), (num), (nbits))
+#define bitops_uint_to_hexstr(str, size, num, nbits) BITOPS_GENERIC_UNSIGNED((num), uint_to_hexstr, uint_to_hexstr_u32)((str), (size), (num), (nbits))
+#define bitops_twiggle_bit(input, bit, operation) BITOPS_GENERIC_UNSIGNED((input), twiggle_bit, twiggle_bit)((input), (bit), (operation))
+#define bitops_grab_three_bits(input, start_bit) BITOPS_GENERIC_UNSIGNED((input), grab_three_bits, grab_three_bits)((input), (start_bit))
+
+int test_generic(void);
+
+#endif
@@ -0,0 +1,70 @@
+#ifndef _INC_BITLAYOUT_H
+#define _INC_BITLAYOUT_H
+
+#include <stdint.h>
+#include <stdlib.h>
+#include "bitops.h"
+
+/*
+ * Configurable hexdump layouts. A hexdump_layout_t describes the row (16, 32 or 64 bytes),
+ * how bytes are grouped into words and in which byte order words are printed, the offset
+ * width, an optional ASCII gutter, and whether runs of repeated rows collapse to a single
+ * "*" line as xxd and hexdump -C do. hexdump_plan_compile turns it once into a plan: a
+ * prebuilt row template (offset gutter, separators, gutter bars, newline), the output column
+ * of every byte, the digit and ASCII tables, and a row emitter specialized for the row width
+ * and gutter, so the per-row loop only copies the template and stores digits.
+ *
+ * Every layout prints "OOOOOOOO  " (or 16 offset digits) and then the groups separated by
+ * one space. A partial last row keeps its columns, with spaces for the missing bytes.
+ * The default layout, { 16, 1, 0 }, prints exactly what hexdump does.
+ */
+
+#define HEXDUMP_LAYOUT_MAX_ROW_BYTES (64)
+///< 16 offset digits, the gutter, 64 "XX " columns (the last space is the newline), "  |", 64 ASCII characters and "|"
+#define HEXDUMP_LAYOUT_MAX_ROW_CHARS (16 + 2 + (3 * HEXDUMP_LAYOUT_MAX_ROW_BYTES) + 3 + HEXDUMP_LAYOUT_MAX_ROW_BYTES + 1)
+
+#define HEXDUMP_LAYOUT_LITTLE_ENDIAN (0x1u)	///< Print each group as a little-endian word (last byte first)
+#define HEXDUMP_LAYOUT_ASCII (0x2u)		///< Add "  |...|" with printable bytes, '.' for the rest
+#define HEXDUMP_LAYOUT_COLLAPSE (0x4u)		///< Replace each run of rows equal to the row above with one "*" line
+#define HEXDUMP_LAYOUT_OFFSET64 (0x8u)		///< Print 16 offset digits instead of 8
+#define HEXDUMP_LAYOUT_LOWER (0x10u)		///< Lowercase hex digits
+
+typedef struct {
+	uint8_t row_bytes;	///< 16, 32 or 64
+	uint8_t group_bytes;	///< 1, 2, 4 or 8, printed with no space between them
+	uint32_t flags;		///< Bitwise OR of HEXDUMP_LAYOUT_* flags
+} hexdump_layout_t;
+
+typedef struct hexdump_plan hexdump_plan_t;
+
+typedef void (*hexdump_row_fn)(const hexdump_plan_t* plan, char* dst, uint64_t offset, const uint8_t* src);
+
+struct hexdump_plan {
+	hexdump_layout_t layout;
+	hexdump_row_fn emit_row;				///< Full-row emitter picked for the row width and gutter
+	size_t row_chars;					///< Characters in a full row, newline included
+	size_t offset_pairs;					///< Offset digit pairs (4 or 8)
+	size_t hex_column;					///< Column of the first digit of the first group
+	size_t ascii_column;					///< Column of the first ASCII gutter character
+	uint16_t byte_column[HEXDUMP_LAYOUT_MAX_ROW_BYTES];	///< Column of the two digits of each byte of the row
+	char template_row[HEXDUMP_LAYOUT_MAX_ROW_CHARS];
+	char pairs[256][2];
+	char ascii[256];
+};
+
+///< Where a dump made in several calls has got to. Set up with hexdump_cursor_init
+typedef struct {
+	uint64_t offset;	///< Offset printed on the next row
+	const uint8_t* prev;	///< The previous full row, compared against for HEXDUMP_LAYOUT_COLLAPSE
+	int collapsed;		///< 1 once "*" has been printed for the current run of repeated rows
+} hexdump_cursor_t;
+
+int hexdump_plan_compile(hexdump_plan_t* plan, const hexdump_layout_t* layout);
+size_t hexdump_plan_len(const hexdump_plan_t* plan, size_t nbytes);
+void hexdump_cursor_init(hexdump_cursor_t* cursor, uint64_t first_offset);
+size_t hexdump_layout_emit(const hexdump_plan_t* plan, hexdump_cursor_t* cursor, char* str, size_t size, const uint8_t* src, size_t nbytes, size_t* consumed);
+char* hexdump_layout(char* str, size_t size, const hexdump_plan_t* plan, const void* loc, size_t nbytes, uint64_t first_offset);
+
+int test_layout(void);
+
+#endif
@@ -1,6 +1,7 @@
 #ifndef _INC_BITOPS_H
 #define _INC_BITOPS_H
 
+#include <assert.h>
 #include <stdint.h>
 #include <stdlib.h>
 
@@ -10,12 +11,251 @@ typedef enum {
 	TOGGLE
 } operation_t;
 
+///< Instruction set tiers selectable with bitops_set_isa or the BITOPS_ISA environment variable
+typedef enum {
+	BITOPS_ISA_SCALAR,
+	BITOPS_ISA_SSE2,
+	BITOPS_ISA_AVX2,
+	BITOPS_ISA_AVX512
+} bitops_isa_t;
+
+#define BITOPS_CPU_SSE2 (0x1u)
+#define BITOPS_CPU_SSSE3 (0x2u)
+#define BITOPS_CPU_AVX2 (0x4u)
+#define BITOPS_CPU_BMI2 (0x8u)
+#define BITOPS_CPU_AVX512F (0x10u)
+
+typedef struct {
+	uint8_t start_bit;
+	uint8_t width;
+} bitfield_t;
+
+#define BINSTR_SLOT_BYTES(nbits) ((size_t)(nbits) + 3)
+#define BINSTR_RANGE_CHECK (0x1u)
+#define BINSTR_REVERSED (0x2u)		///< Print the nbits-wide value least significant bit first
+#define BINSTR_BIG_ENDIAN (0x4u)	///< Swap the bytes of the nbits-wide value (nbits a multiple of 8) before printing
+
+#define HEXSTR_UPPER (0x0u)
+#define HEXSTR_LOWER (0x1u)
+#define HEXSTR_NO_PREFIX (0x2u)
+#define HEXSTR_REVERSED (0x4u)		///< Reverse the bit order of the nbits-wide value before printing
+#define HEXSTR_BIG_ENDIAN (0x8u)	///< Swap the bytes of the nbits-wide value (nbits 8, 16 or 32) before printing
+#define HEXSTR_SLOT_BYTES(nbits, flags) ((size_t)(nbits) / 4 + (((flags) & HEXSTR_NO_PREFIX) ? 0 : 2) + 1)
+
+///< Precomputed string tables for bitops_set_cache. Each entry is a whole "0b..."/"0x..." string with its \0
+#define BITOPS_CACHE_OFF (0x0u)
+#define BITOPS_CACHE_8 (0x1u)		///< All 256 8-bit strings; 16- and 32-bit values are built from 8-bit entries
+#define BITOPS_CACHE_16 (0x2u)		///< All 65536 16-bit strings as well; 32-bit values are built from two entries
+#define BITOPS_CACHE_BIN8_STRIDE (16)
+#define BITOPS_CACHE_HEX8_STRIDE (8)
+#define BITOPS_CACHE_BIN16_STRIDE (20)
+#define BITOPS_CACHE_HEX16_STRIDE (8)
+#define BITOPS_CACHE_8_BYTES (256 * (BITOPS_CACHE_BIN8_STRIDE + (2 * BITOPS_CACHE_HEX8_STRIDE)))
+#define BITOPS_CACHE_16_BYTES (65536 * (BITOPS_CACHE_BIN16_STRIDE + (2 * BITOPS_CACHE_HEX16_STRIDE)))
+
+#define BITPERM_BITS (32)
+#define BITPERM_ZERO (-1)		///< Permutation table entry for an output bit that is always 0
+
+///< A bit permutation compiled by bitperm_compile, as rotate-and-mask groups and as pext/pdep pairs
+typedef struct {
+	uint8_t ngroups;			///< Groups of source bits that all move by the same rotation
+	uint8_t nchains;			///< Runs of source bits whose order the permutation keeps
+	uint8_t group_rotate[BITPERM_BITS];	///< Left rotation of each group
+	uint32_t group_mask[BITPERM_BITS];	///< Source bits of each group
+	uint32_t chain_src[BITPERM_BITS];	///< Source bits of each run, for pext
+	uint32_t chain_dst[BITPERM_BITS];	///< Destination bits of each run, for pdep
+} bitperm_t;
+
+#define HEXDUMP_BYTES_PER_ROW (16)
+#define HEXDUMP_ROW_CHARS (58)
+
+typedef struct {
+	uint64_t offset;
+	size_t npending;
+	uint8_t pending[HEXDUMP_BYTES_PER_ROW];
+} hexdump_stream_t;
+
+///< Bump-pointer string arena over caller-owned storage. Appended strings sit back to back with no terminators between them
+typedef struct {
+	char* base;
+	size_t size;
+	size_t used;
+} bitops_arena_t;
+
+///< Pointer/length view of one string appended to an arena. A failed append returns { NULL, 0 }
+typedef struct {
+	const char* str;
+	size_t len;
+} bitops_view_t;
+
+bitops_isa_t bitops_init(void);
+bitops_isa_t bitops_set_isa(bitops_isa_t isa);
+bitops_isa_t bitops_isa(void);
+bitops_isa_t bitops_isa_max_supported(void);
+uint32_t bitops_set_cache(uint32_t tables);
+uint32_t bitops_cache(void);
+size_t bitops_cache_footprint(void);
+uint32_t bitops_cpu_features(void);
+const char* bitops_isa_name(bitops_isa_t isa);
+int bitops_isa_parse(const char* name);
 int uint_to_binstr(char* str, size_t size, uint32_t num, uint8_t nbits);
+int uint_to_binstr_fmt(char* str, size_t size, uint32_t num, uint8_t nbits, uint32_t flags);
+int uint_to_binstr_many(const uint32_t* in, size_t n, char* out, size_t out_size, uint8_t nbits);
 int int_to_binstr(char* str, size_t size, int32_t num, uint8_t nbits);
+int int8_to_binstr_many(const int8_t* in, size_t n, char* out, size_t out_size, uint8_t nbits, uint32_t flags);
+int int16_to_binstr_many(const int16_t* in, size_t n, char* out, size_t out_size, uint8_t nbits, uint32_t flags);
+int int32_to_binstr_many(const int32_t* in, size_t n, char* out, size_t out_size, uint8_t nbits, uint32_t flags);
 int uint_to_hexstr(char* str, size_t size, uint32_t num, uint8_t nbits);
+int uint_to_hexstr_fmt(char* str, size_t size, uint32_t num, uint8_t nbits, uint32_t flags);
+int uint_to_hexstr_many(const uint32_t* in, size_t n, char* out, size_t out_size, uint8_t nbits, uint32_t flags);
 uint32_t twiggle_bit(uint32_t input, int bit, operation_t operation);
+int twiggle_bit_many(uint32_t* data, size_t n, int bit, operation_t operation);
+int twiggle_bits_many(uint32_t* data, size_t n, const int* bits, operation_t operation);
 uint32_t grab_three_bits(uint32_t input, int start_bit);
+uint32_t extract_bits(uint32_t input, int start_bit, int width);
+uint32_t deposit_bits(uint32_t input, uint32_t value, int start_bit, int width);
+uint32_t reverse_bits(uint32_t input, int nbits);
+void reverse_bits_many(uint32_t* data, size_t n);
+void swap_bytes_many(uint32_t* data, size_t n);
+int bitperm_compile(bitperm_t* perm, const int8_t table[BITPERM_BITS]);
+uint32_t permute_bits(uint32_t input, const bitperm_t* perm);
+void permute_bits_many(uint32_t* data, size_t n, const bitperm_t* perm);
+void extract_fields(uint32_t input, const bitfield_t* fields, size_t nfields, uint32_t* out);
+uint32_t deposit_fields(uint32_t input, const bitfield_t* fields, size_t nfields, const uint32_t* values);
 char* hexdump(char* str, size_t size, const void* loc, size_t nbytes);
+char* hexdump_parallel(char* str, size_t size, const void* loc, size_t nbytes, int nthreads);
+size_t hexdump_len(size_t nbytes);
+void hexdump_init(hexdump_stream_t* stream);
+size_t hexdump_feed(hexdump_stream_t* stream, char* str, size_t size, const void* loc, size_t nbytes, size_t* consumed);
+size_t hexdump_finish(hexdump_stream_t* stream, char* str, size_t size);
+int binstr_to_uint(const char* str, size_t len, uint32_t* num, size_t* error_pos);
+int hexstr_to_uint(const char* str, size_t len, uint32_t* num, size_t* error_pos);
+int hexdump_parse(const char* text, size_t len, uint8_t* out, size_t out_size, size_t* nbytes, size_t* error_pos);
+void bitops_arena_init(bitops_arena_t* arena, char* buffer, size_t size);
+void bitops_arena_reset(bitops_arena_t* arena);
+bitops_view_t bitops_arena_contents(const bitops_arena_t* arena);
+bitops_view_t bitops_arena_append(bitops_arena_t* arena, const char* str, size_t len);
+bitops_view_t uint_to_binstr_arena(bitops_arena_t* arena, uint32_t num, uint8_t nbits);
+bitops_view_t int_to_binstr_arena(bitops_arena_t* arena, int32_t num, uint8_t nbits);
+bitops_view_t uint_to_hexstr_arena(bitops_arena_t* arena, uint32_t num, uint8_t nbits);
+bitops_view_t hexdump_arena(bitops_arena_t* arena, const void* loc, size_t nbytes);
+
+/*
+ * Fixed-width formatters. Every call site that knows its width at compile time can use
+ * uint_to_binstr8/16/32, int_to_binstr8/16/32 and uint_to_hexstr8/16/32 directly; the
+ * generic functions dispatch to these for widths 8, 16 and 32. Each one is straight-line
+ * code with no loop counter or width check, and produces exactly what the generic
+ * function would for the same width.
+ */
+
+///< Writes the 8 bits of byte as '0'/'1' characters at dst, most significant bit first
+#define BITOPS_BIN_BYTE(dst, byte) do { \
+	(dst)[0] = (char)('0' + (((byte) >> 7) & 1u)); \
+	(dst)[1] = (char)('0' + (((byte) >> 6) & 1u)); \
+	(dst)[2] = (char)('0' + (((byte) >> 5) & 1u)); \
+	(dst)[3] = (char)('0' + (((byte) >> 4) & 1u)); \
+	(dst)[4] = (char)('0' + (((byte) >> 3) & 1u)); \
+	(dst)[5] = (char)('0' + (((byte) >> 2) & 1u)); \
+	(dst)[6] = (char)('0' + (((byte) >> 1) & 1u)); \
+	(dst)[7] = (char)('0' + ((byte) & 1u)); \
+} while (0)
+
+#define BITOPS_BIN_WIDTH_8(dst, v) BITOPS_BIN_BYTE((dst), (v))
+#define BITOPS_BIN_WIDTH_16(dst, v) do { \
+	BITOPS_BIN_BYTE((dst), (v) >> 8); \
+	BITOPS_BIN_BYTE((dst) + 8, (v)); \
+} while (0)
+#define BITOPS_BIN_WIDTH_32(dst, v) do { \
+	BITOPS_BIN_BYTE((dst), (v) >> 24); \
+	BITOPS_BIN_BYTE((dst) + 8, (v) >> 16); \
+	BITOPS_BIN_BYTE((dst) + 16, (v) >> 8); \
+	BITOPS_BIN_BYTE((dst) + 24, (v)); \
+} while (0)
+
+///< Uppercase hex digit for a nibble without a branch: digits above 9 get the extra 7 between '9' and 'A'
+#define BITOPS_HEX_DIGIT(n) ((char)('0' + (n) + ((((n) + 6u) >> 4) * 7u)))
+#define BITOPS_HEX_BYTE(dst, byte) do { \
+	(dst)[0] = BITOPS_HEX_DIGIT(((byte) >> 4) & 0xFu); \
+	(dst)[1] = BITOPS_HEX_DIGIT((byte) & 0xFu); \
+} while (0)
+
+#define BITOPS_HEX_WIDTH_8(dst, v) BITOPS_HEX_BYTE((dst), (v))
+#define BITOPS_HEX_WIDTH_16(dst, v) do { \
+	BITOPS_HEX_BYTE((dst), (v) >> 8); \
+	BITOPS_HEX_BYTE((dst) + 2, (v)); \
+} while (0)
+#define BITOPS_HEX_WIDTH_32(dst, v) do { \
+	BITOPS_HEX_BYTE((dst), (v) >> 24); \
+	BITOPS_HEX_BYTE((dst) + 2, (v) >> 16); \
+	BITOPS_HEX_BYTE((dst) + 4, (v) >> 8); \
+	BITOPS_HEX_BYTE((dst) + 6, (v)); \
+} while (0)
+
+#define BITOPS_DEFINE_FIXED_WIDTH(nbits) \
+static inline int uint_to_binstr##nbits(char* str, size_t size, uint32_t num) { \
+	assert(str != NULL); \
+	assert(size > (size_t)(nbits) + 2); \
+	(void)size; \
+	if (num > (0xFFFFFFFFu >> (32 - (nbits)))) { \
+		str[0] = '\0'; \
+		return -1; \
+	} \
+	str[0] = '0'; \
+	str[1] = 'b'; \
+	BITOPS_BIN_WIDTH_##nbits(str + 2, num); \
+	str[(nbits) + 2] = '\0'; \
+	return (nbits) + 2; \
+} \
+static inline int int_to_binstr##nbits(char* str, size_t size, int32_t num) { \
+	assert(str != NULL); \
+	assert(size > (size_t)(nbits) + 2); \
+	(void)size; \
+	str[0] = '0'; \
+	str[1] = 'b'; \
+	BITOPS_BIN_WIDTH_##nbits(str + 2, (uint32_t)num); \
+	str[(nbits) + 2] = '\0'; \
+	return (nbits) + 2; \
+} \
+static inline int uint_to_hexstr##nbits(char* str, size_t size, uint32_t num) { \
+	assert(str != NULL); \
+	assert(size > (size_t)(nbits) / 4 + 2); \
+	(void)size; \
+	str[0] = '0'; \
+	str[1] = 'x'; \
+	BITOPS_HEX_WIDTH_##nbits(str + 2, num); \
+	str[(nbits) / 4 + 2] = '\0'; \
+	return (nbits) / 4 + 2; \
+}
+
+BITOPS_DEFINE_FIXED_WIDTH(8)
+BITOPS_DEFINE_FIXED_WIDTH(16)
+BITOPS_DEFINE_FIXED_WIDTH(32)
+
+/**
+ * \fn reverse_bits32(uint32_t x)
+ * \brief Reverses the order of the 32 bits of x: three swap steps within each byte, then a byte swap
+ *
+ * \return x with bit 0 swapped with bit 31, bit 1 with bit 30, and so on
+ */
+static inline uint32_t reverse_bits32(uint32_t x) {
+	x = ((x >> 1) & 0x55555555u) | ((x & 0x55555555u) << 1);
+	x = ((x >> 2) & 0x33333333u) | ((x & 0x33333333u) << 2);
+	x = ((x >> 4) & 0x0F0F0F0Fu) | ((x & 0x0F0F0F0Fu) << 4);
+
+	return __builtin_bswap32(x);
+}
+
+/**
+ * \fn swap_bytes32(uint32_t x)
+ * \brief Reverses the byte order of x (one bswap)
+ *
+ * \return x with byte 0 swapped with byte 3 and byte 1 with byte 2
+ */
+static inline uint32_t swap_bytes32(uint32_t x) {
+	return __builtin_bswap32(x);
+}
+
+uint32_t test_rand32(uint32_t* state);
 
 int test_uint_to_binstr(char* str, size_t size, uint32_t num, uint8_t nbits);
 int test_int_to_binstr(char* str, size_t size, int32_t num, uint8_t nbits);
@@ -23,5 +263,17 @@ int test_uint_to_hexstr(char* str, size_t size, uint32_t num, uint8_t nbits);
 int test_twiggle_bit(uint32_t input, int bit, operation_t operation);
 int test_grab_three_bits(uint32_t input, int start_bit);
 int test_hexdump(char* str, size_t size, const void* loc, size_t nbytes);
+int test_uint_to_binstr_many(void);
+int test_uint_to_hexstr_many(void);
+int test_twiggle_bit_many(void);
+int test_extract_bits(void);
+int test_fixed_width(void);
+int test_hexdump_parallel(void);
+int test_int_to_binstr_many(void);
+int test_parsers(void);
+int test_arena(void);
+int test_dispatch(void);
+int test_permute(void);
+int test_cache(void);
 
 #endif
\ No newline at end of file
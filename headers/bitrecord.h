@@ -0,0 +1,36 @@
+#ifndef _INC_BITRECORD_H
+#define _INC_BITRECORD_H
+
+#include <stdint.h>
+#include <stdlib.h>
+#include <sys/uio.h>
+#include "bitops.h"
+
+#define BITREC_MAX_SEGMENTS (128)
+
+///< Builds records as an iovec list: formatted digits live in the arena, prefixes and separators point at constant strings
+typedef struct {
+	bitops_arena_t arena;
+	struct iovec iov[BITREC_MAX_SEGMENTS];
+	int iovcnt;
+	size_t nbytes;
+	const char* separator;
+	size_t separator_len;
+	int need_separator;
+	int failed;
+} bitrec_t;
+
+void bitrec_init(bitrec_t* rec, char* buffer, size_t size, const char* separator);
+void bitrec_reset(bitrec_t* rec);
+int bitrec_static(bitrec_t* rec, const char* str, size_t len);
+int bitrec_end(bitrec_t* rec);
+int bitrec_binstr(bitrec_t* rec, uint32_t num, uint8_t nbits);
+int bitrec_int_binstr(bitrec_t* rec, int32_t num, uint8_t nbits);
+int bitrec_hexstr(bitrec_t* rec, uint32_t num, uint8_t nbits);
+int bitrec_hexdump(bitrec_t* rec, const void* loc, size_t nbytes);
+const struct iovec* bitrec_iov(const bitrec_t* rec, int* iovcnt);
+int bitrec_writev(int fd, bitrec_t* rec);
+
+int test_record(void);
+
+#endif
@@ -0,0 +1,71 @@
+#ifndef _INC_BITSERVE_H
+#define _INC_BITSERVE_H
+
+#include <stdint.h>
+#include <stdlib.h>
+#include "bitops.h"
+
+/*
+ * A formatting service over a Unix domain stream socket. A client sends requests, each a
+ * bitserve_request_t followed by length bytes of payload, and gets back one bitserve_reply_t
+ * and length bytes of output per request, in the order the requests were sent. Both sides are
+ * on one machine, so headers are in host byte order.
+ *
+ *	BITSERVE_BINSTR  : payload is length / 4 uint32_t values, output is what uint_to_binstr_many
+ *	                   writes for nbits (1 to 32, flags 0); status is its count of values too wide,
+ *	                   whose slots are all \0
+ *	BITSERVE_HEXSTR  : payload is length / 4 uint32_t values, output is what uint_to_hexstr_many
+ *	                   writes for nbits (4, 8, 16 or 32) and the HEXSTR_* flags; status is 0
+ *	BITSERVE_HEXDUMP : payload is length raw bytes, output is their hexdump with its \0
+ *	                   (nbits and flags 0); status is 0
+ *
+ * A request with a bad op, nbits, flags or length gets a negative status and no output, and
+ * the connection carries on. A bad magic or a length over BITSERVE_MAX_PAYLOAD closes it.
+ *
+ * The server is one epoll thread and a pool of workers. The epoll thread reads and splits
+ * requests, the workers format them, and the epoll thread writes the replies back in order
+ * without blocking, so a client may keep up to BITSERVE_MAX_INFLIGHT requests outstanding
+ * before reading any reply. Request and reply buffers stay with their job and are reused.
+ */
+
+#define BITSERVE_MAGIC (0x56525342u)			///< "BSRV" in a little-endian dump
+#define BITSERVE_MAX_PAYLOAD (1u << 20)
+#define BITSERVE_MAX_INFLIGHT (64)			///< Requests per connection being formatted or waiting to be written
+#define BITSERVE_MAX_WORKERS (64)
+#define BITSERVE_DEFAULT_SOCKET "/tmp/bitserve.sock"
+#define BITSERVE_INVALID ((size_t)-1)			///< bitserve_reply_bytes for a request the server refuses
+
+#define BITSERVE_BINSTR (1)
+#define BITSERVE_HEXSTR (2)
+#define BITSERVE_HEXDUMP (3)
+
+typedef struct {
+	uint32_t magic;			///< BITSERVE_MAGIC
+	uint8_t op;			///< BITSERVE_BINSTR, BITSERVE_HEXSTR or BITSERVE_HEXDUMP
+	uint8_t nbits;
+	uint16_t flags;
+	uint32_t id;			///< Copied into the reply
+	uint32_t length;		///< Payload bytes after the header
+} bitserve_request_t;
+
+typedef struct {
+	uint32_t magic;			///< BITSERVE_MAGIC
+	int32_t status;			///< Negative if the request was refused
+	uint32_t id;
+	uint32_t length;		///< Output bytes after the header
+} bitserve_reply_t;
+
+typedef struct bitserve_server bitserve_server_t;
+
+bitserve_server_t* bitserve_start(const char* path, int nworkers);
+void bitserve_stop(bitserve_server_t* server);
+
+size_t bitserve_reply_bytes(uint8_t op, uint8_t nbits, uint16_t flags, size_t in_len);
+int bitserve_connect(const char* path);
+int bitserve_send(int fd, uint8_t op, uint8_t nbits, uint16_t flags, uint32_t id, const void* in, size_t in_len);
+int bitserve_recv(int fd, bitserve_reply_t* reply, void* out, size_t out_size);
+int bitserve_call(int fd, uint8_t op, uint8_t nbits, uint16_t flags, const void* in, size_t in_len, void* out, size_t out_size, size_t* out_len);
+
+int test_serve(void);
+
+#endif
@@ -0,0 +1,56 @@
+#ifndef _INC_BITSTATS_H
+#define _INC_BITSTATS_H
+
+#include <stdint.h>
+#include <stdio.h>
+
+/*
+ * Optional per-function counters, compiled in with "make STATS=1" (-DBITOPS_STATS). Each
+ * thread counts into its own block, so the hot path never takes a lock or a contended cache
+ * line; bitops_stats_snapshot and bitops_stats_dump add the blocks of every thread together.
+ * Without BITOPS_STATS the BITOPS_STAT_* macros expand to nothing and the snapshot is all zero.
+ */
+
+typedef enum {
+	BITOPS_STAT_UINT_TO_BINSTR,
+	BITOPS_STAT_INT_TO_BINSTR,
+	BITOPS_STAT_UINT_TO_HEXSTR,
+	BITOPS_STAT_UINT_TO_BINSTR_MANY,
+	BITOPS_STAT_UINT_TO_HEXSTR_MANY,
+	BITOPS_STAT_HEXDUMP,
+	BITOPS_STAT_TWIGGLE_BIT,
+	BITOPS_STAT_GRAB_THREE_BITS,
+	BITOPS_STAT_COUNT
+} bitops_stat_id_t;
+
+///< nbits 1 to 32 have their own bucket; bucket 0 counts calls with no width (hexdump)
+#define BITOPS_STAT_NBITS_BUCKETS (33)
+
+typedef struct {
+	uint64_t calls;
+	uint64_t bytes;
+	uint64_t failures;
+	uint64_t cycles;
+	uint64_t nbits[BITOPS_STAT_NBITS_BUCKETS];
+} bitops_stat_t;
+
+#ifdef BITOPS_STATS
+uint64_t bitops_stat_clock(void);
+void bitops_stat_record(bitops_stat_id_t id, unsigned nbits, uint64_t bytes, int failed, uint64_t cycles);
+
+#define BITOPS_STAT_START() uint64_t bitops_stat_start = bitops_stat_clock()
+#define BITOPS_STAT_STOP(id, nbits, bytes, failed) bitops_stat_record((id), (unsigned)(nbits), (uint64_t)(bytes), (failed), bitops_stat_clock() - bitops_stat_start)
+#else
+#define BITOPS_STAT_START() do { } while (0)
+#define BITOPS_STAT_STOP(id, nbits, bytes, failed) do { } while (0)
+#endif
+
+int bitops_stats_enabled(void);
+void bitops_stats_snapshot(bitops_stat_t stats[BITOPS_STAT_COUNT]);
+void bitops_stats_reset(void);
+void bitops_stats_dump(FILE* f);
+const char* bitops_stat_name(bitops_stat_id_t id);
+
+int test_stats(void);
+
+#endif
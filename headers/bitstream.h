@@ -0,0 +1,44 @@
+#ifndef _INC_BITSTREAM_H
+#define _INC_BITSTREAM_H
+
+#include <stdint.h>
+#include <stdlib.h>
+#include "bitops.h"
+
+/*
+ * Packed fields of any width laid end to end in a byte stream, crossing byte and word
+ * boundaries freely. Bits are numbered as in bitvec and bitdiff: bit p of the stream is bit
+ * (p % 8) of byte p / 8, and each field is stored least significant bit first, so a 3-bit
+ * field followed by a 5-bit field fills one byte as 0bBBBBBAAA.
+ *
+ * A reader keeps the next bits in a 64-bit buffer refilled with one unaligned load at the
+ * current bit position, which always leaves at least 57 bits, so a field of up to
+ * BITSTREAM_MAX_BITS is one shift and mask. A writer ORs fields into the same buffer and
+ * stores whole bytes with one 8-byte store, keeping fewer than 8 bits back. Streams are not
+ * shared between threads.
+ */
+
+#define BITSTREAM_MAX_BITS (57)			///< Widest field bitstream_read and bitstream_write take
+#define BITSTREAM_MAX_MANY_BITS (32)		///< Widest field bitstream_read_many takes
+
+typedef struct {
+	uint8_t* buf;		///< Stream bytes. A reader never writes through it
+	size_t size;		///< Bytes in buf
+	size_t bitpos;		///< Bits read or written so far
+	uint64_t cache;		///< Reader: the bits from bitpos on. Writer: the bits before bitpos not yet stored
+	uint8_t cached;		///< Valid bits in cache (fewer than 8 for a writer)
+	uint8_t writing;	///< 1 for a writer, 0 for a reader
+} bitstream_t;
+
+void bitstream_init_reader(bitstream_t* bs, const void* buf, size_t size);
+void bitstream_init_writer(bitstream_t* bs, void* buf, size_t size);
+int bitstream_read(bitstream_t* bs, uint8_t nbits, uint64_t* value);
+int bitstream_write(bitstream_t* bs, uint64_t value, uint8_t nbits);
+int bitstream_read_many(bitstream_t* bs, uint32_t* out, size_t n, uint8_t nbits);
+int bitstream_seek(bitstream_t* bs, size_t bitpos);
+size_t bitstream_tell(const bitstream_t* bs);
+size_t bitstream_flush(bitstream_t* bs);
+
+int test_bitstream(void);
+
+#endif
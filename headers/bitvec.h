@@ -0,0 +1,41 @@
+#ifndef _INC_BITVEC_H
+#define _INC_BITVEC_H
+
+#include <stdint.h>
+#include <stdlib.h>
+#include "bitops.h"
+
+#define BITVEC_WORD_BITS (64)
+#define BITVEC_WORDS(nbits) (((size_t)(nbits) + BITVEC_WORD_BITS - 1) / BITVEC_WORD_BITS)
+#define BITVEC_NONE ((size_t)-1)
+
+///< Bits at and above nbits in the last word are always kept clear
+typedef struct {
+	uint64_t* words;
+	size_t nbits;
+	int owned;
+} bitvec_t;
+
+int bitvec_init(bitvec_t* bv, size_t nbits);
+void bitvec_wrap(bitvec_t* bv, uint64_t* words, size_t nbits);
+void bitvec_free(bitvec_t* bv);
+
+int bitvec_get(const bitvec_t* bv, size_t bit);
+void bitvec_twiggle(bitvec_t* bv, size_t bit, operation_t operation);
+void bitvec_twiggle_range(bitvec_t* bv, size_t start_bit, size_t count, operation_t operation);
+
+size_t bitvec_popcount(const bitvec_t* bv);
+size_t bitvec_find_first_set(const bitvec_t* bv);
+size_t bitvec_find_next_set(const bitvec_t* bv, size_t from_bit);
+
+void bitvec_and(bitvec_t* dst, const bitvec_t* a, const bitvec_t* b);
+void bitvec_or(bitvec_t* dst, const bitvec_t* a, const bitvec_t* b);
+void bitvec_xor(bitvec_t* dst, const bitvec_t* a, const bitvec_t* b);
+void bitvec_andnot(bitvec_t* dst, const bitvec_t* a, const bitvec_t* b);
+
+int bitvec_to_binstr(char* str, size_t size, const bitvec_t* bv);
+char* bitvec_hexdump(char* str, size_t size, const bitvec_t* bv);
+
+int test_bitvec(void);
+
+#endif
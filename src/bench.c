@@ -0,0 +1,851 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <fcntl.h>
+#include <pthread.h>
+#include <time.h>
+#include <unistd.h>
+#include "bitops.h"
+#include "bitatomic.h"
+#include "bitdiff.h"
+#include "bitlayout.h"
+#include "bitrecord.h"
+#include "bitstream.h"
+#include "bitstats.h"
+
+#define NULL_TERMINATOR_BYTE (1)
+#define PREFIX_BYTES_BIN (2)
+#define UINT32_T_BITS (32)
+
+#define BENCH_VALUES (4096)
+#define BENCH_WARMUP_RUNS (3)
+#define BENCH_TIMED_RUNS (101)
+#define BENCH_DUMP_BYTES (4096)
+#define BENCH_DUMP_CHARS (BENCH_DUMP_BYTES / HEXDUMP_BYTES_PER_ROW * HEXDUMP_ROW_CHARS + NULL_TERMINATOR_BYTE)
+#define BENCH_SEED (5813u)
+#define BENCH_RECORD_BYTES (128)
+#define BENCH_RECORD_SEGMENTS (10)
+#define BENCH_DIFF_BYTES (8u << 20)
+#define BENCH_DIFF_STRIDE (65536u)
+#define BENCH_STREAM_FIELDS (65536u)
+#define BENCH_STREAM_BYTES (BENCH_STREAM_FIELDS * 4u)
+#define BENCH_ATOMIC_MAX_THREADS (8)
+#define BENCH_ATOMIC_PAIRS (200000u)
+#define BENCH_EVICT_BYTES (64u << 20)
+#define BENCH_EVICT_LINES (8)
+#define BENCH_LINE_BYTES (64)
+
+typedef enum {
+	INPUT_SEQUENTIAL,
+	INPUT_RANDOM
+} bench_input_t;
+
+typedef struct {
+	const char* name;
+	int nbits;
+	size_t (*run)(int nbits);
+} bench_case_t;
+
+typedef struct {
+	const char* name;
+	const char* input;
+	int nbits;
+	double median_ns;
+	double p99_ns;
+	double mb_per_s;
+	double syscalls_per_call;
+	double copied_per_call;
+} bench_result_t;
+
+static uint32_t bench_values[BENCH_VALUES];
+static int bench_bits[BENCH_VALUES];
+static uint8_t bench_dump_input[BENCH_DUMP_BYTES];
+static uint8_t bench_sparse_input[BENCH_DUMP_BYTES];
+static hexdump_plan_t bench_plan_default;
+static hexdump_plan_t bench_plan_collapse;
+static char bench_dump_output[BENCH_DUMP_CHARS];
+static uint8_t* bench_diff_a;
+static uint8_t* bench_diff_b;
+static uint8_t* bench_diff_xor;
+static uint8_t bench_stream[BENCH_STREAM_BYTES];
+static uint32_t bench_stream_fields[BENCH_STREAM_FIELDS];
+static bitperm_t bench_perm;
+static uint8_t* bench_evict_buf;
+static size_t bench_evict_pos;
+static char bench_hex_output[BENCH_VALUES * HEXSTR_SLOT_BYTES(UINT32_T_BITS, HEXSTR_LOWER)];
+static volatile uint32_t bench_sink;
+static int bench_null_fd = -1;
+static size_t bench_syscalls;
+static size_t bench_copied;
+
+/**
+ * \fn bench_now_ns(void)
+ * \brief Reads the monotonic clock
+ *
+ * \return The current time in nanoseconds
+ */
+static uint64_t bench_now_ns(void) {
+	struct timespec ts;
+
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+
+	return ((uint64_t)ts.tv_sec * 1000000000ull) + (uint64_t)ts.tv_nsec;
+}
+
+/**
+ * \fn bench_fill(bench_input_t input, int nbits)
+ * \brief Fills the shared input sets with either counting or pseudo-random values that fit in nbits
+ *
+ * \return None
+ */
+static void bench_fill(bench_input_t input, int nbits) {
+	uint32_t state = BENCH_SEED;
+	uint32_t mask = 0xFFFFFFFF >> (UINT32_T_BITS - nbits);
+	int i;
+
+	for (i = 0; i < BENCH_VALUES; i++) {
+		if (input == INPUT_SEQUENTIAL) {
+			bench_values[i] = (uint32_t)i & mask;
+			bench_bits[i] = i % UINT32_T_BITS;
+		}
+		else {
+			state ^= state << 13;
+			state ^= state >> 17;
+			state ^= state << 5;
+			bench_values[i] = state & mask;
+			bench_bits[i] = (int)(state >> 27);
+		}
+	}
+
+	for (i = 0; i < BENCH_DUMP_BYTES; i++) {
+		bench_dump_input[i] = (uint8_t)bench_values[i % BENCH_VALUES];
+		///< One non-zero byte per 1 KiB, like a sparsely used memory region
+		bench_sparse_input[i] = ((i % 1024) == 100) ? bench_dump_input[i] | 1u : 0;
+	}
+}
+
+///< Each runner makes one call per value in the input set and returns the number of bytes it produced
+static size_t run_uint_to_binstr(int nbits) {
+	char str[PREFIX_BYTES_BIN + UINT32_T_BITS + NULL_TERMINATOR_BYTE];
+	size_t bytes = 0;
+	int i;
+
+	for (i = 0; i < BENCH_VALUES; i++) {
+		bytes += (size_t)uint_to_binstr(str, sizeof(str), bench_values[i], (uint8_t)nbits);
+		bench_sink += (uint32_t)str[2];
+	}
+
+	return bytes;
+}
+
+static size_t run_int_to_binstr(int nbits) {
+	char str[PREFIX_BYTES_BIN + UINT32_T_BITS + NULL_TERMINATOR_BYTE];
+	size_t bytes = 0;
+	int i;
+
+	for (i = 0; i < BENCH_VALUES; i++) {
+		bytes += (size_t)int_to_binstr(str, sizeof(str), (int32_t)bench_values[i], (uint8_t)nbits);
+		bench_sink += (uint32_t)str[2];
+	}
+
+	return bytes;
+}
+
+static size_t run_int32_to_binstr_many(int nbits) {
+	static char out[BENCH_VALUES * (PREFIX_BYTES_BIN + UINT32_T_BITS + NULL_TERMINATOR_BYTE)];
+
+	int32_to_binstr_many((const int32_t*)bench_values, BENCH_VALUES, out, sizeof(out), (uint8_t)nbits, 0);
+	bench_sink += (uint32_t)out[2];
+
+	return BENCH_VALUES * (size_t)(nbits + PREFIX_BYTES_BIN);
+}
+
+static size_t run_uint_to_hexstr(int nbits) {
+	char str[PREFIX_BYTES_BIN + UINT32_T_BITS + NULL_TERMINATOR_BYTE];
+	size_t bytes = 0;
+	int i;
+
+	for (i = 0; i < BENCH_VALUES; i++) {
+		bytes += (size_t)uint_to_hexstr(str, sizeof(str), bench_values[i], (uint8_t)nbits);
+		bench_sink += (uint32_t)str[2];
+	}
+
+	return bytes;
+}
+
+static size_t run_twiggle_bit(int nbits) {
+	uint32_t acc = 0;
+	int i;
+
+	for (i = 0; i < BENCH_VALUES; i++) {
+		acc += twiggle_bit(bench_values[i], bench_bits[i], (operation_t)(i % 3));
+	}
+	bench_sink += acc;
+
+	return BENCH_VALUES * sizeof(uint32_t);
+}
+
+static size_t run_grab_three_bits(int nbits) {
+	uint32_t acc = 0;
+	int i;
+
+	for (i = 0; i < BENCH_VALUES; i++) {
+		acc += grab_three_bits(bench_values[i], bench_bits[i] % (UINT32_T_BITS - 2));
+	}
+	bench_sink += acc;
+
+	return BENCH_VALUES * sizeof(uint32_t);
+}
+
+static size_t run_hexdump(int nbits) {
+	hexdump(bench_dump_output, sizeof(bench_dump_output), bench_dump_input, BENCH_DUMP_BYTES);
+	bench_sink += (uint32_t)bench_dump_output[0];
+
+	return hexdump_len(BENCH_DUMP_BYTES);
+}
+
+///< The default layout through the compiled row emitter, on the same input as run_hexdump
+static size_t run_hexdump_layout(int nbits) {
+	hexdump_layout(bench_dump_output, sizeof(bench_dump_output), &bench_plan_default, bench_dump_input, BENCH_DUMP_BYTES, 0);
+	bench_sink += (uint32_t)bench_dump_output[0];
+
+	return hexdump_len(BENCH_DUMP_BYTES);
+}
+
+///< A mostly-zero buffer with hexdump, then with 64-byte rows collapsing repeats
+static size_t run_hexdump_sparse(int nbits) {
+	hexdump(bench_dump_output, sizeof(bench_dump_output), bench_sparse_input, BENCH_DUMP_BYTES);
+	bench_sink += (uint32_t)bench_dump_output[0];
+
+	return hexdump_len(BENCH_DUMP_BYTES);
+}
+
+static size_t run_hexdump_collapse(int nbits) {
+	hexdump_layout(bench_dump_output, sizeof(bench_dump_output), &bench_plan_collapse, bench_sparse_input, BENCH_DUMP_BYTES, 0);
+	bench_sink += (uint32_t)bench_dump_output[0];
+
+	return strlen(bench_dump_output);
+}
+
+///< Two 8 MiB snapshots that differ in one bit per 64 KiB. The memcmp baseline finds the same changed blocks; each case reports both buffers as its bytes
+static size_t run_bitdiff_memcmp(int nbits) {
+	size_t changed = 0;
+	size_t k;
+
+	for (k = 0; k < BENCH_DIFF_BYTES; k += BITDIFF_BLOCK_BYTES) {
+		changed += (memcmp(bench_diff_a + k, bench_diff_b + k, BITDIFF_BLOCK_BYTES) != 0);
+	}
+	bench_sink += (uint32_t)changed;
+
+	return 2 * BENCH_DIFF_BYTES;
+}
+
+static size_t run_bitdiff_count(int nbits) {
+	bench_sink += (uint32_t)bitdiff_count(bench_diff_a, bench_diff_b, BENCH_DIFF_BYTES);
+
+	return 2 * BENCH_DIFF_BYTES;
+}
+
+static size_t run_bitdiff_walk(int nbits) {
+	bitdiff_iter_t it;
+	size_t pos;
+
+	bitdiff_init(&it, bench_diff_a, bench_diff_b, BENCH_DIFF_BYTES);
+	while ((pos = bitdiff_next(&it)) != BITDIFF_NONE) {
+		bench_sink += (uint32_t)pos;
+	}
+
+	return 2 * BENCH_DIFF_BYTES;
+}
+
+static size_t run_bitdiff_xor(int nbits) {
+	bitdiff_xor(bench_diff_xor, bench_diff_a, bench_diff_b, BENCH_DIFF_BYTES);
+	bench_sink += bench_diff_xor[0];
+
+	return 2 * BENCH_DIFF_BYTES;
+}
+
+///< BENCH_STREAM_FIELDS packed fields of nbits bits, one bitstream_read per field, then one bitstream_read_many. Bytes are the decoded uint32_t array
+static size_t run_bitstream_read(int nbits) {
+	bitstream_t bs;
+	uint64_t value;
+	size_t i;
+
+	bitstream_init_reader(&bs, bench_stream, BENCH_STREAM_BYTES);
+	for (i = 0; i < BENCH_STREAM_FIELDS; i++) {
+		bitstream_read(&bs, (uint8_t)nbits, &value);
+		bench_stream_fields[i] = (uint32_t)value;
+	}
+	bench_sink += bench_stream_fields[BENCH_STREAM_FIELDS - 1];
+
+	return sizeof(bench_stream_fields);
+}
+
+static size_t run_bitstream_read_many(int nbits) {
+	bitstream_t bs;
+
+	bitstream_init_reader(&bs, bench_stream, BENCH_STREAM_BYTES);
+	bitstream_read_many(&bs, bench_stream_fields, BENCH_STREAM_FIELDS, (uint8_t)nbits);
+	bench_sink += bench_stream_fields[BENCH_STREAM_FIELDS - 1];
+
+	return sizeof(bench_stream_fields);
+}
+
+/**
+ * \fn bench_evict(void)
+ * \brief Reads the next BENCH_EVICT_LINES cache lines of a buffer larger than the last-level cache, standing in for the rest of a busy process competing for the cache
+ *
+ * \return None
+ */
+static inline void bench_evict(void) {
+	uint32_t acc = 0;
+	int i;
+
+	for (i = 0; i < BENCH_EVICT_LINES; i++) {
+		acc += bench_evict_buf[bench_evict_pos];
+		bench_evict_pos = (bench_evict_pos + BENCH_LINE_BYTES) % BENCH_EVICT_BYTES;
+	}
+	bench_sink += acc;
+}
+
+/**
+ * \fn bench_format(int nbits, uint32_t tables, int hex, int evict)
+ * \brief One uint_to_binstr or uint_to_hexstr call per value with the given string tables selected, optionally with bench_evict between calls
+ *
+ * \return Bytes produced
+ */
+static size_t bench_format(int nbits, uint32_t tables, int hex, int evict) {
+	char str[PREFIX_BYTES_BIN + UINT32_T_BITS + NULL_TERMINATOR_BYTE];
+	size_t bytes = 0;
+	int i;
+
+	bitops_set_cache(tables);
+	for (i = 0; i < BENCH_VALUES; i++) {
+		if (evict) {
+			bench_evict();
+		}
+		bytes += (size_t)(hex ? uint_to_hexstr(str, sizeof(str), bench_values[i], (uint8_t)nbits) : uint_to_binstr(str, sizeof(str), bench_values[i], (uint8_t)nbits));
+		bench_sink += (uint32_t)str[2];
+	}
+	bitops_set_cache(BITOPS_CACHE_OFF);
+
+	return bytes;
+}
+
+///< Table and computed formatting: run_uint_to_binstr and run_uint_to_hexstr are the computed paths without eviction
+static size_t run_binstr_table8(int nbits) {
+	return bench_format(nbits, BITOPS_CACHE_8, 0, 0);
+}
+
+static size_t run_binstr_table16(int nbits) {
+	return bench_format(nbits, BITOPS_CACHE_16, 0, 0);
+}
+
+static size_t run_hexstr_table16(int nbits) {
+	return bench_format(nbits, BITOPS_CACHE_16, 1, 0);
+}
+
+static size_t run_binstr_evict(int nbits) {
+	return bench_format(nbits, BITOPS_CACHE_OFF, 0, 1);
+}
+
+static size_t run_binstr_table8_evict(int nbits) {
+	return bench_format(nbits, BITOPS_CACHE_8, 0, 1);
+}
+
+static size_t run_binstr_table16_evict(int nbits) {
+	return bench_format(nbits, BITOPS_CACHE_16, 0, 1);
+}
+
+static size_t run_hexstr_evict(int nbits) {
+	return bench_format(nbits, BITOPS_CACHE_OFF, 1, 1);
+}
+
+static size_t run_hexstr_table16_evict(int nbits) {
+	return bench_format(nbits, BITOPS_CACHE_16, 1, 1);
+}
+
+///< In-place word transforms on bench_values. Each pass transforms the previous pass's output, which costs the same
+static size_t run_reverse_bits_many(int nbits) {
+	reverse_bits_many(bench_values, BENCH_VALUES);
+	bench_sink += bench_values[0];
+
+	return sizeof(bench_values);
+}
+
+static size_t run_swap_bytes_many(int nbits) {
+	swap_bytes_many(bench_values, BENCH_VALUES);
+	bench_sink += bench_values[0];
+
+	return sizeof(bench_values);
+}
+
+static size_t run_permute_bits(int nbits) {
+	uint32_t acc = 0;
+	int i;
+
+	for (i = 0; i < BENCH_VALUES; i++) {
+		acc += permute_bits(bench_values[i], &bench_perm);
+	}
+	bench_sink += acc;
+
+	return sizeof(bench_values);
+}
+
+static size_t run_permute_bits_many(int nbits) {
+	permute_bits_many(bench_values, BENCH_VALUES, &bench_perm);
+	bench_sink += bench_values[0];
+
+	return sizeof(bench_values);
+}
+
+///< Big-endian hex of every value: the byte swap folded into the formatter, then as a separate swap_bytes_many pass
+static size_t run_hexstr_big_endian(int nbits) {
+	uint_to_hexstr_many(bench_values, BENCH_VALUES, bench_hex_output, sizeof(bench_hex_output), (uint8_t)nbits, HEXSTR_LOWER | HEXSTR_BIG_ENDIAN);
+	bench_sink += (uint32_t)bench_hex_output[2];
+
+	return sizeof(bench_hex_output);
+}
+
+static size_t run_hexstr_swap_then_format(int nbits) {
+	swap_bytes_many(bench_values, BENCH_VALUES);
+	uint_to_hexstr_many(bench_values, BENCH_VALUES, bench_hex_output, sizeof(bench_hex_output), (uint8_t)nbits, HEXSTR_LOWER);
+	bench_sink += (uint32_t)bench_hex_output[2];
+
+	return sizeof(bench_hex_output);
+}
+
+///< One log record "reg 0x<hex32>, 0b<nbits>, 0b<nbits signed>\n" per value, written to /dev/null. bench_copied counts bytes stored into user buffers
+static size_t run_record_concat(int nbits) {
+	char str[PREFIX_BYTES_BIN + UINT32_T_BITS + NULL_TERMINATOR_BYTE];
+	char line[BENCH_RECORD_BYTES];
+	size_t bytes = 0;
+	size_t len;
+	int n;
+	int i;
+
+	for (i = 0; i < BENCH_VALUES; i++) {
+		memcpy(line, "reg ", 4);
+		len = 4;
+		n = uint_to_hexstr(str, sizeof(str), bench_values[i], UINT32_T_BITS);
+		memcpy(line + len, str, (size_t)n);
+		len += (size_t)n;
+		bench_copied += 2 * (size_t)n + NULL_TERMINATOR_BYTE;
+		memcpy(line + len, ", ", 2);
+		len += 2;
+		n = uint_to_binstr(str, sizeof(str), bench_values[i], (uint8_t)nbits);
+		memcpy(line + len, str, (size_t)n);
+		len += (size_t)n;
+		bench_copied += 2 * (size_t)n + NULL_TERMINATOR_BYTE;
+		memcpy(line + len, ", ", 2);
+		len += 2;
+		n = int_to_binstr(str, sizeof(str), (int32_t)bench_values[i], (uint8_t)nbits);
+		memcpy(line + len, str, (size_t)n);
+		len += (size_t)n;
+		bench_copied += 2 * (size_t)n + NULL_TERMINATOR_BYTE;
+		line[len++] = '\n';
+		bench_copied += 4 + 2 + 2 + 1;
+
+		bytes += (size_t)write(bench_null_fd, line, len);
+		bench_syscalls++;
+	}
+
+	return bytes;
+}
+
+static size_t run_record_iovec(int nbits) {
+	static char buffer[BITREC_MAX_SEGMENTS / BENCH_RECORD_SEGMENTS * BENCH_RECORD_BYTES];
+	static bitrec_t rec;
+	size_t bytes = 0;
+	size_t used;
+	int i;
+
+	bitrec_init(&rec, buffer, sizeof(buffer), ", ");
+
+	for (i = 0; i < BENCH_VALUES; i++) {
+		if (rec.iovcnt + BENCH_RECORD_SEGMENTS > BITREC_MAX_SEGMENTS) {
+			bytes += rec.nbytes;
+			bitrec_writev(bench_null_fd, &rec);
+			bench_syscalls++;
+		}
+
+		used = rec.arena.used;
+		bitrec_static(&rec, "reg ", 4);
+		bitrec_hexstr(&rec, bench_values[i], UINT32_T_BITS);
+		bitrec_binstr(&rec, bench_values[i], (uint8_t)nbits);
+		bitrec_int_binstr(&rec, (int32_t)bench_values[i], (uint8_t)nbits);
+		bitrec_end(&rec);
+		///< Each formatter also stores the terminator that the next field overwrites
+		bench_copied += rec.arena.used - used + 3;
+	}
+
+	bytes += rec.nbytes;
+	bitrec_writev(bench_null_fd, &rec);
+	bench_syscalls++;
+
+	return bytes;
+}
+
+static const bench_case_t bench_cases[] = {
+	{ "uint_to_binstr", 8, run_uint_to_binstr },
+	{ "uint_to_binstr", 16, run_uint_to_binstr },
+	{ "uint_to_binstr", 32, run_uint_to_binstr },
+	{ "int_to_binstr", 8, run_int_to_binstr },
+	{ "int_to_binstr", 12, run_int_to_binstr },
+	{ "int_to_binstr", 32, run_int_to_binstr },
+	{ "int32_to_binstr_many", 8, run_int32_to_binstr_many },
+	{ "int32_to_binstr_many", 12, run_int32_to_binstr_many },
+	{ "int32_to_binstr_many", 32, run_int32_to_binstr_many },
+	{ "uint_to_hexstr", 8, run_uint_to_hexstr },
+	{ "uint_to_hexstr", 16, run_uint_to_hexstr },
+	{ "uint_to_hexstr", 32, run_uint_to_hexstr },
+	{ "binstr_table8", 8, run_binstr_table8 },
+	{ "binstr_table8", 16, run_binstr_table8 },
+	{ "binstr_table8", 32, run_binstr_table8 },
+	{ "binstr_table16", 16, run_binstr_table16 },
+	{ "binstr_table16", 32, run_binstr_table16 },
+	{ "hexstr_table16", 16, run_hexstr_table16 },
+	{ "hexstr_table16", 32, run_hexstr_table16 },
+	{ "binstr_evict", 16, run_binstr_evict },
+	{ "binstr_table8_evict", 16, run_binstr_table8_evict },
+	{ "binstr_table16_evict", 16, run_binstr_table16_evict },
+	{ "hexstr_evict", 16, run_hexstr_evict },
+	{ "hexstr_table16_evict", 16, run_hexstr_table16_evict },
+	{ "twiggle_bit", 32, run_twiggle_bit },
+	{ "grab_three_bits", 32, run_grab_three_bits },
+	{ "hexdump", 8, run_hexdump },
+	{ "hexdump_layout", 8, run_hexdump_layout },
+	{ "hexdump_sparse", 8, run_hexdump_sparse },
+	{ "hexdump_collapse", 8, run_hexdump_collapse },
+	{ "bitdiff_memcmp", 8, run_bitdiff_memcmp },
+	{ "bitdiff_count", 8, run_bitdiff_count },
+	{ "bitdiff_walk", 8, run_bitdiff_walk },
+	{ "bitdiff_xor", 8, run_bitdiff_xor },
+	{ "bitstream_read", 3, run_bitstream_read },
+	{ "bitstream_read", 5, run_bitstream_read },
+	{ "bitstream_read", 13, run_bitstream_read },
+	{ "bitstream_read_many", 3, run_bitstream_read_many },
+	{ "bitstream_read_many", 5, run_bitstream_read_many },
+	{ "bitstream_read_many", 13, run_bitstream_read_many },
+	{ "reverse_bits_many", 32, run_reverse_bits_many },
+	{ "swap_bytes_many", 32, run_swap_bytes_many },
+	{ "permute_bits", 32, run_permute_bits },
+	{ "permute_bits_many", 32, run_permute_bits_many },
+	{ "hexstr_big_endian", 32, run_hexstr_big_endian },
+	{ "hexstr_swap_then_format", 32, run_hexstr_swap_then_format },
+	{ "record_concat", 12, run_record_concat },
+	{ "record_iovec", 12, run_record_iovec }
+};
+
+#define BENCH_NCASES (sizeof(bench_cases) / sizeof(bench_cases[0]))
+
+static int bench_compare(const void* a, const void* b) {
+	double x = *(const double*)a;
+	double y = *(const double*)b;
+
+	return (x > y) - (x < y);
+}
+
+typedef enum {
+	ATOMIC_MUTEX_WORD,		///< twiggle_bit on one shared word under a mutex
+	ATOMIC_SHARED_WORD,		///< atomic_test_and_set_bit / atomic_test_and_clear_bit, each thread on its own bit of one word
+	ATOMIC_DENSE_BITMAP,		///< atomic_bitmap_twiggle with 512-bit shards, thread t on bit t: one cache line for all threads
+	ATOMIC_PADDED_BITMAP,		///< atomic_bitmap_twiggle with 64-bit shards, thread t on bit 64 * t: one cache line per thread
+	ATOMIC_MODES
+} bench_atomic_mode_t;
+
+static const char* bench_atomic_names[ATOMIC_MODES] = { "mutex twiggle_bit", "atomic shared word", "atomic dense bitmap", "atomic padded bitmap" };
+
+typedef struct {
+	bench_atomic_mode_t mode;
+	int id;
+	uint32_t* word;
+	pthread_mutex_t* lock;
+	atomic_bitmap_t* bitmap;
+} bench_atomic_worker_t;
+
+/**
+ * \fn bench_atomic_worker(void* arg)
+ * \brief Sets and clears one bit BENCH_ATOMIC_PAIRS times the way its mode says
+ *
+ * \return NULL
+ */
+static void* bench_atomic_worker(void* arg) {
+	bench_atomic_worker_t* w = (bench_atomic_worker_t*)arg;
+	size_t bit = (w->mode == ATOMIC_PADDED_BITMAP) ? (size_t)w->id * 64 : (size_t)w->id;
+	uint32_t i;
+
+	for (i = 0; i < BENCH_ATOMIC_PAIRS; i++) {
+		switch (w->mode) {
+			case ATOMIC_MUTEX_WORD:
+				pthread_mutex_lock(w->lock);
+				*w->word = twiggle_bit(*w->word, w->id, SET);
+				pthread_mutex_unlock(w->lock);
+				pthread_mutex_lock(w->lock);
+				*w->word = twiggle_bit(*w->word, w->id, CLEAR);
+				pthread_mutex_unlock(w->lock);
+				break;
+			case ATOMIC_SHARED_WORD:
+				atomic_test_and_set_bit(w->word, w->id, __ATOMIC_ACQUIRE);
+				atomic_test_and_clear_bit(w->word, w->id, __ATOMIC_RELEASE);
+				break;
+			default:
+				atomic_bitmap_twiggle(w->bitmap, bit, SET, __ATOMIC_ACQUIRE);
+				atomic_bitmap_twiggle(w->bitmap, bit, CLEAR, __ATOMIC_RELEASE);
+				break;
+		}
+	}
+
+	return NULL;
+}
+
+/**
+ * \fn bench_atomic(bench_atomic_mode_t mode, int nthreads)
+ * \brief Runs nthreads workers of one mode at once
+ *
+ * \return Million bit operations per second over all threads, or 0 if the threads could not be started
+ */
+static double bench_atomic(bench_atomic_mode_t mode, int nthreads) {
+	bench_atomic_worker_t workers[BENCH_ATOMIC_MAX_THREADS];
+	pthread_t threads[BENCH_ATOMIC_MAX_THREADS];
+	pthread_mutex_t lock = PTHREAD_MUTEX_INITIALIZER;
+	atomic_bitmap_t bitmap;
+	uint32_t word = 0;
+	uint64_t start;
+	uint64_t elapsed;
+	int started = 0;
+	int t;
+
+	if (atomic_bitmap_init(&bitmap, BENCH_ATOMIC_MAX_THREADS * 64, (mode == ATOMIC_DENSE_BITMAP) ? 512 : 64) != 0) {
+		return 0.0;
+	}
+
+	start = bench_now_ns();
+	for (t = 0; t < nthreads; t++) {
+		workers[t].mode = mode;
+		workers[t].id = t;
+		workers[t].word = &word;
+		workers[t].lock = &lock;
+		workers[t].bitmap = &bitmap;
+		if (pthread_create(&threads[t], NULL, bench_atomic_worker, &workers[t]) != 0) {
+			break;
+		}
+		started++;
+	}
+	for (t = 0; t < started; t++) {
+		pthread_join(threads[t], NULL);
+	}
+	elapsed = bench_now_ns() - start;
+	atomic_bitmap_free(&bitmap);
+	bench_sink += word;
+
+	return (started == nthreads) ? ((double)nthreads * BENCH_ATOMIC_PAIRS * 2.0) / ((double)elapsed / 1000.0) : 0.0;
+}
+
+/**
+ * \fn bench_calls(const bench_case_t* bc)
+ * \brief Calls per timed pass: one for the cases that process a whole buffer, one per input value for the rest
+ *
+ * \return The number of calls the pass time is divided by
+ */
+static size_t bench_calls(const bench_case_t* bc) {
+	static size_t (*const whole_buffer[])(int nbits) = { run_hexdump, run_hexdump_layout, run_hexdump_sparse, run_hexdump_collapse, run_bitdiff_memcmp, run_bitdiff_count, run_bitdiff_walk, run_bitdiff_xor, run_bitstream_read, run_bitstream_read_many };
+	size_t i;
+
+	for (i = 0; i < sizeof(whole_buffer) / sizeof(whole_buffer[0]); i++) {
+		if (bc->run == whole_buffer[i]) {
+			return 1;
+		}
+	}
+
+	return BENCH_VALUES;
+}
+
+/**
+ * \fn bench_measure(const bench_case_t* bc, bench_input_t input, bench_result_t* result)
+ * \brief Warms up one case, times BENCH_TIMED_RUNS passes over the input set, and reports median and p99 per call
+ *
+ * \return None
+ */
+static void bench_measure(const bench_case_t* bc, bench_input_t input, bench_result_t* result) {
+	double samples[BENCH_TIMED_RUNS];
+	uint64_t start;
+	size_t bytes = 0;
+	size_t calls = bench_calls(bc);
+	int i;
+
+	bench_fill(input, bc->nbits);
+
+	for (i = 0; i < BENCH_WARMUP_RUNS; i++) {
+		bc->run(bc->nbits);
+	}
+
+	bench_syscalls = 0;
+	bench_copied = 0;
+
+	for (i = 0; i < BENCH_TIMED_RUNS; i++) {
+		start = bench_now_ns();
+		bytes = bc->run(bc->nbits);
+		samples[i] = (double)(bench_now_ns() - start) / (double)calls;
+	}
+
+	qsort(samples, BENCH_TIMED_RUNS, sizeof(samples[0]), bench_compare);
+
+	result->name = bc->name;
+	result->input = (input == INPUT_SEQUENTIAL) ? "sequential" : "random";
+	result->nbits = bc->nbits;
+	result->median_ns = samples[BENCH_TIMED_RUNS / 2];
+	result->p99_ns = samples[(BENCH_TIMED_RUNS * 99 + 99) / 100 - 1];
+	///< Bytes per call over ns per call is GB/s; scale to MB/s
+	result->mb_per_s = ((double)bytes / (double)calls) / result->median_ns * 1000.0;
+	result->syscalls_per_call = (double)bench_syscalls / (double)(calls * BENCH_TIMED_RUNS);
+	result->copied_per_call = (double)bench_copied / (double)(calls * BENCH_TIMED_RUNS);
+}
+
+static void bench_write_csv(FILE* f, const bench_result_t* results, size_t n) {
+	size_t i;
+
+	fprintf(f, "function,nbits,input,median_ns_per_call,p99_ns_per_call,mb_per_s,syscalls_per_call,bytes_copied_per_call\n");
+	for (i = 0; i < n; i++) {
+		fprintf(f, "%s,%d,%s,%.3f,%.3f,%.1f,%.3f,%.1f\n", results[i].name, results[i].nbits, results[i].input, results[i].median_ns, results[i].p99_ns, results[i].mb_per_s, results[i].syscalls_per_call, results[i].copied_per_call);
+	}
+}
+
+static void bench_write_json(FILE* f, const bench_result_t* results, size_t n) {
+	size_t i;
+
+	fprintf(f, "[\n");
+	for (i = 0; i < n; i++) {
+		fprintf(f, "  {\"function\": \"%s\", \"nbits\": %d, \"input\": \"%s\", \"median_ns_per_call\": %.3f, \"p99_ns_per_call\": %.3f, \"mb_per_s\": %.1f, \"syscalls_per_call\": %.3f, \"bytes_copied_per_call\": %.1f}%s\n", results[i].name, results[i].nbits, results[i].input, results[i].median_ns, results[i].p99_ns, results[i].mb_per_s, results[i].syscalls_per_call, results[i].copied_per_call, (i + 1 < n) ? "," : "");
+	}
+	fprintf(f, "]\n");
+}
+
+int main(int argc, char** argv) {
+	bench_result_t results[BENCH_NCASES * 2];
+	const char* csv_path = NULL;
+	const char* json_path = NULL;
+	size_t n = 0;
+	size_t i;
+	int input;
+	int nthreads;
+	FILE* f;
+
+	for (i = 1; i < (size_t)argc; i++) {
+		if ((strcmp(argv[i], "--csv") == 0) && (i + 1 < (size_t)argc)) {
+			csv_path = argv[++i];
+		}
+		else if ((strcmp(argv[i], "--json") == 0) && (i + 1 < (size_t)argc)) {
+			json_path = argv[++i];
+		}
+		else {
+			fprintf(stderr, "usage: %s [--csv file] [--json file]\n", argv[0]);
+			return EXIT_FAILURE;
+		}
+	}
+
+	hexdump_layout_t layout = { 16, 1, 0 };
+
+	hexdump_plan_compile(&bench_plan_default, &layout);
+	layout.row_bytes = 64;
+	layout.group_bytes = 8;
+	layout.flags = HEXDUMP_LAYOUT_COLLAPSE;
+	hexdump_plan_compile(&bench_plan_collapse, &layout);
+
+	bench_evict_buf = calloc(BENCH_EVICT_BYTES, 1);
+	if (bench_evict_buf == NULL) {
+		perror("calloc");
+		return EXIT_FAILURE;
+	}
+
+	bench_diff_a = calloc(BENCH_DIFF_BYTES, 1);
+	bench_diff_b = calloc(BENCH_DIFF_BYTES, 1);
+	bench_diff_xor = malloc(BENCH_DIFF_BYTES);
+	if ((bench_diff_a == NULL) || (bench_diff_b == NULL) || (bench_diff_xor == NULL)) {
+		perror("calloc");
+		return EXIT_FAILURE;
+	}
+	for (i = 0; i < BENCH_DIFF_BYTES; i++) {
+		bench_diff_a[i] = bench_diff_b[i] = (uint8_t)(i * 2654435761u >> 24);
+	}
+	for (i = 0; i < BENCH_DIFF_BYTES; i += BENCH_DIFF_STRIDE) {
+		bench_diff_b[i + (i / BENCH_DIFF_STRIDE) % BENCH_DIFF_STRIDE] ^= 0x10;
+	}
+
+	for (i = 0; i < BENCH_STREAM_BYTES; i++) {
+		bench_stream[i] = (uint8_t)(i * 2654435761u >> 24);
+	}
+
+	///< A nibble shuffle: eight rotation groups, but only three PEXT/PDEP chains
+	int8_t perm_table[BITPERM_BITS];
+	for (i = 0; i < BITPERM_BITS; i++) {
+		perm_table[i] = (int8_t)((((i / 4) * 5 + 3) % 8) * 4 + (i % 4));
+	}
+	bitperm_compile(&bench_perm, perm_table);
+
+	bench_null_fd = open("/dev/null", O_WRONLY);
+	if (bench_null_fd < 0) {
+		perror("/dev/null");
+		return EXIT_FAILURE;
+	}
+
+	for (i = 0; i < BENCH_NCASES; i++) {
+		for (input = INPUT_SEQUENTIAL; input <= INPUT_RANDOM; input++) {
+			bench_measure(&bench_cases[i], (bench_input_t)input, &results[n]);
+			n++;
+		}
+	}
+	free(bench_diff_a);
+	free(bench_diff_b);
+	free(bench_diff_xor);
+
+	printf("ISA tier: %s (BITOPS_ISA=scalar|sse2|avx2|avx512 to compare tiers)\n\n", bitops_isa_name(bitops_init()));
+	printf("%-20s %5s %-10s %12s %12s %10s\n", "function", "nbits", "input", "median ns", "p99 ns", "MB/s");
+	for (i = 0; i < n; i++) {
+		printf("%-20s %5d %-10s %12.3f %12.3f %10.1f\n", results[i].name, results[i].nbits, results[i].input, results[i].median_ns, results[i].p99_ns, results[i].mb_per_s);
+	}
+
+	printf("\n%-20s %-10s %16s %16s\n", "record path", "input", "syscalls/record", "bytes copied");
+	for (i = 0; i < n; i++) {
+		if ((bench_cases[i / 2].run == run_record_concat) || (bench_cases[i / 2].run == run_record_iovec)) {
+			printf("%-20s %-10s %16.3f %16.1f\n", results[i].name, results[i].input, results[i].syscalls_per_call, results[i].copied_per_call);
+		}
+	}
+
+	printf("\n%-22s %10s %10s %10s %10s\n", "atomic bit ops (M/s)", "1 thread", "2 threads", "4 threads", "8 threads");
+	for (i = 0; i < ATOMIC_MODES; i++) {
+		printf("%-22s", bench_atomic_names[i]);
+		for (nthreads = 1; nthreads <= BENCH_ATOMIC_MAX_THREADS; nthreads *= 2) {
+			printf(" %10.1f", bench_atomic((bench_atomic_mode_t)i, nthreads));
+		}
+		printf("\n");
+	}
+
+	///< Only in a STATS=1 build, where the timings above include the counting
+	if (bitops_stats_enabled()) {
+		printf("\n");
+		bitops_stats_dump(stdout);
+	}
+
+	if (csv_path != NULL) {
+		f = fopen(csv_path, "w");
+		if (f == NULL) {
+			perror(csv_path);
+			return EXIT_FAILURE;
+		}
+		bench_write_csv(f, results, n);
+		fclose(f);
+	}
+
+	if (json_path != NULL) {
+		f = fopen(json_path, "w");
+		if (f == NULL) {
+			perror(json_path);
+			return EXIT_FAILURE;
+		}
+		bench_write_json(f, results, n);
+		fclose(f);
+	}
+
+	return EXIT_SUCCESS;
+}
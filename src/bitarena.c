@@ -0,0 +1,317 @@
+#include <stdio.h>
+#include <string.h>
+#include "bitops.h"
+
+#define EXIT_TEST_SUCCESS (1)
+#define EXIT_TEST_FAILURE (0)
+
+#define NULL_TERMINATOR_BYTE (1)
+#define PREFIX_BYTES_BIN (2)
+#define PREFIX_BYTES_HEX (2)
+#define BITS_PER_NIBBLE (4)
+#define UINT32_T_BITS (32)
+
+#define TEST_16_SEED (4242u)
+#define TEST_16_VALUES (512)
+#define TEST_16_ARENA_BYTES (64 * 1024)
+#define TEST_16_DUMP_BYTES (100)
+
+char TEST_16_ARENA[TEST_16_ARENA_BYTES];
+char TEST_16_EXPECTED[TEST_16_ARENA_BYTES];
+
+/*
+ * Arena variants of the formatters. Each one checks the room left in the arena at run time
+ * (the plain formatters only assert on size), formats straight into the arena, and advances
+ * the bump pointer past the string but not past its terminator. The next append writes over
+ * that terminator, so a batch ends up as one contiguous block that can go to a single write(),
+ * while the most recent view is still a valid C string.
+ */
+
+static const bitops_view_t bitops_view_none = { NULL, 0 };
+
+/**
+ * \fn bitops_arena_init(bitops_arena_t* arena, char* buffer, size_t size)
+ * \brief Sets up an empty arena over a caller-owned buffer. The arena never allocates or frees
+ *
+ * \param arena Pointer to the arena to set up
+ * \param buffer Pointer to the storage to append into
+ * \param size Num of bytes of the storage pointed to by buffer
+ *
+ * \return None
+ */
+void bitops_arena_init(bitops_arena_t* arena, char* buffer, size_t size) {
+	assert(arena != NULL);
+	assert((buffer != NULL) || (size == 0));
+
+	arena->base = buffer;
+	arena->size = size;
+	arena->used = 0;
+
+	if (size > 0) {
+		buffer[0] = '\0';
+	}
+}
+
+/**
+ * \fn bitops_arena_reset(bitops_arena_t* arena)
+ * \brief Empties the arena in O(1). Views taken before the reset must no longer be used
+ *
+ * \return None
+ */
+void bitops_arena_reset(bitops_arena_t* arena) {
+	assert(arena != NULL);
+
+	arena->used = 0;
+
+	if (arena->size > 0) {
+		arena->base[0] = '\0';
+	}
+}
+
+/**
+ * \fn bitops_arena_contents(const bitops_arena_t* arena)
+ * \brief Returns everything appended since the last reset, ready to be passed to write()
+ *
+ * \return View of the whole arena contents
+ */
+bitops_view_t bitops_arena_contents(const bitops_arena_t* arena) {
+	assert(arena != NULL);
+
+	bitops_view_t view = { arena->base, arena->used };
+
+	return view;
+}
+
+/**
+ * \fn bitops_arena_commit(bitops_arena_t* arena, size_t len)
+ * \brief Advances the arena past a string of len characters just written at its bump pointer
+ *
+ * \return View of the new string
+ */
+static bitops_view_t bitops_arena_commit(bitops_arena_t* arena, size_t len) {
+	bitops_view_t view = { arena->base + arena->used, len };
+
+	arena->used += len;
+
+	return view;
+}
+
+/**
+ * \fn bitops_arena_commit_fmt(bitops_arena_t* arena, int len)
+ * \brief Commits the result of one of the int-returning formatters
+ *
+ * \return View of the new string, or the empty view if the formatter reported an error
+ */
+static bitops_view_t bitops_arena_commit_fmt(bitops_arena_t* arena, int len) {
+	if (len < 0) {
+		///< Formatters clear str on error, which restores the previous terminator
+		return bitops_view_none;
+	}
+
+	return bitops_arena_commit(arena, (size_t)len);
+}
+
+/**
+ * \fn bitops_arena_room(const bitops_arena_t* arena, size_t len)
+ * \brief Checks that len characters plus a terminator fit after the bump pointer
+ *
+ * \return 1 if they fit, 0 otherwise
+ */
+static inline int bitops_arena_room(const bitops_arena_t* arena, size_t len) {
+	return (arena->size - arena->used) > len;
+}
+
+/**
+ * \fn bitops_arena_append(bitops_arena_t* arena, const char* str, size_t len)
+ * \brief Copies len characters of str into the arena, typically a separator between formatted values
+ *
+ * \return View of the copy, or the empty view if the arena is full (the arena is left unchanged)
+ */
+bitops_view_t bitops_arena_append(bitops_arena_t* arena, const char* str, size_t len) {
+	assert(arena != NULL);
+	assert((str != NULL) || (len == 0));
+
+	if (!bitops_arena_room(arena, len)) {
+		return bitops_view_none;
+	}
+
+	memcpy(arena->base + arena->used, str, len);
+	arena->base[arena->used + len] = '\0';
+
+	return bitops_arena_commit(arena, len);
+}
+
+/**
+ * \fn uint_to_binstr_arena(bitops_arena_t* arena, uint32_t num, uint8_t nbits)
+ * \brief Appends the binary representation of a 32-bit unsigned int to the arena, exactly as uint_to_binstr would write it
+ *
+ * \param arena Pointer to the arena
+ * \param num The value to be converted
+ * \param nbits The number of bits in the input (range from 1 to 32)
+ *
+ * \return View of the new string. In the case of an error (i.e. the arena is full, nbits is out of range or num does not fit in nbits), returns the empty view and the arena is left unchanged.
+ */
+bitops_view_t uint_to_binstr_arena(bitops_arena_t* arena, uint32_t num, uint8_t nbits) {
+	assert(arena != NULL);
+
+	if ((nbits == 0) || (nbits > UINT32_T_BITS) || !bitops_arena_room(arena, (size_t)nbits + PREFIX_BYTES_BIN)) {
+		return bitops_view_none;
+	}
+
+	return bitops_arena_commit_fmt(arena, uint_to_binstr(arena->base + arena->used, arena->size - arena->used, num, nbits));
+}
+
+/**
+ * \fn int_to_binstr_arena(bitops_arena_t* arena, int32_t num, uint8_t nbits)
+ * \brief Appends the two's complement binary representation of a 32-bit signed int to the arena, exactly as int_to_binstr would write it
+ *
+ * \param arena Pointer to the arena
+ * \param num The value to be converted
+ * \param nbits The number of bits in the input (range from 1 to 32)
+ *
+ * \return View of the new string. In the case of an error (i.e. the arena is full or nbits is out of range), returns the empty view and the arena is left unchanged.
+ */
+bitops_view_t int_to_binstr_arena(bitops_arena_t* arena, int32_t num, uint8_t nbits) {
+	assert(arena != NULL);
+
+	if ((nbits == 0) || (nbits > UINT32_T_BITS) || !bitops_arena_room(arena, (size_t)nbits + PREFIX_BYTES_BIN)) {
+		return bitops_view_none;
+	}
+
+	return bitops_arena_commit_fmt(arena, int_to_binstr(arena->base + arena->used, arena->size - arena->used, num, nbits));
+}
+
+/**
+ * \fn uint_to_hexstr_arena(bitops_arena_t* arena, uint32_t num, uint8_t nbits)
+ * \brief Appends the hex representation of a 32-bit unsigned int to the arena, exactly as uint_to_hexstr would write it
+ *
+ * \param arena Pointer to the arena
+ * \param num The value to be converted
+ * \param nbits The number of bits in the input (note: nbits must be one of the values 4, 8, 16, or 32)
+ *
+ * \return View of the new string. In the case of an error (i.e. the arena is full or nbits is not a supported width), returns the empty view and the arena is left unchanged.
+ */
+bitops_view_t uint_to_hexstr_arena(bitops_arena_t* arena, uint32_t num, uint8_t nbits) {
+	assert(arena != NULL);
+
+	if (((nbits != 4) && (nbits != 8) && (nbits != 16) && (nbits != 32)) || !bitops_arena_room(arena, (size_t)nbits / BITS_PER_NIBBLE + PREFIX_BYTES_HEX)) {
+		return bitops_view_none;
+	}
+
+	return bitops_arena_commit_fmt(arena, uint_to_hexstr(arena->base + arena->used, arena->size - arena->used, num, nbits));
+}
+
+/**
+ * \fn hexdump_arena(bitops_arena_t* arena, const void* loc, size_t nbytes)
+ * \brief Appends the hexdump of nbytes at loc to the arena, exactly as hexdump would write it
+ *
+ * \param arena Pointer to the arena
+ * \param loc Starting location of memory to begin dumping bytes from
+ * \param nbytes The number of bytes to read from loc
+ *
+ * \return View of the dump. In the case of an error (i.e. the arena cannot hold the whole dump), returns the empty view and the arena is left unchanged.
+ */
+bitops_view_t hexdump_arena(bitops_arena_t* arena, const void* loc, size_t nbytes) {
+	assert(arena != NULL);
+
+	size_t len = hexdump_len(nbytes);
+
+	if (!bitops_arena_room(arena, len)) {
+		return bitops_view_none;
+	}
+
+	hexdump(arena->base + arena->used, arena->size - arena->used, loc, nbytes);
+
+	return bitops_arena_commit(arena, len);
+}
+
+int test_arena(void) {
+	static const uint8_t widths[] = { 4, 8, 16, 32 };
+	char str[PREFIX_BYTES_BIN + UINT32_T_BITS + NULL_TERMINATOR_BYTE];
+	uint8_t dump_input[TEST_16_DUMP_BYTES];
+	bitops_arena_t arena;
+	bitops_view_t view;
+	bitops_view_t all;
+	uint32_t state = TEST_16_SEED;
+	uint32_t num;
+	uint8_t nbits;
+	size_t expected_len = 0;
+	size_t used;
+	int len;
+	int i;
+	int return_code = EXIT_TEST_SUCCESS;
+
+	bitops_arena_init(&arena, TEST_16_ARENA, sizeof(TEST_16_ARENA));
+
+	///< Interleave all three formatters with separators and check the arena is their plain concatenation
+	for (i = 0; i < TEST_16_VALUES; i++) {
+		num = test_rand32(&state);
+		switch (i % 3) {
+			case 0:
+				nbits = (uint8_t)(1 + (num >> 27));
+				num &= 0xFFFFFFFF >> (UINT32_T_BITS - nbits);
+				view = uint_to_binstr_arena(&arena, num, nbits);
+				len = uint_to_binstr(str, sizeof(str), num, nbits);
+				break;
+			case 1:
+				nbits = (uint8_t)(1 + (num >> 27));
+				view = int_to_binstr_arena(&arena, (int32_t)num, nbits);
+				len = int_to_binstr(str, sizeof(str), (int32_t)num, nbits);
+				break;
+			default:
+				nbits = widths[num >> 30];
+				view = uint_to_hexstr_arena(&arena, num & (0xFFFFFFFF >> (UINT32_T_BITS - nbits)), nbits);
+				len = uint_to_hexstr(str, sizeof(str), num & (0xFFFFFFFF >> (UINT32_T_BITS - nbits)), nbits);
+				break;
+		}
+
+		if ((view.str == NULL) || (view.len != (size_t)len) || (memcmp(view.str, str, (size_t)len) != 0) || (view.str[view.len] != '\0')) {
+			printf("test_uint_to_binstr_arena: (FAILURE): value %d, nbits = %u, EXPECT = %s\n", i, nbits, str);
+			return_code = EXIT_TEST_FAILURE;
+		}
+		memcpy(TEST_16_EXPECTED + expected_len, str, (size_t)len);
+		expected_len += (size_t)len;
+
+		bitops_arena_append(&arena, "\n", 1);
+		TEST_16_EXPECTED[expected_len++] = '\n';
+	}
+
+	for (i = 0; i < TEST_16_DUMP_BYTES; i++) {
+		dump_input[i] = (uint8_t)test_rand32(&state);
+	}
+	view = hexdump_arena(&arena, dump_input, TEST_16_DUMP_BYTES);
+	hexdump(TEST_16_EXPECTED + expected_len, sizeof(TEST_16_EXPECTED) - expected_len, dump_input, TEST_16_DUMP_BYTES);
+	expected_len += hexdump_len(TEST_16_DUMP_BYTES);
+
+	all = bitops_arena_contents(&arena);
+	if ((view.len != hexdump_len(TEST_16_DUMP_BYTES)) || (all.str != TEST_16_ARENA) || (all.len != expected_len) || (memcmp(all.str, TEST_16_EXPECTED, expected_len) != 0)) {
+		printf("test_hexdump_arena: (FAILURE): arena holds %u bytes, EXPECT %u\n", (uint32_t)all.len, (uint32_t)expected_len);
+		return_code = EXIT_TEST_FAILURE;
+	}
+
+	///< Errors leave the arena untouched: a value that does not fit nbits, a bad width, and a full arena
+	used = arena.used;
+	if ((uint_to_binstr_arena(&arena, 0x1FF, 8).str != NULL) || (uint_to_hexstr_arena(&arena, 0, 12).str != NULL) || (int_to_binstr_arena(&arena, 0, 0).str != NULL)
+		|| (hexdump_arena(&arena, TEST_16_ARENA, sizeof(TEST_16_ARENA)).str != NULL) || (arena.used != used) || (arena.base[used] != '\0')) {
+		printf("test_uint_to_binstr_arena: (FAILURE): failed append changed the arena\n");
+		return_code = EXIT_TEST_FAILURE;
+	}
+
+	///< Fill to the last byte: exactly room for "0xF" and its terminator, then nothing more
+	bitops_arena_init(&arena, TEST_16_ARENA, PREFIX_BYTES_HEX + 1 + NULL_TERMINATOR_BYTE);
+	view = uint_to_hexstr_arena(&arena, 0xF, 4);
+	if ((view.len != PREFIX_BYTES_HEX + 1) || (strcmp(view.str, "0xF") != 0) || (bitops_arena_append(&arena, "\n", 1).str != NULL)) {
+		printf("test_uint_to_hexstr_arena: (FAILURE): arena boundary\n");
+		return_code = EXIT_TEST_FAILURE;
+	}
+
+	bitops_arena_reset(&arena);
+	if ((arena.used != 0) || (bitops_arena_contents(&arena).len != 0) || (uint_to_hexstr_arena(&arena, 0xA, 4).len != PREFIX_BYTES_HEX + 1)) {
+		printf("test_arena: (FAILURE): reset\n");
+		return_code = EXIT_TEST_FAILURE;
+	}
+
+	printf("test_arena: %d values and a %d-byte dump appended into one %u-byte block\n", TEST_16_VALUES, TEST_16_DUMP_BYTES, (uint32_t)expected_len);
+
+	return return_code;
+}
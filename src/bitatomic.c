@@ -0,0 +1,568 @@
+#include <assert.h>
+#include <pthread.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "bitatomic.h"
+
+#define EXIT_FAILURE_N (-1)
+#define EXIT_TEST_SUCCESS (1)
+#define EXIT_TEST_FAILURE (0)
+
+#define UINT32_T_BITS (32)
+#define UINT64_T_BITS (64)
+#define BITMAP_LINE_WORDS (ATOMIC_BITMAP_LINE_BYTES / sizeof(uint64_t))
+
+#define TEST_24_THREADS (8)
+#define TEST_24_ITERATIONS (20000u)
+#define TEST_24_RANGE_WORDS (64u)
+#define TEST_24_RANGE_BITS (37u)			///< Odd, so the ranges of neighbouring threads share words
+#define TEST_24_RANGE_ROUNDS (200u)
+#define TEST_24_BITMAP_BITS (TEST_24_THREADS * 300u)
+
+///< Runs one __atomic_fetch_* builtin with memorder as a constant, since the builtins treat any other memorder as __ATOMIC_SEQ_CST
+#define ATOMIC_FETCH_ORDERED(result, fetch, ptr, val, memorder) do { \
+	switch (memorder) { \
+		case __ATOMIC_RELAXED: \
+			(result) = fetch((ptr), (val), __ATOMIC_RELAXED); \
+			break; \
+		case __ATOMIC_CONSUME: \
+		case __ATOMIC_ACQUIRE: \
+			(result) = fetch((ptr), (val), __ATOMIC_ACQUIRE); \
+			break; \
+		case __ATOMIC_RELEASE: \
+			(result) = fetch((ptr), (val), __ATOMIC_RELEASE); \
+			break; \
+		case __ATOMIC_ACQ_REL: \
+			(result) = fetch((ptr), (val), __ATOMIC_ACQ_REL); \
+			break; \
+		default: \
+			(result) = fetch((ptr), (val), __ATOMIC_SEQ_CST); \
+			break; \
+	} \
+} while (0)
+
+///< The same for __atomic_load_n; orders a load cannot take are strengthened to __ATOMIC_SEQ_CST
+#define ATOMIC_LOAD_ORDERED(result, ptr, memorder) do { \
+	switch (memorder) { \
+		case __ATOMIC_RELAXED: \
+			(result) = __atomic_load_n((ptr), __ATOMIC_RELAXED); \
+			break; \
+		case __ATOMIC_CONSUME: \
+		case __ATOMIC_ACQUIRE: \
+			(result) = __atomic_load_n((ptr), __ATOMIC_ACQUIRE); \
+			break; \
+		default: \
+			(result) = __atomic_load_n((ptr), __ATOMIC_SEQ_CST); \
+			break; \
+	} \
+} while (0)
+
+/**
+ * \fn atomic_apply32(uint32_t* word, uint32_t mask, operation_t operation, int memorder, uint32_t* prev)
+ * \brief Sets, clears or toggles the bits of mask in *word with one atomic read-modify-write
+ *
+ * \return If successful, returns 0 and stores the word as it was in *prev. If operation is not CLEAR, SET or TOGGLE, returns a negative value and *word is left unchanged.
+ */
+static inline int atomic_apply32(uint32_t* word, uint32_t mask, operation_t operation, int memorder, uint32_t* prev) {
+	switch (operation) {
+		case CLEAR:
+			ATOMIC_FETCH_ORDERED(*prev, __atomic_fetch_and, word, ~mask, memorder);
+			break;
+		case SET:
+			ATOMIC_FETCH_ORDERED(*prev, __atomic_fetch_or, word, mask, memorder);
+			break;
+		case TOGGLE:
+			ATOMIC_FETCH_ORDERED(*prev, __atomic_fetch_xor, word, mask, memorder);
+			break;
+		default:
+			return EXIT_FAILURE_N;
+	}
+
+	return 0;
+}
+
+/**
+ * \fn atomic_apply64(uint64_t* word, uint64_t mask, operation_t operation, int memorder, uint64_t* prev)
+ * \brief atomic_apply32 for the 64-bit words of an atomic_bitmap_t
+ *
+ * \return If successful, returns 0. If operation is not CLEAR, SET or TOGGLE, returns a negative value.
+ */
+static inline int atomic_apply64(uint64_t* word, uint64_t mask, operation_t operation, int memorder, uint64_t* prev) {
+	switch (operation) {
+		case CLEAR:
+			ATOMIC_FETCH_ORDERED(*prev, __atomic_fetch_and, word, ~mask, memorder);
+			break;
+		case SET:
+			ATOMIC_FETCH_ORDERED(*prev, __atomic_fetch_or, word, mask, memorder);
+			break;
+		case TOGGLE:
+			ATOMIC_FETCH_ORDERED(*prev, __atomic_fetch_xor, word, mask, memorder);
+			break;
+		default:
+			return EXIT_FAILURE_N;
+	}
+
+	return 0;
+}
+
+/**
+ * \fn atomic_twiggle_bit(uint32_t* word, int bit, operation_t operation, int memorder)
+ * \brief Changes a single bit of a shared 32-bit word in place, atomically
+ *
+ * \param word Pointer to the shared word
+ * \param bit The single bit to operate on (range from 0 to 31)
+ * \param operation The type of operation to perform on bit (CLEAR, SET, TOGGLE)
+ * \param memorder The memory order of the read-modify-write (__ATOMIC_RELAXED to __ATOMIC_SEQ_CST)
+ *
+ * \return If successful, returns the bit as it was before the operation (0 or 1). In the case of an error, returns a negative value and *word is left unchanged.
+ */
+int atomic_twiggle_bit(uint32_t* word, int bit, operation_t operation, int memorder) {
+	uint32_t prev;
+
+	assert(word != NULL);
+
+	if ((bit < 0) || (bit >= UINT32_T_BITS) || (atomic_apply32(word, (uint32_t)1 << bit, operation, memorder, &prev) != 0)) {
+		return EXIT_FAILURE_N;
+	}
+
+	return (int)((prev >> bit) & 1u);
+}
+
+/**
+ * \fn atomic_test_and_set_bit(uint32_t* word, int bit, int memorder)
+ * \brief Sets a bit of a shared word and reports whether it was already set
+ *
+ * \return 1 if the bit was set, 0 if this call set it, or a negative value if bit is out of range
+ */
+int atomic_test_and_set_bit(uint32_t* word, int bit, int memorder) {
+	return atomic_twiggle_bit(word, bit, SET, memorder);
+}
+
+/**
+ * \fn atomic_test_and_clear_bit(uint32_t* word, int bit, int memorder)
+ * \brief Clears a bit of a shared word and reports whether it was set
+ *
+ * \return 1 if this call cleared the bit, 0 if it was already clear, or a negative value if bit is out of range
+ */
+int atomic_test_and_clear_bit(uint32_t* word, int bit, int memorder) {
+	return atomic_twiggle_bit(word, bit, CLEAR, memorder);
+}
+
+/**
+ * \fn atomic_test_bit(const uint32_t* word, int bit, int memorder)
+ * \brief Reads a single bit of a shared word with an atomic load
+ *
+ * \return The bit (0 or 1), or a negative value if bit is out of range
+ */
+int atomic_test_bit(const uint32_t* word, int bit, int memorder) {
+	uint32_t value;
+
+	assert(word != NULL);
+
+	if ((bit < 0) || (bit >= UINT32_T_BITS)) {
+		return EXIT_FAILURE_N;
+	}
+
+	ATOMIC_LOAD_ORDERED(value, word, memorder);
+
+	return (int)((value >> bit) & 1u);
+}
+
+/**
+ * \fn atomic_twiggle_range(uint32_t* words, size_t start, size_t count, operation_t operation, int memorder, size_t* were_set)
+ * \brief Changes bits start to start + count - 1 of a shared array of 32-bit words (bit b being bit b % 32 of words[b / 32]), one atomic read-modify-write per word
+ *
+ * \param words Pointer to the shared words
+ * \param start The first bit of the range
+ * \param count The number of bits in the range
+ * \param operation The type of operation to perform on each bit (CLEAR, SET, TOGGLE)
+ * \param memorder The memory order of each read-modify-write
+ * \param were_set If not NULL, receives how many bits of the range were set just before each word was changed
+ *
+ * \return If successful, returns 0. If operation is not CLEAR, SET or TOGGLE, returns a negative value and words is left unchanged.
+ *
+ * The range as a whole is not atomic: another thread may see some words changed and others not yet.
+ */
+int atomic_twiggle_range(uint32_t* words, size_t start, size_t count, operation_t operation, int memorder, size_t* were_set) {
+	size_t set = 0;
+	size_t bit = start;
+	size_t end = start + count;
+	size_t span;
+	uint32_t mask;
+	uint32_t prev;
+
+	assert((words != NULL) || (count == 0));
+
+	if ((operation != CLEAR) && (operation != SET) && (operation != TOGGLE)) {
+		return EXIT_FAILURE_N;
+	}
+
+	while (bit < end) {
+		span = UINT32_T_BITS - (bit % UINT32_T_BITS);
+		span = (span < end - bit) ? span : end - bit;
+		mask = (0xFFFFFFFFu >> (UINT32_T_BITS - span)) << (bit % UINT32_T_BITS);
+		atomic_apply32(&words[bit / UINT32_T_BITS], mask, operation, memorder, &prev);
+		set += (size_t)__builtin_popcount(prev & mask);
+		bit += span;
+	}
+
+	if (were_set != NULL) {
+		*were_set = set;
+	}
+
+	return 0;
+}
+
+/**
+ * \fn atomic_bitmap_init(atomic_bitmap_t* bm, size_t nbits, size_t shard_bits)
+ * \brief Allocates a zeroed bitmap of nbits bits, shard_bits bits to each cache line
+ *
+ * \param bm Pointer to the bitmap to set up
+ * \param nbits The number of bits in the bitmap
+ * \param shard_bits Bits per shard: 64, 128, 256 or 512. Smaller shards spread the bits over more cache lines
+ *
+ * \return If successful, returns 0. If shard_bits is not valid or the storage cannot be allocated, returns a negative value.
+ */
+int atomic_bitmap_init(atomic_bitmap_t* bm, size_t nbits, size_t shard_bits) {
+	void* words = NULL;
+	size_t bytes;
+
+	assert(bm != NULL);
+
+	bm->words = NULL;
+	if ((shard_bits < UINT64_T_BITS) || (shard_bits > ATOMIC_BITMAP_MAX_SHARD_BITS) || ((shard_bits & (shard_bits - 1)) != 0)) {
+		return EXIT_FAILURE_N;
+	}
+
+	bm->nbits = nbits;
+	bm->shard_bits = shard_bits;
+	bm->nshards = (nbits + shard_bits - 1) / shard_bits;
+	bm->words_per_shard = BITMAP_LINE_WORDS;
+
+	bytes = ((bm->nshards > 0) ? bm->nshards : 1) * ATOMIC_BITMAP_LINE_BYTES;
+	if (posix_memalign(&words, ATOMIC_BITMAP_LINE_BYTES, bytes) != 0) {
+		return EXIT_FAILURE_N;
+	}
+	memset(words, 0, bytes);
+	bm->words = (uint64_t*)words;
+
+	return 0;
+}
+
+/**
+ * \fn atomic_bitmap_free(atomic_bitmap_t* bm)
+ * \brief Releases the storage of a bitmap. No other thread may be using it
+ *
+ * \return None
+ */
+void atomic_bitmap_free(atomic_bitmap_t* bm) {
+	assert(bm != NULL);
+
+	free(bm->words);
+	bm->words = NULL;
+}
+
+/**
+ * \fn atomic_bitmap_word(const atomic_bitmap_t* bm, size_t bit)
+ * \brief Finds the word holding a bit: word (bit % shard_bits) / 64 of shard bit / shard_bits
+ *
+ * \return Pointer to the word
+ */
+static inline uint64_t* atomic_bitmap_word(const atomic_bitmap_t* bm, size_t bit) {
+	return &bm->words[((bit / bm->shard_bits) * bm->words_per_shard) + ((bit % bm->shard_bits) / UINT64_T_BITS)];
+}
+
+/**
+ * \fn atomic_bitmap_twiggle(atomic_bitmap_t* bm, size_t bit, operation_t operation, int memorder)
+ * \brief Changes one bit of a shared bitmap in place, atomically
+ *
+ * \return If successful, returns the bit as it was before the operation (0 or 1). If bit is out of range or operation is not valid, returns a negative value.
+ */
+int atomic_bitmap_twiggle(atomic_bitmap_t* bm, size_t bit, operation_t operation, int memorder) {
+	uint64_t prev;
+
+	assert((bm != NULL) && (bm->words != NULL));
+
+	if ((bit >= bm->nbits) || (atomic_apply64(atomic_bitmap_word(bm, bit), 1ull << (bit % UINT64_T_BITS), operation, memorder, &prev) != 0)) {
+		return EXIT_FAILURE_N;
+	}
+
+	return (int)((prev >> (bit % UINT64_T_BITS)) & 1u);
+}
+
+/**
+ * \fn atomic_bitmap_test(const atomic_bitmap_t* bm, size_t bit, int memorder)
+ * \brief Reads one bit of a shared bitmap with an atomic load
+ *
+ * \return The bit (0 or 1), or a negative value if bit is out of range
+ */
+int atomic_bitmap_test(const atomic_bitmap_t* bm, size_t bit, int memorder) {
+	uint64_t value;
+
+	assert((bm != NULL) && (bm->words != NULL));
+
+	if (bit >= bm->nbits) {
+		return EXIT_FAILURE_N;
+	}
+
+	ATOMIC_LOAD_ORDERED(value, atomic_bitmap_word(bm, bit), memorder);
+
+	return (int)((value >> (bit % UINT64_T_BITS)) & 1u);
+}
+
+/**
+ * \fn atomic_bitmap_acquire(atomic_bitmap_t* bm, size_t first_shard, int memorder)
+ * \brief Finds a clear bit and sets it, searching the shards from first_shard on and wrapping around
+ *
+ * \param bm Pointer to the shared bitmap
+ * \param first_shard The shard to search first. Threads that start at different shards rarely contend
+ * \param memorder The memory order of the test-and-set that claims the bit
+ *
+ * \return The bit this call set, or ATOMIC_BITMAP_FULL if every bit was set when it looked
+ */
+size_t atomic_bitmap_acquire(atomic_bitmap_t* bm, size_t first_shard, int memorder) {
+	uint64_t* word;
+	uint64_t valid;
+	uint64_t free_bits;
+	uint64_t prev;
+	size_t shard;
+	size_t base;
+	size_t bits;
+	size_t s;
+	size_t w;
+	int bit;
+
+	assert((bm != NULL) && (bm->words != NULL));
+
+	for (s = 0; s < bm->nshards; s++) {
+		shard = (first_shard + s) % bm->nshards;
+		for (w = 0; w < bm->shard_bits / UINT64_T_BITS; w++) {
+			base = (shard * bm->shard_bits) + (w * UINT64_T_BITS);
+			if (base >= bm->nbits) {
+				break;
+			}
+			bits = bm->nbits - base;
+			valid = (bits >= UINT64_T_BITS) ? ~0ull : ((1ull << bits) - 1);
+			word = &bm->words[(shard * bm->words_per_shard) + w];
+
+			///< Retry on the same word while it has clear bits; a lost race only means another thread took that bit
+			free_bits = ~__atomic_load_n(word, __ATOMIC_RELAXED) & valid;
+			while (free_bits != 0) {
+				bit = __builtin_ctzll(free_bits);
+				ATOMIC_FETCH_ORDERED(prev, __atomic_fetch_or, word, 1ull << bit, memorder);
+				if ((prev & (1ull << bit)) == 0) {
+					return base + (size_t)bit;
+				}
+				free_bits = ~prev & valid;
+			}
+		}
+	}
+
+	return ATOMIC_BITMAP_FULL;
+}
+
+/**
+ * \fn atomic_bitmap_count(const atomic_bitmap_t* bm)
+ * \brief Counts the set bits with relaxed loads. While other threads change the bitmap the count is only a snapshot of each word in turn
+ *
+ * \return The number of set bits
+ */
+size_t atomic_bitmap_count(const atomic_bitmap_t* bm) {
+	size_t count = 0;
+	size_t s;
+	size_t w;
+
+	assert((bm != NULL) && (bm->words != NULL));
+
+	for (s = 0; s < bm->nshards; s++) {
+		for (w = 0; w < bm->shard_bits / UINT64_T_BITS; w++) {
+			count += (size_t)__builtin_popcountll(__atomic_load_n(&bm->words[(s * bm->words_per_shard) + w], __ATOMIC_RELAXED));
+		}
+	}
+
+	return count;
+}
+
+typedef struct {
+	int id;
+	uint32_t* word;
+	uint32_t* range_words;
+	atomic_bitmap_t* bitmap;
+	uint8_t* acquired;		///< One byte per bitmap bit, set when this thread acquired it
+	size_t errors;
+} test_atomic_worker_t;
+
+static pthread_barrier_t test_atomic_barrier;
+
+/**
+ * \fn test_atomic_worker(void* arg)
+ * \brief One stress thread: test-and-set/clear of its own bit of a shared word, toggles of a bit every thread toggles, set/clear of ranges that share words with other threads' ranges, and acquiring bitmap bits until none are left
+ *
+ * \return NULL
+ */
+static void* test_atomic_worker(void* arg) {
+	test_atomic_worker_t* w = (test_atomic_worker_t*)arg;
+	size_t were_set;
+	size_t bit;
+	uint32_t i;
+	uint32_t round;
+
+	pthread_barrier_wait(&test_atomic_barrier);
+
+	for (i = 0; i < TEST_24_ITERATIONS; i++) {
+		w->errors += (atomic_test_and_set_bit(w->word, w->id, __ATOMIC_ACQUIRE) != 0);
+		w->errors += (atomic_test_bit(w->word, w->id, __ATOMIC_RELAXED) != 1);
+		w->errors += (atomic_test_and_clear_bit(w->word, w->id, __ATOMIC_RELEASE) != 1);
+		atomic_twiggle_bit(w->word, 31, TOGGLE, __ATOMIC_RELAXED);
+	}
+	///< One extra toggle from thread 0 leaves bit 30 set once every thread is done
+	if (w->id == 0) {
+		atomic_twiggle_bit(w->word, 30, TOGGLE, __ATOMIC_RELAXED);
+	}
+
+	pthread_barrier_wait(&test_atomic_barrier);
+
+	///< Thread id owns every TEST_24_THREADS-th run of TEST_24_RANGE_BITS bits
+	for (round = 0; round < TEST_24_RANGE_ROUNDS; round++) {
+		for (bit = w->id * TEST_24_RANGE_BITS; bit + TEST_24_RANGE_BITS <= TEST_24_RANGE_WORDS * UINT32_T_BITS; bit += TEST_24_THREADS * TEST_24_RANGE_BITS) {
+			atomic_twiggle_range(w->range_words, bit, TEST_24_RANGE_BITS, SET, __ATOMIC_RELAXED, &were_set);
+			w->errors += (were_set != 0);
+		}
+		if (round + 1 == TEST_24_RANGE_ROUNDS) {
+			break;
+		}
+		for (bit = w->id * TEST_24_RANGE_BITS; bit + TEST_24_RANGE_BITS <= TEST_24_RANGE_WORDS * UINT32_T_BITS; bit += TEST_24_THREADS * TEST_24_RANGE_BITS) {
+			atomic_twiggle_range(w->range_words, bit, TEST_24_RANGE_BITS, CLEAR, __ATOMIC_SEQ_CST, &were_set);
+			w->errors += (were_set != TEST_24_RANGE_BITS);
+		}
+	}
+
+	pthread_barrier_wait(&test_atomic_barrier);
+
+	while ((bit = atomic_bitmap_acquire(w->bitmap, (size_t)w->id, __ATOMIC_ACQ_REL)) != ATOMIC_BITMAP_FULL) {
+		w->acquired[bit] = 1;
+	}
+
+	return NULL;
+}
+
+/**
+ * \fn test_atomic(void)
+ * \brief Stresses the atomic bit operations from TEST_24_THREADS threads and checks no update was lost, then checks the error cases
+ *
+ * \return If successful, returns EXIT_TEST_SUCCESS. If unsuccessful, returns EXIT_TEST_FAILURE.
+ */
+int test_atomic(void) {
+	static uint8_t acquired[TEST_24_THREADS][TEST_24_BITMAP_BITS];
+	static uint32_t range_words[TEST_24_RANGE_WORDS];
+	test_atomic_worker_t workers[TEST_24_THREADS];
+	pthread_t threads[TEST_24_THREADS];
+	atomic_bitmap_t bitmap;
+	uint32_t word = 0;
+	uint32_t expected;
+	size_t owners;
+	size_t bit;
+	size_t k;
+	int t;
+	int started = 0;
+	int return_code = EXIT_TEST_SUCCESS;
+
+	memset(acquired, 0, sizeof(acquired));
+	memset(range_words, 0, sizeof(range_words));
+	if (atomic_bitmap_init(&bitmap, TEST_24_BITMAP_BITS, UINT64_T_BITS) != 0) {
+		return EXIT_TEST_FAILURE;
+	}
+
+	pthread_barrier_init(&test_atomic_barrier, NULL, TEST_24_THREADS);
+	for (t = 0; t < TEST_24_THREADS; t++) {
+		workers[t].id = t;
+		workers[t].word = &word;
+		workers[t].range_words = range_words;
+		workers[t].bitmap = &bitmap;
+		workers[t].acquired = acquired[t];
+		workers[t].errors = 0;
+	}
+	for (t = 0; t < TEST_24_THREADS; t++) {
+		if (pthread_create(&threads[t], NULL, test_atomic_worker, &workers[t]) != 0) {
+			break;
+		}
+		started++;
+	}
+	for (t = 0; t < started; t++) {
+		pthread_join(threads[t], NULL);
+	}
+	pthread_barrier_destroy(&test_atomic_barrier);
+
+	if (started != TEST_24_THREADS) {
+		printf("test_atomic: (FAILURE): only %d of %d threads started\n", started, TEST_24_THREADS);
+		atomic_bitmap_free(&bitmap);
+		return EXIT_TEST_FAILURE;
+	}
+
+	for (t = 0; t < TEST_24_THREADS; t++) {
+		if (workers[t].errors != 0) {
+			printf("test_atomic: (FAILURE): thread %d saw %zu bits in the wrong state\n", t, workers[t].errors);
+			return_code = EXIT_TEST_FAILURE;
+		}
+	}
+
+	///< Each thread's own bit ends clear, bit 31 was toggled an even number of times and bit 30 once
+	if (word != ((uint32_t)1 << 30)) {
+		printf("test_atomic: (FAILURE): shared word is 0x%08X, expected 0x40000000\n", word);
+		return_code = EXIT_TEST_FAILURE;
+	}
+
+	for (k = 0; k < TEST_24_RANGE_WORDS; k++) {
+		expected = 0;
+		for (bit = k * UINT32_T_BITS; bit < (k + 1) * UINT32_T_BITS; bit++) {
+			///< Bits past the last whole run of any thread are never touched
+			if ((bit / TEST_24_RANGE_BITS + 1) * TEST_24_RANGE_BITS <= TEST_24_RANGE_WORDS * UINT32_T_BITS) {
+				expected |= (uint32_t)1 << (bit % UINT32_T_BITS);
+			}
+		}
+		if (range_words[k] != expected) {
+			printf("test_atomic: (FAILURE): range word %zu is 0x%08X, expected 0x%08X\n", k, range_words[k], expected);
+			return_code = EXIT_TEST_FAILURE;
+			break;
+		}
+	}
+
+	for (bit = 0; bit < TEST_24_BITMAP_BITS; bit++) {
+		owners = 0;
+		for (t = 0; t < TEST_24_THREADS; t++) {
+			owners += acquired[t][bit];
+		}
+		if (owners != 1) {
+			printf("test_atomic: (FAILURE): bitmap bit %zu acquired by %zu threads\n", bit, owners);
+			return_code = EXIT_TEST_FAILURE;
+			break;
+		}
+	}
+	if (atomic_bitmap_count(&bitmap) != TEST_24_BITMAP_BITS) {
+		printf("test_atomic: (FAILURE): bitmap count %zu after acquiring every bit\n", atomic_bitmap_count(&bitmap));
+		return_code = EXIT_TEST_FAILURE;
+	}
+
+	///< A released bit is the one acquired next, and bits land in their shard's cache line
+	if ((atomic_bitmap_twiggle(&bitmap, 200, CLEAR, __ATOMIC_RELEASE) != 1) || (atomic_bitmap_test(&bitmap, 200, __ATOMIC_ACQUIRE) != 0)
+		|| (atomic_bitmap_acquire(&bitmap, 0, __ATOMIC_ACQUIRE) != 200) || (atomic_bitmap_acquire(&bitmap, 0, __ATOMIC_ACQUIRE) != ATOMIC_BITMAP_FULL)
+		|| (((uintptr_t)atomic_bitmap_word(&bitmap, 200) - (uintptr_t)bitmap.words) != 3 * ATOMIC_BITMAP_LINE_BYTES)) {
+		printf("test_atomic: (FAILURE): bitmap release and reacquire\n");
+		return_code = EXIT_TEST_FAILURE;
+	}
+	atomic_bitmap_free(&bitmap);
+
+	///< Error cases leave the word unchanged
+	word = 0x12345678;
+	if ((atomic_twiggle_bit(&word, 32, SET, __ATOMIC_SEQ_CST) >= 0) || (atomic_twiggle_bit(&word, -1, SET, __ATOMIC_SEQ_CST) >= 0)
+		|| (atomic_twiggle_bit(&word, 0, (operation_t)3, __ATOMIC_SEQ_CST) >= 0) || (atomic_twiggle_range(&word, 0, 8, (operation_t)3, __ATOMIC_SEQ_CST, NULL) >= 0)
+		|| (atomic_bitmap_init(&bitmap, 100, 96) >= 0) || (word != 0x12345678)) {
+		printf("test_atomic: (FAILURE): invalid arguments accepted\n");
+		return_code = EXIT_TEST_FAILURE;
+	}
+
+	printf("test_atomic: %d threads, %u test-and-set/clear pairs each, %u range rounds, %u bitmap bits acquired\n", TEST_24_THREADS, TEST_24_ITERATIONS, TEST_24_RANGE_ROUNDS, TEST_24_BITMAP_BITS);
+
+	return return_code;
+}
@@ -0,0 +1,637 @@
+#include <assert.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "bitdiff.h"
+
+#if defined(__x86_64__) || defined(__i386__)
+#define BITOPS_X86 (1)
+#include <immintrin.h>
+#endif
+
+#define EXIT_FAILURE_N (-1)
+#define EXIT_TEST_SUCCESS (1)
+#define EXIT_TEST_FAILURE (0)
+
+#define NULL_TERMINATOR_BYTE (1)
+#define BITS_PER_BYTE (8)
+#define UINT32_T_BITS (32)
+#define UINT64_T_BITS (64)
+#define BLOCK_WORDS (BITDIFF_BLOCK_BYTES / 8)
+
+#define TEST_22_SEED (0xD1FFu)
+#define TEST_22_BYTES (4096u + 45u)
+#define TEST_22_ROUNDS (40u)
+#define TEST_22_LINES (16u)
+
+uint8_t TEST_22_A[TEST_22_BYTES];
+uint8_t TEST_22_B[TEST_22_BYTES];
+uint8_t TEST_22_XOR[TEST_22_BYTES];
+size_t TEST_22_EXPECTED[TEST_22_BYTES * BITS_PER_BYTE];
+char TEST_22_STR[(TEST_22_LINES * BITDIFF_LINE_CHARS) + NULL_TERMINATOR_BYTE];
+
+/**
+ * \fn bitdiff_load64(const uint8_t* p)
+ * \brief Loads 8 bytes as a little-endian word, so bit p of the word is bit p % 8 of byte p / 8 on every host
+ *
+ * \return The word
+ */
+static inline uint64_t bitdiff_load64(const uint8_t* p) {
+	uint64_t word;
+
+	memcpy(&word, p, sizeof(word));
+#if defined(__BYTE_ORDER__) && (__BYTE_ORDER__ == __ORDER_BIG_ENDIAN__)
+	word = __builtin_bswap64(word);
+#endif
+
+	return word;
+}
+
+/**
+ * \fn bitdiff_scan_scalar(const uint8_t* a, const uint8_t* b, size_t block, size_t nblocks)
+ * \brief Finds the first 64-byte block at or after block whose bytes differ, ORing the XOR of its eight words
+ *
+ * \return The index of that block, or nblocks if the rest of the blocks are equal
+ */
+static size_t bitdiff_scan_scalar(const uint8_t* a, const uint8_t* b, size_t block, size_t nblocks) {
+	const uint8_t* pa;
+	const uint8_t* pb;
+	uint64_t acc;
+	size_t k;
+
+	for (; block < nblocks; block++) {
+		pa = a + (block * BITDIFF_BLOCK_BYTES);
+		pb = b + (block * BITDIFF_BLOCK_BYTES);
+		acc = 0;
+		for (k = 0; k < BITDIFF_BLOCK_BYTES; k += 8) {
+			acc |= bitdiff_load64(pa + k) ^ bitdiff_load64(pb + k);
+		}
+		if (acc != 0) {
+			return block;
+		}
+	}
+
+	return nblocks;
+}
+
+#ifdef BITOPS_X86
+/**
+ * \fn bitdiff_scan_sse2(const uint8_t* a, const uint8_t* b, size_t block, size_t nblocks)
+ * \brief bitdiff_scan_scalar with four 16-byte XORs per block and one byte compare against zero
+ *
+ * \return The index of the first block that differs, or nblocks
+ */
+static __attribute__((target("sse2"))) size_t bitdiff_scan_sse2(const uint8_t* a, const uint8_t* b, size_t block, size_t nblocks) {
+	const __m128i* pa;
+	const __m128i* pb;
+	__m128i acc;
+
+	for (; block < nblocks; block++) {
+		pa = (const __m128i*)(a + (block * BITDIFF_BLOCK_BYTES));
+		pb = (const __m128i*)(b + (block * BITDIFF_BLOCK_BYTES));
+		acc = _mm_or_si128(_mm_xor_si128(_mm_loadu_si128(pa), _mm_loadu_si128(pb)), _mm_xor_si128(_mm_loadu_si128(pa + 1), _mm_loadu_si128(pb + 1)));
+		acc = _mm_or_si128(acc, _mm_xor_si128(_mm_loadu_si128(pa + 2), _mm_loadu_si128(pb + 2)));
+		acc = _mm_or_si128(acc, _mm_xor_si128(_mm_loadu_si128(pa + 3), _mm_loadu_si128(pb + 3)));
+		if (_mm_movemask_epi8(_mm_cmpeq_epi8(acc, _mm_setzero_si128())) != 0xFFFF) {
+			return block;
+		}
+	}
+
+	return nblocks;
+}
+
+/**
+ * \fn bitdiff_scan_avx2(const uint8_t* a, const uint8_t* b, size_t block, size_t nblocks)
+ * \brief bitdiff_scan_scalar with two 32-byte XORs per block and one vptest
+ *
+ * \return The index of the first block that differs, or nblocks
+ */
+static __attribute__((target("avx2"))) size_t bitdiff_scan_avx2(const uint8_t* a, const uint8_t* b, size_t block, size_t nblocks) {
+	const __m256i* pa;
+	const __m256i* pb;
+	__m256i acc;
+
+	for (; block < nblocks; block++) {
+		pa = (const __m256i*)(a + (block * BITDIFF_BLOCK_BYTES));
+		pb = (const __m256i*)(b + (block * BITDIFF_BLOCK_BYTES));
+		acc = _mm256_or_si256(_mm256_xor_si256(_mm256_loadu_si256(pa), _mm256_loadu_si256(pb)), _mm256_xor_si256(_mm256_loadu_si256(pa + 1), _mm256_loadu_si256(pb + 1)));
+		if (!_mm256_testz_si256(acc, acc)) {
+			return block;
+		}
+	}
+
+	return nblocks;
+}
+
+/**
+ * \fn bitdiff_scan_avx512(const uint8_t* a, const uint8_t* b, size_t block, size_t nblocks)
+ * \brief bitdiff_scan_scalar with one 64-byte compare per block
+ *
+ * \return The index of the first block that differs, or nblocks
+ */
+static __attribute__((target("avx512f"))) size_t bitdiff_scan_avx512(const uint8_t* a, const uint8_t* b, size_t block, size_t nblocks) {
+	for (; block < nblocks; block++) {
+		if (_mm512_cmpneq_epi64_mask(_mm512_loadu_si512(a + (block * BITDIFF_BLOCK_BYTES)), _mm512_loadu_si512(b + (block * BITDIFF_BLOCK_BYTES))) != 0) {
+			return block;
+		}
+	}
+
+	return nblocks;
+}
+
+/**
+ * \fn bitdiff_xor_avx2(uint8_t* dst, const uint8_t* a, const uint8_t* b, size_t nbytes)
+ * \brief XORs the leading multiple of 32 bytes with 32-byte loads and stores
+ *
+ * \return The number of bytes written
+ */
+static __attribute__((target("avx2"))) size_t bitdiff_xor_avx2(uint8_t* dst, const uint8_t* a, const uint8_t* b, size_t nbytes) {
+	size_t k;
+
+	for (k = 0; k + 32 <= nbytes; k += 32) {
+		_mm256_storeu_si256((__m256i*)(dst + k), _mm256_xor_si256(_mm256_loadu_si256((const __m256i*)(a + k)), _mm256_loadu_si256((const __m256i*)(b + k))));
+	}
+
+	return k;
+}
+
+/**
+ * \fn bitdiff_xor_sse2(uint8_t* dst, const uint8_t* a, const uint8_t* b, size_t nbytes)
+ * \brief XORs the leading multiple of 16 bytes with 16-byte loads and stores
+ *
+ * \return The number of bytes written
+ */
+static __attribute__((target("sse2"))) size_t bitdiff_xor_sse2(uint8_t* dst, const uint8_t* a, const uint8_t* b, size_t nbytes) {
+	size_t k;
+
+	for (k = 0; k + 16 <= nbytes; k += 16) {
+		_mm_storeu_si128((__m128i*)(dst + k), _mm_xor_si128(_mm_loadu_si128((const __m128i*)(a + k)), _mm_loadu_si128((const __m128i*)(b + k))));
+	}
+
+	return k;
+}
+#endif
+
+/**
+ * \fn bitdiff_pick_scan(void)
+ * \brief Picks the widest block scanner the chosen ISA tier allows
+ *
+ * \return The scanner
+ */
+static bitdiff_scan_fn bitdiff_pick_scan(void) {
+#ifdef BITOPS_X86
+	uint32_t features = bitops_cpu_features();
+
+	if (features & BITOPS_CPU_AVX512F) {
+		return bitdiff_scan_avx512;
+	}
+	if (features & BITOPS_CPU_AVX2) {
+		return bitdiff_scan_avx2;
+	}
+	if (features & BITOPS_CPU_SSE2) {
+		return bitdiff_scan_sse2;
+	}
+#endif
+
+	return bitdiff_scan_scalar;
+}
+
+/**
+ * \fn bitdiff_load_block(uint64_t diff[], const uint8_t* a, const uint8_t* b, size_t nbytes)
+ * \brief Stores the XOR of up to 64 bytes as eight little-endian words, the bytes past nbytes counting as equal
+ *
+ * \return None
+ */
+static void bitdiff_load_block(uint64_t diff[], const uint8_t* a, const uint8_t* b, size_t nbytes) {
+	uint8_t tail_a[BITDIFF_BLOCK_BYTES];
+	uint8_t tail_b[BITDIFF_BLOCK_BYTES];
+	size_t k;
+
+	if (nbytes < BITDIFF_BLOCK_BYTES) {
+		memset(tail_a, 0, sizeof(tail_a));
+		memset(tail_b, 0, sizeof(tail_b));
+		memcpy(tail_a, a, nbytes);
+		memcpy(tail_b, b, nbytes);
+		a = tail_a;
+		b = tail_b;
+	}
+
+	for (k = 0; k < BLOCK_WORDS; k++) {
+		diff[k] = bitdiff_load64(a + (k * 8)) ^ bitdiff_load64(b + (k * 8));
+	}
+}
+
+/**
+ * \fn bitdiff_init(bitdiff_iter_t* it, const void* a, const void* b, size_t nbytes)
+ * \brief Starts a walk over the bits that differ between a and b, with the block scanner of the current ISA tier
+ *
+ * \param it Pointer to the walk to set up
+ * \param a Pointer to the first buffer
+ * \param b Pointer to the second buffer
+ * \param nbytes The size of each buffer
+ *
+ * \return None
+ */
+void bitdiff_init(bitdiff_iter_t* it, const void* a, const void* b, size_t nbytes) {
+	assert(it != NULL);
+	assert((nbytes == 0) || ((a != NULL) && (b != NULL)));
+
+	it->a = (const uint8_t*)a;
+	it->b = (const uint8_t*)b;
+	it->nbytes = nbytes;
+	it->nblocks = nbytes / BITDIFF_BLOCK_BYTES;
+	it->next_block = 0;
+	it->word_index = 0;
+	it->nwords = 0;
+	it->scan = bitdiff_pick_scan();
+}
+
+/**
+ * \fn bitdiff_next(bitdiff_iter_t* it)
+ * \brief Finds the next bit that differs, in increasing order of position
+ *
+ * \param it Pointer to a walk set up with bitdiff_init
+ *
+ * \return The bit position (bit p % 8 of byte p / 8), or BITDIFF_NONE once every changed bit has been reported
+ */
+size_t bitdiff_next(bitdiff_iter_t* it) {
+	uint64_t* word;
+	size_t block;
+	size_t bit;
+
+	assert(it != NULL);
+
+	for (;;) {
+		while (it->nwords > 0) {
+			word = &it->diff[BLOCK_WORDS - it->nwords];
+			if (*word != 0) {
+				bit = (size_t)__builtin_ctzll(*word);
+				*word &= *word - 1;
+				return ((it->word_index + (BLOCK_WORDS - it->nwords)) * UINT64_T_BITS) + bit;
+			}
+			it->nwords--;
+		}
+
+		if (it->next_block > it->nblocks) {
+			return BITDIFF_NONE;
+		}
+
+		///< Equal blocks are skipped by the scanner; past the last one comes the tail, walked once
+		block = (it->next_block < it->nblocks) ? it->scan(it->a, it->b, it->next_block, it->nblocks) : it->nblocks;
+		if (block < it->nblocks) {
+			bitdiff_load_block(it->diff, it->a + (block * BITDIFF_BLOCK_BYTES), it->b + (block * BITDIFF_BLOCK_BYTES), BITDIFF_BLOCK_BYTES);
+		}
+		else {
+			bitdiff_load_block(it->diff, it->a + (block * BITDIFF_BLOCK_BYTES), it->b + (block * BITDIFF_BLOCK_BYTES), it->nbytes - (block * BITDIFF_BLOCK_BYTES));
+		}
+		it->word_index = block * BLOCK_WORDS;
+		it->nwords = BLOCK_WORDS;
+		it->next_block = block + 1;
+	}
+}
+
+/**
+ * \fn bitdiff_count(const void* a, const void* b, size_t nbytes)
+ * \brief Counts the bits that differ between a and b. Equal blocks are skipped by the block scanner, so the cost of mostly equal buffers is the scan
+ *
+ * \return The number of differing bits
+ */
+size_t bitdiff_count(const void* a, const void* b, size_t nbytes) {
+	const uint8_t* pa = (const uint8_t*)a;
+	const uint8_t* pb = (const uint8_t*)b;
+	bitdiff_scan_fn scan = bitdiff_pick_scan();
+	size_t nblocks = nbytes / BITDIFF_BLOCK_BYTES;
+	size_t block = 0;
+	size_t count = 0;
+	uint64_t diff[BLOCK_WORDS];
+	size_t k;
+
+	assert((nbytes == 0) || ((a != NULL) && (b != NULL)));
+
+	for (;;) {
+		block = scan(pa, pb, block, nblocks);
+		if (block >= nblocks) {
+			break;
+		}
+		for (k = 0; k < BLOCK_WORDS; k++) {
+			count += (size_t)__builtin_popcountll(bitdiff_load64(pa + (block * BITDIFF_BLOCK_BYTES) + (k * 8)) ^ bitdiff_load64(pb + (block * BITDIFF_BLOCK_BYTES) + (k * 8)));
+		}
+		block++;
+	}
+
+	bitdiff_load_block(diff, pa + (nblocks * BITDIFF_BLOCK_BYTES), pb + (nblocks * BITDIFF_BLOCK_BYTES), nbytes - (nblocks * BITDIFF_BLOCK_BYTES));
+	for (k = 0; k < BLOCK_WORDS; k++) {
+		count += (size_t)__builtin_popcountll(diff[k]);
+	}
+
+	return count;
+}
+
+/**
+ * \fn bitdiff_xor(void* dst, const void* a, const void* b, size_t nbytes)
+ * \brief Writes a ^ b to dst, the set bits of which are the bits that differ. dst may be a or b
+ *
+ * \return None
+ */
+void bitdiff_xor(void* dst, const void* a, const void* b, size_t nbytes) {
+	uint8_t* pd = (uint8_t*)dst;
+	const uint8_t* pa = (const uint8_t*)a;
+	const uint8_t* pb = (const uint8_t*)b;
+	uint64_t wa;
+	uint64_t wb;
+	size_t k = 0;
+
+	assert((nbytes == 0) || ((dst != NULL) && (a != NULL) && (b != NULL)));
+
+#ifdef BITOPS_X86
+	if (bitops_cpu_features() & BITOPS_CPU_AVX2) {
+		k = bitdiff_xor_avx2(pd, pa, pb, nbytes);
+	}
+	else if (bitops_cpu_features() & BITOPS_CPU_SSE2) {
+		k = bitdiff_xor_sse2(pd, pa, pb, nbytes);
+	}
+#endif
+
+	for (; k + 8 <= nbytes; k += 8) {
+		memcpy(&wa, pa + k, sizeof(wa));
+		memcpy(&wb, pb + k, sizeof(wb));
+		wa ^= wb;
+		memcpy(pd + k, &wa, sizeof(wa));
+	}
+	for (; k < nbytes; k++) {
+		pd[k] = pa[k] ^ pb[k];
+	}
+}
+
+/**
+ * \fn bitdiff_load32(const uint8_t* p, size_t avail)
+ * \brief Loads a 32-bit little-endian word of which only the first avail bytes exist, the rest reading as zero
+ *
+ * \return The word
+ */
+static uint32_t bitdiff_load32(const uint8_t* p, size_t avail) {
+	uint32_t word = 0;
+	size_t k;
+
+	for (k = 0; (k < BITDIFF_WORD_BYTES) && (k < avail); k++) {
+		word |= (uint32_t)p[k] << (k * BITS_PER_BYTE);
+	}
+
+	return word;
+}
+
+/**
+ * \fn bitdiff_render_line_chars(size_t word)
+ * \brief Gives the length of the line of one changed 32-bit word
+ *
+ * \return BITDIFF_LINE64_CHARS if the word's offset needs more than 8 digits, BITDIFF_LINE_CHARS otherwise
+ */
+static size_t bitdiff_render_line_chars(size_t word) {
+	return ((uint64_t)word * BITDIFF_WORD_BYTES > UINT32_MAX) ? BITDIFF_LINE64_CHARS : BITDIFF_LINE_CHARS;
+}
+
+/**
+ * \fn bitdiff_render_line(char* line, const bitdiff_iter_t* it, size_t word)
+ * \brief Prints the line of one changed 32-bit word, newline included, in exactly bitdiff_render_line_chars(word) characters
+ *
+ * \return None
+ */
+static void bitdiff_render_line(char* line, const bitdiff_iter_t* it, size_t word) {
+	size_t offset = word * BITDIFF_WORD_BYTES;
+	uint32_t va = bitdiff_load32(it->a + offset, it->nbytes - offset);
+	uint32_t vb = bitdiff_load32(it->b + offset, it->nbytes - offset);
+	uint32_t changed = va ^ vb;
+	char* p = line;
+	int k;
+
+	///< Each formatter writes its terminator, which the separator after it overwrites
+	if (bitdiff_render_line_chars(word) == BITDIFF_LINE64_CHARS) {
+		uint_to_hexstr_fmt(p, 8 + NULL_TERMINATOR_BYTE, (uint32_t)((uint64_t)offset >> UINT32_T_BITS), UINT32_T_BITS, HEXSTR_NO_PREFIX);
+		p += 8;
+	}
+	uint_to_hexstr_fmt(p, 8 + NULL_TERMINATOR_BYTE, (uint32_t)offset, UINT32_T_BITS, HEXSTR_NO_PREFIX);
+	p += 8;
+	*p++ = ' ';
+	*p++ = ' ';
+	uint_to_hexstr32(p, 10 + NULL_TERMINATOR_BYTE, va);
+	p += 10;
+	*p++ = ' ';
+	uint_to_hexstr32(p, 10 + NULL_TERMINATOR_BYTE, vb);
+	p += 10;
+	*p++ = ' ';
+	*p++ = ' ';
+	uint_to_binstr32(p, 34 + NULL_TERMINATOR_BYTE, va);
+	p += 34;
+	*p++ = ' ';
+	uint_to_binstr32(p, 34 + NULL_TERMINATOR_BYTE, vb);
+	p += 34;
+	*p++ = ' ';
+	*p++ = ' ';
+	for (k = UINT32_T_BITS - 1; k >= 0; k--) {
+		*p++ = ((changed >> k) & 1u) ? '^' : '.';
+	}
+	*p = '\n';
+}
+
+/**
+ * \fn bitdiff_render_emit(bitdiff_iter_t* it, char* str, size_t size)
+ * \brief Prints one line per changed 32-bit word from where the walk has got to, stopping at the first line that does not fit. No null terminator is written
+ *
+ * \param it Pointer to a walk set up with bitdiff_init. Lines that fit are consumed from it, so the next call carries on
+ * \param str Pointer to the output
+ * \param size The space at str
+ *
+ * \return The number of characters written: BITDIFF_LINE_CHARS per line, or BITDIFF_LINE64_CHARS for a word past 4 GiB
+ */
+size_t bitdiff_render_emit(bitdiff_iter_t* it, char* str, size_t size) {
+	char line[BITDIFF_LINE64_CHARS + NULL_TERMINATOR_BYTE];
+	size_t written = 0;
+	size_t chars;
+	size_t pos;
+	size_t word;
+	size_t index;
+
+	assert(it != NULL);
+	assert((str != NULL) || (size == 0));
+
+	for (;;) {
+		pos = bitdiff_next(it);
+		if (pos == BITDIFF_NONE) {
+			break;
+		}
+
+		index = (pos / UINT64_T_BITS) - it->word_index;
+		word = pos / UINT32_T_BITS;
+		chars = bitdiff_render_line_chars(word);
+		if (size - written < chars) {
+			///< Put the bit back, so the next call prints this word first
+			it->diff[index] |= 1ull << (pos % UINT64_T_BITS);
+			break;
+		}
+
+		bitdiff_render_line(line, it, word);
+		memcpy(str + written, line, chars);
+		written += chars;
+
+		///< pos was the lowest changed bit of its word; the line covers the rest of them
+		it->diff[index] &= ~(0xFFFFFFFFull << ((word % 2) * UINT32_T_BITS));
+	}
+
+	return written;
+}
+
+/**
+ * \fn bitdiff_render(char* str, size_t size, const void* a, const void* b, size_t nbytes)
+ * \brief Prints one line per 32-bit word that differs between a and b
+ *
+ * \param str Pointer to the output, null terminated
+ * \param size The space at str
+ * \param a Pointer to the first buffer
+ * \param b Pointer to the second buffer
+ * \param nbytes The size of each buffer
+ *
+ * \return If successful, returns str. If the lines do not all fit, returns str set to the empty string.
+ */
+char* bitdiff_render(char* str, size_t size, const void* a, const void* b, size_t nbytes) {
+	bitdiff_iter_t it;
+	size_t written;
+
+	assert(str != NULL);
+	assert(size >= NULL_TERMINATOR_BYTE);
+
+	bitdiff_init(&it, a, b, nbytes);
+	written = bitdiff_render_emit(&it, str, size - NULL_TERMINATOR_BYTE);
+	if (bitdiff_next(&it) != BITDIFF_NONE) {
+		str[0] = '\0';
+		return str;
+	}
+	str[written] = '\0';
+
+	return str;
+}
+
+/**
+ * \fn test_diff(void)
+ * \brief Walks, counts and XORs random buffers with sparse and dense changes under every ISA tier against a byte-by-byte reference, and checks a rendered known answer
+ *
+ * \return If successful, returns EXIT_TEST_SUCCESS. If unsuccessful, returns EXIT_TEST_FAILURE.
+ */
+int test_diff(void) {
+	bitdiff_iter_t it;
+	bitops_isa_t saved_isa = bitops_isa();
+	bitops_isa_t max_isa = bitops_isa_max_supported();
+	bitops_isa_t isa;
+	uint32_t state = TEST_22_SEED;
+	uint32_t round;
+	size_t nbytes;
+	size_t nflips;
+	size_t nexpected;
+	size_t k;
+	size_t pos;
+	size_t found;
+	size_t written;
+	size_t total;
+	size_t chunk;
+	uint8_t a[6];
+	uint8_t b[6];
+	int return_code = EXIT_TEST_SUCCESS;
+
+	for (round = 0; round < TEST_22_ROUNDS; round++) {
+		nbytes = test_rand32(&state) % (TEST_22_BYTES + 1);
+		for (k = 0; k < nbytes; k++) {
+			TEST_22_A[k] = (uint8_t)test_rand32(&state);
+		}
+		memcpy(TEST_22_B, TEST_22_A, nbytes);
+
+		///< Mostly a few flips, now and then a dense change, always one in the tail when there is one
+		nflips = (round % 8 == 7) ? nbytes * 2 : test_rand32(&state) % 12;
+		for (k = 0; (nbytes > 0) && (k < nflips); k++) {
+			pos = test_rand32(&state) % (nbytes * BITS_PER_BYTE);
+			TEST_22_B[pos / BITS_PER_BYTE] ^= (uint8_t)(1u << (pos % BITS_PER_BYTE));
+		}
+		if (nbytes % BITDIFF_BLOCK_BYTES != 0) {
+			TEST_22_B[nbytes - 1] ^= 0x80;
+		}
+
+		nexpected = 0;
+		for (pos = 0; pos < nbytes * BITS_PER_BYTE; pos++) {
+			if ((TEST_22_A[pos / BITS_PER_BYTE] ^ TEST_22_B[pos / BITS_PER_BYTE]) & (1u << (pos % BITS_PER_BYTE))) {
+				TEST_22_EXPECTED[nexpected++] = pos;
+			}
+		}
+
+		for (isa = BITOPS_ISA_SCALAR; isa <= max_isa; isa++) {
+			bitops_set_isa(isa);
+
+			bitdiff_init(&it, TEST_22_A, TEST_22_B, nbytes);
+			found = 0;
+			while ((pos = bitdiff_next(&it)) != BITDIFF_NONE) {
+				if ((found >= nexpected) || (TEST_22_EXPECTED[found] != pos)) {
+					printf("test_diff: (FAILURE) [%s]: %zu bytes, change %zu reported at bit %zu\n", bitops_isa_name(isa), nbytes, found, pos);
+					return_code = EXIT_TEST_FAILURE;
+					break;
+				}
+				found++;
+			}
+			if ((pos == BITDIFF_NONE) && (found != nexpected)) {
+				printf("test_diff: (FAILURE) [%s]: %zu bytes, %zu of %zu changes reported\n", bitops_isa_name(isa), nbytes, found, nexpected);
+				return_code = EXIT_TEST_FAILURE;
+			}
+
+			if (bitdiff_count(TEST_22_A, TEST_22_B, nbytes) != nexpected) {
+				printf("test_diff: (FAILURE) [%s]: %zu bytes, count %zu, expected %zu\n", bitops_isa_name(isa), nbytes, bitdiff_count(TEST_22_A, TEST_22_B, nbytes), nexpected);
+				return_code = EXIT_TEST_FAILURE;
+			}
+
+			bitdiff_xor(TEST_22_XOR, TEST_22_A, TEST_22_B, nbytes);
+			for (k = 0; k < nbytes; k++) {
+				if (TEST_22_XOR[k] != (uint8_t)(TEST_22_A[k] ^ TEST_22_B[k])) {
+					printf("test_diff: (FAILURE) [%s]: %zu bytes, XOR wrong at byte %zu\n", bitops_isa_name(isa), nbytes, k);
+					return_code = EXIT_TEST_FAILURE;
+					break;
+				}
+			}
+
+			///< Rendering in pieces of one or two lines must give the same lines as one call
+			if (nflips < 12) {
+				bitdiff_render(TEST_22_STR, sizeof(TEST_22_STR), TEST_22_A, TEST_22_B, nbytes);
+				total = strlen(TEST_22_STR);
+				bitdiff_init(&it, TEST_22_A, TEST_22_B, nbytes);
+				written = 0;
+				do {
+					chunk = (BITDIFF_LINE_CHARS * (1 + (test_rand32(&state) % 2))) + (test_rand32(&state) % 10);
+					chunk = (chunk < sizeof(TEST_22_STR) - written) ? chunk : sizeof(TEST_22_STR) - written;
+					k = bitdiff_render_emit(&it, TEST_22_STR + written, chunk);
+					written += k;
+				} while (k > 0);
+				if (((total == 0) && (nexpected > 0)) || (written != total)) {
+					printf("test_diff: (FAILURE) [%s]: %zu bytes rendered as %zu characters whole, %zu in pieces\n", bitops_isa_name(isa), nbytes, total, written);
+					return_code = EXIT_TEST_FAILURE;
+				}
+			}
+		}
+	}
+	bitops_set_isa(saved_isa);
+
+	///< A known answer, with a short last word
+	memcpy(a, "\x00\x00\x00\x00\x0F\xF0", sizeof(a));
+	memcpy(b, "\x01\x00\x00\x80\x0F\xF1", sizeof(b));
+	bitdiff_render(TEST_22_STR, sizeof(TEST_22_STR), a, b, sizeof(a));
+	if (strcmp(TEST_22_STR,
+		"00000000  0x00000000 0x80000001  0b00000000000000000000000000000000 0b10000000000000000000000000000001  ^..............................^\n"
+		"00000004  0x0000F00F 0x0000F10F  0b00000000000000001111000000001111 0b00000000000000001111000100001111  .......................^........\n") != 0) {
+		printf("test_diff: (FAILURE): known answer, RESULT =\n%s", TEST_22_STR);
+		return_code = EXIT_TEST_FAILURE;
+	}
+
+	///< Output too small for every line leaves the empty string
+	bitdiff_render(TEST_22_STR, BITDIFF_LINE_CHARS + NULL_TERMINATOR_BYTE, a, b, sizeof(a));
+	if (TEST_22_STR[0] != '\0') {
+		printf("test_diff: (FAILURE): truncated render was not emptied\n");
+		return_code = EXIT_TEST_FAILURE;
+	}
+
+	printf("test_diff: %u buffer pairs checked under ISA tiers scalar to %s\n", TEST_22_ROUNDS, bitops_isa_name(max_isa));
+
+	return return_code;
+}
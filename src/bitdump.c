@@ -0,0 +1,264 @@
+#include <errno.h>
+#include <fcntl.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/uio.h>
+#include <unistd.h>
+#include "bitops.h"
+#include "bitlayout.h"
+
+#define BITDUMP_SEGMENTS (8)
+#define BITDUMP_SEGMENT_BYTES (256 * 1024)
+
+static char bitdump_buffer[BITDUMP_SEGMENTS][BITDUMP_SEGMENT_BYTES];
+
+/**
+ * \fn bitdump_writev_all(int fd, struct iovec* iov, int iovcnt)
+ * \brief Writes every byte described by iov, retrying after short writes and interrupts
+ *
+ * \param fd File descriptor to write to
+ * \param iov Pointer to the segments to write (modified as bytes are written)
+ * \param iovcnt The number of segments pointed to by iov
+ *
+ * \return 0 if successful, -1 on a write error (errno is set)
+ */
+static int bitdump_writev_all(int fd, struct iovec* iov, int iovcnt) {
+	ssize_t written;
+
+	while (iovcnt > 0) {
+		written = writev(fd, iov, iovcnt);
+		if (written < 0) {
+			if (errno == EINTR) {
+				continue;
+			}
+			return -1;
+		}
+
+		while ((iovcnt > 0) && ((size_t)written >= iov->iov_len)) {
+			written -= (ssize_t)iov->iov_len;
+			iov++;
+			iovcnt--;
+		}
+		if (iovcnt > 0) {
+			iov->iov_base = (char*)iov->iov_base + written;
+			iov->iov_len -= (size_t)written;
+		}
+	}
+
+	return 0;
+}
+
+/**
+ * \fn bitdump_parse_size(const char* text, uint64_t* value)
+ * \brief Parses a decimal, 0x-hex or 0-octal byte count
+ *
+ * \return 0 if text is a complete number, -1 otherwise
+ */
+static int bitdump_parse_size(const char* text, uint64_t* value) {
+	char* end;
+
+	errno = 0;
+	*value = strtoull(text, &end, 0);
+
+	return ((errno == 0) && (end != text) && (*end == '\0') && (text[0] != '-')) ? 0 : -1;
+}
+
+static void bitdump_usage(const char* name) {
+	fprintf(stderr, "usage: %s [--offset bytes] [--length bytes] [--width 16|32|64] [--group 1|2|4|8] [--le] [--ascii] [--collapse] [--offset64] [--lower] file\n", name);
+}
+
+/**
+ * \fn bitdump_stream(const uint8_t* src, size_t nbytes, uint64_t first_offset)
+ * \brief Streams the dump of src to stdout. Rows are formatted into a fixed set of segments which are handed to a single writev once they are all full
+ *
+ * \param src Pointer to the bytes to dump
+ * \param nbytes The number of bytes to dump
+ * \param first_offset The offset printed on the first row
+ * \param plan Pointer to a compiled layout, or NULL for the plain hexdump format
+ *
+ * \return 0 if successful, -1 on a write error
+ */
+static int bitdump_stream(const uint8_t* src, size_t nbytes, uint64_t first_offset, const hexdump_plan_t* plan) {
+	struct iovec iov[BITDUMP_SEGMENTS];
+	hexdump_stream_t stream;
+	hexdump_cursor_t cursor;
+	size_t used = 0;
+	size_t consumed;
+	size_t fill = 0;
+	int segment = 0;
+
+	hexdump_init(&stream);
+	stream.offset = first_offset;
+	hexdump_cursor_init(&cursor, first_offset);
+
+	for (;;) {
+		if (plan != NULL) {
+			fill += hexdump_layout_emit(plan, &cursor, bitdump_buffer[segment] + fill, BITDUMP_SEGMENT_BYTES - fill, src + used, nbytes - used, &consumed);
+			used += consumed;
+			if (used == nbytes) {
+				break;
+			}
+		}
+		else {
+			fill += hexdump_feed(&stream, bitdump_buffer[segment] + fill, BITDUMP_SEGMENT_BYTES - fill, src + used, nbytes - used, &consumed);
+			used += consumed;
+
+			if (used == nbytes) {
+				fill += hexdump_finish(&stream, bitdump_buffer[segment] + fill, BITDUMP_SEGMENT_BYTES - fill);
+				if (stream.npending == 0) {
+					break;
+				}
+			}
+		}
+
+		///< This segment cannot take another row; move to the next one, flushing once all are full
+		iov[segment].iov_base = bitdump_buffer[segment];
+		iov[segment].iov_len = fill;
+		segment++;
+		fill = 0;
+
+		if (segment == BITDUMP_SEGMENTS) {
+			if (bitdump_writev_all(STDOUT_FILENO, iov, segment) != 0) {
+				return -1;
+			}
+			segment = 0;
+		}
+	}
+
+	iov[segment].iov_base = bitdump_buffer[segment];
+	iov[segment].iov_len = fill;
+
+	return bitdump_writev_all(STDOUT_FILENO, iov, segment + 1);
+}
+
+int main(int argc, char** argv) {
+	const char* path = NULL;
+	uint64_t offset = 0;
+	uint64_t length = UINT64_MAX;
+	uint64_t value;
+	hexdump_layout_t layout = { 16, 1, 0 };
+	hexdump_plan_t plan;
+	int use_layout = 0;
+	uint64_t map_start;
+	size_t map_len;
+	long page_size = sysconf(_SC_PAGESIZE);
+	struct stat st;
+	uint8_t* map;
+	int fd;
+	int i;
+	int return_code;
+
+	for (i = 1; i < argc; i++) {
+		if ((strcmp(argv[i], "--offset") == 0) && (i + 1 < argc)) {
+			if (bitdump_parse_size(argv[++i], &offset) != 0) {
+				bitdump_usage(argv[0]);
+				return EXIT_FAILURE;
+			}
+		}
+		else if ((strcmp(argv[i], "--length") == 0) && (i + 1 < argc)) {
+			if (bitdump_parse_size(argv[++i], &length) != 0) {
+				bitdump_usage(argv[0]);
+				return EXIT_FAILURE;
+			}
+		}
+		else if (((strcmp(argv[i], "--width") == 0) || (strcmp(argv[i], "--group") == 0)) && (i + 1 < argc)) {
+			if ((bitdump_parse_size(argv[i + 1], &value) != 0) || (value > 64)) {
+				bitdump_usage(argv[0]);
+				return EXIT_FAILURE;
+			}
+			if (strcmp(argv[i], "--width") == 0) {
+				layout.row_bytes = (uint8_t)value;
+			}
+			else {
+				layout.group_bytes = (uint8_t)value;
+			}
+			use_layout = 1;
+			i++;
+		}
+		else if (strcmp(argv[i], "--le") == 0) {
+			layout.flags |= HEXDUMP_LAYOUT_LITTLE_ENDIAN;
+			use_layout = 1;
+		}
+		else if (strcmp(argv[i], "--ascii") == 0) {
+			layout.flags |= HEXDUMP_LAYOUT_ASCII;
+			use_layout = 1;
+		}
+		else if (strcmp(argv[i], "--collapse") == 0) {
+			layout.flags |= HEXDUMP_LAYOUT_COLLAPSE;
+			use_layout = 1;
+		}
+		else if (strcmp(argv[i], "--offset64") == 0) {
+			layout.flags |= HEXDUMP_LAYOUT_OFFSET64;
+			use_layout = 1;
+		}
+		else if (strcmp(argv[i], "--lower") == 0) {
+			layout.flags |= HEXDUMP_LAYOUT_LOWER;
+			use_layout = 1;
+		}
+		else if ((path == NULL) && (argv[i][0] != '-')) {
+			path = argv[i];
+		}
+		else {
+			bitdump_usage(argv[0]);
+			return EXIT_FAILURE;
+		}
+	}
+
+	if ((path == NULL) || (use_layout && (hexdump_plan_compile(&plan, &layout) != 0))) {
+		bitdump_usage(argv[0]);
+		return EXIT_FAILURE;
+	}
+
+	fd = open(path, O_RDONLY);
+	if ((fd < 0) || (fstat(fd, &st) != 0)) {
+		perror(path);
+		return EXIT_FAILURE;
+	}
+
+	///< Clamp the window to the file; an empty window prints nothing
+	if (offset >= (uint64_t)st.st_size) {
+		close(fd);
+		return EXIT_SUCCESS;
+	}
+	if (length > (uint64_t)st.st_size - offset) {
+		length = (uint64_t)st.st_size - offset;
+	}
+	if ((length == 0) || (length > SIZE_MAX)) {
+		close(fd);
+		return (length == 0) ? EXIT_SUCCESS : EXIT_FAILURE;
+	}
+
+	///< 8-digit offsets wrap past 4 GiB, so a window reaching beyond it always gets 16-digit offsets
+	if ((offset + length > (uint64_t)UINT32_MAX + 1) && !(layout.flags & HEXDUMP_LAYOUT_OFFSET64)) {
+		layout.flags |= HEXDUMP_LAYOUT_OFFSET64;
+		use_layout = 1;
+		if (hexdump_plan_compile(&plan, &layout) != 0) {
+			close(fd);
+			bitdump_usage(argv[0]);
+			return EXIT_FAILURE;
+		}
+	}
+
+	///< mmap needs a page-aligned file offset, so map from the page holding the window start
+	map_start = offset - (offset % (uint64_t)page_size);
+	map_len = (size_t)(length + (offset - map_start));
+	map = mmap(NULL, map_len, PROT_READ, MAP_PRIVATE, fd, (off_t)map_start);
+	close(fd);
+	if (map == MAP_FAILED) {
+		perror(path);
+		return EXIT_FAILURE;
+	}
+	madvise(map, map_len, MADV_SEQUENTIAL);
+
+	return_code = bitdump_stream(map + (offset - map_start), (size_t)length, offset, use_layout ? &plan : NULL);
+	if (return_code != 0) {
+		perror("write");
+	}
+
+	munmap(map, map_len);
+
+	return (return_code == 0) ? EXIT_SUCCESS : EXIT_FAILURE;
+}
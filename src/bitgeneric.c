@@ -0,0 +1,258 @@
+#include <stdio.h>
+#include <string.h>
+#include "bitgeneric.h"
+
+#define EXIT_FAILURE_N (-1)
+#define EXIT_TEST_SUCCESS (1)
+#define EXIT_TEST_FAILURE (0)
+
+#define BITS_PER_BYTE (8)
+#define BITS_PER_NIBBLE (4)
+#define NULL_TERMINATOR_BYTE (1)
+#define PREFIX_BYTES_BIN (2)
+#define PREFIX_BYTES_HEX (2)
+#define GENERIC_MAX_BITS (128)
+
+#define TEST_18_SEED (777u)
+#define TEST_18_ROUNDS (2000)
+
+char TEST_18_RESULT[PREFIX_BYTES_BIN + GENERIC_MAX_BITS + NULL_TERMINATOR_BYTE];
+char TEST_18_EXPECTED[PREFIX_BYTES_BIN + GENERIC_MAX_BITS + NULL_TERMINATOR_BYTE];
+
+/*
+ * One template per width. Formatting writes any leading bits (or nibble) that do not fill a
+ * byte, then whole bytes from the top down with BITOPS_BIN_BYTE / BITOPS_HEX_BYTE. The
+ * full-width case has a compile-time trip count, so the compiler emits it as straight-line
+ * code; every shift is done in the value's own type.
+ */
+///< Hex formatter for one width; also instantiated for uint32_t so the _Generic front end refuses too-wide values at every width
+#define DEFINE_GENERIC_HEXSTR(suffix, utype, width) \
+int uint_to_hexstr_##suffix(char* str, size_t size, utype num, uint8_t nbits) { \
+	assert(str != NULL); \
+	assert((nbits > 0) && (nbits <= (width)) && (nbits % BITS_PER_NIBBLE == 0)); \
+	assert(size > (size_t)nbits / BITS_PER_NIBBLE + PREFIX_BYTES_HEX); \
+	(void)size; \
+	int current_byte = PREFIX_BYTES_HEX; \
+	int bit = nbits; \
+	if ((nbits < (width)) && ((num >> nbits) != 0)) { \
+		str[0] = '\0'; \
+		return EXIT_FAILURE_N; \
+	} \
+	str[0] = '0'; \
+	str[1] = 'x'; \
+	if (bit % BITS_PER_BYTE != 0) { \
+		bit -= BITS_PER_NIBBLE; \
+		str[current_byte++] = BITOPS_HEX_DIGIT((unsigned)(num >> bit) & 0xFu); \
+	} \
+	while (bit > 0) { \
+		bit -= BITS_PER_BYTE; \
+		BITOPS_HEX_BYTE(str + current_byte, (unsigned)(uint8_t)(num >> bit)); \
+		current_byte += 2; \
+	} \
+	str[current_byte] = '\0'; \
+	return current_byte; \
+}
+
+#define DEFINE_GENERIC_WIDTH(suffix, ssuffix, utype, stype, width) \
+int uint_to_binstr_##suffix(char* str, size_t size, utype num, uint8_t nbits) { \
+	assert(str != NULL); \
+	assert(size > (size_t)nbits + PREFIX_BYTES_BIN); \
+	assert((nbits > 0) && (nbits <= (width))); \
+	(void)size; \
+	int current_byte = PREFIX_BYTES_BIN; \
+	int bit = nbits; \
+	if ((nbits < (width)) && ((num >> nbits) != 0)) { \
+		str[0] = '\0'; \
+		return EXIT_FAILURE_N; \
+	} \
+	str[0] = '0'; \
+	str[1] = 'b'; \
+	while (bit % BITS_PER_BYTE != 0) { \
+		bit--; \
+		str[current_byte++] = (char)('0' + (int)((num >> bit) & 1u)); \
+	} \
+	while (bit > 0) { \
+		bit -= BITS_PER_BYTE; \
+		BITOPS_BIN_BYTE(str + current_byte, (uint8_t)(num >> bit)); \
+		current_byte += BITS_PER_BYTE; \
+	} \
+	str[current_byte] = '\0'; \
+	return current_byte; \
+} \
+int int_to_binstr_##ssuffix(char* str, size_t size, stype num, uint8_t nbits) { \
+	assert((nbits > 0) && (nbits <= (width))); \
+	utype bits = (utype)num; \
+	if (nbits < (width)) { \
+		bits &= (utype)~(utype)0 >> ((width) - nbits); \
+	} \
+	return uint_to_binstr_##suffix(str, size, bits, nbits); \
+} \
+DEFINE_GENERIC_HEXSTR(suffix, utype, width) \
+utype twiggle_bit_##suffix(utype input, int bit, operation_t operation) { \
+	assert(((width) > bit) && (bit >= 0)); \
+	assert((operation == CLEAR) || (operation == SET) || (operation == TOGGLE)); \
+	switch (operation) { \
+		case CLEAR: \
+			return input & (utype)~((utype)1 << bit); \
+		case SET: \
+			return input | (utype)((utype)1 << bit); \
+		case TOGGLE: \
+			return input ^ (utype)((utype)1 << bit); \
+		default: \
+			return (utype)~(utype)0; \
+	} \
+} \
+utype grab_three_bits_##suffix(utype input, int start_bit) { \
+	assert(((width) - 3 >= start_bit) && (start_bit >= 0)); \
+	return (utype)((input >> start_bit) & 0x7u); \
+}
+
+DEFINE_GENERIC_WIDTH(u8, s8, uint8_t, int8_t, 8)
+DEFINE_GENERIC_HEXSTR(u32, uint32_t, 32)
+DEFINE_GENERIC_WIDTH(u16, s16, uint16_t, int16_t, 16)
+DEFINE_GENERIC_WIDTH(u64, s64, uint64_t, int64_t, 64)
+#ifdef BITOPS_HAVE_INT128
+DEFINE_GENERIC_WIDTH(u128, s128, bitops_u128_t, bitops_s128_t, 128)
+#endif
+
+/**
+ * \fn test_generic_reference(char* str, const uint32_t* words, int nbits, int hex)
+ * \brief Builds the expected string one bit or nibble at a time from little-endian 32-bit words
+ *
+ * \return The number of characters written, not including the terminal \0
+ */
+static int test_generic_reference(char* str, const uint32_t* words, int nbits, int hex) {
+	int step = hex ? BITS_PER_NIBBLE : 1;
+	int current_byte = PREFIX_BYTES_BIN;
+	int bit;
+	unsigned digit;
+
+	str[0] = '0';
+	str[1] = hex ? 'x' : 'b';
+
+	for (bit = nbits - step; bit >= 0; bit -= step) {
+		digit = (words[bit / 32] >> (bit % 32)) & (hex ? 0xFu : 1u);
+		str[current_byte++] = "0123456789ABCDEF"[digit];
+	}
+	str[current_byte] = '\0';
+
+	return current_byte;
+}
+
+///< Checks one generated formatter against the reference, for a value whose bits are in words
+#define TEST_18_CHECK(call, words, nbits, hex) do { \
+	int expected_len = test_generic_reference(TEST_18_EXPECTED, (words), (nbits), (hex)); \
+	int len = (call); \
+	if ((len != expected_len) || (strcmp(TEST_18_RESULT, TEST_18_EXPECTED) != 0)) { \
+		printf("test_generic: (FAILURE): %s, nbits = %d\nEXPECT = %s\nRESULT = %s\n", #call, (nbits), TEST_18_EXPECTED, TEST_18_RESULT); \
+		return_code = EXIT_TEST_FAILURE; \
+	} \
+} while (0)
+
+int test_generic(void) {
+	uint32_t state = TEST_18_SEED;
+	uint32_t words[4];
+	uint32_t masked[4];
+	uint8_t v8;
+	uint16_t v16;
+	uint32_t v32;
+	uint64_t v64;
+	int64_t s64;
+	int nbits;
+	int bit;
+	int i;
+	int k;
+	int return_code = EXIT_TEST_SUCCESS;
+#ifdef BITOPS_HAVE_INT128
+	bitops_u128_t v128;
+	bitops_s128_t s128;
+#endif
+
+	///< _Generic must keep the argument's width in the result type
+	if ((sizeof(bitops_twiggle_bit((uint8_t)0, 0, SET)) != 1) || (sizeof(bitops_twiggle_bit((uint16_t)0, 0, SET)) != 2)
+		|| (sizeof(bitops_twiggle_bit((uint32_t)0, 0, SET)) != 4) || (sizeof(bitops_grab_three_bits((uint64_t)0, 0)) != 8)) {
+		printf("test_generic: (FAILURE): _Generic picked the wrong width\n");
+		return_code = EXIT_TEST_FAILURE;
+	}
+
+	for (i = 0; i < TEST_18_ROUNDS; i++) {
+		for (k = 0; k < 4; k++) {
+			words[k] = test_rand32(&state);
+		}
+
+		///< 8 and 16 bits: full width, and a random narrower width
+		v8 = (uint8_t)words[0];
+		v16 = (uint16_t)words[0];
+		TEST_18_CHECK(bitops_uint_to_binstr(TEST_18_RESULT, sizeof(TEST_18_RESULT), v8, 8), words, 8, 0);
+		TEST_18_CHECK(bitops_uint_to_binstr(TEST_18_RESULT, sizeof(TEST_18_RESULT), v16, 16), words, 16, 0);
+		TEST_18_CHECK(bitops_uint_to_hexstr(TEST_18_RESULT, sizeof(TEST_18_RESULT), v16, 16), words, 16, 1);
+		TEST_18_CHECK(bitops_int_to_binstr(TEST_18_RESULT, sizeof(TEST_18_RESULT), (int16_t)v16, 11), words, 11, 0);
+
+		///< 32 bits: hex through uint_to_hexstr_u32 at full width and at a random multiple of 4
+		v32 = words[0];
+		TEST_18_CHECK(bitops_uint_to_binstr(TEST_18_RESULT, sizeof(TEST_18_RESULT), v32, 32), words, 32, 0);
+		TEST_18_CHECK(bitops_uint_to_hexstr(TEST_18_RESULT, sizeof(TEST_18_RESULT), v32, 32), words, 32, 1);
+		nbits = BITS_PER_NIBBLE * (1 + (int)(words[2] % 8));
+		v32 = (nbits < 32) ? (words[0] & (((uint32_t)1 << nbits) - 1)) : words[0];
+		masked[0] = v32;
+		TEST_18_CHECK(bitops_uint_to_hexstr(TEST_18_RESULT, sizeof(TEST_18_RESULT), v32, (uint8_t)nbits), masked, nbits, 1);
+
+		///< 64 bits: the full value, then every width from a random low part
+		v64 = ((uint64_t)words[1] << 32) | words[0];
+		s64 = (int64_t)v64;
+		nbits = 1 + (int)(words[2] % 64);
+		masked[0] = words[0];
+		masked[1] = words[1];
+		if (nbits < 64) {
+			v64 &= ~(uint64_t)0 >> (64 - nbits);
+			masked[0] = (uint32_t)v64;
+			masked[1] = (uint32_t)(v64 >> 32);
+		}
+		TEST_18_CHECK(bitops_uint_to_binstr(TEST_18_RESULT, sizeof(TEST_18_RESULT), v64, (uint8_t)nbits), masked, nbits, 0);
+		TEST_18_CHECK(bitops_int_to_binstr(TEST_18_RESULT, sizeof(TEST_18_RESULT), s64, (uint8_t)nbits), masked, nbits, 0);
+		nbits = (nbits + 3) & ~3;
+		v64 = ((uint64_t)words[1] << 32) | words[0];
+		if (nbits < 64) {
+			v64 &= ~(uint64_t)0 >> (64 - nbits);
+		}
+		masked[0] = (uint32_t)v64;
+		masked[1] = (uint32_t)(v64 >> 32);
+		TEST_18_CHECK(bitops_uint_to_hexstr(TEST_18_RESULT, sizeof(TEST_18_RESULT), v64, (uint8_t)nbits), masked, nbits, 1);
+
+		bit = (int)(words[3] % 64);
+		v64 = ((uint64_t)words[1] << 32) | words[0];
+		if ((bitops_twiggle_bit(v64, bit, SET) != (v64 | ((uint64_t)1 << bit))) || (bitops_twiggle_bit(v64, bit, CLEAR) != (v64 & ~((uint64_t)1 << bit)))
+			|| (bitops_twiggle_bit(v64, bit, TOGGLE) != (v64 ^ ((uint64_t)1 << bit))) || (bitops_grab_three_bits(v64, bit % 62) != ((v64 >> (bit % 62)) & 7))) {
+			printf("test_generic: (FAILURE): 64-bit twiggle/grab, bit = %d\n", bit);
+			return_code = EXIT_TEST_FAILURE;
+		}
+
+#ifdef BITOPS_HAVE_INT128
+		v128 = ((bitops_u128_t)words[3] << 96) | ((bitops_u128_t)words[2] << 64) | ((bitops_u128_t)words[1] << 32) | words[0];
+		s128 = (bitops_s128_t)v128;
+		TEST_18_CHECK(bitops_uint_to_binstr(TEST_18_RESULT, sizeof(TEST_18_RESULT), v128, 128), words, 128, 0);
+		TEST_18_CHECK(bitops_int_to_binstr(TEST_18_RESULT, sizeof(TEST_18_RESULT), s128, 128), words, 128, 0);
+		TEST_18_CHECK(bitops_uint_to_hexstr(TEST_18_RESULT, sizeof(TEST_18_RESULT), v128, 128), words, 128, 1);
+
+		bit = (int)(words[3] % 128);
+		if ((bitops_twiggle_bit(v128, bit, TOGGLE) != (v128 ^ ((bitops_u128_t)1 << bit))) || (bitops_twiggle_bit(v128, bit, CLEAR) != (v128 & ~((bitops_u128_t)1 << bit)))
+			|| (bitops_grab_three_bits(v128, bit % 126) != ((v128 >> (bit % 126)) & 7))) {
+			printf("test_generic: (FAILURE): 128-bit twiggle/grab, bit = %d\n", bit);
+			return_code = EXIT_TEST_FAILURE;
+		}
+#endif
+	}
+
+	///< A value wider than nbits is an error, as with uint_to_binstr
+	if ((bitops_uint_to_binstr(TEST_18_RESULT, sizeof(TEST_18_RESULT), (uint64_t)1 << 40, 40) != EXIT_FAILURE_N) || (TEST_18_RESULT[0] != '\0')
+		|| (bitops_uint_to_hexstr(TEST_18_RESULT, sizeof(TEST_18_RESULT), (uint16_t)0x100, 8) != EXIT_FAILURE_N)
+		|| (bitops_uint_to_hexstr(TEST_18_RESULT, sizeof(TEST_18_RESULT), (uint32_t)0x1FF, 8) != EXIT_FAILURE_N) || (TEST_18_RESULT[0] != '\0')
+		|| (bitops_uint_to_hexstr(TEST_18_RESULT, sizeof(TEST_18_RESULT), (uint64_t)0x1FF, 8) != EXIT_FAILURE_N)) {
+		printf("test_generic: (FAILURE): out-of-range value accepted\n");
+		return_code = EXIT_TEST_FAILURE;
+	}
+
+	printf("test_generic: %d random values per width through the _Generic front ends\n", TEST_18_ROUNDS);
+
+	return return_code;
+}
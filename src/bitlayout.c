@@ -0,0 +1,510 @@
+#include <stdio.h>
+#include <string.h>
+#include "bitlayout.h"
+
+#define EXIT_FAILURE_N (-1)
+#define EXIT_TEST_SUCCESS (1)
+#define EXIT_TEST_FAILURE (0)
+
+#define NULL_TERMINATOR_BYTE (1)
+#define HEXDUMP_GUTTER_CHARS (2)
+#define ASCII_GUTTER_OPEN "  |"
+#define ASCII_GUTTER_OPEN_CHARS (3)
+#define COLLAPSE_LINE "*\n"
+#define COLLAPSE_LINE_CHARS (2)
+
+#define TEST_21_SEED (4242u)
+#define TEST_21_MAX_BYTES (300)
+#define TEST_21_DUMP_CHARS (32768)
+#define TEST_21_SPARSE_BYTES (65536)
+
+uint8_t TEST_21_DATA[TEST_21_MAX_BYTES];
+char TEST_21_EXPECTED[TEST_21_DUMP_CHARS];
+char TEST_21_RESULT[TEST_21_DUMP_CHARS];
+
+/**
+ * \fn hexdump_plan_offset(const hexdump_plan_t* plan, char* dst, uint64_t offset)
+ * \brief Writes the offset digits at the start of a row
+ *
+ * \return None
+ */
+static inline void hexdump_plan_offset(const hexdump_plan_t* plan, char* dst, uint64_t offset) {
+	size_t k;
+
+	for (k = 0; k < plan->offset_pairs; k++) {
+		memcpy(dst + (2 * k), plan->pairs[(offset >> (8 * (plan->offset_pairs - 1 - k))) & 0xFF], 2);
+	}
+}
+
+/*
+ * One full-row emitter per row width and gutter. The trip counts and the ASCII test are
+ * compile-time constants, so each is a template copy followed by straight-line digit stores.
+ */
+#define DEFINE_HEXDUMP_ROW(nbytes, with_ascii, suffix) \
+static void hexdump_row_##nbytes##_##suffix(const hexdump_plan_t* plan, char* dst, uint64_t offset, const uint8_t* src) { \
+	size_t i; \
+	memcpy(dst, plan->template_row, plan->row_chars); \
+	hexdump_plan_offset(plan, dst, offset); \
+	for (i = 0; i < (nbytes); i++) { \
+		memcpy(dst + plan->byte_column[i], plan->pairs[src[i]], 2); \
+	} \
+	if (with_ascii) { \
+		for (i = 0; i < (nbytes); i++) { \
+			dst[plan->ascii_column + i] = plan->ascii[src[i]]; \
+		} \
+	} \
+}
+
+DEFINE_HEXDUMP_ROW(16, 0, hex)
+DEFINE_HEXDUMP_ROW(16, 1, ascii)
+DEFINE_HEXDUMP_ROW(32, 0, hex)
+DEFINE_HEXDUMP_ROW(32, 1, ascii)
+DEFINE_HEXDUMP_ROW(64, 0, hex)
+DEFINE_HEXDUMP_ROW(64, 1, ascii)
+
+/**
+ * \fn hexdump_plan_compile(hexdump_plan_t* plan, const hexdump_layout_t* layout)
+ * \brief Builds the row template, byte columns, digit and ASCII tables, and picks the row emitter for a layout
+ *
+ * \param plan Pointer to the plan to fill in
+ * \param layout Pointer to the layout (only read during the call)
+ *
+ * \return 0 if successful. If the row width, group size or flags are not supported, returns a negative value and plan is left unusable.
+ */
+int hexdump_plan_compile(hexdump_plan_t* plan, const hexdump_layout_t* layout) {
+	assert(plan != NULL);
+	assert(layout != NULL);
+
+	const char* digits = (layout->flags & HEXDUMP_LAYOUT_LOWER) ? "0123456789abcdef" : "0123456789ABCDEF";
+	size_t row = layout->row_bytes;
+	size_t group = layout->group_bytes;
+	size_t i;
+	size_t k;
+	size_t column;
+	int ascii = (layout->flags & HEXDUMP_LAYOUT_ASCII) ? 1 : 0;
+
+	plan->emit_row = NULL;
+
+	if (((row != 16) && (row != 32) && (row != 64)) || ((group != 1) && (group != 2) && (group != 4) && (group != 8))
+		|| ((layout->flags & ~(HEXDUMP_LAYOUT_LITTLE_ENDIAN | HEXDUMP_LAYOUT_ASCII | HEXDUMP_LAYOUT_COLLAPSE | HEXDUMP_LAYOUT_OFFSET64 | HEXDUMP_LAYOUT_LOWER)) != 0)) {
+		return EXIT_FAILURE_N;
+	}
+
+	plan->layout = *layout;
+	plan->offset_pairs = (layout->flags & HEXDUMP_LAYOUT_OFFSET64) ? 8 : 4;
+	plan->hex_column = (2 * plan->offset_pairs) + HEXDUMP_GUTTER_CHARS;
+
+	for (i = 0; i < 256; i++) {
+		plan->pairs[i][0] = digits[i >> 4];
+		plan->pairs[i][1] = digits[i & 0xF];
+		plan->ascii[i] = ((i >= 0x20) && (i < 0x7F)) ? (char)i : '.';
+	}
+
+	///< Byte i sits in group i / group; little-endian groups print their bytes last to first
+	for (i = 0; i < row; i++) {
+		k = (layout->flags & HEXDUMP_LAYOUT_LITTLE_ENDIAN) ? (group - 1 - (i % group)) : (i % group);
+		plan->byte_column[i] = (uint16_t)(plan->hex_column + ((i / group) * ((2 * group) + 1)) + (2 * k));
+	}
+
+	///< Everything but the digits is fixed, so it is laid down once here
+	column = plan->hex_column + (row * 2) + (row / group) - 1;
+	memset(plan->template_row, ' ', sizeof(plan->template_row));
+	if (ascii) {
+		memcpy(plan->template_row + column, ASCII_GUTTER_OPEN, ASCII_GUTTER_OPEN_CHARS);
+		plan->ascii_column = column + ASCII_GUTTER_OPEN_CHARS;
+		column = plan->ascii_column + row;
+		plan->template_row[column++] = '|';
+	}
+	else {
+		plan->ascii_column = column;
+	}
+	plan->template_row[column++] = '\n';
+	plan->row_chars = column;
+
+	switch (row) {
+		case 16:
+			plan->emit_row = ascii ? hexdump_row_16_ascii : hexdump_row_16_hex;
+			break;
+		case 32:
+			plan->emit_row = ascii ? hexdump_row_32_ascii : hexdump_row_32_hex;
+			break;
+		default:
+			plan->emit_row = ascii ? hexdump_row_64_ascii : hexdump_row_64_hex;
+			break;
+	}
+
+	return 0;
+}
+
+/**
+ * \fn hexdump_partial_row_len(const hexdump_plan_t* plan, size_t n)
+ * \brief Length of a last row holding n bytes (1 to row_bytes - 1), newline included
+ *
+ * \return The number of characters
+ */
+static size_t hexdump_partial_row_len(const hexdump_plan_t* plan, size_t n) {
+	size_t group = plan->layout.group_bytes;
+	size_t groups = (n + group - 1) / group;
+
+	if (plan->layout.flags & HEXDUMP_LAYOUT_ASCII) {
+		return plan->ascii_column + n + 2;
+	}
+
+	return plan->hex_column + (groups * ((2 * group) + 1));
+}
+
+/**
+ * \fn hexdump_emit_partial(const hexdump_plan_t* plan, char* dst, uint64_t offset, const uint8_t* src, size_t n)
+ * \brief Writes a last row of n bytes. Missing bytes are left as spaces, so the columns (and the ASCII gutter) line up with the rows above
+ *
+ * \return The number of characters written
+ */
+static size_t hexdump_emit_partial(const hexdump_plan_t* plan, char* dst, uint64_t offset, const uint8_t* src, size_t n) {
+	size_t len = hexdump_partial_row_len(plan, n);
+	size_t i;
+
+	memcpy(dst, plan->template_row, len);
+	hexdump_plan_offset(plan, dst, offset);
+	for (i = 0; i < n; i++) {
+		memcpy(dst + plan->byte_column[i], plan->pairs[src[i]], 2);
+	}
+
+	if (plan->layout.flags & HEXDUMP_LAYOUT_ASCII) {
+		for (i = 0; i < n; i++) {
+			dst[plan->ascii_column + i] = plan->ascii[src[i]];
+		}
+		dst[len - 2] = '|';
+	}
+	dst[len - 1] = '\n';
+
+	return len;
+}
+
+/**
+ * \fn hexdump_plan_len(const hexdump_plan_t* plan, size_t nbytes)
+ * \brief Returns the number of characters in the dump of nbytes without collapsing, not including the terminal \0. A collapsed dump is never longer
+ *
+ * \return The number of characters
+ */
+size_t hexdump_plan_len(const hexdump_plan_t* plan, size_t nbytes) {
+	assert((plan != NULL) && (plan->emit_row != NULL));
+
+	size_t tail = nbytes % plan->layout.row_bytes;
+
+	return ((nbytes / plan->layout.row_bytes) * plan->row_chars) + ((tail > 0) ? hexdump_partial_row_len(plan, tail) : 0);
+}
+
+/**
+ * \fn hexdump_cursor_init(hexdump_cursor_t* cursor, uint64_t first_offset)
+ * \brief Starts a dump whose first row is labeled first_offset
+ *
+ * \return None
+ */
+void hexdump_cursor_init(hexdump_cursor_t* cursor, uint64_t first_offset) {
+	assert(cursor != NULL);
+
+	cursor->offset = first_offset;
+	cursor->prev = NULL;
+	cursor->collapsed = 0;
+}
+
+/**
+ * \fn hexdump_layout_emit(const hexdump_plan_t* plan, hexdump_cursor_t* cursor, char* str, size_t size, const uint8_t* src, size_t nbytes, size_t* consumed)
+ * \brief Formats as many rows as fit in str. Call again with src advanced by *consumed (and nbytes reduced by it) until every byte is consumed.
+ * With HEXDUMP_LAYOUT_COLLAPSE the cursor keeps a pointer to the previous row, so src must be one contiguous buffer across the calls.
+ * The last row of the dump is always printed, even when it repeats, so the dump shows where the data ends.
+ *
+ * \param plan Pointer to a compiled plan
+ * \param cursor Pointer to the dump position, set up with hexdump_cursor_init
+ * \param str Pointer to a char array (no terminal \0 is written)
+ * \param size Num of bytes of the char array pointed to by str
+ * \param src Pointer to the next bytes to dump
+ * \param nbytes The number of bytes left in the whole dump
+ * \param consumed Set to the number of bytes of src formatted (or collapsed)
+ *
+ * \return The number of characters written to str
+ */
+size_t hexdump_layout_emit(const hexdump_plan_t* plan, hexdump_cursor_t* cursor, char* str, size_t size, const uint8_t* src, size_t nbytes, size_t* consumed) {
+	assert((plan != NULL) && (plan->emit_row != NULL));
+	assert(cursor != NULL);
+	assert(str != NULL);
+	assert((src != NULL) || (nbytes == 0));
+	assert(consumed != NULL);
+
+	size_t row = plan->layout.row_bytes;
+	size_t used = 0;
+	size_t current_byte = 0;
+	int collapse = (plan->layout.flags & HEXDUMP_LAYOUT_COLLAPSE) ? 1 : 0;
+
+	while (nbytes - used > row) {
+		if (collapse && (cursor->prev != NULL) && (memcmp(cursor->prev, src + used, row) == 0)) {
+			if (!cursor->collapsed) {
+				if (size - current_byte < COLLAPSE_LINE_CHARS) {
+					break;
+				}
+				memcpy(str + current_byte, COLLAPSE_LINE, COLLAPSE_LINE_CHARS);
+				current_byte += COLLAPSE_LINE_CHARS;
+				cursor->collapsed = 1;
+			}
+		}
+		else {
+			if (size - current_byte < plan->row_chars) {
+				break;
+			}
+			plan->emit_row(plan, str + current_byte, cursor->offset, src + used);
+			current_byte += plan->row_chars;
+			cursor->collapsed = 0;
+		}
+
+		cursor->prev = src + used;
+		cursor->offset += row;
+		used += row;
+	}
+
+	///< The last row, full or partial
+	if ((nbytes - used > 0) && (nbytes - used <= row)) {
+		if (nbytes - used == row) {
+			if (size - current_byte >= plan->row_chars) {
+				plan->emit_row(plan, str + current_byte, cursor->offset, src + used);
+				current_byte += plan->row_chars;
+				cursor->offset += row;
+				used = nbytes;
+			}
+		}
+		else if (size - current_byte >= hexdump_partial_row_len(plan, nbytes - used)) {
+			current_byte += hexdump_emit_partial(plan, str + current_byte, cursor->offset, src + used, nbytes - used);
+			cursor->offset += nbytes - used;
+			used = nbytes;
+		}
+	}
+
+	*consumed = used;
+
+	return current_byte;
+}
+
+/**
+ * \fn hexdump_layout(char* str, size_t size, const hexdump_plan_t* plan, const void* loc, size_t nbytes, uint64_t first_offset)
+ * \brief Returns a string holding the dump of nbytes starting at loc in the plan's layout
+ *
+ * \param str Pointer to a char array
+ * \param size Num of bytes of the char array pointed to by str (hexdump_plan_len(plan, nbytes) + 1 always suffices)
+ * \param plan Pointer to a compiled plan
+ * \param loc Starting location of memory to begin dumping bytes from
+ * \param nbytes The number of bytes to read from loc
+ * \param first_offset The offset printed on the first row
+ *
+ * \return str, for daisy-chaining. In the case of an error (i.e. str is not large enough to hold the dump), str will be set to empty.
+ */
+char* hexdump_layout(char* str, size_t size, const hexdump_plan_t* plan, const void* loc, size_t nbytes, uint64_t first_offset) {
+	assert(str != NULL);
+	assert(size > 0);
+
+	hexdump_cursor_t cursor;
+	size_t consumed;
+	size_t current_byte;
+
+	hexdump_cursor_init(&cursor, first_offset);
+	current_byte = hexdump_layout_emit(plan, &cursor, str, size - NULL_TERMINATOR_BYTE, (const uint8_t*)loc, nbytes, &consumed);
+
+	if (consumed != nbytes) {
+		str[0] = '\0';
+		return str;
+	}
+
+	///< Terminate str with NULL
+	str[current_byte] = '\0';
+
+	return str;
+}
+
+/**
+ * \fn test_layout_reference(char* str, const hexdump_layout_t* layout, const uint8_t* src, size_t nbytes, uint64_t first_offset)
+ * \brief Builds the expected dump with sprintf, one byte at a time, straight from the layout description
+ *
+ * \return The number of characters written, not including the terminal \0
+ */
+static size_t test_layout_reference(char* str, const hexdump_layout_t* layout, const uint8_t* src, size_t nbytes, uint64_t first_offset) {
+	const char* byte_format = (layout->flags & HEXDUMP_LAYOUT_LOWER) ? "%02x" : "%02X";
+	size_t row = layout->row_bytes;
+	size_t group = layout->group_bytes;
+	size_t n = 0;
+	size_t start;
+	size_t count;
+	size_t g;
+	size_t k;
+	size_t i;
+	int collapsed = 0;
+
+	for (start = 0; start < nbytes; start += row) {
+		count = (nbytes - start < row) ? (nbytes - start) : row;
+
+		if ((layout->flags & HEXDUMP_LAYOUT_COLLAPSE) && (start > 0) && (nbytes - start > row) && (memcmp(src + start - row, src + start, row) == 0)) {
+			if (!collapsed) {
+				n += (size_t)sprintf(str + n, "*\n");
+				collapsed = 1;
+			}
+			continue;
+		}
+		collapsed = 0;
+
+		if (layout->flags & HEXDUMP_LAYOUT_OFFSET64) {
+			n += (size_t)sprintf(str + n, (layout->flags & HEXDUMP_LAYOUT_LOWER) ? "%016llx  " : "%016llX  ", (unsigned long long)(first_offset + start));
+		}
+		else {
+			n += (size_t)sprintf(str + n, (layout->flags & HEXDUMP_LAYOUT_LOWER) ? "%08x  " : "%08X  ", (unsigned)((first_offset + start) & 0xFFFFFFFF));
+		}
+
+		///< Without the gutter, a partial row stops after its last group; with it, every group is printed (blank where missing)
+		for (g = 0; g < row / group; g++) {
+			if ((g * group >= count) && !(layout->flags & HEXDUMP_LAYOUT_ASCII)) {
+				break;
+			}
+			for (k = 0; k < group; k++) {
+				i = (layout->flags & HEXDUMP_LAYOUT_LITTLE_ENDIAN) ? (g * group + group - 1 - k) : (g * group + k);
+				n += (i < count) ? (size_t)sprintf(str + n, byte_format, src[start + i]) : (size_t)sprintf(str + n, "  ");
+			}
+			str[n++] = ' ';
+		}
+
+		if (layout->flags & HEXDUMP_LAYOUT_ASCII) {
+			n += (size_t)sprintf(str + n, " |");
+			for (i = 0; i < count; i++) {
+				str[n++] = ((src[start + i] >= 0x20) && (src[start + i] < 0x7F)) ? (char)src[start + i] : '.';
+			}
+			str[n++] = '|';
+			str[n++] = '\n';
+		}
+		else {
+			str[n - 1] = '\n';
+		}
+	}
+	str[n] = '\0';
+
+	return n;
+}
+
+int test_layout(void) {
+	static const uint8_t rows[] = { 16, 32, 64 };
+	static const uint8_t groups[] = { 1, 2, 4, 8 };
+	hexdump_layout_t layout;
+	hexdump_plan_t plan;
+	hexdump_cursor_t cursor;
+	uint32_t state = TEST_21_SEED;
+	uint32_t flags;
+	size_t r;
+	size_t g;
+	size_t k;
+	size_t nbytes;
+	size_t chars;
+	size_t written;
+	size_t fed;
+	size_t consumed;
+	size_t chunk;
+	size_t dense_chars;
+	uint8_t* sparse;
+	char* sparse_dump;
+	int return_code = EXIT_TEST_SUCCESS;
+
+	for (k = 0; k < TEST_21_MAX_BYTES; k++) {
+		///< Runs of repeated rows for the collapse flag, then random bytes
+		TEST_21_DATA[k] = (k < 160) ? (uint8_t)(k % 16) : (uint8_t)test_rand32(&state);
+	}
+
+	///< The default layout must print exactly what hexdump does
+	layout.row_bytes = 16;
+	layout.group_bytes = 1;
+	layout.flags = 0;
+	hexdump_plan_compile(&plan, &layout);
+	for (nbytes = 0; nbytes <= TEST_21_MAX_BYTES; nbytes += 13) {
+		hexdump(TEST_21_EXPECTED, sizeof(TEST_21_EXPECTED), TEST_21_DATA, nbytes);
+		hexdump_layout(TEST_21_RESULT, sizeof(TEST_21_RESULT), &plan, TEST_21_DATA, nbytes, 0);
+		if (strcmp(TEST_21_RESULT, TEST_21_EXPECTED) != 0) {
+			printf("test_layout: (FAILURE): default layout differs from hexdump for %zu bytes\n", nbytes);
+			return_code = EXIT_TEST_FAILURE;
+		}
+	}
+
+	///< Every row width, group size and flag combination, whole and fed in random pieces
+	for (r = 0; r < sizeof(rows); r++) {
+		for (g = 0; g < sizeof(groups); g++) {
+			for (flags = 0; flags <= 0x1F; flags++) {
+				layout.row_bytes = rows[r];
+				layout.group_bytes = groups[g];
+				layout.flags = flags;
+				if (hexdump_plan_compile(&plan, &layout) != 0) {
+					printf("test_layout: (FAILURE): layout %u/%u/0x%X rejected\n", rows[r], groups[g], flags);
+					return_code = EXIT_TEST_FAILURE;
+					continue;
+				}
+
+				nbytes = test_rand32(&state) % (TEST_21_MAX_BYTES + 1);
+				chars = test_layout_reference(TEST_21_EXPECTED, &layout, TEST_21_DATA, nbytes, 0xFFFFFFF0ull);
+				hexdump_layout(TEST_21_RESULT, sizeof(TEST_21_RESULT), &plan, TEST_21_DATA, nbytes, 0xFFFFFFF0ull);
+				if ((strcmp(TEST_21_RESULT, TEST_21_EXPECTED) != 0) || (chars > hexdump_plan_len(&plan, nbytes))) {
+					printf("test_layout: (FAILURE): layout %u/%u/0x%X, %zu bytes\nEXPECT:\n%sRESULT:\n%s", rows[r], groups[g], flags, nbytes, TEST_21_EXPECTED, TEST_21_RESULT);
+					return_code = EXIT_TEST_FAILURE;
+				}
+
+				///< Output space for one row at a time, so every call stops mid-dump
+				hexdump_cursor_init(&cursor, 0xFFFFFFF0ull);
+				written = 0;
+				for (fed = 0; fed < nbytes; fed += consumed) {
+					chunk = plan.row_chars + (test_rand32(&state) % 4);
+					written += hexdump_layout_emit(&plan, &cursor, TEST_21_RESULT + written, chunk, TEST_21_DATA + fed, nbytes - fed, &consumed);
+					if ((consumed == 0) && (chunk >= plan.row_chars)) {
+						break;
+					}
+				}
+				TEST_21_RESULT[written] = '\0';
+				if (strcmp(TEST_21_RESULT, TEST_21_EXPECTED) != 0) {
+					printf("test_layout: (FAILURE): layout %u/%u/0x%X, %zu bytes emitted a row at a time\n", rows[r], groups[g], flags, nbytes);
+					return_code = EXIT_TEST_FAILURE;
+				}
+			}
+		}
+	}
+
+	///< A known answer: 32-byte rows of little-endian 4-byte words with the gutter
+	layout.row_bytes = 32;
+	layout.group_bytes = 4;
+	layout.flags = HEXDUMP_LAYOUT_LITTLE_ENDIAN | HEXDUMP_LAYOUT_ASCII;
+	hexdump_plan_compile(&plan, &layout);
+	hexdump_layout(TEST_21_RESULT, sizeof(TEST_21_RESULT), &plan, "Logical-Bit-Operations", 22, 0);
+	if (strcmp(TEST_21_RESULT, "00000000  69676F4C 2D6C6163 2D746942 7265704F 6F697461     736E                    |Logical-Bit-Operations|\n") != 0) {
+		printf("test_layout: (FAILURE): known answer, RESULT = %s", TEST_21_RESULT);
+		return_code = EXIT_TEST_FAILURE;
+	}
+
+	///< A sparse region: one non-zero byte per 4 KiB page
+	sparse = calloc(TEST_21_SPARSE_BYTES, 1);
+	layout.row_bytes = 64;
+	layout.group_bytes = 8;
+	layout.flags = HEXDUMP_LAYOUT_COLLAPSE | HEXDUMP_LAYOUT_OFFSET64;
+	hexdump_plan_compile(&plan, &layout);
+	dense_chars = hexdump_plan_len(&plan, TEST_21_SPARSE_BYTES);
+	sparse_dump = malloc(dense_chars + NULL_TERMINATOR_BYTE);
+	if ((sparse == NULL) || (sparse_dump == NULL)) {
+		return_code = EXIT_TEST_FAILURE;
+	}
+	else {
+		for (k = 0; k < TEST_21_SPARSE_BYTES; k += 4096) {
+			sparse[k + 100] = 0xA5;
+		}
+		hexdump_layout(sparse_dump, dense_chars + NULL_TERMINATOR_BYTE, &plan, sparse, TEST_21_SPARSE_BYTES, 0x7FFF00000000ull);
+		chars = strlen(sparse_dump);
+		if ((chars == 0) || (strncmp(sparse_dump, "00007FFF00000000  ", 18) != 0) || (chars * 4 > dense_chars)) {
+			printf("test_layout: (FAILURE): sparse collapse gave %zu of %zu characters\n", chars, dense_chars);
+			return_code = EXIT_TEST_FAILURE;
+		}
+		else {
+			printf("test_layout: sparse %u-byte region collapses from %zu to %zu characters\n", TEST_21_SPARSE_BYTES, dense_chars, chars);
+		}
+	}
+	free(sparse);
+	free(sparse_dump);
+
+	printf("test_layout: %zu layouts checked against the reference\n", sizeof(rows) * sizeof(groups) * 32);
+
+	return return_code;
+}
@@ -1,7 +1,16 @@
 #include <assert.h>
+#include <limits.h>
+#include <pthread.h>
 #include <stdio.h>
 #include <stdlib.h>
+#include <string.h>
 #include "bitops.h"
+#include "bitstats.h"
+
+#if defined(__x86_64__) || defined(__i386__)
+#define BITOPS_X86 (1)
+#include <immintrin.h>
+#endif
 
 #define EXIT_BIT_FAILURE (0xFFFFFFFF)
 #define EXIT_FAILURE_N (-1)
@@ -14,6 +23,95 @@
 #define PREFIX_BYTES_HEX (2)
 #define UINT32_T_BITS (32)
 
+#define HEXDUMP_OFFSET_CHARS (8)
+#define HEXDUMP_GUTTER_CHARS (2)
+#define HEX_PAIR_STRIDE (3)
+#define HEXDUMP_PARALLEL_MAX_THREADS (64)
+#define HEXDUMP_PARALLEL_MIN_ROWS (4096)
+#define HEXDUMP_ROW_LEN(n) (HEXDUMP_OFFSET_CHARS + HEXDUMP_GUTTER_CHARS + ((n) * HEX_PAIR_STRIDE))
+
+///< Each entry holds the two hex digits of its index, a space, and a spare byte so rows can be built with 4-byte stores
+#define HEX_DIGIT(n, a) ((char)(((n) < 10) ? ('0' + (n)) : ((a) + (n) - 10)))
+#define HEX_PAIR_ENTRY(b, a) { HEX_DIGIT((b) >> 4, a), HEX_DIGIT((b) & 0xF, a), ' ', ' ' }
+#define HEX_PAIR_ROW(hi, a) \
+	HEX_PAIR_ENTRY((hi) + 0x0, a), HEX_PAIR_ENTRY((hi) + 0x1, a), HEX_PAIR_ENTRY((hi) + 0x2, a), HEX_PAIR_ENTRY((hi) + 0x3, a), \
+	HEX_PAIR_ENTRY((hi) + 0x4, a), HEX_PAIR_ENTRY((hi) + 0x5, a), HEX_PAIR_ENTRY((hi) + 0x6, a), HEX_PAIR_ENTRY((hi) + 0x7, a), \
+	HEX_PAIR_ENTRY((hi) + 0x8, a), HEX_PAIR_ENTRY((hi) + 0x9, a), HEX_PAIR_ENTRY((hi) + 0xA, a), HEX_PAIR_ENTRY((hi) + 0xB, a), \
+	HEX_PAIR_ENTRY((hi) + 0xC, a), HEX_PAIR_ENTRY((hi) + 0xD, a), HEX_PAIR_ENTRY((hi) + 0xE, a), HEX_PAIR_ENTRY((hi) + 0xF, a)
+#define HEX_PAIR_TABLE(a) { \
+	HEX_PAIR_ROW(0x00, a), HEX_PAIR_ROW(0x10, a), HEX_PAIR_ROW(0x20, a), HEX_PAIR_ROW(0x30, a), \
+	HEX_PAIR_ROW(0x40, a), HEX_PAIR_ROW(0x50, a), HEX_PAIR_ROW(0x60, a), HEX_PAIR_ROW(0x70, a), \
+	HEX_PAIR_ROW(0x80, a), HEX_PAIR_ROW(0x90, a), HEX_PAIR_ROW(0xA0, a), HEX_PAIR_ROW(0xB0, a), \
+	HEX_PAIR_ROW(0xC0, a), HEX_PAIR_ROW(0xD0, a), HEX_PAIR_ROW(0xE0, a), HEX_PAIR_ROW(0xF0, a) }
+
+///< Indexed by (flags & HEXSTR_LOWER)
+static const char hex_nibble_table[2][16] = {
+	{ '0', '1', '2', '3', '4', '5', '6', '7', '8', '9', 'A', 'B', 'C', 'D', 'E', 'F' },
+	{ '0', '1', '2', '3', '4', '5', '6', '7', '8', '9', 'a', 'b', 'c', 'd', 'e', 'f' }
+};
+
+static const char hex_pair_table[2][256][4] = {
+	HEX_PAIR_TABLE('A'),
+	HEX_PAIR_TABLE('a')
+};
+
+///< Each entry holds the 8 binary digits of its index, most significant first, so a byte is formatted with one 8-byte copy
+#define BIN_BYTE_ENTRY(b) { \
+	(char)('0' + (((b) >> 7) & 1)), (char)('0' + (((b) >> 6) & 1)), (char)('0' + (((b) >> 5) & 1)), (char)('0' + (((b) >> 4) & 1)), \
+	(char)('0' + (((b) >> 3) & 1)), (char)('0' + (((b) >> 2) & 1)), (char)('0' + (((b) >> 1) & 1)), (char)('0' + ((b) & 1)) }
+#define BIN_BYTE_ROW(hi) \
+	BIN_BYTE_ENTRY((hi) + 0x0), BIN_BYTE_ENTRY((hi) + 0x1), BIN_BYTE_ENTRY((hi) + 0x2), BIN_BYTE_ENTRY((hi) + 0x3), \
+	BIN_BYTE_ENTRY((hi) + 0x4), BIN_BYTE_ENTRY((hi) + 0x5), BIN_BYTE_ENTRY((hi) + 0x6), BIN_BYTE_ENTRY((hi) + 0x7), \
+	BIN_BYTE_ENTRY((hi) + 0x8), BIN_BYTE_ENTRY((hi) + 0x9), BIN_BYTE_ENTRY((hi) + 0xA), BIN_BYTE_ENTRY((hi) + 0xB), \
+	BIN_BYTE_ENTRY((hi) + 0xC), BIN_BYTE_ENTRY((hi) + 0xD), BIN_BYTE_ENTRY((hi) + 0xE), BIN_BYTE_ENTRY((hi) + 0xF)
+
+static const char bin_byte_table[256][8] = {
+	BIN_BYTE_ROW(0x00), BIN_BYTE_ROW(0x10), BIN_BYTE_ROW(0x20), BIN_BYTE_ROW(0x30),
+	BIN_BYTE_ROW(0x40), BIN_BYTE_ROW(0x50), BIN_BYTE_ROW(0x60), BIN_BYTE_ROW(0x70),
+	BIN_BYTE_ROW(0x80), BIN_BYTE_ROW(0x90), BIN_BYTE_ROW(0xA0), BIN_BYTE_ROW(0xB0),
+	BIN_BYTE_ROW(0xC0), BIN_BYTE_ROW(0xD0), BIN_BYTE_ROW(0xE0), BIN_BYTE_ROW(0xF0)
+};
+
+/**
+ * \fn reorder_bits(uint32_t num, uint8_t nbits, uint32_t reversed, uint32_t big_endian)
+ * \brief Applies the REVERSED and BIG_ENDIAN formatter flags to the low nbits bits of num, the byte swap first
+ *
+ * \return The transformed nbits-wide value, with the bits above nbits clear
+ */
+static inline uint32_t reorder_bits(uint32_t num, uint8_t nbits, uint32_t reversed, uint32_t big_endian) {
+	int shift = UINT32_T_BITS - nbits;
+
+	num &= 0xFFFFFFFFu >> shift;
+	if (big_endian) {
+		num = swap_bytes32(num) >> shift;
+	}
+	if (reversed) {
+		num = reverse_bits32(num) >> shift;
+	}
+
+	return num;
+}
+
+///< Kernels for the chosen ISA tier, filled by bitops_dispatch_fill and read through bitops_table
+typedef struct {
+	bitops_isa_t isa;
+	uint32_t features;
+	int (*uint_to_binstr_many)(const uint32_t* in, size_t n, char* out, size_t out_size, uint8_t nbits);
+	void (*uint_to_hexstr_many)(const uint32_t* in, size_t n, char* out, size_t out_size, uint8_t nbits, uint32_t flags);
+	void (*twiggle_many)(uint32_t* data, size_t n, uint32_t mask, uint32_t keep, uint32_t flip);
+	void (*twiggle_each)(uint32_t* data, size_t n, const int* bits, uint32_t keep, uint32_t flip);
+	uint32_t (*extract_bits)(uint32_t input, int start_bit, int width);
+	uint32_t (*deposit_bits)(uint32_t input, uint32_t value, int start_bit, int width);
+	void (*extract_fields)(uint32_t input, const bitfield_t* fields, size_t nfields, uint32_t* out);
+	uint32_t (*deposit_fields)(uint32_t input, const bitfield_t* fields, size_t nfields, const uint32_t* values);
+	void (*reverse_many)(uint32_t* data, size_t n);
+	void (*swap_many)(uint32_t* data, size_t n);
+	uint32_t (*permute_bits)(uint32_t input, const bitperm_t* perm);
+	void (*permute_many)(uint32_t* data, size_t n, const bitperm_t* perm);
+} bitops_dispatch_t;
+
+static const bitops_dispatch_t* bitops_table(void);
+
 #define TEST_1A_DEC (18u)
 #define TEST_1A_BITS (8u)
 #define TEST_1A_RETURN (10)
@@ -65,10 +163,14 @@ char TEST_3C_EXPECTED[PREFIX_BYTES_HEX + UINT32_T_BITS + NULL_TERMINATOR_BYTE] =
 #define TEST_4C_DEC (29495u)
 #define TEST_4C_BIT (5)
 #define TEST_4C_OP (TOGGLE)
+#define TEST_4D_DEC (29495u)
+#define TEST_4D_BIT (4)
+#define TEST_4D_OP (CLEAR)
 
 uint32_t TEST_4A_EXPECTED = 1u;
 uint32_t TEST_4B_EXPECTED = 8u;
 uint32_t TEST_4C_EXPECTED = 29463u;
+uint32_t TEST_4D_EXPECTED = 29479u;
 
 #define TEST_5A_DEC (29495u)
 #define TEST_5A_SBIT (6)
@@ -78,22 +180,386 @@ uint32_t TEST_4C_EXPECTED = 29463u;
 uint32_t TEST_5A_EXPECTED = 4u;
 uint32_t TEST_5B_EXPECTED = 6u;
 
+#define TEST_6A_NBYTES (100u)
+#define TEST_6B_NBYTES (1000u)
+#define TEST_6B_CHUNK (7u)
+#define TEST_6B_WINDOW (64u)
+#define TEST_6C_NBYTES (20u)
+#define TEST_6C_SIZE (16u)
+#define TEST_6_DATA_BYTES (1024u)
+#define TEST_6_EXPECTED_BYTES (4096u)
+
+uint8_t TEST_6_DATA[TEST_6_DATA_BYTES];
+
+#define TEST_7_SEED (5813u)
+#define TEST_7_VALUES (257u)
+#define TEST_7_ROUNDS (64u)
+#define TEST_7_OUT_BYTES (TEST_7_VALUES * (PREFIX_BYTES_BIN + UINT32_T_BITS + NULL_TERMINATOR_BYTE))
+
+uint32_t TEST_7_INPUT[TEST_7_VALUES];
+char TEST_7_SCALAR[TEST_7_OUT_BYTES];
+char TEST_7_RESULT[TEST_7_OUT_BYTES];
+
+#define TEST_8_SEED (2022u)
+#define TEST_8_VALUES (131u)
+#define TEST_8_ROUNDS (64u)
+#define TEST_8_OUT_BYTES (TEST_8_VALUES * (PREFIX_BYTES_HEX + (UINT32_T_BITS / BITS_PER_NIBBLE) + NULL_TERMINATOR_BYTE))
+
+uint32_t TEST_8_INPUT[TEST_8_VALUES];
+char TEST_8_SCALAR[TEST_8_OUT_BYTES];
+char TEST_8_RESULT[TEST_8_OUT_BYTES];
+
+#define TEST_9_SEED (4096u)
+#define TEST_9_WORDS (1027u)
+#define TEST_9_ROUNDS (16u)
+
+uint32_t TEST_9_INPUT[TEST_9_WORDS];
+uint32_t TEST_9_EXPECTED[TEST_9_WORDS];
+uint32_t TEST_9_RESULT[TEST_9_WORDS];
+int TEST_9_BITS[TEST_9_WORDS];
+
+#define TEST_10_SEED (1234u)
+#define TEST_10_ROUNDS (256u)
+
+bitfield_t TEST_10_FIELDS[] = { { 0, 3 }, { 3, 5 }, { 8, 13 }, { 21, 11 }, { 0, 32 } };
+#define TEST_10_NFIELDS (sizeof(TEST_10_FIELDS) / sizeof(TEST_10_FIELDS[0]))
+
+#define TEST_11_SEED (8086u)
+#define TEST_11_ROUNDS (4096u)
+
+#define TEST_12_NBYTES (1048576u + 7u)
+#define TEST_12_MAX_THREADS (8)
+#define TEST_12_WIDE_NBYTES (((HEXDUMP_PARALLEL_MAX_THREADS + 1u) * HEXDUMP_PARALLEL_MIN_ROWS * HEXDUMP_BYTES_PER_ROW) + 7u)	///< More rows than HEXDUMP_PARALLEL_MAX_THREADS chunks of HEXDUMP_PARALLEL_MIN_ROWS
+
+#define TEST_13_SEED (1999u)
+#define TEST_13_VALUES (97u)
+#define TEST_13_OUT_BYTES (TEST_13_VALUES * (PREFIX_BYTES_BIN + UINT32_T_BITS + NULL_TERMINATOR_BYTE))
+
+int8_t TEST_13_INPUT8[TEST_13_VALUES];
+int16_t TEST_13_INPUT16[TEST_13_VALUES];
+int32_t TEST_13_INPUT32[TEST_13_VALUES];
+char TEST_13_RESULT[TEST_13_OUT_BYTES];
+char TEST_6_EXPECTED[TEST_6_EXPECTED_BYTES];
+
+#define TEST_19_SEED (60606u)
+#define TEST_19_VALUES (1003u)
+#define TEST_19_BIN_BYTES (TEST_19_VALUES * (PREFIX_BYTES_BIN + UINT32_T_BITS + NULL_TERMINATOR_BYTE))
+#define TEST_19_HEX_BYTES (TEST_19_VALUES * (PREFIX_BYTES_HEX + (UINT32_T_BITS / BITS_PER_NIBBLE) + NULL_TERMINATOR_BYTE))
+
+uint32_t TEST_19_INPUT[TEST_19_VALUES];
+uint32_t TEST_19_WORDS[TEST_19_VALUES];
+uint32_t TEST_19_WORDS_SCALAR[TEST_19_VALUES];
+int TEST_19_BITS[TEST_19_VALUES];
+char TEST_19_SCALAR[TEST_19_BIN_BYTES];
+char TEST_19_RESULT[TEST_19_BIN_BYTES];
+char TEST_19_HEX_SCALAR[TEST_19_HEX_BYTES];
+char TEST_19_HEX_RESULT[TEST_19_HEX_BYTES];
+
+#define TEST_25_SEED (2525u)
+#define TEST_25_VALUES (1001u)
+#define TEST_25_TABLES (8)
+#define TEST_25_HEX_BYTES (TEST_25_VALUES * (PREFIX_BYTES_HEX + (UINT32_T_BITS / BITS_PER_NIBBLE) + NULL_TERMINATOR_BYTE))
+#define TEST_25_BIN_BYTES (TEST_25_VALUES * (PREFIX_BYTES_BIN + UINT32_T_BITS + NULL_TERMINATOR_BYTE))
+
+uint32_t TEST_25_INPUT[TEST_25_VALUES];
+uint32_t TEST_25_RESULT[TEST_25_VALUES];
+char TEST_25_HEX[TEST_25_HEX_BYTES];
+char TEST_25_BIN[TEST_25_BIN_BYTES];
+
+#define TEST_26_SEED (65536u)
+#define TEST_26_VALUES (4099u)
+#define TEST_26_ROUNDS (30000u)
+#define TEST_26_THREADS (8)
+
+uint32_t TEST_26_INPUT[TEST_26_VALUES];
+char TEST_26_BIN[TEST_26_VALUES][PREFIX_BYTES_BIN + UINT32_T_BITS + NULL_TERMINATOR_BYTE];
+char TEST_26_HEX[TEST_26_VALUES][PREFIX_BYTES_HEX + (UINT32_T_BITS / BITS_PER_NIBBLE) + NULL_TERMINATOR_BYTE];
+pthread_barrier_t TEST_26_BARRIER;
+
+#ifndef BITOPS_NO_CACHE
+#define BITOPS_CACHE_PENDING (0x80000000u)	///< bitops_cache_ready value while a requested table is still to be built
+
+static char bitops_cache_bin8[256][BITOPS_CACHE_BIN8_STRIDE];
+static char bitops_cache_hex8[2][256][BITOPS_CACHE_HEX8_STRIDE];	///< Indexed by (flags & HEXSTR_LOWER)
+static char* bitops_cache_bin16;		///< 65536 entries of BITOPS_CACHE_BIN16_STRIDE bytes
+static char* bitops_cache_hex16[2];		///< 65536 entries of BITOPS_CACHE_HEX16_STRIDE bytes, indexed by (flags & HEXSTR_LOWER)
+static uint32_t bitops_cache_requested = BITOPS_CACHE_OFF;	///< Tables the formatters should use, set by bitops_set_cache
+static uint32_t bitops_cache_built = BITOPS_CACHE_OFF;		///< Tables filled in so far, each bit set with release order once its table is complete
+static uint32_t bitops_cache_ready = BITOPS_CACHE_OFF;		///< The one word the formatters test: requested tables that are built, or BITOPS_CACHE_PENDING
+static pthread_once_t bitops_cache8_once = PTHREAD_ONCE_INIT;
+static pthread_once_t bitops_cache16_once = PTHREAD_ONCE_INIT;
+
 /**
- * \fn uint_to_binstr(char* str, size_t size, uint32_t num, uint8_t nbits)
- * \brief Stores binary representation of a 32-bit unsigned int into a null-terminated string
- * 
- * \param str Pointer to a char array
- * \param size Num of bytes of the char array pointed to by str
- * \param num The value to be converted
- * \param nbits The number of bits in the input
- * 
- * \return If successful, returns the number of characters written to str, not including the terminal \0. In the case of an error, the function returns a negative value, and str is set to the empty string.
+ * \fn bitops_cache_build8(void)
+ * \brief Fills the 8-bit tables from the computed formatters. Runs exactly once, under pthread_once
+ *
+ * \return None
  */
-int uint_to_binstr(char* str, size_t size, uint32_t num, uint8_t nbits) {
+static void bitops_cache_build8(void) {
+	uint32_t v;
+	int lower;
+	char* entry;
+
+	for (v = 0; v < 256; v++) {
+		uint_to_binstr8(bitops_cache_bin8[v], BITOPS_CACHE_BIN8_STRIDE, v);
+		for (lower = 0; lower < 2; lower++) {
+			entry = bitops_cache_hex8[lower][v];
+			entry[0] = '0';
+			entry[1] = 'x';
+			memcpy(entry + PREFIX_BYTES_HEX, hex_pair_table[lower][v], 2);
+			entry[PREFIX_BYTES_HEX + 2] = '\0';
+		}
+	}
+
+	__atomic_or_fetch(&bitops_cache_built, BITOPS_CACHE_8, __ATOMIC_RELEASE);
+}
+
+/**
+ * \fn bitops_cache_build16(void)
+ * \brief Allocates and fills the 16-bit tables as one block. Runs exactly once, under pthread_once; if the allocation fails the tables stay unbuilt
+ *
+ * \return None
+ */
+static void bitops_cache_build16(void) {
+	char* block = malloc(BITOPS_CACHE_16_BYTES);
+	char* entry;
+	uint32_t v;
+	int lower;
+
+	if (block == NULL) {
+		return;
+	}
+
+	bitops_cache_bin16 = block;
+	bitops_cache_hex16[0] = block + (65536 * BITOPS_CACHE_BIN16_STRIDE);
+	bitops_cache_hex16[1] = bitops_cache_hex16[0] + (65536 * BITOPS_CACHE_HEX16_STRIDE);
+
+	for (v = 0; v < 65536; v++) {
+		uint_to_binstr16(bitops_cache_bin16 + (v * BITOPS_CACHE_BIN16_STRIDE), BITOPS_CACHE_BIN16_STRIDE, v);
+		for (lower = 0; lower < 2; lower++) {
+			entry = bitops_cache_hex16[lower] + (v * BITOPS_CACHE_HEX16_STRIDE);
+			entry[0] = '0';
+			entry[1] = 'x';
+			memcpy(entry + PREFIX_BYTES_HEX, hex_pair_table[lower][v >> 8], 2);
+			memcpy(entry + PREFIX_BYTES_HEX + 2, hex_pair_table[lower][v & 0xFF], 2);
+			entry[PREFIX_BYTES_HEX + 4] = '\0';
+		}
+	}
+
+	__atomic_or_fetch(&bitops_cache_built, BITOPS_CACHE_16, __ATOMIC_RELEASE);
+}
+
+/**
+ * \fn bitops_cache_build(void)
+ * \brief Builds whichever requested tables are missing and publishes them in bitops_cache_ready. Any thread may get here; pthread_once makes the others wait for the one building
+ *
+ * \return BITOPS_CACHE_* bits of the tables ready to use
+ */
+static uint32_t bitops_cache_build(void) {
+	uint32_t pending = BITOPS_CACHE_PENDING;
+	uint32_t requested = __atomic_load_n(&bitops_cache_requested, __ATOMIC_RELAXED);
+	uint32_t built;
+
+	if (requested != BITOPS_CACHE_OFF) {
+		pthread_once(&bitops_cache8_once, bitops_cache_build8);
+	}
+	if (requested & BITOPS_CACHE_16) {
+		pthread_once(&bitops_cache16_once, bitops_cache_build16);
+	}
+
+	built = __atomic_load_n(&bitops_cache_built, __ATOMIC_ACQUIRE);
+
+	///< A 16-bit table that could not be allocated is not asked for again, and the 8-bit tables carry on alone
+	if ((requested & ~built) != 0) {
+		__atomic_and_fetch(&bitops_cache_requested, built, __ATOMIC_RELAXED);
+	}
+
+	///< Only replaces PENDING: if bitops_set_cache turned the tables off meanwhile, that choice stands
+	__atomic_compare_exchange_n(&bitops_cache_ready, &pending, requested & built, 0, __ATOMIC_RELEASE, __ATOMIC_RELAXED);
+
+	return requested & built;
+}
+
+/**
+ * \fn bitops_cache_tables(void)
+ * \brief Reports which tables the formatters may read, building any requested table on first use
+ *
+ * \return BITOPS_CACHE_* bits of the tables ready to use, BITOPS_CACHE_OFF when the cache is not in use
+ */
+static inline uint32_t bitops_cache_tables(void) {
+	uint32_t ready = __atomic_load_n(&bitops_cache_ready, __ATOMIC_ACQUIRE);
+
+	if (__builtin_expect((ready & BITOPS_CACHE_PENDING) != 0, 0)) {
+		ready = bitops_cache_build();
+	}
+
+	return ready;
+}
+
+/**
+ * \fn cache_binstr(char* str, uint32_t num, uint8_t nbits, uint32_t tables)
+ * \brief Copies the binary string of an 8-, 16- or 32-bit value out of the tables: one fixed-size copy per cached chunk, the first taking the "0b" and the last the \0
+ *
+ * \return The number of characters written to str, not including the terminal \0
+ */
+static inline int cache_binstr(char* str, uint32_t num, uint8_t nbits, uint32_t tables) {
+	const char* bin16 = bitops_cache_bin16;
+
+	switch (nbits) {
+		case 8:
+			memcpy(str, bitops_cache_bin8[num], PREFIX_BYTES_BIN + 8 + NULL_TERMINATOR_BYTE);
+			break;
+		case 16:
+			if (tables & BITOPS_CACHE_16) {
+				memcpy(str, bin16 + (num * BITOPS_CACHE_BIN16_STRIDE), PREFIX_BYTES_BIN + 16 + NULL_TERMINATOR_BYTE);
+			}
+			else {
+				memcpy(str, bitops_cache_bin8[num >> 8], PREFIX_BYTES_BIN + 8);
+				memcpy(str + PREFIX_BYTES_BIN + 8, bitops_cache_bin8[num & 0xFF] + PREFIX_BYTES_BIN, 8 + NULL_TERMINATOR_BYTE);
+			}
+			break;
+		default:
+			if (tables & BITOPS_CACHE_16) {
+				memcpy(str, bin16 + ((num >> 16) * BITOPS_CACHE_BIN16_STRIDE), PREFIX_BYTES_BIN + 16);
+				memcpy(str + PREFIX_BYTES_BIN + 16, bin16 + ((num & 0xFFFF) * BITOPS_CACHE_BIN16_STRIDE) + PREFIX_BYTES_BIN, 16 + NULL_TERMINATOR_BYTE);
+			}
+			else {
+				memcpy(str, bitops_cache_bin8[num >> 24], PREFIX_BYTES_BIN + 8);
+				memcpy(str + PREFIX_BYTES_BIN + 8, bitops_cache_bin8[(num >> 16) & 0xFF] + PREFIX_BYTES_BIN, 8);
+				memcpy(str + PREFIX_BYTES_BIN + 16, bitops_cache_bin8[(num >> 8) & 0xFF] + PREFIX_BYTES_BIN, 8);
+				memcpy(str + PREFIX_BYTES_BIN + 24, bitops_cache_bin8[num & 0xFF] + PREFIX_BYTES_BIN, 8 + NULL_TERMINATOR_BYTE);
+			}
+			break;
+	}
+
+	return PREFIX_BYTES_BIN + nbits;
+}
+
+/**
+ * \fn cache_hexstr(char* str, uint32_t num, uint8_t nbits, uint32_t flags, uint32_t tables)
+ * \brief Copies the hex string of an 8-, 16- or 32-bit value out of the tables, the way cache_binstr does. HEXSTR_NO_PREFIX starts the first copy past the "0x"
+ *
+ * \return The number of characters written to str, not including the terminal \0
+ */
+static inline int cache_hexstr(char* str, uint32_t num, uint8_t nbits, uint32_t flags, uint32_t tables) {
+	const char (*hex8)[BITOPS_CACHE_HEX8_STRIDE] = bitops_cache_hex8[flags & HEXSTR_LOWER];
+	const char* hex16 = bitops_cache_hex16[flags & HEXSTR_LOWER];
+	size_t skip = (flags & HEXSTR_NO_PREFIX) ? PREFIX_BYTES_HEX : 0;
+
+	switch (nbits) {
+		case 8:
+			memcpy(str, hex8[num] + skip, PREFIX_BYTES_HEX + 2 + NULL_TERMINATOR_BYTE - skip);
+			break;
+		case 16:
+			if (tables & BITOPS_CACHE_16) {
+				memcpy(str, hex16 + (num * BITOPS_CACHE_HEX16_STRIDE) + skip, PREFIX_BYTES_HEX + 4 + NULL_TERMINATOR_BYTE - skip);
+			}
+			else {
+				memcpy(str, hex8[num >> 8] + skip, PREFIX_BYTES_HEX + 2 - skip);
+				memcpy(str + PREFIX_BYTES_HEX + 2 - skip, hex8[num & 0xFF] + PREFIX_BYTES_HEX, 2 + NULL_TERMINATOR_BYTE);
+			}
+			break;
+		default:
+			if (tables & BITOPS_CACHE_16) {
+				memcpy(str, hex16 + ((num >> 16) * BITOPS_CACHE_HEX16_STRIDE) + skip, PREFIX_BYTES_HEX + 4 - skip);
+				memcpy(str + PREFIX_BYTES_HEX + 4 - skip, hex16 + ((num & 0xFFFF) * BITOPS_CACHE_HEX16_STRIDE) + PREFIX_BYTES_HEX, 4 + NULL_TERMINATOR_BYTE);
+			}
+			else {
+				memcpy(str, hex8[num >> 24] + skip, PREFIX_BYTES_HEX + 2 - skip);
+				memcpy(str + PREFIX_BYTES_HEX + 2 - skip, hex8[(num >> 16) & 0xFF] + PREFIX_BYTES_HEX, 2);
+				memcpy(str + PREFIX_BYTES_HEX + 4 - skip, hex8[(num >> 8) & 0xFF] + PREFIX_BYTES_HEX, 2);
+				memcpy(str + PREFIX_BYTES_HEX + 6 - skip, hex8[num & 0xFF] + PREFIX_BYTES_HEX, 2 + NULL_TERMINATOR_BYTE);
+			}
+			break;
+	}
+
+	return (int)(PREFIX_BYTES_HEX + (nbits / BITS_PER_NIBBLE) - skip);
+}
+
+/**
+ * \fn binstr_cached(char* str, uint32_t num, uint8_t nbits)
+ * \brief Table path of uint_to_binstr and int_to_binstr for 8, 16 and 32 bits, kept out of line so the computed path stays one load and branch longer
+ *
+ * \return Same as uint_to_binstr
+ */
+static __attribute__((noinline)) int binstr_cached(char* str, uint32_t num, uint8_t nbits) {
+	uint32_t tables = bitops_cache_tables();
+	int i;
+
+	if (num > (0xFFFFFFFF >> (UINT32_T_BITS - nbits))) {
+		str[0] = '\0';
+		return EXIT_FAILURE_N;
+	}
+
+	///< Turned off since the caller looked
+	if (tables == BITOPS_CACHE_OFF) {
+		str[0] = '0';
+		str[1] = 'b';
+		for (i = 0; i < nbits; i += 8) {
+			memcpy(str + PREFIX_BYTES_BIN + i, bin_byte_table[(num >> (nbits - 8 - i)) & 0xFF], 8);
+		}
+		str[PREFIX_BYTES_BIN + nbits] = '\0';
+		return PREFIX_BYTES_BIN + nbits;
+	}
+
+	return cache_binstr(str, num, nbits, tables);
+}
+
+/**
+ * \fn hexstr_cached(char* str, uint32_t num, uint8_t nbits, uint32_t flags)
+ * \brief Table path of uint_to_hexstr and uint_to_hexstr_fmt for 8, 16 and 32 bits, kept out of line like binstr_cached
+ *
+ * \return Same as uint_to_hexstr_fmt
+ */
+static __attribute__((noinline)) int hexstr_cached(char* str, uint32_t num, uint8_t nbits, uint32_t flags) {
+	uint32_t tables = bitops_cache_tables();
+	int current_byte = (flags & HEXSTR_NO_PREFIX) ? 0 : PREFIX_BYTES_HEX;
+	int i;
+
+	num &= 0xFFFFFFFF >> (UINT32_T_BITS - nbits);
+
+	///< Turned off since the caller looked
+	if (tables == BITOPS_CACHE_OFF) {
+		str[0] = '0';
+		str[1] = 'x';
+		for (i = nbits - 8; i >= 0; i -= 8) {
+			memcpy(str + current_byte, hex_pair_table[flags & HEXSTR_LOWER][(num >> i) & 0xFF], 2);
+			current_byte += 2;
+		}
+		str[current_byte] = '\0';
+		return current_byte;
+	}
+
+	return cache_hexstr(str, num, nbits, flags, tables);
+}
+#endif
+
+/**
+ * \fn uint_to_binstr_body(char* str, size_t size, uint32_t num, uint8_t nbits)
+ * \brief Does the work of uint_to_binstr; the public wrapper adds the STATS counters
+ */
+static inline int uint_to_binstr_body(char* str, size_t size, uint32_t num, uint8_t nbits) {
 	assert(str != NULL);
 	assert(size > (size_t)nbits + PREFIX_BYTES_BIN);
 	assert(nbits > 0);
 
+#ifndef BITOPS_NO_CACHE
+	if ((__atomic_load_n(&bitops_cache_ready, __ATOMIC_RELAXED) != BITOPS_CACHE_OFF) && ((nbits == 8) || (nbits == 16) || (nbits == 32))) {
+		return binstr_cached(str, num, nbits);
+	}
+#endif
+
+	switch (nbits) {
+		case 8:
+			return uint_to_binstr8(str, size, num);
+		case 16:
+			return uint_to_binstr16(str, size, num);
+		case 32:
+			return uint_to_binstr32(str, size, num);
+		default:
+			break;
+	}
+
 	if (num > (0xFFFFFFFF >> (UINT32_T_BITS - nbits))) {
 		str[0] = '\0';
 		return EXIT_FAILURE_N;
@@ -123,21 +589,223 @@ int uint_to_binstr(char* str, size_t size, uint32_t num, uint8_t nbits) {
 }
 
 /**
- * \fn int_to_binstr(char* str, size_t size, uint32_t num, uint8_t nbits)
- * \brief Stores binary representation of a 32-bit signed int into a null-terminated string
+ * \fn uint_to_binstr(char* str, size_t size, uint32_t num, uint8_t nbits)
+ * \brief Stores binary representation of a 32-bit unsigned int into a null-terminated string
+ * 
+ * \param str Pointer to a char array
+ * \param size Num of bytes of the char array pointed to by str
+ * \param num The value to be converted
+ * \param nbits The number of bits in the input
+ * 
+ * \return If successful, returns the number of characters written to str, not including the terminal \0. In the case of an error, the function returns a negative value, and str is set to the empty string.
+ */
+int uint_to_binstr(char* str, size_t size, uint32_t num, uint8_t nbits) {
+	BITOPS_STAT_START();
+	int len = uint_to_binstr_body(str, size, num, nbits);
+
+	BITOPS_STAT_STOP(BITOPS_STAT_UINT_TO_BINSTR, nbits, (len < 0) ? 0 : len, len < 0);
+
+	return len;
+}
+
+/**
+ * \fn uint_to_binstr_fmt(char* str, size_t size, uint32_t num, uint8_t nbits, uint32_t flags)
+ * \brief Stores binary representation of a 32-bit unsigned int into a null-terminated string, with the bit or byte order changed in the same pass
  *
  * \param str Pointer to a char array
  * \param size Num of bytes of the char array pointed to by str
  * \param num The value to be converted
  * \param nbits The number of bits in the input
+ * \param flags Bitwise OR of BINSTR_REVERSED and BINSTR_BIG_ENDIAN, or 0 for what uint_to_binstr prints. Both together reverse the bits within each byte
  *
- * \return If successful, returns the number of characters written to str, not including the terminal \0. In the case of an error, the function returns a negative value, and str is set to the empty string.
+ * \return If successful, returns the number of characters written to str, not including the terminal \0. If num does not fit in nbits, or BINSTR_BIG_ENDIAN is given and nbits is not a multiple of 8, the function returns a negative value, and str is set to the empty string.
  */
-int int_to_binstr(char* str, size_t size, int32_t num, uint8_t nbits) {
+int uint_to_binstr_fmt(char* str, size_t size, uint32_t num, uint8_t nbits, uint32_t flags) {
+	assert(str != NULL);
+	assert(size > (size_t)nbits + PREFIX_BYTES_BIN);
+	assert((nbits > 0) && (nbits <= UINT32_T_BITS));
+
+	if ((num > (0xFFFFFFFF >> (UINT32_T_BITS - nbits))) || ((flags & BINSTR_BIG_ENDIAN) && ((nbits % 8) != 0))) {
+		str[0] = '\0';
+		return EXIT_FAILURE_N;
+	}
+
+	return uint_to_binstr_body(str, size, reorder_bits(num, nbits, flags & BINSTR_REVERSED, flags & BINSTR_BIG_ENDIAN), nbits);
+}
+
+/**
+ * \fn binstr32_scalar(char* dst, uint32_t num)
+ * \brief Writes all 32 bits of num as '0'/'1' characters, most significant bit first
+ *
+ * \param dst Pointer to at least 32 writable bytes
+ * \param num The value to be converted
+ *
+ * \return None
+ */
+static inline void binstr32_scalar(char* dst, uint32_t num) {
+	int i;
+
+	for (i = 0; i < UINT32_T_BITS; i++) {
+		dst[i] = (char)('0' + ((num >> (UINT32_T_BITS - 1 - i)) & 1u));
+	}
+}
+
+#ifdef BITOPS_X86
+/**
+ * \fn binstr32_sse2(char* dst, uint32_t num)
+ * \brief SSE2 version of binstr32_scalar. Each byte of num is broadcast to 8 lanes, masked against one bit per lane and turned into '0'/'1' by a compare
+ *
+ * \param dst Pointer to at least 32 writable bytes
+ * \param num The value to be converted
+ *
+ * \return None
+ */
+static inline __attribute__((target("sse2"))) void binstr32_sse2(char* dst, uint32_t num) {
+	const __m128i bit_mask = _mm_set_epi8(0x01, 0x02, 0x04, 0x08, 0x10, 0x20, 0x40, (char)0x80, 0x01, 0x02, 0x04, 0x08, 0x10, 0x20, 0x40, (char)0x80);
+	const __m128i ascii_zero = _mm_set1_epi8('0');
+	__m128i bytes = _mm_cvtsi32_si128((int)__builtin_bswap32(num));
+	__m128i hi;
+	__m128i lo;
+
+	///< b3 b2 b1 b0 -> b3 x8, b2 x8 | b1 x8, b0 x8
+	bytes = _mm_unpacklo_epi8(bytes, bytes);
+	bytes = _mm_unpacklo_epi16(bytes, bytes);
+	hi = _mm_unpacklo_epi32(bytes, bytes);
+	lo = _mm_unpackhi_epi32(bytes, bytes);
+
+	hi = _mm_cmpeq_epi8(_mm_and_si128(hi, bit_mask), bit_mask);
+	lo = _mm_cmpeq_epi8(_mm_and_si128(lo, bit_mask), bit_mask);
+
+	///< A matching lane is -1, so subtracting it turns '0' into '1'
+	_mm_storeu_si128((__m128i*)dst, _mm_sub_epi8(ascii_zero, hi));
+	_mm_storeu_si128((__m128i*)(dst + 16), _mm_sub_epi8(ascii_zero, lo));
+}
+
+/**
+ * \fn binstr32_avx2(char* dst, uint32_t num)
+ * \brief AVX2 version of binstr32_sse2 producing all 32 characters with a single shuffle and store
+ *
+ * \param dst Pointer to at least 32 writable bytes
+ * \param num The value to be converted
+ *
+ * \return None
+ */
+static inline __attribute__((target("avx2"))) void binstr32_avx2(char* dst, uint32_t num) {
+	const __m256i byte_index = _mm256_set_epi8(3, 3, 3, 3, 3, 3, 3, 3, 2, 2, 2, 2, 2, 2, 2, 2, 1, 1, 1, 1, 1, 1, 1, 1, 0, 0, 0, 0, 0, 0, 0, 0);
+	const __m256i bit_mask = _mm256_set1_epi64x((long long)0x0102040810204080ull);
+	__m256i bits = _mm256_set1_epi32((int)__builtin_bswap32(num));
+
+	bits = _mm256_shuffle_epi8(bits, byte_index);
+	bits = _mm256_cmpeq_epi8(_mm256_and_si256(bits, bit_mask), bit_mask);
+	_mm256_storeu_si256((__m256i*)dst, _mm256_sub_epi8(_mm256_set1_epi8('0'), bits));
+}
+#endif
+
+///< Expands to one batch binary-string loop built around a 32-character kernel. Slots are formatted in order, so a kernel store that runs past its slot is overwritten by the next one; only slots near the end of out go through a bounce buffer
+#define DEFINE_BINSTR_MANY(name, attr, kernel) \
+static attr int name(const uint32_t* in, size_t n, char* out, size_t out_size, uint8_t nbits) { \
+	size_t i; \
+	size_t stride = BINSTR_SLOT_BYTES(nbits); \
+	uint32_t limit = 0xFFFFFFFF >> (UINT32_T_BITS - nbits); \
+	int shift = UINT32_T_BITS - nbits; \
+	int failures = 0; \
+	char bounce[UINT32_T_BITS]; \
+	char* slot; \
+	for (i = 0; i < n; i++) { \
+		slot = out + (i * stride); \
+		if (in[i] > limit) { \
+			slot[0] = '\0'; \
+			failures++; \
+			continue; \
+		} \
+		slot[0] = '0'; \
+		slot[1] = 'b'; \
+		if ((size_t)(slot - out) + PREFIX_BYTES_BIN + UINT32_T_BITS <= out_size) { \
+			kernel(slot + PREFIX_BYTES_BIN, in[i] << shift); \
+		} \
+		else { \
+			kernel(bounce, in[i] << shift); \
+			memcpy(slot + PREFIX_BYTES_BIN, bounce, nbits); \
+		} \
+		slot[PREFIX_BYTES_BIN + nbits] = '\0'; \
+	} \
+	return failures; \
+}
+
+DEFINE_BINSTR_MANY(uint_to_binstr_many_scalar, , binstr32_scalar)
+#ifdef BITOPS_X86
+DEFINE_BINSTR_MANY(uint_to_binstr_many_sse2, __attribute__((target("sse2"))), binstr32_sse2)
+DEFINE_BINSTR_MANY(uint_to_binstr_many_avx2, __attribute__((target("avx2"))), binstr32_avx2)
+#endif
+
+typedef int (*binstr_many_fn_t)(const uint32_t* in, size_t n, char* out, size_t out_size, uint8_t nbits);
+
+/**
+ * \fn uint_to_binstr_many_body(const uint32_t* in, size_t n, char* out, size_t out_size, uint8_t nbits)
+ * \brief Does the work of uint_to_binstr_many; the public wrapper adds the STATS counters
+ */
+static inline int uint_to_binstr_many_body(const uint32_t* in, size_t n, char* out, size_t out_size, uint8_t nbits) {
+	assert((in != NULL) || (n == 0));
+	assert(out != NULL);
+	assert((nbits > 0) && (nbits <= UINT32_T_BITS));
+
+	if (out_size < n * BINSTR_SLOT_BYTES(nbits)) {
+		if (out_size > 0) {
+			out[0] = '\0';
+		}
+		return EXIT_FAILURE_N;
+	}
+
+	return bitops_table()->uint_to_binstr_many(in, n, out, out_size, nbits);
+}
+
+/**
+ * \fn uint_to_binstr_many(const uint32_t* in, size_t n, char* out, size_t out_size, uint8_t nbits)
+ * \brief Stores the binary representation of n 32-bit unsigned ints into consecutive fixed-size slots of out. Slot i starts at out + i * BINSTR_SLOT_BYTES(nbits) and holds exactly what uint_to_binstr would write for in[i]
+ *
+ * \param in Pointer to the values to be converted
+ * \param n The number of values in the array pointed to by in
+ * \param out Pointer to a char array
+ * \param out_size Num of bytes of the char array pointed to by out
+ * \param nbits The number of bits in each input
+ *
+ * \return If successful, returns the number of values that do not fit in nbits (their slots are set to the empty string). If out cannot hold n slots, the function returns a negative value and out is set to the empty string.
+ */
+int uint_to_binstr_many(const uint32_t* in, size_t n, char* out, size_t out_size, uint8_t nbits) {
+	BITOPS_STAT_START();
+	int failures = uint_to_binstr_many_body(in, n, out, out_size, nbits);
+
+	BITOPS_STAT_STOP(BITOPS_STAT_UINT_TO_BINSTR_MANY, nbits, (failures < 0) ? 0 : n * BINSTR_SLOT_BYTES(nbits), failures < 0);
+
+	return failures;
+}
+
+/**
+ * \fn int_to_binstr_body(char* str, size_t size, int32_t num, uint8_t nbits)
+ * \brief Does the work of int_to_binstr; the public wrapper adds the STATS counters
+ */
+static inline int int_to_binstr_body(char* str, size_t size, int32_t num, uint8_t nbits) {
 	assert(str != NULL);
 	assert(size > (size_t)nbits + PREFIX_BYTES_BIN);
 	assert(nbits > 0);
 
+#ifndef BITOPS_NO_CACHE
+	if ((__atomic_load_n(&bitops_cache_ready, __ATOMIC_RELAXED) != BITOPS_CACHE_OFF) && ((nbits == 8) || (nbits == 16) || (nbits == 32))) {
+		return binstr_cached(str, (uint32_t)num & (0xFFFFFFFF >> (UINT32_T_BITS - nbits)), nbits);
+	}
+#endif
+
+	switch (nbits) {
+		case 8:
+			return int_to_binstr8(str, size, num);
+		case 16:
+			return int_to_binstr16(str, size, num);
+		case 32:
+			return int_to_binstr32(str, size, num);
+		default:
+			break;
+	}
+
 	int i;
 	int current_byte = PREFIX_BYTES_BIN;
 
@@ -162,118 +830,438 @@ int int_to_binstr(char* str, size_t size, int32_t num, uint8_t nbits) {
 }
 
 /**
- * \fn uint_to_hexstr(char* str, size_t size, uint32_t num, uint8_t nbits)
- * \brief Stores hex representation of a 32-bit unsigned int into a null-terminated string
+ * \fn int_to_binstr(char* str, size_t size, uint32_t num, uint8_t nbits)
+ * \brief Stores binary representation of a 32-bit signed int into a null-terminated string
  *
  * \param str Pointer to a char array
  * \param size Num of bytes of the char array pointed to by str
  * \param num The value to be converted
- * \param nbits The number of bits in the input (note: nbits must be one of the values 4, 8, 16, or 32 to correspond to 1, 2, 4, or 8 hex digits)
+ * \param nbits The number of bits in the input
  *
  * \return If successful, returns the number of characters written to str, not including the terminal \0. In the case of an error, the function returns a negative value, and str is set to the empty string.
  */
-int uint_to_hexstr(char* str, size_t size, uint32_t num, uint8_t nbits) {
-	assert(str != NULL);
-	assert(size > (size_t)nbits + PREFIX_BYTES_HEX);
-	assert((nbits == 4) || (nbits == 8) || (nbits == 16) || (nbits == 32));
+int int_to_binstr(char* str, size_t size, int32_t num, uint8_t nbits) {
+	BITOPS_STAT_START();
+	int len = int_to_binstr_body(str, size, num, nbits);
 
-	int i;
-	int current_byte = PREFIX_BYTES_HEX;
-	uint8_t current_nibble;
+	BITOPS_STAT_STOP(BITOPS_STAT_INT_TO_BINSTR, nbits, (len < 0) ? 0 : len, len < 0);
 
-	str[0] = '0';
-	str[1] = 'x';
+	return len;
+}
 
-	for (i = nbits; i > 0; i = i - 4) {
-		current_nibble = 0;
-		//printf("--- %u & %u, i = %u\n", num, (uint32_t)(1 << i) | (uint32_t)(1 << (i - 1)) | (uint32_t)(1 << (i - 2)) | (uint32_t)(1 << (i - 3)), i);
-		current_nibble = (((num & (uint32_t)(1 << (i - 1))) | (num & (uint32_t)(1 << (i - 2))) | (num & (uint32_t)(1 << (i - 3))) | (num & (uint32_t)(1 << (i - 4)))) >> (i - BITS_PER_NIBBLE));
+/**
+ * \fn binstr_table_emit(char* dst, uint32_t bits, int nbytes)
+ * \brief Writes nbytes * 8 binary digits of bits, most significant first, one table copy per byte
+ *
+ * \param dst Pointer to at least nbytes * 8 writable bytes
+ * \param bits The value to be converted, left-aligned so its first digit is bit 31
+ * \param nbytes The number of bytes of bits to write (range from 1 to 4)
+ *
+ * \return None
+ */
+static inline void binstr_table_emit(char* dst, uint32_t bits, int nbytes) {
+	int i;
 
-		switch (current_nibble) {
-			case 0b1111:
-				str[current_byte] = 'F';
-				break;
-			case 0b1110:
-				str[current_byte] = 'E';
-				break;
-			case 0b1101:
-				str[current_byte] = 'D';
-				break;
-			case 0b1100:
-				str[current_byte] = 'C';
-				break;
-			case 0b1011:
-				str[current_byte] = 'B';
-				break;
-			case 0b1010:
-				str[current_byte] = 'A';
-				break;
-			case 0b1001:
-				str[current_byte] = '9';
-				break;
-			case 0b1000:
-				str[current_byte] = '8';
-				break;
-			case 0b0111:
-				str[current_byte] = '7';
-				break;
-			case 0b0110:
-				str[current_byte] = '6';
-				break;
-			case 0b0101:
-				str[current_byte] = '5';
-				break;
-			case 0b0100:
-				str[current_byte] = '4';
-				break;
-			case 0b0011:
-				str[current_byte] = '3';
-				break;
-			case 0b0010:
-				str[current_byte] = '2';
-				break;
-			case 0b0001:
-				str[current_byte] = '1';
-				break;
-			case 0b0000:
-				str[current_byte] = '0';
-				break;
-			default:
-				return EXIT_TEST_FAILURE;
+	for (i = 0; i < nbytes; i++) {
+		memcpy(dst + (i * 8), bin_byte_table[(bits >> 24) & 0xFF], 8);
+		bits <<= 8;
+	}
+}
+
+/**
+ * \fn int_binstr_slot(char* slot, size_t room, int32_t num, uint8_t nbits, uint32_t flags)
+ * \brief Formats one signed value into its batch slot, exactly as int_to_binstr would, with an optional two's complement range check
+ *
+ * \param slot Pointer to the slot
+ * \param room Bytes writable from slot to the end of the output buffer
+ * \param num The value to be converted
+ * \param nbits The number of bits in the output
+ * \param flags BINSTR_RANGE_CHECK rejects values that do not fit in nbits; BINSTR_REVERSED and BINSTR_BIG_ENDIAN reorder the nbits-wide value after the check
+ *
+ * \return 1 if num was rejected by the range check, 0 otherwise
+ */
+static inline int int_binstr_slot(char* slot, size_t room, int32_t num, uint8_t nbits, uint32_t flags) {
+	int nbytes = (nbits + 7) / 8;
+	uint32_t sign_bits;
+	char bounce[UINT32_T_BITS];
+
+	if ((flags & BINSTR_RANGE_CHECK) && (nbits < UINT32_T_BITS)) {
+		///< num fits iff every bit from nbits - 1 upward matches the sign bit
+		sign_bits = (uint32_t)(num >> (nbits - 1));
+		if ((sign_bits != 0) && (sign_bits != 0xFFFFFFFF)) {
+			slot[0] = '\0';
+			return 1;
 		}
-		//printf(" - str[%d] = %c, current_nibble = %u\n", current_byte, str[current_byte], current_nibble);
-		current_byte++;
 	}
 
-	///< Terminate str with NULL
-	str[current_byte] = '\0';
+	if (flags & (BINSTR_REVERSED | BINSTR_BIG_ENDIAN)) {
+		num = (int32_t)reorder_bits((uint32_t)num, nbits, flags & BINSTR_REVERSED, flags & BINSTR_BIG_ENDIAN);
+	}
 
-	return current_byte;
+	slot[0] = '0';
+	slot[1] = 'b';
+
+	///< Whole-byte copies may run past nbits into the next slot, which is written afterwards
+	if (PREFIX_BYTES_BIN + ((size_t)nbytes * 8) <= room) {
+		binstr_table_emit(slot + PREFIX_BYTES_BIN, (uint32_t)num << (UINT32_T_BITS - nbits), nbytes);
+	}
+	else {
+		binstr_table_emit(bounce, (uint32_t)num << (UINT32_T_BITS - nbits), nbytes);
+		memcpy(slot + PREFIX_BYTES_BIN, bounce, nbits);
+	}
+
+	slot[PREFIX_BYTES_BIN + nbits] = '\0';
+
+	return 0;
+}
+
+///< Expands to one batch signed formatter for an input element type
+#define DEFINE_INT_BINSTR_MANY(name, type) \
+int name(const type* in, size_t n, char* out, size_t out_size, uint8_t nbits, uint32_t flags) { \
+	assert((in != NULL) || (n == 0)); \
+	assert(out != NULL); \
+	assert((nbits > 0) && (nbits <= UINT32_T_BITS)); \
+	size_t i; \
+	size_t stride = BINSTR_SLOT_BYTES(nbits); \
+	int failures = 0; \
+	if ((out_size < n * stride) || ((flags & BINSTR_BIG_ENDIAN) && ((nbits % 8) != 0))) { \
+		if (out_size > 0) { \
+			out[0] = '\0'; \
+		} \
+		return EXIT_FAILURE_N; \
+	} \
+	for (i = 0; i < n; i++) { \
+		failures += int_binstr_slot(out + (i * stride), out_size - (i * stride), (int32_t)in[i], nbits, flags); \
+	} \
+	return failures; \
 }
 
 /**
- * \fn twiggle_bit(uint32_t input, int bit, operation_t operation)
- * \brief Changes exactly a single bit of a 32-bit unsigned int
+ * \fn int8_to_binstr_many(const int8_t* in, size_t n, char* out, size_t out_size, uint8_t nbits, uint32_t flags)
+ * \fn int16_to_binstr_many(const int16_t* in, size_t n, char* out, size_t out_size, uint8_t nbits, uint32_t flags)
+ * \fn int32_to_binstr_many(const int32_t* in, size_t n, char* out, size_t out_size, uint8_t nbits, uint32_t flags)
+ * \brief Stores the binary representation of n signed ints into consecutive fixed-size slots of out. Each value is sign-extended to 32 bits and slot i, starting at out + i * BINSTR_SLOT_BYTES(nbits), holds what int_to_binstr would write for it
  *
- * \param input The 32-bit value to operate on
- * \param bit The single bit in input to operate on (range from 0 to 31)
- * \param operation The type of operation to perform on bit (CLEAR, SET, TOGGLE)
+ * \param in Pointer to the values to be converted
+ * \param n The number of values in the array pointed to by in
+ * \param out Pointer to a char array
+ * \param out_size Num of bytes of the char array pointed to by out
+ * \param nbits The number of bits in each output (range from 1 to 32)
+ * \param flags BINSTR_RANGE_CHECK sets the slot of any value that does not fit in nbits as two's complement to the empty string, the way uint_to_binstr does for unsigned values. BINSTR_REVERSED and BINSTR_BIG_ENDIAN print each value as uint_to_binstr_fmt does
  *
- * \return If successful, returns the transformed 32-bit value. In the case of an error, the function returns 0xFFFFFFFF.
+ * \return If successful, returns the number of values rejected by the range check (always 0 without BINSTR_RANGE_CHECK). If out cannot hold n slots, or BINSTR_BIG_ENDIAN is given and nbits is not a multiple of 8, the function returns a negative value and out is set to the empty string.
  */
-uint32_t twiggle_bit(uint32_t input, int bit, operation_t operation) {
+DEFINE_INT_BINSTR_MANY(int8_to_binstr_many, int8_t)
+DEFINE_INT_BINSTR_MANY(int16_to_binstr_many, int16_t)
+DEFINE_INT_BINSTR_MANY(int32_to_binstr_many, int32_t)
+
+/**
+ * \fn uint_to_hexstr_body(char* str, size_t size, uint32_t num, uint8_t nbits)
+ * \brief Does the work of uint_to_hexstr; the public wrapper adds the STATS counters
+ */
+static inline int uint_to_hexstr_body(char* str, size_t size, uint32_t num, uint8_t nbits) {
+#ifndef BITOPS_NO_CACHE
+	if ((__atomic_load_n(&bitops_cache_ready, __ATOMIC_RELAXED) != BITOPS_CACHE_OFF) && (nbits != 4)) {
+		assert(str != NULL);
+		assert((nbits == 8) || (nbits == 16) || (nbits == 32));
+		assert(size > (size_t)(nbits / BITS_PER_NIBBLE) + PREFIX_BYTES_HEX);
+
+		return hexstr_cached(str, num, nbits, HEXSTR_UPPER);
+	}
+#endif
+
+	switch (nbits) {
+		case 8:
+			return uint_to_hexstr8(str, size, num);
+		case 16:
+			return uint_to_hexstr16(str, size, num);
+		case 32:
+			return uint_to_hexstr32(str, size, num);
+		default:
+			return uint_to_hexstr_fmt(str, size, num, nbits, HEXSTR_UPPER);
+	}
+}
+
+/**
+ * \fn uint_to_hexstr(char* str, size_t size, uint32_t num, uint8_t nbits)
+ * \brief Stores hex representation of a 32-bit unsigned int into a null-terminated string
+ *
+ * \param str Pointer to a char array
+ * \param size Num of bytes of the char array pointed to by str
+ * \param num The value to be converted
+ * \param nbits The number of bits in the input (note: nbits must be one of the values 4, 8, 16, or 32 to correspond to 1, 2, 4, or 8 hex digits)
+ *
+ * \return If successful, returns the number of characters written to str, not including the terminal \0. In the case of an error, the function returns a negative value, and str is set to the empty string.
+ */
+int uint_to_hexstr(char* str, size_t size, uint32_t num, uint8_t nbits) {
+	BITOPS_STAT_START();
+	int len = uint_to_hexstr_body(str, size, num, nbits);
+
+	BITOPS_STAT_STOP(BITOPS_STAT_UINT_TO_HEXSTR, nbits, (len < 0) ? 0 : len, len < 0);
+
+	return len;
+}
+
+/**
+ * \fn hexstr32_swar(uint32_t num, uint32_t flags)
+ * \brief Spreads the 8 nibbles of num into the 8 bytes of a 64-bit word and converts all of them to ASCII hex digits at once, without branches
+ *
+ * \param num The value to be converted
+ * \param flags HEXSTR_LOWER selects lowercase digits
+ *
+ * \return 8 hex digits, most significant first in memory order, ready to be stored with memcpy
+ */
+static inline uint64_t hexstr32_swar(uint32_t num, uint32_t flags) {
+	uint64_t x = num;
+	uint64_t alpha;
+
+	///< Nibble k of num ends up in byte k of x
+	x = ((x & 0x00000000FFFF0000ull) << 16) | (x & 0x000000000000FFFFull);
+	x = ((x & 0x0000FF000000FF00ull) << 8) | (x & 0x000000FF000000FFull);
+	x = ((x & 0x00F000F000F000F0ull) << 4) | (x & 0x000F000F000F000Full);
+
+	///< 1 in every byte whose nibble is 10 or more
+	alpha = ((x + 0x0606060606060606ull) >> 4) & 0x0101010101010101ull;
+
+	x += 0x3030303030303030ull + (alpha * ((flags & HEXSTR_LOWER) ? ('a' - '0' - 10) : ('A' - '0' - 10)));
+
+#if __BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__
+	x = __builtin_bswap64(x);
+#endif
+
+	return x;
+}
+
+/**
+ * \fn uint_to_hexstr_fmt(char* str, size_t size, uint32_t num, uint8_t nbits, uint32_t flags)
+ * \brief Stores hex representation of a 32-bit unsigned int into a null-terminated string, with a choice of digit case and prefix
+ *
+ * \param str Pointer to a char array
+ * \param size Num of bytes of the char array pointed to by str
+ * \param num The value to be converted
+ * \param nbits The number of bits in the input (note: nbits must be one of the values 4, 8, 16, or 32 to correspond to 1, 2, 4, or 8 hex digits)
+ * \param flags Bitwise OR of HEXSTR_UPPER or HEXSTR_LOWER, and optionally HEXSTR_NO_PREFIX to leave off the "0x", HEXSTR_REVERSED to reverse the bit order and HEXSTR_BIG_ENDIAN to swap the bytes of the nbits-wide value first
+ *
+ * \return If successful, returns the number of characters written to str, not including the terminal \0. If HEXSTR_BIG_ENDIAN is given with an nbits of 4, the function returns a negative value, and str is set to the empty string.
+ */
+int uint_to_hexstr_fmt(char* str, size_t size, uint32_t num, uint8_t nbits, uint32_t flags) {
+	assert(str != NULL);
+	assert((nbits == 4) || (nbits == 8) || (nbits == 16) || (nbits == 32));
+
+	int ndigits = nbits / BITS_PER_NIBBLE;
+	int current_byte = (flags & HEXSTR_NO_PREFIX) ? 0 : PREFIX_BYTES_HEX;
+	const char (*pairs)[4] = hex_pair_table[flags & HEXSTR_LOWER];
+	uint64_t digits;
+
+	assert(size > (size_t)ndigits + (size_t)current_byte);
+
+	if (flags & (HEXSTR_REVERSED | HEXSTR_BIG_ENDIAN)) {
+		if ((flags & HEXSTR_BIG_ENDIAN) && (nbits < 8)) {
+			str[0] = '\0';
+			return EXIT_FAILURE_N;
+		}
+		num = reorder_bits(num, nbits, flags & HEXSTR_REVERSED, flags & HEXSTR_BIG_ENDIAN);
+	}
+
+#ifndef BITOPS_NO_CACHE
+	if ((__atomic_load_n(&bitops_cache_ready, __ATOMIC_RELAXED) != BITOPS_CACHE_OFF) && (nbits != 4)) {
+		return hexstr_cached(str, num, nbits, flags);
+	}
+#endif
+
+	str[0] = '0';
+	str[1] = 'x';
+
+	switch (nbits) {
+		case 4:
+			str[current_byte] = hex_nibble_table[flags & HEXSTR_LOWER][num & 0xF];
+			break;
+		case 8:
+			memcpy(str + current_byte, pairs[num & 0xFF], 2);
+			break;
+		case 16:
+			memcpy(str + current_byte, pairs[(num >> 8) & 0xFF], 2);
+			memcpy(str + current_byte + 2, pairs[num & 0xFF], 2);
+			break;
+		default:
+			digits = hexstr32_swar(num, flags);
+			memcpy(str + current_byte, &digits, sizeof(digits));
+			break;
+	}
+
+	current_byte += ndigits;
+
+	///< Terminate str with NULL
+	str[current_byte] = '\0';
+
+	return current_byte;
+}
+
+/**
+ * \fn hexstr_many_scalar(const uint32_t* in, size_t n, char* out, size_t out_size, uint8_t nbits, uint32_t flags)
+ * \brief Portable batch hex formatter built on hexstr32_swar. Slots are filled in order so an 8-digit store that runs past a short slot is overwritten by the next one
+ *
+ * \return None
+ */
+static void hexstr_many_scalar(const uint32_t* in, size_t n, char* out, size_t out_size, uint8_t nbits, uint32_t flags) {
+	size_t i;
+	size_t stride = HEXSTR_SLOT_BYTES(nbits, flags);
+	size_t prefix = (flags & HEXSTR_NO_PREFIX) ? 0 : PREFIX_BYTES_HEX;
+	size_t ndigits = nbits / BITS_PER_NIBBLE;
+	int shift = UINT32_T_BITS - nbits;
+	uint64_t digits;
+	char* slot;
+
+	for (i = 0; i < n; i++) {
+		slot = out + (i * stride);
+		slot[0] = '0';
+		slot[1] = 'x';
+		digits = hexstr32_swar(((flags & (HEXSTR_REVERSED | HEXSTR_BIG_ENDIAN)) ? reorder_bits(in[i], nbits, flags & HEXSTR_REVERSED, flags & HEXSTR_BIG_ENDIAN) : in[i]) << shift, flags);
+		if ((size_t)(slot - out) + prefix + sizeof(digits) <= out_size) {
+			memcpy(slot + prefix, &digits, sizeof(digits));
+		}
+		else {
+			memcpy(slot + prefix, &digits, ndigits);
+		}
+		slot[prefix + ndigits] = '\0';
+	}
+}
+
+#ifdef BITOPS_X86
+/**
+ * \fn reverse_byte_bits_ssse3(__m128i v)
+ * \brief Reverses the bits within each byte of v: each nibble is looked up reversed in a 16-entry pshufb table and the two halves swap places
+ *
+ * \return The 16 bytes, each bit-reversed
+ */
+static inline __attribute__((target("ssse3"))) __m128i reverse_byte_bits_ssse3(__m128i v) {
+	const __m128i reversed_nibble = _mm_setr_epi8(0x0, 0x8, 0x4, 0xC, 0x2, 0xA, 0x6, 0xE, 0x1, 0x9, 0x5, 0xD, 0x3, 0xB, 0x7, 0xF);
+	const __m128i low_nibble = _mm_set1_epi8(0x0F);
+	__m128i lo = _mm_shuffle_epi8(reversed_nibble, _mm_and_si128(v, low_nibble));
+	__m128i hi = _mm_shuffle_epi8(reversed_nibble, _mm_and_si128(_mm_srli_epi16(v, 4), low_nibble));
+
+	return _mm_or_si128(_mm_slli_epi16(lo, 4), hi);
+}
+
+/**
+ * \fn hexstr_many_ssse3(const uint32_t* in, size_t n, char* out, size_t out_size, uint8_t nbits, uint32_t flags)
+ * \brief SSSE3 batch hex formatter. Four values per iteration are byte-swapped, split into nibbles and mapped to digits with one pshufb lookup, then written to their slots 8 digits at a time. The REVERSED and BIG_ENDIAN flags change the byte-swap step rather than adding a pass
+ *
+ * \return None
+ */
+static __attribute__((target("ssse3"))) void hexstr_many_ssse3(const uint32_t* in, size_t n, char* out, size_t out_size, uint8_t nbits, uint32_t flags) {
+	const __m128i bswap_index = _mm_set_epi8(12, 13, 14, 15, 8, 9, 10, 11, 4, 5, 6, 7, 0, 1, 2, 3);
+	const __m128i low_nibble = _mm_set1_epi8(0x0F);
+	const __m128i digit_table = _mm_loadu_si128((const __m128i*)hex_nibble_table[flags & HEXSTR_LOWER]);
+	const __m128i shift = _mm_cvtsi32_si128(UINT32_T_BITS - nbits);
+	const __m128i width_mask = _mm_set1_epi32((int)(0xFFFFFFFFu >> (UINT32_T_BITS - nbits)));
+	///< A bit reversal is a reversal within each byte plus a byte swap, and big-endian output undoes the byte swap below, so
+	///< the flags fold to one nibble-table pass, with the swap and alignment skipped when exactly one of them is set
+	uint32_t reorder = flags & (HEXSTR_REVERSED | HEXSTR_BIG_ENDIAN);
+	int in_digit_order = (reorder == HEXSTR_REVERSED) || (reorder == HEXSTR_BIG_ENDIAN);
+	size_t stride = HEXSTR_SLOT_BYTES(nbits, flags);
+	size_t prefix = (flags & HEXSTR_NO_PREFIX) ? 0 : PREFIX_BYTES_HEX;
+	size_t ndigits = nbits / BITS_PER_NIBBLE;
+	size_t i = 0;
+	int j;
+	char* slot;
+	char digits[4][8];
+	__m128i v;
+	__m128i hi;
+	__m128i lo;
+
+	///< Stop vectorizing while the last group's 8-digit stores could still run past out
+	while ((i + 4 <= n) && (((i + 3) * stride) + prefix + 8 <= out_size)) {
+		v = _mm_loadu_si128((const __m128i*)(in + i));
+		if (reorder) {
+			v = _mm_and_si128(v, width_mask);
+			if (flags & HEXSTR_REVERSED) {
+				v = reverse_byte_bits_ssse3(v);
+			}
+		}
+		if (!in_digit_order) {
+			v = _mm_sll_epi32(v, shift);
+			v = _mm_shuffle_epi8(v, bswap_index);
+		}
+		hi = _mm_and_si128(_mm_srli_epi16(v, 4), low_nibble);
+		lo = _mm_and_si128(v, low_nibble);
+		_mm_storeu_si128((__m128i*)digits[0], _mm_shuffle_epi8(digit_table, _mm_unpacklo_epi8(hi, lo)));
+		_mm_storeu_si128((__m128i*)digits[2], _mm_shuffle_epi8(digit_table, _mm_unpackhi_epi8(hi, lo)));
+
+		for (j = 0; j < 4; j++) {
+			slot = out + ((i + j) * stride);
+			slot[0] = '0';
+			slot[1] = 'x';
+			memcpy(slot + prefix, digits[j], 8);
+			slot[prefix + ndigits] = '\0';
+		}
+		i += 4;
+	}
+
+	hexstr_many_scalar(in + i, n - i, out + (i * stride), out_size - (i * stride), nbits, flags);
+}
+#endif
+
+/**
+ * \fn uint_to_hexstr_many_body(const uint32_t* in, size_t n, char* out, size_t out_size, uint8_t nbits, uint32_t flags)
+ * \brief Does the work of uint_to_hexstr_many; the public wrapper adds the STATS counters
+ */
+static inline int uint_to_hexstr_many_body(const uint32_t* in, size_t n, char* out, size_t out_size, uint8_t nbits, uint32_t flags) {
+	assert((in != NULL) || (n == 0));
+	assert(out != NULL);
+	assert((nbits == 4) || (nbits == 8) || (nbits == 16) || (nbits == 32));
+
+	if ((out_size < n * HEXSTR_SLOT_BYTES(nbits, flags)) || ((flags & HEXSTR_BIG_ENDIAN) && (nbits < 8))) {
+		if (out_size > 0) {
+			out[0] = '\0';
+		}
+		return EXIT_FAILURE_N;
+	}
+
+	bitops_table()->uint_to_hexstr_many(in, n, out, out_size, nbits, flags);
+
+	return 0;
+}
+
+/**
+ * \fn uint_to_hexstr_many(const uint32_t* in, size_t n, char* out, size_t out_size, uint8_t nbits, uint32_t flags)
+ * \brief Stores the hex representation of n 32-bit unsigned ints into consecutive fixed-size slots of out. Slot i starts at out + i * HEXSTR_SLOT_BYTES(nbits, flags) and holds exactly what uint_to_hexstr_fmt would write for in[i]
+ *
+ * \param in Pointer to the values to be converted
+ * \param n The number of values in the array pointed to by in
+ * \param out Pointer to a char array
+ * \param out_size Num of bytes of the char array pointed to by out
+ * \param nbits The number of bits in each input (one of 4, 8, 16, or 32)
+ * \param flags Same as for uint_to_hexstr_fmt
+ *
+ * \return If successful, returns 0. If out cannot hold n slots, or HEXSTR_BIG_ENDIAN is given with an nbits of 4, the function returns a negative value and out is set to the empty string.
+ */
+int uint_to_hexstr_many(const uint32_t* in, size_t n, char* out, size_t out_size, uint8_t nbits, uint32_t flags) {
+	BITOPS_STAT_START();
+	int status = uint_to_hexstr_many_body(in, n, out, out_size, nbits, flags);
+
+	BITOPS_STAT_STOP(BITOPS_STAT_UINT_TO_HEXSTR_MANY, nbits, (status < 0) ? 0 : n * HEXSTR_SLOT_BYTES(nbits, flags), status < 0);
+
+	return status;
+}
+
+/**
+ * \fn twiggle_bit_body(uint32_t input, int bit, operation_t operation)
+ * \brief Does the work of twiggle_bit; the public wrapper adds the STATS counters
+ */
+static inline uint32_t twiggle_bit_body(uint32_t input, int bit, operation_t operation) {
 	assert((UINT32_T_BITS > bit) && (bit >= 0));
 	assert((operation == CLEAR) || (operation == SET) || (operation == TOGGLE));
 
 	switch (operation) {
 		case CLEAR:
-			input &= (0xFFFFFFFF & (0 << bit));
+			input &= ~((uint32_t)1 << bit);
 			break;
 		case SET:
-			input |= (1 << bit);
+			input |= ((uint32_t)1 << bit);
 			break;
 		case TOGGLE:
-			input ^= (1 << bit);
+			input ^= ((uint32_t)1 << bit);
 			break;
 		default:
 			return EXIT_BIT_FAILURE;
@@ -283,6 +1271,264 @@ uint32_t twiggle_bit(uint32_t input, int bit, operation_t operation) {
 	return input;
 }
 
+/**
+ * \fn twiggle_bit(uint32_t input, int bit, operation_t operation)
+ * \brief Changes exactly a single bit of a 32-bit unsigned int
+ *
+ * \param input The 32-bit value to operate on
+ * \param bit The single bit in input to operate on (range from 0 to 31)
+ * \param operation The type of operation to perform on bit (CLEAR, SET, TOGGLE)
+ *
+ * \return If successful, returns the transformed 32-bit value. In the case of an error, the function returns 0xFFFFFFFF.
+ */
+uint32_t twiggle_bit(uint32_t input, int bit, operation_t operation) {
+	BITOPS_STAT_START();
+	uint32_t output = twiggle_bit_body(input, bit, operation);
+
+	BITOPS_STAT_STOP(BITOPS_STAT_TWIGGLE_BIT, 1, 0, (operation != CLEAR) && (operation != SET) && (operation != TOGGLE));
+
+	return output;
+}
+
+///< Every operation is written as (word & ~(mask & keep)) ^ (mask & flip) so the kernels need no per-word branch on operation
+#define TWIGGLE_KEEP(op) (((op) == TOGGLE) ? 0u : 0xFFFFFFFF)
+#define TWIGGLE_FLIP(op) (((op) == CLEAR) ? 0u : 0xFFFFFFFF)
+
+/**
+ * \fn twiggle_many_scalar(uint32_t* data, size_t n, uint32_t mask, uint32_t keep, uint32_t flip)
+ * \brief Portable kernel applying the same single-bit mask to every word
+ *
+ * \return None
+ */
+static void twiggle_many_scalar(uint32_t* data, size_t n, uint32_t mask, uint32_t keep, uint32_t flip) {
+	size_t i;
+
+	for (i = 0; i < n; i++) {
+		data[i] = (data[i] & ~(mask & keep)) ^ (mask & flip);
+	}
+}
+
+/**
+ * \fn twiggle_each_scalar(uint32_t* data, size_t n, const int* bits, uint32_t keep, uint32_t flip)
+ * \brief Portable kernel applying bit bits[i] to word data[i]
+ *
+ * \return None
+ */
+static void twiggle_each_scalar(uint32_t* data, size_t n, const int* bits, uint32_t keep, uint32_t flip) {
+	size_t i;
+	uint32_t mask;
+
+	for (i = 0; i < n; i++) {
+		mask = (uint32_t)1 << bits[i];
+		data[i] = (data[i] & ~(mask & keep)) ^ (mask & flip);
+	}
+}
+
+#ifdef BITOPS_X86
+/**
+ * \fn twiggle_many_sse2(uint32_t* data, size_t n, uint32_t mask, uint32_t keep, uint32_t flip)
+ * \brief SSE2 version of twiggle_many_scalar, 4 words per iteration
+ *
+ * \return None
+ */
+static __attribute__((target("sse2"))) void twiggle_many_sse2(uint32_t* data, size_t n, uint32_t mask, uint32_t keep, uint32_t flip) {
+	const __m128i clear = _mm_set1_epi32((int)(mask & keep));
+	const __m128i toggle = _mm_set1_epi32((int)(mask & flip));
+	size_t i = 0;
+	__m128i v;
+
+	for (; i + 4 <= n; i += 4) {
+		v = _mm_loadu_si128((const __m128i*)(data + i));
+		v = _mm_xor_si128(_mm_andnot_si128(clear, v), toggle);
+		_mm_storeu_si128((__m128i*)(data + i), v);
+	}
+
+	twiggle_many_scalar(data + i, n - i, mask, keep, flip);
+}
+
+/**
+ * \fn twiggle_many_avx2(uint32_t* data, size_t n, uint32_t mask, uint32_t keep, uint32_t flip)
+ * \brief AVX2 version of twiggle_many_scalar, 8 words per iteration
+ *
+ * \return None
+ */
+static __attribute__((target("avx2"))) void twiggle_many_avx2(uint32_t* data, size_t n, uint32_t mask, uint32_t keep, uint32_t flip) {
+	const __m256i clear = _mm256_set1_epi32((int)(mask & keep));
+	const __m256i toggle = _mm256_set1_epi32((int)(mask & flip));
+	size_t i = 0;
+	__m256i v;
+
+	for (; i + 8 <= n; i += 8) {
+		v = _mm256_loadu_si256((const __m256i*)(data + i));
+		v = _mm256_xor_si256(_mm256_andnot_si256(clear, v), toggle);
+		_mm256_storeu_si256((__m256i*)(data + i), v);
+	}
+
+	twiggle_many_scalar(data + i, n - i, mask, keep, flip);
+}
+
+/**
+ * \fn twiggle_each_sse2(uint32_t* data, size_t n, const int* bits, uint32_t keep, uint32_t flip)
+ * \brief SSE2 version of twiggle_each_scalar. SSE2 has no per-lane variable shift, so 1 << bit is built as the float 2^bit and truncated back to an integer (2^31 saturates to 0x80000000, which is the wanted mask)
+ *
+ * \return None
+ */
+static __attribute__((target("sse2"))) void twiggle_each_sse2(uint32_t* data, size_t n, const int* bits, uint32_t keep, uint32_t flip) {
+	const __m128i vkeep = _mm_set1_epi32((int)keep);
+	const __m128i vflip = _mm_set1_epi32((int)flip);
+	const __m128i bias = _mm_set1_epi32(127);
+	size_t i = 0;
+	__m128i mask;
+	__m128i v;
+
+	for (; i + 4 <= n; i += 4) {
+		mask = _mm_slli_epi32(_mm_add_epi32(_mm_loadu_si128((const __m128i*)(bits + i)), bias), 23);
+		mask = _mm_cvttps_epi32(_mm_castsi128_ps(mask));
+		v = _mm_loadu_si128((const __m128i*)(data + i));
+		v = _mm_xor_si128(_mm_andnot_si128(_mm_and_si128(mask, vkeep), v), _mm_and_si128(mask, vflip));
+		_mm_storeu_si128((__m128i*)(data + i), v);
+	}
+
+	twiggle_each_scalar(data + i, n - i, bits + i, keep, flip);
+}
+
+/**
+ * \fn twiggle_each_avx2(uint32_t* data, size_t n, const int* bits, uint32_t keep, uint32_t flip)
+ * \brief AVX2 version of twiggle_each_scalar using a per-lane variable shift
+ *
+ * \return None
+ */
+static __attribute__((target("avx2"))) void twiggle_each_avx2(uint32_t* data, size_t n, const int* bits, uint32_t keep, uint32_t flip) {
+	const __m256i vkeep = _mm256_set1_epi32((int)keep);
+	const __m256i vflip = _mm256_set1_epi32((int)flip);
+	const __m256i one = _mm256_set1_epi32(1);
+	size_t i = 0;
+	__m256i mask;
+	__m256i v;
+
+	for (; i + 8 <= n; i += 8) {
+		mask = _mm256_sllv_epi32(one, _mm256_loadu_si256((const __m256i*)(bits + i)));
+		v = _mm256_loadu_si256((const __m256i*)(data + i));
+		v = _mm256_xor_si256(_mm256_andnot_si256(_mm256_and_si256(mask, vkeep), v), _mm256_and_si256(mask, vflip));
+		_mm256_storeu_si256((__m256i*)(data + i), v);
+	}
+
+	twiggle_each_scalar(data + i, n - i, bits + i, keep, flip);
+}
+
+/**
+ * \fn twiggle_many_avx512(uint32_t* data, size_t n, uint32_t mask, uint32_t keep, uint32_t flip)
+ * \brief AVX-512 version of twiggle_many_scalar, 16 words per iteration. The tail is done with a masked load and store instead of the scalar loop
+ *
+ * \return None
+ */
+static __attribute__((target("avx512f"))) void twiggle_many_avx512(uint32_t* data, size_t n, uint32_t mask, uint32_t keep, uint32_t flip) {
+	const __m512i clear = _mm512_set1_epi32((int)(mask & keep));
+	const __m512i toggle = _mm512_set1_epi32((int)(mask & flip));
+	size_t i = 0;
+	__mmask16 tail;
+	__m512i v;
+
+	for (; i + 16 <= n; i += 16) {
+		v = _mm512_loadu_si512((const void*)(data + i));
+		v = _mm512_xor_si512(_mm512_andnot_si512(clear, v), toggle);
+		_mm512_storeu_si512((void*)(data + i), v);
+	}
+
+	if (i < n) {
+		tail = (__mmask16)((1u << (n - i)) - 1);
+		v = _mm512_maskz_loadu_epi32(tail, (const void*)(data + i));
+		v = _mm512_xor_si512(_mm512_andnot_si512(clear, v), toggle);
+		_mm512_mask_storeu_epi32((void*)(data + i), tail, v);
+	}
+}
+
+/**
+ * \fn twiggle_each_avx512(uint32_t* data, size_t n, const int* bits, uint32_t keep, uint32_t flip)
+ * \brief AVX-512 version of twiggle_each_scalar, 16 words per iteration with a masked tail
+ *
+ * \return None
+ */
+static __attribute__((target("avx512f"))) void twiggle_each_avx512(uint32_t* data, size_t n, const int* bits, uint32_t keep, uint32_t flip) {
+	const __m512i vkeep = _mm512_set1_epi32((int)keep);
+	const __m512i vflip = _mm512_set1_epi32((int)flip);
+	const __m512i one = _mm512_set1_epi32(1);
+	__mmask16 lanes = 0xFFFF;
+	size_t i;
+	__m512i mask;
+	__m512i v;
+
+	for (i = 0; i < n; i += 16) {
+		if (n - i < 16) {
+			lanes = (__mmask16)((1u << (n - i)) - 1);
+		}
+		mask = _mm512_sllv_epi32(one, _mm512_maskz_loadu_epi32(lanes, (const void*)(bits + i)));
+		v = _mm512_maskz_loadu_epi32(lanes, (const void*)(data + i));
+		v = _mm512_xor_si512(_mm512_andnot_si512(_mm512_and_si512(mask, vkeep), v), _mm512_and_si512(mask, vflip));
+		_mm512_mask_storeu_epi32((void*)(data + i), lanes, v);
+	}
+}
+#endif
+
+/**
+ * \fn twiggle_bit_many(uint32_t* data, size_t n, int bit, operation_t operation)
+ * \brief Changes the same single bit of every 32-bit unsigned int in an array, in place
+ *
+ * \param data Pointer to the words to operate on
+ * \param n The number of words in the array pointed to by data
+ * \param bit The single bit in each word to operate on (range from 0 to 31)
+ * \param operation The type of operation to perform on bit (CLEAR, SET, TOGGLE)
+ *
+ * \return If successful, returns 0. In the case of an error, the function returns a negative value and data is left unchanged.
+ */
+int twiggle_bit_many(uint32_t* data, size_t n, int bit, operation_t operation) {
+	assert((data != NULL) || (n == 0));
+	assert((UINT32_T_BITS > bit) && (bit >= 0));
+
+	uint32_t mask = (uint32_t)1 << bit;
+
+	if ((operation != CLEAR) && (operation != SET) && (operation != TOGGLE)) {
+		return EXIT_FAILURE_N;
+	}
+
+	bitops_table()->twiggle_many(data, n, mask, TWIGGLE_KEEP(operation), TWIGGLE_FLIP(operation));
+
+	return 0;
+}
+
+/**
+ * \fn twiggle_bits_many(uint32_t* data, size_t n, const int* bits, operation_t operation)
+ * \brief Changes bit bits[i] of word data[i] for every word in an array, in place
+ *
+ * \param data Pointer to the words to operate on
+ * \param n The number of words in the array pointed to by data (and bits)
+ * \param bits Pointer to the bit number for each word (each in range from 0 to 31)
+ * \param operation The type of operation to perform on each bit (CLEAR, SET, TOGGLE)
+ *
+ * \return If successful, returns 0. In the case of an error, the function returns a negative value and data is left unchanged.
+ */
+int twiggle_bits_many(uint32_t* data, size_t n, const int* bits, operation_t operation) {
+	assert(((data != NULL) && (bits != NULL)) || (n == 0));
+
+	if ((operation != CLEAR) && (operation != SET) && (operation != TOGGLE)) {
+		return EXIT_FAILURE_N;
+	}
+
+	bitops_table()->twiggle_each(data, n, bits, TWIGGLE_KEEP(operation), TWIGGLE_FLIP(operation));
+
+	return 0;
+}
+
+/**
+ * \fn grab_three_bits_body(uint32_t input, int start_bit)
+ * \brief Does the work of grab_three_bits; the public wrapper adds the STATS counters
+ */
+static inline uint32_t grab_three_bits_body(uint32_t input, int start_bit) {
+	assert((UINT32_T_BITS - 3 >= start_bit) && (start_bit >= 0));
+
+	return extract_bits(input, start_bit, 3);
+}
+
 /**
  * \fn grab_three_bits(uint32_t input, int start_bit)
  * \brief Returns 3 consecutive bits of a 32-bit unsigned int as a 32-bit unsigned int
@@ -293,262 +1539,2487 @@ uint32_t twiggle_bit(uint32_t input, int bit, operation_t operation) {
  * \return If successful, returns a 32-bit value whose 3 least significant bits are the 3 bits grabbed from input, in respective order. In the case of an error, the function returns 0xFFFFFFFF.
  */
 uint32_t grab_three_bits(uint32_t input, int start_bit) {
-	assert((UINT32_T_BITS - 3 >= start_bit) && (start_bit >= 0));
+	BITOPS_STAT_START();
+	uint32_t output = grab_three_bits_body(input, start_bit);
+
+	BITOPS_STAT_STOP(BITOPS_STAT_GRAB_THREE_BITS, 3, 0, (start_bit < 0) || (start_bit > UINT32_T_BITS - 3));
+
+	return output;
+}
+
+///< Mask of the width least significant bits, valid for width 1 to 32
+#define FIELD_MASK(width) (0xFFFFFFFF >> (UINT32_T_BITS - (width)))
+
+/**
+ * \fn extract_bits_scalar(uint32_t input, int start_bit, int width)
+ * \brief Shift/mask version of extract_bits for CPUs without BMI2
+ *
+ * \return The field, shifted down to bit 0
+ */
+static inline uint32_t extract_bits_scalar(uint32_t input, int start_bit, int width) {
+	return (input >> start_bit) & FIELD_MASK(width);
+}
+
+/**
+ * \fn deposit_bits_scalar(uint32_t input, uint32_t value, int start_bit, int width)
+ * \brief Shift/mask version of deposit_bits for CPUs without BMI2
+ *
+ * \return input with the field replaced
+ */
+static inline uint32_t deposit_bits_scalar(uint32_t input, uint32_t value, int start_bit, int width) {
+	uint32_t mask = FIELD_MASK(width) << start_bit;
+
+	return (input & ~mask) | ((value << start_bit) & mask);
+}
+
+#ifdef BITOPS_X86
+/**
+ * \fn extract_bits_bmi2(uint32_t input, int start_bit, int width)
+ * \brief BMI2 version of extract_bits. BZHI zeroes everything above width without building a mask
+ *
+ * \return The field, shifted down to bit 0
+ */
+static inline __attribute__((target("bmi2"))) uint32_t extract_bits_bmi2(uint32_t input, int start_bit, int width) {
+	return _bzhi_u32(input >> start_bit, (unsigned int)width);
+}
+
+/**
+ * \fn deposit_bits_bmi2(uint32_t input, uint32_t value, int start_bit, int width)
+ * \brief BMI2 version of deposit_bits. PDEP scatters the low bits of value into the field positions
+ *
+ * \return input with the field replaced
+ */
+static inline __attribute__((target("bmi2"))) uint32_t deposit_bits_bmi2(uint32_t input, uint32_t value, int start_bit, int width) {
+	uint32_t mask = _bzhi_u32(0xFFFFFFFF, (unsigned int)width) << start_bit;
+
+	return (input & ~mask) | _pdep_u32(value, mask);
+}
+
+/**
+ * \fn extract_fields_bmi2(uint32_t input, const bitfield_t* fields, size_t nfields, uint32_t* out)
+ * \brief BMI2 loop for extract_fields. PEXT gathers each field straight from its mask
+ *
+ * \return None
+ */
+static __attribute__((target("bmi2"))) void extract_fields_bmi2(uint32_t input, const bitfield_t* fields, size_t nfields, uint32_t* out) {
+	size_t i;
+
+	for (i = 0; i < nfields; i++) {
+		out[i] = _pext_u32(input, _bzhi_u32(0xFFFFFFFF, fields[i].width) << fields[i].start_bit);
+	}
+}
+
+/**
+ * \fn deposit_fields_bmi2(uint32_t input, const bitfield_t* fields, size_t nfields, const uint32_t* values)
+ * \brief BMI2 loop for deposit_fields
+ *
+ * \return input with every field replaced
+ */
+static __attribute__((target("bmi2"))) uint32_t deposit_fields_bmi2(uint32_t input, const bitfield_t* fields, size_t nfields, const uint32_t* values) {
+	size_t i;
+
+	for (i = 0; i < nfields; i++) {
+		input = deposit_bits_bmi2(input, values[i], fields[i].start_bit, fields[i].width);
+	}
+
+	return input;
+}
+#endif
+
+/**
+ * \fn extract_fields_scalar(uint32_t input, const bitfield_t* fields, size_t nfields, uint32_t* out)
+ * \brief Shift/mask loop for extract_fields
+ *
+ * \return None
+ */
+static void extract_fields_scalar(uint32_t input, const bitfield_t* fields, size_t nfields, uint32_t* out) {
+	size_t i;
+
+	for (i = 0; i < nfields; i++) {
+		out[i] = extract_bits_scalar(input, fields[i].start_bit, fields[i].width);
+	}
+}
+
+/**
+ * \fn deposit_fields_scalar(uint32_t input, const bitfield_t* fields, size_t nfields, const uint32_t* values)
+ * \brief Shift/mask loop for deposit_fields
+ *
+ * \return input with every field replaced
+ */
+static uint32_t deposit_fields_scalar(uint32_t input, const bitfield_t* fields, size_t nfields, const uint32_t* values) {
+	size_t i;
+
+	for (i = 0; i < nfields; i++) {
+		input = deposit_bits_scalar(input, values[i], fields[i].start_bit, fields[i].width);
+	}
+
+	return input;
+}
+
+/**
+ * \fn bitops_has_bmi2(void)
+ * \brief Reports whether BMI2 instructions are enabled in the chosen ISA tier
+ *
+ * \return 1 if BMI2 instructions may be used, 0 otherwise
+ */
+static int bitops_has_bmi2(void) {
+	return (bitops_cpu_features() & BITOPS_CPU_BMI2) ? 1 : 0;
+}
+
+/**
+ * \fn extract_bits(uint32_t input, int start_bit, int width)
+ * \brief Returns width consecutive bits of a 32-bit unsigned int as a 32-bit unsigned int
+ *
+ * \param input The 32-bit value to operate on
+ * \param start_bit The least-significant bit number of the field (range from 0 to 31)
+ * \param width The number of bits in the field (range from 1 to 32 - start_bit)
+ *
+ * \return A 32-bit value whose width least significant bits are the bits grabbed from input, in respective order
+ */
+uint32_t extract_bits(uint32_t input, int start_bit, int width) {
+	assert((start_bit >= 0) && (width > 0) && (start_bit + width <= UINT32_T_BITS));
+
+	return bitops_table()->extract_bits(input, start_bit, width);
+}
+
+/**
+ * \fn deposit_bits(uint32_t input, uint32_t value, int start_bit, int width)
+ * \brief Replaces width consecutive bits of a 32-bit unsigned int with the low bits of value
+ *
+ * \param input The 32-bit value to operate on
+ * \param value The new field contents (bits above width are ignored)
+ * \param start_bit The least-significant bit number of the field (range from 0 to 31)
+ * \param width The number of bits in the field (range from 1 to 32 - start_bit)
+ *
+ * \return The transformed 32-bit value
+ */
+uint32_t deposit_bits(uint32_t input, uint32_t value, int start_bit, int width) {
+	assert((start_bit >= 0) && (width > 0) && (start_bit + width <= UINT32_T_BITS));
+
+	return bitops_table()->deposit_bits(input, value, start_bit, width);
+}
+
+/**
+ * \fn extract_fields(uint32_t input, const bitfield_t* fields, size_t nfields, uint32_t* out)
+ * \brief Splits one 32-bit word into nfields fields described by fields
+ *
+ * \param input The 32-bit value to operate on
+ * \param fields Pointer to the field descriptors (fields may overlap and appear in any order)
+ * \param nfields The number of descriptors pointed to by fields
+ * \param out Pointer to an array receiving one right-aligned value per field
+ *
+ * \return None
+ */
+void extract_fields(uint32_t input, const bitfield_t* fields, size_t nfields, uint32_t* out) {
+	assert(((fields != NULL) && (out != NULL)) || (nfields == 0));
+
+	size_t i;
+
+	for (i = 0; i < nfields; i++) {
+		assert((fields[i].width > 0) && (fields[i].start_bit + fields[i].width <= UINT32_T_BITS));
+	}
+
+	bitops_table()->extract_fields(input, fields, nfields, out);
+}
+
+/**
+ * \fn deposit_fields(uint32_t input, const bitfield_t* fields, size_t nfields, const uint32_t* values)
+ * \brief Replaces nfields fields of a 32-bit word in one call. Later fields win where descriptors overlap
+ *
+ * \param input The 32-bit value to operate on
+ * \param fields Pointer to the field descriptors
+ * \param nfields The number of descriptors pointed to by fields
+ * \param values Pointer to one new value per field
+ *
+ * \return The transformed 32-bit value
+ */
+uint32_t deposit_fields(uint32_t input, const bitfield_t* fields, size_t nfields, const uint32_t* values) {
+	assert(((fields != NULL) && (values != NULL)) || (nfields == 0));
+
+	size_t i;
+
+	for (i = 0; i < nfields; i++) {
+		assert((fields[i].width > 0) && (fields[i].start_bit + fields[i].width <= UINT32_T_BITS));
+	}
+
+	return bitops_table()->deposit_fields(input, fields, nfields, values);
+}
+
+/**
+ * \fn reverse_many_scalar(uint32_t* data, size_t n)
+ * \brief Scalar loop for reverse_bits_many
+ *
+ * \return None
+ */
+static void reverse_many_scalar(uint32_t* data, size_t n) {
+	size_t i;
+
+	for (i = 0; i < n; i++) {
+		data[i] = reverse_bits32(data[i]);
+	}
+}
+
+/**
+ * \fn swap_many_scalar(uint32_t* data, size_t n)
+ * \brief Scalar loop for swap_bytes_many
+ *
+ * \return None
+ */
+static void swap_many_scalar(uint32_t* data, size_t n) {
+	size_t i;
+
+	for (i = 0; i < n; i++) {
+		data[i] = swap_bytes32(data[i]);
+	}
+}
+
+/**
+ * \fn permute_groups(uint32_t input, const bitperm_t* perm)
+ * \brief Moves the bits of input one rotation group at a time
+ *
+ * \return The permuted value
+ */
+static inline uint32_t permute_groups(uint32_t input, const bitperm_t* perm) {
+	uint32_t result = 0;
+	uint32_t x;
+	int g;
+
+	for (g = 0; g < perm->ngroups; g++) {
+		x = input & perm->group_mask[g];
+		result |= (x << perm->group_rotate[g]) | (x >> ((UINT32_T_BITS - perm->group_rotate[g]) & 31));
+	}
+
+	return result;
+}
+
+/**
+ * \fn permute_bits_scalar(uint32_t input, const bitperm_t* perm)
+ * \brief Rotate-and-mask version of permute_bits
+ *
+ * \return The permuted value
+ */
+static uint32_t permute_bits_scalar(uint32_t input, const bitperm_t* perm) {
+	return permute_groups(input, perm);
+}
+
+/**
+ * \fn permute_many_scalar(uint32_t* data, size_t n, const bitperm_t* perm)
+ * \brief Rotate-and-mask loop for permute_bits_many
+ *
+ * \return None
+ */
+static void permute_many_scalar(uint32_t* data, size_t n, const bitperm_t* perm) {
+	size_t i;
+
+	for (i = 0; i < n; i++) {
+		data[i] = permute_groups(data[i], perm);
+	}
+}
+
+#ifdef BITOPS_X86
+/**
+ * \fn reverse_many_ssse3(uint32_t* data, size_t n)
+ * \brief SSSE3 loop for reverse_bits_many. The bits within each byte are reversed through the nibble table, then pshufb swaps the bytes of each word
+ *
+ * \return None
+ */
+static __attribute__((target("ssse3"))) void reverse_many_ssse3(uint32_t* data, size_t n) {
+	const __m128i bswap_index = _mm_setr_epi8(3, 2, 1, 0, 7, 6, 5, 4, 11, 10, 9, 8, 15, 14, 13, 12);
+	__m128i v;
+	size_t i;
+
+	for (i = 0; i + 4 <= n; i += 4) {
+		v = _mm_loadu_si128((const __m128i*)(data + i));
+		_mm_storeu_si128((__m128i*)(data + i), _mm_shuffle_epi8(reverse_byte_bits_ssse3(v), bswap_index));
+	}
+
+	reverse_many_scalar(data + i, n - i);
+}
+
+/**
+ * \fn swap_many_ssse3(uint32_t* data, size_t n)
+ * \brief SSSE3 loop for swap_bytes_many, one pshufb per four words
+ *
+ * \return None
+ */
+static __attribute__((target("ssse3"))) void swap_many_ssse3(uint32_t* data, size_t n) {
+	const __m128i bswap_index = _mm_setr_epi8(3, 2, 1, 0, 7, 6, 5, 4, 11, 10, 9, 8, 15, 14, 13, 12);
+	size_t i;
+
+	for (i = 0; i + 4 <= n; i += 4) {
+		_mm_storeu_si128((__m128i*)(data + i), _mm_shuffle_epi8(_mm_loadu_si128((const __m128i*)(data + i)), bswap_index));
+	}
+
+	swap_many_scalar(data + i, n - i);
+}
+
+/**
+ * \fn reverse_many_avx2(uint32_t* data, size_t n)
+ * \brief AVX2 loop for reverse_bits_many, the SSSE3 nibble-table method on eight words at a time
+ *
+ * \return None
+ */
+static __attribute__((target("avx2"))) void reverse_many_avx2(uint32_t* data, size_t n) {
+	const __m256i reversed_nibble = _mm256_setr_epi8(0x0, 0x8, 0x4, 0xC, 0x2, 0xA, 0x6, 0xE, 0x1, 0x9, 0x5, 0xD, 0x3, 0xB, 0x7, 0xF,
+		0x0, 0x8, 0x4, 0xC, 0x2, 0xA, 0x6, 0xE, 0x1, 0x9, 0x5, 0xD, 0x3, 0xB, 0x7, 0xF);
+	const __m256i bswap_index = _mm256_setr_epi8(3, 2, 1, 0, 7, 6, 5, 4, 11, 10, 9, 8, 15, 14, 13, 12,
+		3, 2, 1, 0, 7, 6, 5, 4, 11, 10, 9, 8, 15, 14, 13, 12);
+	const __m256i low_nibble = _mm256_set1_epi8(0x0F);
+	__m256i v;
+	__m256i lo;
+	__m256i hi;
+	size_t i;
+
+	for (i = 0; i + 8 <= n; i += 8) {
+		v = _mm256_loadu_si256((const __m256i*)(data + i));
+		lo = _mm256_shuffle_epi8(reversed_nibble, _mm256_and_si256(v, low_nibble));
+		hi = _mm256_shuffle_epi8(reversed_nibble, _mm256_and_si256(_mm256_srli_epi16(v, 4), low_nibble));
+		v = _mm256_or_si256(_mm256_slli_epi16(lo, 4), hi);
+		_mm256_storeu_si256((__m256i*)(data + i), _mm256_shuffle_epi8(v, bswap_index));
+	}
+
+	reverse_many_scalar(data + i, n - i);
+}
+
+/**
+ * \fn swap_many_avx2(uint32_t* data, size_t n)
+ * \brief AVX2 loop for swap_bytes_many, one vpshufb per eight words
+ *
+ * \return None
+ */
+static __attribute__((target("avx2"))) void swap_many_avx2(uint32_t* data, size_t n) {
+	const __m256i bswap_index = _mm256_setr_epi8(3, 2, 1, 0, 7, 6, 5, 4, 11, 10, 9, 8, 15, 14, 13, 12,
+		3, 2, 1, 0, 7, 6, 5, 4, 11, 10, 9, 8, 15, 14, 13, 12);
+	size_t i;
+
+	for (i = 0; i + 8 <= n; i += 8) {
+		_mm256_storeu_si256((__m256i*)(data + i), _mm256_shuffle_epi8(_mm256_loadu_si256((const __m256i*)(data + i)), bswap_index));
+	}
+
+	swap_many_scalar(data + i, n - i);
+}
+
+/**
+ * \fn permute_chains_bmi2(uint32_t input, const bitperm_t* perm)
+ * \brief Moves the bits of input one order-preserving chain at a time: PEXT gathers a chain's sources and PDEP scatters them to its destinations
+ *
+ * \return The permuted value
+ */
+static inline __attribute__((target("bmi2"))) uint32_t permute_chains_bmi2(uint32_t input, const bitperm_t* perm) {
+	uint32_t result = 0;
+	int c;
+
+	for (c = 0; c < perm->nchains; c++) {
+		result |= _pdep_u32(_pext_u32(input, perm->chain_src[c]), perm->chain_dst[c]);
+	}
+
+	return result;
+}
+
+/**
+ * \fn permute_bits_bmi2(uint32_t input, const bitperm_t* perm)
+ * \brief BMI2 version of permute_bits. Uses the PEXT/PDEP chains when there are fewer of them than rotation groups
+ *
+ * \return The permuted value
+ */
+static __attribute__((target("bmi2"))) uint32_t permute_bits_bmi2(uint32_t input, const bitperm_t* perm) {
+	return (perm->nchains < perm->ngroups) ? permute_chains_bmi2(input, perm) : permute_groups(input, perm);
+}
+
+/**
+ * \fn permute_many_avx2(uint32_t* data, size_t n, const bitperm_t* perm)
+ * \brief AVX2 loop for permute_bits_many. Each rotation group is an AND and two shifts on eight words at a time
+ *
+ * \return None
+ */
+static __attribute__((target("avx2"))) void permute_many_avx2(uint32_t* data, size_t n, const bitperm_t* perm) {
+	__m256i mask[BITPERM_BITS];
+	__m128i left[BITPERM_BITS];
+	__m128i right[BITPERM_BITS];
+	__m256i v;
+	__m256i x;
+	__m256i acc;
+	size_t i;
+	int g;
+
+	for (g = 0; g < perm->ngroups; g++) {
+		mask[g] = _mm256_set1_epi32((int)perm->group_mask[g]);
+		left[g] = _mm_cvtsi32_si128(perm->group_rotate[g]);
+		right[g] = _mm_cvtsi32_si128(UINT32_T_BITS - perm->group_rotate[g]);
+	}
+
+	for (i = 0; i + 8 <= n; i += 8) {
+		v = _mm256_loadu_si256((const __m256i*)(data + i));
+		acc = _mm256_setzero_si256();
+		for (g = 0; g < perm->ngroups; g++) {
+			///< A shift by 32 gives zero, so a rotation of 0 needs no special case
+			x = _mm256_and_si256(v, mask[g]);
+			acc = _mm256_or_si256(acc, _mm256_or_si256(_mm256_sll_epi32(x, left[g]), _mm256_srl_epi32(x, right[g])));
+		}
+		_mm256_storeu_si256((__m256i*)(data + i), acc);
+	}
+
+	permute_many_scalar(data + i, n - i, perm);
+}
+#endif
+
+/**
+ * \fn reverse_bits(uint32_t input, int nbits)
+ * \brief Reverses the order of the low nbits bits of a 32-bit unsigned int
+ *
+ * \param input The 32-bit value to operate on
+ * \param nbits The number of bits to reverse (range from 1 to 32)
+ *
+ * \return The low nbits bits of input in reverse order. Bits above nbits are clear
+ */
+uint32_t reverse_bits(uint32_t input, int nbits) {
+	assert((nbits > 0) && (nbits <= UINT32_T_BITS));
+
+	return reverse_bits32(input) >> (UINT32_T_BITS - nbits);
+}
+
+/**
+ * \fn reverse_bits_many(uint32_t* data, size_t n)
+ * \brief Reverses the bit order of n 32-bit words in place
+ *
+ * \param data Pointer to the words
+ * \param n Num of words pointed to by data
+ *
+ * \return None
+ */
+void reverse_bits_many(uint32_t* data, size_t n) {
+	assert((data != NULL) || (n == 0));
+
+	bitops_table()->reverse_many(data, n);
+}
+
+/**
+ * \fn swap_bytes_many(uint32_t* data, size_t n)
+ * \brief Reverses the byte order of n 32-bit words in place, converting between little- and big-endian
+ *
+ * \param data Pointer to the words
+ * \param n Num of words pointed to by data
+ *
+ * \return None
+ */
+void swap_bytes_many(uint32_t* data, size_t n) {
+	assert((data != NULL) || (n == 0));
+
+	bitops_table()->swap_many(data, n);
+}
+
+/**
+ * \fn bitperm_compile(bitperm_t* perm, const int8_t table[BITPERM_BITS])
+ * \brief Compiles a fixed bit permutation into the masks and shift counts permute_bits applies
+ *
+ * \param perm Pointer to the compiled permutation
+ * \param table For each output bit i, the input bit moved there, or BITPERM_ZERO to leave output bit i clear. An input bit may feed several output bits
+ *
+ * \return If successful, returns the number of rotation groups. If any table entry is outside BITPERM_ZERO..31, the function returns a negative value and perm is left empty, permuting every input to 0.
+ */
+int bitperm_compile(bitperm_t* perm, const int8_t table[BITPERM_BITS]) {
+	assert((perm != NULL) && (table != NULL));
+
+	uint32_t chain_last[BITPERM_BITS];
+	int src;
+	int rotate;
+	int i;
+	int k;
+
+	memset(perm, 0, sizeof(*perm));
+
+	for (i = 0; i < BITPERM_BITS; i++) {
+		if ((table[i] < BITPERM_ZERO) || (table[i] >= BITPERM_BITS)) {
+			return EXIT_FAILURE_N;
+		}
+	}
+
+	for (i = 0; i < BITPERM_BITS; i++) {
+		src = table[i];
+		if (src == BITPERM_ZERO) {
+			continue;
+		}
+
+		///< Every bit moving the same distance, modulo 32, shares one rotate and mask
+		rotate = (i - src) & 31;
+		for (k = 0; (k < perm->ngroups) && (perm->group_rotate[k] != rotate); k++) {
+		}
+		if (k == perm->ngroups) {
+			perm->group_rotate[k] = (uint8_t)rotate;
+			perm->ngroups++;
+		}
+		perm->group_mask[k] |= 1u << src;
+
+		///< Outputs are visited in increasing order, so a chain whose last source is lower keeps PEXT/PDEP order intact
+		for (k = 0; (k < perm->nchains) && (chain_last[k] >= (uint32_t)src); k++) {
+		}
+		if (k == perm->nchains) {
+			perm->nchains++;
+		}
+		perm->chain_src[k] |= 1u << src;
+		perm->chain_dst[k] |= 1u << i;
+		chain_last[k] = (uint32_t)src;
+	}
+
+	return perm->ngroups;
+}
+
+/**
+ * \fn permute_bits(uint32_t input, const bitperm_t* perm)
+ * \brief Applies a permutation compiled by bitperm_compile to a 32-bit unsigned int
+ *
+ * \param input The 32-bit value to operate on
+ * \param perm Pointer to the compiled permutation
+ *
+ * \return The permuted 32-bit value
+ */
+uint32_t permute_bits(uint32_t input, const bitperm_t* perm) {
+	assert(perm != NULL);
+
+	return bitops_table()->permute_bits(input, perm);
+}
+
+/**
+ * \fn permute_bits_many(uint32_t* data, size_t n, const bitperm_t* perm)
+ * \brief Applies a permutation compiled by bitperm_compile to n 32-bit words in place
+ *
+ * \param data Pointer to the words
+ * \param n Num of words pointed to by data
+ * \param perm Pointer to the compiled permutation
+ *
+ * \return None
+ */
+void permute_bits_many(uint32_t* data, size_t n, const bitperm_t* perm) {
+	assert(((data != NULL) || (n == 0)) && (perm != NULL));
+
+	bitops_table()->permute_many(data, n, perm);
+}
+
+static bitops_dispatch_t bitops_dispatch;
+static bitops_isa_t bitops_isa_max = BITOPS_ISA_SCALAR;
+static uint32_t bitops_cpu_detected = 0;
+static pthread_once_t bitops_once = PTHREAD_ONCE_INIT;
+
+static const char* const bitops_isa_names[] = { "scalar", "sse2", "avx2", "avx512" };
+
+///< Features each tier may use, when the CPU has them: SSE2 also covers SSSE3, AVX2 also covers BMI2
+static const uint32_t bitops_isa_features[] = {
+	0,
+	BITOPS_CPU_SSE2 | BITOPS_CPU_SSSE3,
+	BITOPS_CPU_SSE2 | BITOPS_CPU_SSSE3 | BITOPS_CPU_AVX2 | BITOPS_CPU_BMI2,
+	BITOPS_CPU_SSE2 | BITOPS_CPU_SSSE3 | BITOPS_CPU_AVX2 | BITOPS_CPU_BMI2 | BITOPS_CPU_AVX512F
+};
+
+/**
+ * \fn bitops_dispatch_fill(bitops_isa_t isa)
+ * \brief Points every table entry at the widest kernel allowed by isa and present on the CPU. Kernels a tier has no version of fall back to the next tier down
+ *
+ * \return None
+ */
+static void bitops_dispatch_fill(bitops_isa_t isa) {
+	uint32_t features = bitops_cpu_detected & bitops_isa_features[isa];
+
+	bitops_dispatch.isa = isa;
+	bitops_dispatch.features = features;
+	bitops_dispatch.uint_to_binstr_many = uint_to_binstr_many_scalar;
+	bitops_dispatch.uint_to_hexstr_many = hexstr_many_scalar;
+	bitops_dispatch.twiggle_many = twiggle_many_scalar;
+	bitops_dispatch.twiggle_each = twiggle_each_scalar;
+	bitops_dispatch.extract_bits = extract_bits_scalar;
+	bitops_dispatch.deposit_bits = deposit_bits_scalar;
+	bitops_dispatch.extract_fields = extract_fields_scalar;
+	bitops_dispatch.deposit_fields = deposit_fields_scalar;
+	bitops_dispatch.reverse_many = reverse_many_scalar;
+	bitops_dispatch.swap_many = swap_many_scalar;
+	bitops_dispatch.permute_bits = permute_bits_scalar;
+	bitops_dispatch.permute_many = permute_many_scalar;
+
+#ifdef BITOPS_X86
+	if (features & BITOPS_CPU_SSE2) {
+		bitops_dispatch.uint_to_binstr_many = uint_to_binstr_many_sse2;
+		bitops_dispatch.twiggle_many = twiggle_many_sse2;
+		bitops_dispatch.twiggle_each = twiggle_each_sse2;
+	}
+	if (features & BITOPS_CPU_SSSE3) {
+		bitops_dispatch.uint_to_hexstr_many = hexstr_many_ssse3;
+		bitops_dispatch.reverse_many = reverse_many_ssse3;
+		bitops_dispatch.swap_many = swap_many_ssse3;
+	}
+	if (features & BITOPS_CPU_AVX2) {
+		bitops_dispatch.uint_to_binstr_many = uint_to_binstr_many_avx2;
+		bitops_dispatch.twiggle_many = twiggle_many_avx2;
+		bitops_dispatch.twiggle_each = twiggle_each_avx2;
+		bitops_dispatch.reverse_many = reverse_many_avx2;
+		bitops_dispatch.swap_many = swap_many_avx2;
+		///< Eight words per rotation group beat one word per PEXT/PDEP chain, so the batch has no BMI2 version
+		bitops_dispatch.permute_many = permute_many_avx2;
+	}
+	if (features & BITOPS_CPU_BMI2) {
+		bitops_dispatch.extract_bits = extract_bits_bmi2;
+		bitops_dispatch.deposit_bits = deposit_bits_bmi2;
+		bitops_dispatch.extract_fields = extract_fields_bmi2;
+		bitops_dispatch.deposit_fields = deposit_fields_bmi2;
+		bitops_dispatch.permute_bits = permute_bits_bmi2;
+	}
+	if (features & BITOPS_CPU_AVX512F) {
+		bitops_dispatch.twiggle_many = twiggle_many_avx512;
+		bitops_dispatch.twiggle_each = twiggle_each_avx512;
+	}
+#endif
+}
+
+/**
+ * \fn bitops_init_once(void)
+ * \brief Detects CPU features, applies the BITOPS_ISA override and fills the kernel table. Runs exactly once, under pthread_once
+ *
+ * \return None
+ */
+static void bitops_init_once(void) {
+	const char* requested = getenv("BITOPS_ISA");
+	int isa;
+
+#ifdef BITOPS_X86
+	__builtin_cpu_init();
+	bitops_cpu_detected |= __builtin_cpu_supports("sse2") ? BITOPS_CPU_SSE2 : 0;
+	bitops_cpu_detected |= __builtin_cpu_supports("ssse3") ? BITOPS_CPU_SSSE3 : 0;
+	bitops_cpu_detected |= __builtin_cpu_supports("avx2") ? BITOPS_CPU_AVX2 : 0;
+	bitops_cpu_detected |= __builtin_cpu_supports("bmi2") ? BITOPS_CPU_BMI2 : 0;
+	bitops_cpu_detected |= __builtin_cpu_supports("avx512f") ? BITOPS_CPU_AVX512F : 0;
+#endif
+
+	for (isa = BITOPS_ISA_AVX512; isa > BITOPS_ISA_SCALAR; isa--) {
+		///< A tier is available once the CPU has its defining feature (SSE2, AVX2 or AVX512F)
+		if (bitops_cpu_detected & bitops_isa_features[isa] & ~bitops_isa_features[isa - 1] & (BITOPS_CPU_SSE2 | BITOPS_CPU_AVX2 | BITOPS_CPU_AVX512F)) {
+			break;
+		}
+	}
+	bitops_isa_max = (bitops_isa_t)isa;
+
+	if (requested != NULL) {
+		isa = bitops_isa_parse(requested);
+		if (isa < 0) {
+			fprintf(stderr, "bitops: ignoring unknown BITOPS_ISA=%s (expected scalar, sse2, avx2 or avx512)\n", requested);
+			isa = bitops_isa_max;
+		}
+	}
+
+	bitops_dispatch_fill(((bitops_isa_t)isa < bitops_isa_max) ? (bitops_isa_t)isa : bitops_isa_max);
+}
+
+/**
+ * \fn bitops_table(void)
+ * \brief Returns the kernel table, initializing it on first use
+ *
+ * \return Pointer to the filled table
+ */
+static const bitops_dispatch_t* bitops_table(void) {
+	pthread_once(&bitops_once, bitops_init_once);
+
+	return &bitops_dispatch;
+}
+
+/**
+ * \fn bitops_init(void)
+ * \brief Detects CPU features once and selects the kernels every batch and bit-field function uses. Calling it is optional: it also runs when the library is loaded and on first use. The BITOPS_ISA environment variable (scalar, sse2, avx2 or avx512) caps the tier, so each one can be compared on the same machine; a tier above what the CPU supports is lowered to the best one it does support
+ *
+ * \return The ISA tier in use
+ */
+bitops_isa_t bitops_init(void) {
+	return bitops_table()->isa;
+}
+
+__attribute__((constructor)) static void bitops_init_constructor(void) {
+	bitops_init();
+}
+
+/**
+ * \fn bitops_set_isa(bitops_isa_t isa)
+ * \brief Switches to another ISA tier at run time, lowered to what the CPU supports. Not thread-safe: call it before other threads use the library
+ *
+ * \return The ISA tier now in use
+ */
+bitops_isa_t bitops_set_isa(bitops_isa_t isa) {
+	assert((isa >= BITOPS_ISA_SCALAR) && (isa <= BITOPS_ISA_AVX512));
+
+	bitops_table();
+	bitops_dispatch_fill((isa < bitops_isa_max) ? isa : bitops_isa_max);
+
+	return bitops_dispatch.isa;
+}
+
+/**
+ * \fn bitops_isa(void)
+ * \brief Reports the ISA tier the kernels were selected for
+ *
+ * \return The ISA tier in use
+ */
+bitops_isa_t bitops_isa(void) {
+	return bitops_table()->isa;
+}
+
+/**
+ * \fn bitops_isa_max_supported(void)
+ * \brief Reports the widest ISA tier the running CPU supports, regardless of BITOPS_ISA
+ *
+ * \return The widest supported tier
+ */
+bitops_isa_t bitops_isa_max_supported(void) {
+	bitops_table();
+
+	return bitops_isa_max;
+}
+
+/**
+ * \fn bitops_set_cache(uint32_t tables)
+ * \brief Chooses the precomputed string tables uint_to_binstr, int_to_binstr, uint_to_hexstr and uint_to_hexstr_fmt copy 8-, 16- and 32-bit values from. A table is built the first time a formatter needs it, under pthread_once, so any thread may call this at any time. Built tables are kept; BITOPS_CACHE_OFF only stops the formatters using them
+ *
+ * \param tables BITOPS_CACHE_OFF, BITOPS_CACHE_8, or BITOPS_CACHE_16 (which includes the 8-bit tables)
+ *
+ * \return The tables now selected. Always BITOPS_CACHE_OFF in a NOCACHE=1 build
+ */
+uint32_t bitops_set_cache(uint32_t tables) {
+	assert((tables & ~(BITOPS_CACHE_8 | BITOPS_CACHE_16)) == 0);
+
+#ifndef BITOPS_NO_CACHE
+	if (tables & BITOPS_CACHE_16) {
+		tables |= BITOPS_CACHE_8;
+	}
+	__atomic_store_n(&bitops_cache_requested, tables, __ATOMIC_RELAXED);
+
+	///< Tables already built are used straight away; otherwise the next formatter call builds them. A switch racing with a build may
+	///< leave the previous choice in effect until the next bitops_set_cache, which changes speed but never output
+	if ((tables & ~__atomic_load_n(&bitops_cache_built, __ATOMIC_ACQUIRE)) != 0) {
+		__atomic_store_n(&bitops_cache_ready, BITOPS_CACHE_PENDING, __ATOMIC_RELEASE);
+	}
+	else {
+		__atomic_store_n(&bitops_cache_ready, tables, __ATOMIC_RELEASE);
+	}
+
+	return tables;
+#else
+	(void)tables;
+
+	return BITOPS_CACHE_OFF;
+#endif
+}
+
+/**
+ * \fn bitops_cache(void)
+ * \brief Reports the tables selected with bitops_set_cache. BITOPS_CACHE_16 is dropped if its tables could not be allocated
+ *
+ * \return BITOPS_CACHE_* bits of the selected tables
+ */
+uint32_t bitops_cache(void) {
+#ifndef BITOPS_NO_CACHE
+	return __atomic_load_n(&bitops_cache_requested, __ATOMIC_RELAXED);
+#else
+	return BITOPS_CACHE_OFF;
+#endif
+}
+
+/**
+ * \fn bitops_cache_footprint(void)
+ * \brief Reports the memory held by the string tables built so far, whether or not they are selected now
+ *
+ * \return Bytes of built tables: 0, BITOPS_CACHE_8_BYTES, or BITOPS_CACHE_8_BYTES + BITOPS_CACHE_16_BYTES
+ */
+size_t bitops_cache_footprint(void) {
+#ifndef BITOPS_NO_CACHE
+	uint32_t built = __atomic_load_n(&bitops_cache_built, __ATOMIC_ACQUIRE);
+
+	return ((built & BITOPS_CACHE_8) ? BITOPS_CACHE_8_BYTES : 0) + ((built & BITOPS_CACHE_16) ? BITOPS_CACHE_16_BYTES : 0);
+#else
+	return 0;
+#endif
+}
+
+/**
+ * \fn bitops_cpu_features(void)
+ * \brief Reports which instruction set extensions the chosen tier may use
+ *
+ * \return Bitwise OR of BITOPS_CPU_* flags
+ */
+uint32_t bitops_cpu_features(void) {
+	return bitops_table()->features;
+}
+
+/**
+ * \fn bitops_isa_name(bitops_isa_t isa)
+ * \brief Names an ISA tier the way BITOPS_ISA spells it
+ *
+ * \return "scalar", "sse2", "avx2" or "avx512", or "unknown" for any other value
+ */
+const char* bitops_isa_name(bitops_isa_t isa) {
+	return ((isa >= BITOPS_ISA_SCALAR) && (isa <= BITOPS_ISA_AVX512)) ? bitops_isa_names[isa] : "unknown";
+}
+
+/**
+ * \fn bitops_isa_parse(const char* name)
+ * \brief Looks up an ISA tier by the name BITOPS_ISA uses
+ *
+ * \return The tier, or a negative value if name is not one of "scalar", "sse2", "avx2" or "avx512"
+ */
+int bitops_isa_parse(const char* name) {
+	assert(name != NULL);
+
+	int isa;
+
+	for (isa = BITOPS_ISA_SCALAR; isa <= BITOPS_ISA_AVX512; isa++) {
+		if (strcmp(name, bitops_isa_names[isa]) == 0) {
+			return isa;
+		}
+	}
+
+	return EXIT_FAILURE_N;
+}
+
+/**
+ * \fn hexdump_emit_offset(char* dst, uint64_t offset)
+ * \brief Writes the low 32 bits of offset as 8 hex digits followed by the two-space gutter
+ *
+ * \param dst Pointer to at least HEXDUMP_OFFSET_CHARS + HEXDUMP_GUTTER_CHARS bytes
+ * \param offset The row offset to be printed
+ *
+ * \return Pointer just past the gutter
+ */
+static inline char* hexdump_emit_offset(char* dst, uint64_t offset) {
+	memcpy(dst + 0, hex_pair_table[HEXSTR_UPPER][(offset >> 24) & 0xFF], 2);
+	memcpy(dst + 2, hex_pair_table[HEXSTR_UPPER][(offset >> 16) & 0xFF], 2);
+	memcpy(dst + 4, hex_pair_table[HEXSTR_UPPER][(offset >> 8) & 0xFF], 2);
+	memcpy(dst + 6, hex_pair_table[HEXSTR_UPPER][offset & 0xFF], 2);
+	dst[8] = ' ';
+	dst[9] = ' ';
+
+	return dst + HEXDUMP_OFFSET_CHARS + HEXDUMP_GUTTER_CHARS;
+}
+
+/**
+ * \fn hexdump_emit_row(char* dst, uint64_t offset, const uint8_t* src)
+ * \brief Writes one complete 16-byte row, including the trailing newline, using one 4-byte store per byte
+ *
+ * \param dst Pointer to at least HEXDUMP_ROW_CHARS bytes
+ * \param offset The row offset to be printed
+ * \param src Pointer to the 16 bytes of the row
+ *
+ * \return None
+ */
+static inline void hexdump_emit_row(char* dst, uint64_t offset, const uint8_t* src) {
+	int i;
+
+	dst = hexdump_emit_offset(dst, offset);
+
+	///< Each store writes "XX " plus one byte that the next store overwrites
+	for (i = 0; i < HEXDUMP_BYTES_PER_ROW - 1; i++) {
+		memcpy(dst + (i * HEX_PAIR_STRIDE), hex_pair_table[HEXSTR_UPPER][src[i]], 4);
+	}
+
+	dst += (HEXDUMP_BYTES_PER_ROW - 1) * HEX_PAIR_STRIDE;
+	memcpy(dst, hex_pair_table[HEXSTR_UPPER][src[HEXDUMP_BYTES_PER_ROW - 1]], 2);
+	dst[2] = '\n';
+}
+
+/**
+ * \fn hexdump_emit_partial_row(char* dst, uint64_t offset, const uint8_t* src, size_t n)
+ * \brief Writes a final row holding fewer than 16 bytes, including the trailing newline
+ *
+ * \param dst Pointer to at least HEXDUMP_ROW_LEN(n) bytes
+ * \param offset The row offset to be printed
+ * \param src Pointer to the n bytes of the row
+ * \param n Number of bytes in the row (range from 1 to 15)
+ *
+ * \return None
+ */
+static void hexdump_emit_partial_row(char* dst, uint64_t offset, const uint8_t* src, size_t n) {
+	size_t i;
+
+	dst = hexdump_emit_offset(dst, offset);
+
+	for (i = 0; i < n; i++) {
+		memcpy(dst, hex_pair_table[HEXSTR_UPPER][src[i]], 2);
+		dst[2] = ' ';
+		dst += HEX_PAIR_STRIDE;
+	}
+
+	dst[-1] = '\n';
+}
+
+/**
+ * \fn hexdump_body(char* str, size_t size, const void* loc, size_t nbytes)
+ * \brief Does the work of hexdump; the public wrapper adds the STATS counters
+ */
+static inline char* hexdump_body(char* str, size_t size, const void* loc, size_t nbytes) {
+	assert(str != NULL);
+	assert((loc != NULL) || (nbytes == 0));
+
+	hexdump_stream_t stream;
+	size_t consumed;
+	size_t current_byte;
+
+	if (size < hexdump_len(nbytes) + NULL_TERMINATOR_BYTE) {
+		if (size > 0) {
+			str[0] = '\0';
+		}
+		return str;
+	}
+
+	hexdump_init(&stream);
+	current_byte = hexdump_feed(&stream, str, size, loc, nbytes, &consumed);
+	current_byte += hexdump_finish(&stream, str + current_byte, size - current_byte);
+
+	///< Terminate str with NULL
+	str[current_byte] = '\0';
+
+	return str;
+}
+
+/**
+ * \fn hexdump(char* str, size_t size, const void* loc, size_t nbytes)
+ * \brief Returns a string representing a dump of nbytes of memory starting at loc. Bytes are printed up to 16 bytes per line, separate by newlines. Each row will begin with the offset in bytes from loc, in hex.
+ *
+ * \param str Pointer to a char array
+ * \param size Num of bytes of the char array pointed to by str
+ * \param loc Starting location of memory to begin dumping bytes from
+ * \param nbytes The number of bytes to read from loc
+ *
+ * \return If successful, returns the char* str which facilitates daisy-chaining this function into other string manipulation functions (such as puts). In the case of an error (i.e. str is not large enough to hold the requested hex dump), str will be set to empty.
+ */
+char* hexdump(char* str, size_t size, const void* loc, size_t nbytes) {
+	BITOPS_STAT_START();
+	char* result = hexdump_body(str, size, loc, nbytes);
+
+	BITOPS_STAT_STOP(BITOPS_STAT_HEXDUMP, 0, (size < hexdump_len(nbytes) + NULL_TERMINATOR_BYTE) ? 0 : hexdump_len(nbytes), size < hexdump_len(nbytes) + NULL_TERMINATOR_BYTE);
+
+	return result;
+}
+
+/**
+ * \fn hexdump_len(size_t nbytes)
+ * \brief Computes the number of characters hexdump will produce for nbytes of input
+ *
+ * \param nbytes The number of bytes to be dumped
+ *
+ * \return The number of characters in the dump, not including the terminal \0
+ */
+size_t hexdump_len(size_t nbytes) {
+	size_t full_rows = nbytes / HEXDUMP_BYTES_PER_ROW;
+	size_t tail = nbytes % HEXDUMP_BYTES_PER_ROW;
+
+	return (full_rows * HEXDUMP_ROW_CHARS) + ((tail > 0) ? HEXDUMP_ROW_LEN(tail) : 0);
+}
+
+/**
+ * \fn hexdump_init(hexdump_stream_t* stream)
+ * \brief Prepares a stream for a new dump whose first row will be labeled with offset 0
+ *
+ * \param stream Pointer to caller-owned stream state
+ *
+ * \return None
+ */
+void hexdump_init(hexdump_stream_t* stream) {
+	assert(stream != NULL);
+
+	stream->offset = 0;
+	stream->npending = 0;
+}
+
+/**
+ * \fn hexdump_feed(hexdump_stream_t* stream, char* str, size_t size, const void* loc, size_t nbytes, size_t* consumed)
+ * \brief Formats as many complete rows of loc as fit in str. Trailing bytes that do not fill a row are held in stream until the next feed or finish
+ *
+ * \param stream Pointer to stream state set up by hexdump_init
+ * \param str Pointer to a char array receiving the rows (not null-terminated)
+ * \param size Num of bytes of the char array pointed to by str
+ * \param loc Starting location of memory to continue dumping bytes from
+ * \param nbytes The number of bytes available at loc
+ * \param consumed Set to the number of bytes of loc that were taken by the stream. The caller should feed the remaining bytes again once str has been drained
+ *
+ * \return The number of characters written to str
+ */
+size_t hexdump_feed(hexdump_stream_t* stream, char* str, size_t size, const void* loc, size_t nbytes, size_t* consumed) {
+	assert(stream != NULL);
+	assert(str != NULL);
+	assert((loc != NULL) || (nbytes == 0));
+	assert(consumed != NULL);
+
+	const uint8_t* src = (const uint8_t*)loc;
+	size_t used = 0;
+	size_t current_byte = 0;
+	size_t take;
+
+	if (stream->npending > 0) {
+		take = HEXDUMP_BYTES_PER_ROW - stream->npending;
+		if (take > nbytes) {
+			take = nbytes;
+		}
+
+		if (stream->npending + take == HEXDUMP_BYTES_PER_ROW) {
+			if (size < HEXDUMP_ROW_CHARS) {
+				*consumed = 0;
+				return 0;
+			}
+			memcpy(stream->pending + stream->npending, src, take);
+			hexdump_emit_row(str, stream->offset, stream->pending);
+			stream->offset += HEXDUMP_BYTES_PER_ROW;
+			stream->npending = 0;
+			current_byte += HEXDUMP_ROW_CHARS;
+		}
+		else {
+			memcpy(stream->pending + stream->npending, src, take);
+			stream->npending += take;
+		}
+		used = take;
+	}
+
+	while ((nbytes - used >= HEXDUMP_BYTES_PER_ROW) && (size - current_byte >= HEXDUMP_ROW_CHARS)) {
+		hexdump_emit_row(str + current_byte, stream->offset, src + used);
+		stream->offset += HEXDUMP_BYTES_PER_ROW;
+		used += HEXDUMP_BYTES_PER_ROW;
+		current_byte += HEXDUMP_ROW_CHARS;
+	}
+
+	///< Only hold back a partial row once every complete row has been emitted
+	if (nbytes - used < HEXDUMP_BYTES_PER_ROW) {
+		memcpy(stream->pending + stream->npending, src + used, nbytes - used);
+		stream->npending += nbytes - used;
+		used = nbytes;
+	}
+
+	*consumed = used;
+
+	return current_byte;
+}
+
+/**
+ * \fn hexdump_finish(hexdump_stream_t* stream, char* str, size_t size)
+ * \brief Formats the final partial row held in stream, if any
+ *
+ * \param stream Pointer to stream state
+ * \param str Pointer to a char array receiving the row (not null-terminated)
+ * \param size Num of bytes of the char array pointed to by str (HEXDUMP_ROW_CHARS is always enough)
+ *
+ * \return The number of characters written to str. If str is too small nothing is written, 0 is returned and the partial row stays in stream
+ */
+size_t hexdump_finish(hexdump_stream_t* stream, char* str, size_t size) {
+	assert(stream != NULL);
+	assert(str != NULL);
+
+	size_t nchars;
+
+	if (stream->npending == 0) {
+		return 0;
+	}
+
+	nchars = HEXDUMP_ROW_LEN(stream->npending);
+	if (size < nchars) {
+		return 0;
+	}
+
+	hexdump_emit_partial_row(str, stream->offset, stream->pending, stream->npending);
+	stream->offset += stream->npending;
+	stream->npending = 0;
+
+	return nchars;
+}
+
+typedef struct {
+	char* dst;
+	const uint8_t* src;
+	size_t first_row;
+	size_t nrows;
+	size_t tail;
+} hexdump_chunk_t;
+
+/**
+ * \fn hexdump_chunk_worker(void* arg)
+ * \brief Formats one chunk of rows straight into its precomputed slot of the output string
+ *
+ * \param arg Pointer to the hexdump_chunk_t describing the chunk
+ *
+ * \return NULL
+ */
+static void* hexdump_chunk_worker(void* arg) {
+	const hexdump_chunk_t* chunk = (const hexdump_chunk_t*)arg;
+	char* dst = chunk->dst;
+	const uint8_t* src = chunk->src;
+	uint64_t offset = (uint64_t)chunk->first_row * HEXDUMP_BYTES_PER_ROW;
+	size_t i;
+
+	for (i = 0; i < chunk->nrows; i++) {
+		hexdump_emit_row(dst, offset, src);
+		dst += HEXDUMP_ROW_CHARS;
+		src += HEXDUMP_BYTES_PER_ROW;
+		offset += HEXDUMP_BYTES_PER_ROW;
+	}
+
+	if (chunk->tail > 0) {
+		hexdump_emit_partial_row(dst, offset, src, chunk->tail);
+	}
+
+	return NULL;
+}
+
+/**
+ * \fn hexdump_parallel(char* str, size_t size, const void* loc, size_t nbytes, int nthreads)
+ * \brief Same output as hexdump, produced by up to nthreads threads. The input is split on row boundaries and, because every full row is exactly HEXDUMP_ROW_CHARS long, each thread writes its rows directly into their final place in str
+ *
+ * \param str Pointer to a char array
+ * \param size Num of bytes of the char array pointed to by str
+ * \param loc Starting location of memory to begin dumping bytes from
+ * \param nbytes The number of bytes to read from loc
+ * \param nthreads The maximum number of threads to use, including the calling thread (below 1 means 1, above HEXDUMP_PARALLEL_MAX_THREADS means that many). Small dumps use fewer threads
+ *
+ * \return If successful, returns the char* str. In the case of an error (i.e. str is not large enough to hold the requested hex dump), str will be set to empty.
+ */
+char* hexdump_parallel(char* str, size_t size, const void* loc, size_t nbytes, int nthreads) {
+	assert(str != NULL);
+	assert((loc != NULL) || (nbytes == 0));
+
+	hexdump_chunk_t chunks[HEXDUMP_PARALLEL_MAX_THREADS];
+	pthread_t threads[HEXDUMP_PARALLEL_MAX_THREADS];
+	int started[HEXDUMP_PARALLEL_MAX_THREADS];
+	size_t total_rows = nbytes / HEXDUMP_BYTES_PER_ROW;
+	size_t rows_per_chunk;
+	size_t first_row = 0;
+	size_t max_chunks;
+	int nchunks;
+	int i;
+
+	if (size < hexdump_len(nbytes) + NULL_TERMINATOR_BYTE) {
+		if (size > 0) {
+			str[0] = '\0';
+		}
+		return str;
+	}
+
+	///< Keep each thread's share large enough to pay for starting it
+	max_chunks = total_rows / HEXDUMP_PARALLEL_MIN_ROWS;
+	nchunks = (nthreads < 1) ? 1 : ((nthreads > HEXDUMP_PARALLEL_MAX_THREADS) ? HEXDUMP_PARALLEL_MAX_THREADS : nthreads);
+	if ((size_t)nchunks > max_chunks) {
+		nchunks = (int)max_chunks;
+	}
+	if (nchunks <= 1) {
+		return hexdump(str, size, loc, nbytes);
+	}
+
+	rows_per_chunk = (total_rows + (size_t)nchunks - 1) / (size_t)nchunks;
+
+	for (i = 0; i < nchunks; i++) {
+		chunks[i].first_row = first_row;
+		chunks[i].nrows = ((total_rows - first_row) < rows_per_chunk) ? (total_rows - first_row) : rows_per_chunk;
+		chunks[i].dst = str + (first_row * HEXDUMP_ROW_CHARS);
+		chunks[i].src = (const uint8_t*)loc + (first_row * HEXDUMP_BYTES_PER_ROW);
+		chunks[i].tail = 0;
+		first_row += chunks[i].nrows;
+	}
+	chunks[nchunks - 1].tail = nbytes % HEXDUMP_BYTES_PER_ROW;
+
+	///< The calling thread takes chunk 0; a chunk whose thread cannot be started is formatted inline
+	for (i = 1; i < nchunks; i++) {
+		started[i] = (pthread_create(&threads[i], NULL, hexdump_chunk_worker, &chunks[i]) == 0);
+	}
+
+	hexdump_chunk_worker(&chunks[0]);
+
+	for (i = 1; i < nchunks; i++) {
+		if (started[i]) {
+			pthread_join(threads[i], NULL);
+		}
+		else {
+			hexdump_chunk_worker(&chunks[i]);
+		}
+	}
+
+	///< Terminate str with NULL
+	str[hexdump_len(nbytes)] = '\0';
+
+	return str;
+}
+
+int test_uint_to_binstr(char* str, size_t size, uint32_t num, uint8_t nbits) {
+	int i;
+	int num_chars;
+	int return_code = EXIT_TEST_SUCCESS;
+
+	num_chars = uint_to_binstr(str, size, (uint32_t)TEST_1A_DEC, TEST_1A_BITS);
+
+	if (num_chars != (int)TEST_1A_RETURN) {
+		return_code = EXIT_TEST_FAILURE;
+	}
+
+	for (i = 0; i < num_chars; i++) {
+		if (str[i] != TEST_1A_EXPECTED[i]) {
+			printf("test_uint_to_binstr: TEST_A (FAILURE): num = %u, nbits = %u, EXPECT[%d] = %c, return value = %d\n", (uint32_t)TEST_1A_DEC, (uint8_t)TEST_1A_BITS, i, TEST_1A_EXPECTED[i], (int)TEST_1A_RETURN);
+			printf("                                       num = %u, nbits = %u, RESULT[%d] = %c, return value = %d\n", (uint32_t)TEST_1A_DEC, (uint8_t)TEST_1A_BITS, i, str[i], num_chars);
+			return_code = EXIT_TEST_FAILURE;
+		}
+	}
+
+	printf("test_uint_to_binstr: TEST_A (EXPECT) : num = %u, nbits = %u, EXPECT = %s, return value = %d\n", (uint32_t)TEST_1A_DEC, (uint8_t)TEST_1A_BITS, TEST_1A_EXPECTED, (int)TEST_1A_RETURN);
+	printf("test_uint_to_binstr: TEST_A (RESULT) : num = %u, nbits = %u, RESULT = %s, return value = %d\n", (uint32_t)TEST_1A_DEC, (uint8_t)TEST_1A_BITS, str,num_chars);
+
+	num_chars = uint_to_binstr(str, size, (uint32_t)TEST_1B_DEC, TEST_1B_BITS);
+
+	if (num_chars != (int)TEST_1B_RETURN) {
+		return_code = EXIT_TEST_FAILURE;
+	}
+
+	for (i = 0; i < num_chars; i++) {
+		if (str[i] != TEST_1B_EXPECTED[i]) {
+			printf("test_uint_to_binstr: TEST_B (FAILURE): num = %u, nbits = %u, EXPECT[%d] = %c, return value = %d\n", (uint32_t)TEST_1B_DEC, (uint8_t)TEST_1B_BITS, i, TEST_1B_EXPECTED[i], (int)TEST_1B_RETURN);
+			printf("                                       num = %u, nbits = %u, RESULT[%d] = %c, return value = %d\n", (uint32_t)TEST_1B_DEC, (uint8_t)TEST_1B_BITS, i, str[i], num_chars);
+			return_code = EXIT_TEST_FAILURE;
+		}
+	}
+	printf("test_uint_to_binstr: TEST_B (EXPECT) : num = %u, nbits = %u, EXPECT = %s, return value = %d\n", (uint32_t)TEST_1B_DEC, (uint8_t)TEST_1B_BITS, TEST_1B_EXPECTED, (int)TEST_1B_RETURN);
+	printf("test_uint_to_binstr: TEST_B (RESULT) : num = %u, nbits = %u, RESULT = %s, return value = %d\n", (uint32_t)TEST_1B_DEC, (uint8_t)TEST_1B_BITS, str, num_chars);
+
+	num_chars = uint_to_binstr(str, size, (uint32_t)TEST_1C_DEC, TEST_1C_BITS);
+
+	if (num_chars != (int)TEST_1C_RETURN) {
+		return_code = EXIT_TEST_FAILURE;
+	}
+
+	for (i = 0; i < num_chars; i++) {
+		if (str[i] != TEST_1C_EXPECTED[i]) {
+			printf("test_uint_to_binstr: TEST_C (FAILURE): num = %u, nbits = %u, EXPECT[%d] = %c, return value = %d\n", (uint32_t)TEST_1C_DEC, (uint8_t)TEST_1C_BITS, i, TEST_1C_EXPECTED[i], (int)TEST_1C_RETURN);
+			printf("                                       num = %u, nbits = %u, RESULT[%d] = %c, return value = %d\n", (uint32_t)TEST_1C_DEC, (uint8_t)TEST_1C_BITS, i, str[i], num_chars);
+			return_code = EXIT_TEST_FAILURE;
+		}
+	}
+	printf("test_uint_to_binstr: TEST_C (EXPECT) : num = %u, nbits = %u, EXPECT = %s, return value = %d\n", (uint32_t)TEST_1C_DEC, (uint8_t)TEST_1C_BITS, TEST_1C_EXPECTED, (int)TEST_1C_RETURN);
+	printf("test_uint_to_binstr: TEST_C (RESULT) : num = %u, nbits = %u, RESULT = %s, return value = %d\n", (uint32_t)TEST_1C_DEC, (uint8_t)TEST_1C_BITS, str, num_chars);
+
+	return return_code;
+}
+
+int test_int_to_binstr(char* str, size_t size, int32_t num, uint8_t nbits) {
+	int i;
+	int num_chars;
+	int return_code = EXIT_TEST_SUCCESS;
+
+	num_chars = int_to_binstr(str, size, (uint32_t)TEST_2A_DEC, TEST_2A_BITS);
+
+	if (num_chars != (int)TEST_2A_RETURN) {
+		return_code = EXIT_TEST_FAILURE;
+	}
+
+	for (i = 0; i < num_chars; i++) {
+		if (str[i] != TEST_2A_EXPECTED[i]) {
+			printf("test_int_to_binstr: TEST_A (FAILURE): num = %d, nbits = %u, EXPECT[%d] = %c, return value = %d\n", (uint32_t)TEST_2A_DEC, (uint8_t)TEST_2A_BITS, i, TEST_2A_EXPECTED[i], (int)TEST_2A_RETURN);
+			printf("                                      num = %d, nbits = %u, RESULT[%d] = %c, return value = %d\n", (uint32_t)TEST_2A_DEC, (uint8_t)TEST_2A_BITS, i, str[i], num_chars);
+			return_code = EXIT_TEST_FAILURE;
+		}
+	}
+	printf("test_int_to_binstr: TEST_A (EXPECT) : num = %d, nbits = %u, EXPECT = %s, return value = %d\n", (uint32_t)TEST_2A_DEC, (uint8_t)TEST_2A_BITS, TEST_2A_EXPECTED, (int)TEST_2A_RETURN);
+	printf("test_int_to_binstr: TEST_A (RESULT) : num = %d, nbits = %u, RESULT = %s, return value = %d\n", (uint32_t)TEST_2A_DEC, (uint8_t)TEST_2A_BITS, str, num_chars);
+
+	num_chars = int_to_binstr(str, size, (uint32_t)TEST_2B_DEC, TEST_2B_BITS);
+
+	if (num_chars != (int)TEST_2B_RETURN) {
+		return_code = EXIT_TEST_FAILURE;
+	}
+
+	for (i = 0; i < num_chars; i++) {
+		if (str[i] != TEST_2B_EXPECTED[i]) {
+			printf("test_int_to_binstr: TEST_B (FAILURE): num = %d, nbits = %u, EXPECT[%d] = %c, return value = %d\n", (uint32_t)TEST_2B_DEC, (uint8_t)TEST_2B_BITS, i, TEST_2B_EXPECTED[i], (int)TEST_2B_RETURN);
+			printf("                                      num = %d, nbits = %u, RESULT[%d] = %c, return value = %d\n", (uint32_t)TEST_2B_DEC, (uint8_t)TEST_2B_BITS, i, str[i], num_chars);
+			return_code = EXIT_TEST_FAILURE;
+		}
+	}
+	printf("test_int_to_binstr: TEST_B (EXPECT) : num = %d, nbits = %u, EXPECT = %s, return value = %d\n", (uint32_t)TEST_2B_DEC, (uint8_t)TEST_2B_BITS, TEST_2B_EXPECTED, (int)TEST_2B_RETURN);
+	printf("test_int_to_binstr: TEST_B (RESULT) : num = %d, nbits = %u, RESULT = %s, return value = %d\n", (uint32_t)TEST_2B_DEC, (uint8_t)TEST_2B_BITS, str, num_chars);
+
+	num_chars = int_to_binstr(str, size, (uint32_t)TEST_2C_DEC, TEST_2C_BITS);
+
+	if (num_chars != (int)TEST_2C_RETURN) {
+		return_code = EXIT_TEST_FAILURE;
+	}
+
+	for (i = 0; i < num_chars; i++) {
+		if (str[i] != TEST_2C_EXPECTED[i]) {
+			printf("test_int_to_binstr: TEST_C (FAILURE): num = %d, nbits = %u, EXPECT[%d] = %c, return value = %d\n", (uint32_t)TEST_2C_DEC, (uint8_t)TEST_2C_BITS, i, TEST_2C_EXPECTED[i], (int)TEST_2C_RETURN);
+			printf("                                      num = %d, nbits = %u, RESULT[%d] = %c, return value = %d\n", (uint32_t)TEST_2C_DEC, (uint8_t)TEST_2C_BITS, i, str[i], num_chars);
+			return_code = EXIT_TEST_FAILURE;
+		}
+	}
+	printf("test_int_to_binstr: TEST_C (EXPECT) : num = %d, nbits = %u, EXPECT = %s, return value = %d\n", (uint32_t)TEST_2C_DEC, (uint8_t)TEST_2C_BITS, TEST_2C_EXPECTED, (int)TEST_2C_RETURN);
+	printf("test_int_to_binstr: TEST_C (RESULT) : num = %d, nbits = %u, RESULT = %s, return value = %d\n", (uint32_t)TEST_2C_DEC, (uint8_t)TEST_2C_BITS, str, num_chars);
+
+	return return_code;
+}
+
+int test_uint_to_hexstr(char* str, size_t size, uint32_t num, uint8_t nbits) {
+	int i;
+	int num_chars;
+	int return_code = EXIT_TEST_SUCCESS;
+
+	num_chars = uint_to_hexstr(str, size, (uint32_t)TEST_3A_DEC, TEST_3A_BITS);
+
+	if (num_chars != (int)TEST_3A_RETURN) {
+		return_code = EXIT_TEST_FAILURE;
+	}
+
+	for (i = 0; i < num_chars; i++) {
+		if (str[i] != TEST_3A_EXPECTED[i]) {
+			printf("test_uint_to_hexstr: TEST_A (FAILURE): num = %u, nbits = %u, EXPECT[%d] = %c, return value = %d\n", (uint32_t)TEST_3A_DEC, (uint8_t)TEST_3A_BITS, i, TEST_3A_EXPECTED[i], (int)TEST_3A_RETURN);
+			printf("                                       num = %u, nbits = %u, RESULT[%d] = %c, return value = %d\n", (uint32_t)TEST_3A_DEC, (uint8_t)TEST_3A_BITS, i, str[i], num_chars);
+			return_code = EXIT_TEST_FAILURE;
+		}
+	}
+	printf("test_uint_to_hexstr: TEST_A (EXPECT) : num = %u, nbits = %u, EXPECT = %s, return value = %d\n", (uint32_t)TEST_3A_DEC, (uint8_t)TEST_3A_BITS, TEST_3A_EXPECTED, (int)TEST_3A_RETURN);
+	printf("test_uint_to_hexstr: TEST_A (RESULT) : num = %u, nbits = %u, RESULT = %s, return value = %d\n", (uint32_t)TEST_3A_DEC, (uint8_t)TEST_3A_BITS, str, num_chars);
+
+	num_chars = uint_to_hexstr(str, size, (uint32_t)TEST_3B_DEC, TEST_3B_BITS);
+
+	if (num_chars != (int)TEST_3B_RETURN) {
+		return_code = EXIT_TEST_FAILURE;
+	}
+
+	for (i = 0; i < num_chars; i++) {
+		if (str[i] != TEST_3B_EXPECTED[i]) {
+			printf("test_uint_to_hexstr: TEST_B (FAILURE): num = %u, nbits = %u, EXPECT[%d] = %c, return value = %d\n", (uint32_t)TEST_3B_DEC, (uint8_t)TEST_3B_BITS, i, TEST_3B_EXPECTED[i], (int)TEST_3B_RETURN);
+			printf("                                       num = %u, nbits = %u, RESULT[%d] = %c, return value = %d\n", (uint32_t)TEST_3B_DEC, (uint8_t)TEST_3B_BITS, i, str[i], num_chars);
+			return_code = EXIT_TEST_FAILURE;
+		}
+	}
+	printf("test_uint_to_hexstr: TEST_B (EXPECT) : num = %u, nbits = %u, EXPECT = %s, return value = %d\n", (uint32_t)TEST_3B_DEC, (uint8_t)TEST_3B_BITS, TEST_3B_EXPECTED, (int)TEST_3B_RETURN);
+	printf("test_uint_to_hexstr: TEST_B (RESULT) : num = %u, nbits = %u, RESULT = %s, return value = %d\n", (uint32_t)TEST_3B_DEC, (uint8_t)TEST_3B_BITS, str, num_chars);
+
+	num_chars = uint_to_hexstr(str, size, (uint32_t)TEST_3C_DEC, TEST_3C_BITS);
+
+	if (num_chars != (int)TEST_3C_RETURN) {
+		return_code = EXIT_TEST_FAILURE;
+	}
+
+	for (i = 0; i < num_chars; i++) {
+		if (str[i] != TEST_3C_EXPECTED[i]) {
+			printf("test_uint_to_hexstr: TEST_C (FAILURE): num = %u, nbits = %u, EXPECT[%d] = %c, return value = %d\n", (uint32_t)TEST_3C_DEC, (uint8_t)TEST_3C_BITS, i, TEST_3C_EXPECTED[i], (int)TEST_3C_RETURN);
+			printf("                                       num = %u, nbits = %u, RESULT[%d] = %c, return value = %d\n", (uint32_t)TEST_3C_DEC, (uint8_t)TEST_3C_BITS, i, str[i], num_chars);
+			return_code = EXIT_TEST_FAILURE;
+		}
+	}
+	printf("test_uint_to_hexstr: TEST_C (EXPECT) : num = %u, nbits = %u, EXPECT = %s, return value = %d\n", (uint32_t)TEST_3C_DEC, (uint8_t)TEST_3C_BITS, TEST_3C_EXPECTED, (int)TEST_3C_RETURN);
+	printf("test_uint_to_hexstr: TEST_C (RESULT) : num = %u, nbits = %u, RESULT = %s, return value = %d\n", (uint32_t)TEST_3C_DEC, (uint8_t)TEST_3C_BITS, str, num_chars);
+
+	return return_code;
+}
+
+int test_twiggle_bit(uint32_t input, int bit, operation_t operation) {
+	uint32_t output;
+	int return_code = EXIT_TEST_SUCCESS;
+
+	output = twiggle_bit((uint32_t)TEST_4A_DEC, (int)TEST_4A_BIT, (operation_t)TEST_4A_OP);
+
+	if (output != TEST_4A_EXPECTED) {
+		return_code = EXIT_TEST_FAILURE;
+	}
+
+	printf("test_twiggle_bit: TEST_A (EXPECT) : input = %u, bit = %d, operation = %s EXPECT = %u\n", (uint32_t)TEST_4A_DEC, (int)TEST_4A_BIT, ((TEST_4A_OP == CLEAR) ? "CLEAR" : ((TEST_4A_OP == SET) ? "SET" : ((TEST_4A_OP == TOGGLE) ? "TOGGLE" : "UNKNOWN"))), TEST_4A_EXPECTED);
+	printf("test_twiggle_bit: TEST_A (RESULT) : input = %u, bit = %d, operation = %s RESULT = %u\n", (uint32_t)TEST_4A_DEC, (int)TEST_4A_BIT, ((TEST_4A_OP == CLEAR) ? "CLEAR" : ((TEST_4A_OP == SET) ? "SET" : ((TEST_4A_OP == TOGGLE) ? "TOGGLE" : "UNKNOWN"))), output);
+
+	output = twiggle_bit((uint32_t)TEST_4B_DEC, (int)TEST_4B_BIT, (operation_t)TEST_4B_OP);
+
+	if (output != TEST_4B_EXPECTED) {
+		return_code = EXIT_TEST_FAILURE;
+	}
+
+	printf("test_twiggle_bit: TEST_B (EXPECT) : input = %u, bit = %d, operation = %s EXPECT = %u\n", (uint32_t)TEST_4B_DEC, (int)TEST_4B_BIT, ((TEST_4B_OP == CLEAR) ? "CLEAR" : ((TEST_4B_OP == SET) ? "SET" : ((TEST_4B_OP == TOGGLE) ? "TOGGLE" : "UNKNOWN"))), TEST_4B_EXPECTED);
+	printf("test_twiggle_bit: TEST_B (RESULT) : input = %u, bit = %d, operation = %s RESULT = %u\n", (uint32_t)TEST_4B_DEC, (int)TEST_4B_BIT, ((TEST_4B_OP == CLEAR) ? "CLEAR" : ((TEST_4B_OP == SET) ? "SET" : ((TEST_4B_OP == TOGGLE) ? "TOGGLE" : "UNKNOWN"))), output);
+
+	output = twiggle_bit((uint32_t)TEST_4C_DEC, (int)TEST_4C_BIT, (operation_t)TEST_4C_OP);
+
+	if (output != TEST_4C_EXPECTED) {
+		return_code = EXIT_TEST_FAILURE;
+	}
+
+	printf("test_twiggle_bit: TEST_C (EXPECT) : input = %u, bit = %d, operation = %s EXPECT = %u\n", (uint32_t)TEST_4C_DEC, (int)TEST_4C_BIT, ((TEST_4C_OP == CLEAR) ? "CLEAR" : ((TEST_4C_OP == SET) ? "SET" : ((TEST_4C_OP == TOGGLE) ? "TOGGLE" : "UNKNOWN"))), TEST_4C_EXPECTED);
+	printf("test_twiggle_bit: TEST_C (RESULT) : input = %u, bit = %d, operation = %s RESULT = %u\n", (uint32_t)TEST_4C_DEC, (int)TEST_4C_BIT, ((TEST_4C_OP == CLEAR) ? "CLEAR" : ((TEST_4C_OP == SET) ? "SET" : ((TEST_4C_OP == TOGGLE) ? "TOGGLE" : "UNKNOWN"))), output);
+
+	output = twiggle_bit((uint32_t)TEST_4D_DEC, (int)TEST_4D_BIT, (operation_t)TEST_4D_OP);
+
+	if (output != TEST_4D_EXPECTED) {
+		return_code = EXIT_TEST_FAILURE;
+	}
+
+	printf("test_twiggle_bit: TEST_D (EXPECT) : input = %u, bit = %d, operation = %s EXPECT = %u\n", (uint32_t)TEST_4D_DEC, (int)TEST_4D_BIT, ((TEST_4D_OP == CLEAR) ? "CLEAR" : ((TEST_4D_OP == SET) ? "SET" : ((TEST_4D_OP == TOGGLE) ? "TOGGLE" : "UNKNOWN"))), TEST_4D_EXPECTED);
+	printf("test_twiggle_bit: TEST_D (RESULT) : input = %u, bit = %d, operation = %s RESULT = %u\n", (uint32_t)TEST_4D_DEC, (int)TEST_4D_BIT, ((TEST_4D_OP == CLEAR) ? "CLEAR" : ((TEST_4D_OP == SET) ? "SET" : ((TEST_4D_OP == TOGGLE) ? "TOGGLE" : "UNKNOWN"))), output);
+
+	return return_code;
+}
+
+int test_grab_three_bits(uint32_t input, int start_bit) {
+	uint32_t output;
+	int return_code = EXIT_TEST_SUCCESS;
+
+	output = grab_three_bits((uint32_t)TEST_5A_DEC, (int)TEST_5A_SBIT);
+
+	if (output != TEST_5A_EXPECTED) {
+		return_code = EXIT_TEST_FAILURE;
+	}
+
+	printf("test_grab_three_bits: TEST_A (EXPECT) : input = %u, start_bit = %d, EXPECT = %u\n", (uint32_t)TEST_5A_DEC, (int)TEST_5A_SBIT, TEST_5A_EXPECTED);
+	printf("test_grab_three_bits: TEST_A (RESULT) : input = %u, start_bit = %d, RESULT = %u\n", (uint32_t)TEST_5A_DEC, (int)TEST_5A_SBIT, output);
+
+	output = grab_three_bits((uint32_t)TEST_5B_DEC, (int)TEST_5B_SBIT);
+
+	if (output != TEST_5B_EXPECTED) {
+		return_code = EXIT_TEST_FAILURE;
+	}
+
+	printf("test_grab_three_bits: TEST_B (EXPECT) : input = %u, start_bit = %d, EXPECT = %u\n", (uint32_t)TEST_5B_DEC, (int)TEST_5B_SBIT, TEST_5B_EXPECTED);
+	printf("test_grab_three_bits: TEST_B (RESULT) : input = %u, start_bit = %d, RESULT = %u\n", (uint32_t)TEST_5B_DEC, (int)TEST_5B_SBIT, output);
+
+	return return_code;
+}
+
+/**
+ * \fn hexdump_reference(char* str, const uint8_t* src, size_t nbytes)
+ * \brief Builds the expected hexdump output one byte at a time with sprintf, for comparison against hexdump
+ *
+ * \param str Pointer to a char array large enough for hexdump_len(nbytes) + 1 bytes
+ * \param src Pointer to the bytes to be dumped
+ * \param nbytes The number of bytes to dump
+ *
+ * \return The number of characters written to str, not including the terminal \0
+ */
+static size_t hexdump_reference(char* str, const uint8_t* src, size_t nbytes) {
+	size_t i;
+	size_t current_byte = 0;
+
+	for (i = 0; i < nbytes; i++) {
+		if (i % HEXDUMP_BYTES_PER_ROW == 0) {
+			current_byte += sprintf(str + current_byte, "%08X  ", (uint32_t)i);
+		}
+
+		current_byte += sprintf(str + current_byte, "%02X", src[i]);
+
+		if ((i % HEXDUMP_BYTES_PER_ROW == HEXDUMP_BYTES_PER_ROW - 1) || (i == nbytes - 1)) {
+			str[current_byte++] = '\n';
+		}
+		else {
+			str[current_byte++] = ' ';
+		}
+	}
+
+	///< Terminate str with NULL
+	str[current_byte] = '\0';
+
+	return current_byte;
+}
+
+int test_hexdump(char* str, size_t size, const void* loc, size_t nbytes) {
+	size_t i;
+	size_t expected_chars;
+	size_t num_chars;
+	size_t used;
+	size_t consumed;
+	size_t take;
+	char window[TEST_6B_WINDOW];
+	hexdump_stream_t stream;
+	int return_code = EXIT_TEST_SUCCESS;
+
+	for (i = 0; i < TEST_6_DATA_BYTES; i++) {
+		TEST_6_DATA[i] = (uint8_t)((i * 37u) ^ (i >> 3));
+	}
+
+	expected_chars = hexdump_reference(TEST_6_EXPECTED, TEST_6_DATA, TEST_6A_NBYTES);
+	hexdump(str, size, TEST_6_DATA, TEST_6A_NBYTES);
+	num_chars = strlen(str);
+
+	if ((num_chars != expected_chars) || (memcmp(str, TEST_6_EXPECTED, expected_chars) != 0)) {
+		printf("test_hexdump: TEST_A (FAILURE): nbytes = %u, EXPECT length = %u, RESULT length = %u\n", TEST_6A_NBYTES, (uint32_t)expected_chars, (uint32_t)num_chars);
+		return_code = EXIT_TEST_FAILURE;
+	}
+	printf("test_hexdump: TEST_A (EXPECT) : nbytes = %u, EXPECT =\n%s", TEST_6A_NBYTES, TEST_6_EXPECTED);
+	printf("test_hexdump: TEST_A (RESULT) : nbytes = %u, RESULT =\n%s", TEST_6A_NBYTES, str);
+
+	///< Stream the dump through a small fixed window in odd-sized feeds and stitch the windows back together
+	expected_chars = hexdump_reference(TEST_6_EXPECTED, TEST_6_DATA, TEST_6B_NBYTES);
+	hexdump_init(&stream);
+	num_chars = 0;
+	used = 0;
+
+	while (used < TEST_6B_NBYTES) {
+		take = ((TEST_6B_NBYTES - used) < TEST_6B_CHUNK) ? (TEST_6B_NBYTES - used) : TEST_6B_CHUNK;
+		i = hexdump_feed(&stream, window, sizeof(window), TEST_6_DATA + used, take, &consumed);
+		memcpy(str + num_chars, window, i);
+		num_chars += i;
+		used += consumed;
+	}
+	i = hexdump_finish(&stream, window, sizeof(window));
+	memcpy(str + num_chars, window, i);
+	num_chars += i;
+	str[num_chars] = '\0';
+
+	if ((num_chars != expected_chars) || (memcmp(str, TEST_6_EXPECTED, expected_chars) != 0)) {
+		printf("test_hexdump: TEST_B (FAILURE): nbytes = %u, EXPECT length = %u, RESULT length = %u\n", TEST_6B_NBYTES, (uint32_t)expected_chars, (uint32_t)num_chars);
+		return_code = EXIT_TEST_FAILURE;
+	}
+	printf("test_hexdump: TEST_B (EXPECT) : nbytes = %u, chunk = %u, window = %u, EXPECT length = %u\n", TEST_6B_NBYTES, TEST_6B_CHUNK, TEST_6B_WINDOW, (uint32_t)expected_chars);
+	printf("test_hexdump: TEST_B (RESULT) : nbytes = %u, chunk = %u, window = %u, RESULT length = %u\n", TEST_6B_NBYTES, TEST_6B_CHUNK, TEST_6B_WINDOW, (uint32_t)num_chars);
+
+	///< A buffer too small for the whole dump must come back as the empty string
+	hexdump(str, TEST_6C_SIZE, TEST_6_DATA, TEST_6C_NBYTES);
+
+	if (str[0] != '\0') {
+		return_code = EXIT_TEST_FAILURE;
+	}
+	printf("test_hexdump: TEST_C (EXPECT) : nbytes = %u, size = %u, EXPECT = \"\"\n", TEST_6C_NBYTES, TEST_6C_SIZE);
+	printf("test_hexdump: TEST_C (RESULT) : nbytes = %u, size = %u, RESULT = \"%s\"\n", TEST_6C_NBYTES, TEST_6C_SIZE, str);
+
+	return return_code;
+}
+
+/**
+ * \fn test_rand32(uint32_t* state)
+ * \brief Small xorshift generator shared by the tests, so each one is reproducible from a fixed seed
+ *
+ * \param state Pointer to the generator state (must be non-zero)
+ *
+ * \return The next 32-bit pseudo-random value
+ */
+uint32_t test_rand32(uint32_t* state) {
+	uint32_t x = *state;
+
+	x ^= x << 13;
+	x ^= x >> 17;
+	x ^= x << 5;
+	*state = x;
+
+	return x;
+}
+
+int test_uint_to_binstr_many(void) {
+	uint32_t state = TEST_7_SEED;
+	uint32_t round;
+	uint32_t i;
+	uint8_t nbits;
+	int expected_failures;
+	int failures;
+	int return_code = EXIT_TEST_SUCCESS;
+	const char* kernel_names[] = { "sse2", "avx2" };
+	binstr_many_fn_t kernels[] = { NULL, NULL };
+	int k;
+	char single[PREFIX_BYTES_BIN + UINT32_T_BITS + NULL_TERMINATOR_BYTE];
+
+#ifdef BITOPS_X86
+	__builtin_cpu_init();
+	if (__builtin_cpu_supports("sse2")) {
+		kernels[0] = uint_to_binstr_many_sse2;
+	}
+	if (__builtin_cpu_supports("avx2")) {
+		kernels[1] = uint_to_binstr_many_avx2;
+	}
+#endif
+
+	for (round = 0; round < TEST_7_ROUNDS; round++) {
+		for (nbits = 1; nbits <= UINT32_T_BITS; nbits++) {
+			///< Mostly in-range values, with roughly one in eight left full-width to exercise the range check
+			for (i = 0; i < TEST_7_VALUES; i++) {
+				TEST_7_INPUT[i] = test_rand32(&state);
+				if ((TEST_7_INPUT[i] & 0x7) != 0) {
+					TEST_7_INPUT[i] &= 0xFFFFFFFF >> (UINT32_T_BITS - nbits);
+				}
+			}
+
+			expected_failures = uint_to_binstr_many_scalar(TEST_7_INPUT, TEST_7_VALUES, TEST_7_SCALAR, TEST_7_OUT_BYTES, nbits);
+
+			for (i = 0; i < TEST_7_VALUES; i++) {
+				uint_to_binstr(single, sizeof(single), TEST_7_INPUT[i], nbits);
+				if (strcmp(single, TEST_7_SCALAR + (i * BINSTR_SLOT_BYTES(nbits))) != 0) {
+					printf("test_uint_to_binstr_many: (FAILURE): scalar, num = %u, nbits = %u, EXPECT = %s, RESULT = %s\n", TEST_7_INPUT[i], nbits, single, TEST_7_SCALAR + (i * BINSTR_SLOT_BYTES(nbits)));
+					return_code = EXIT_TEST_FAILURE;
+				}
+			}
+
+			for (k = 0; k < 2; k++) {
+				if (kernels[k] == NULL) {
+					continue;
+				}
+
+				///< Exact-size output so the last slots go through the bounce buffer
+				failures = kernels[k](TEST_7_INPUT, TEST_7_VALUES, TEST_7_RESULT, TEST_7_VALUES * BINSTR_SLOT_BYTES(nbits), nbits);
+
+				if (failures != expected_failures) {
+					return_code = EXIT_TEST_FAILURE;
+				}
+
+				for (i = 0; i < TEST_7_VALUES; i++) {
+					if (strcmp(TEST_7_SCALAR + (i * BINSTR_SLOT_BYTES(nbits)), TEST_7_RESULT + (i * BINSTR_SLOT_BYTES(nbits))) != 0) {
+						printf("test_uint_to_binstr_many: (FAILURE): %s, num = %u, nbits = %u, EXPECT = %s, RESULT = %s\n", kernel_names[k], TEST_7_INPUT[i], nbits, TEST_7_SCALAR + (i * BINSTR_SLOT_BYTES(nbits)), TEST_7_RESULT + (i * BINSTR_SLOT_BYTES(nbits)));
+						return_code = EXIT_TEST_FAILURE;
+					}
+				}
+			}
+		}
+	}
+
+	printf("test_uint_to_binstr_many: %u rounds x nbits 1..32 x %u values, sse2 %s, avx2 %s\n", TEST_7_ROUNDS, TEST_7_VALUES, (kernels[0] != NULL) ? "checked" : "skipped", (kernels[1] != NULL) ? "checked" : "skipped");
+
+	return return_code;
+}
+
+int test_uint_to_hexstr_many(void) {
+	uint32_t state = TEST_8_SEED;
+	uint32_t round;
+	uint32_t i;
+	uint32_t flags;
+	uint8_t nbits;
+	size_t stride;
+	int checked_ssse3 = 0;
+	int return_code = EXIT_TEST_SUCCESS;
+	char expected[PREFIX_BYTES_HEX + (UINT32_T_BITS / BITS_PER_NIBBLE) + NULL_TERMINATOR_BYTE];
+	char single[PREFIX_BYTES_HEX + (UINT32_T_BITS / BITS_PER_NIBBLE) + NULL_TERMINATOR_BYTE];
+
+	for (round = 0; round < TEST_8_ROUNDS; round++) {
+		for (nbits = 4; nbits <= UINT32_T_BITS; nbits *= 2) {
+			for (flags = 0; flags <= (HEXSTR_LOWER | HEXSTR_NO_PREFIX); flags++) {
+				stride = HEXSTR_SLOT_BYTES(nbits, flags);
+				for (i = 0; i < TEST_8_VALUES; i++) {
+					TEST_8_INPUT[i] = test_rand32(&state) & (0xFFFFFFFF >> (UINT32_T_BITS - nbits));
+				}
+
+				hexstr_many_scalar(TEST_8_INPUT, TEST_8_VALUES, TEST_8_SCALAR, TEST_8_VALUES * stride, nbits, flags);
+				uint_to_hexstr_many(TEST_8_INPUT, TEST_8_VALUES, TEST_8_RESULT, TEST_8_VALUES * stride, nbits, flags);
+
+				for (i = 0; i < TEST_8_VALUES; i++) {
+					///< Reference is plain printf formatting
+					sprintf(expected, (flags & HEXSTR_LOWER) ? "%s%0*x" : "%s%0*X", (flags & HEXSTR_NO_PREFIX) ? "" : "0x", nbits / BITS_PER_NIBBLE, TEST_8_INPUT[i]);
+					uint_to_hexstr_fmt(single, sizeof(single), TEST_8_INPUT[i], nbits, flags);
+
+					if ((strcmp(expected, single) != 0) || (strcmp(expected, TEST_8_SCALAR + (i * stride)) != 0) || (strcmp(expected, TEST_8_RESULT + (i * stride)) != 0)) {
+						printf("test_uint_to_hexstr_many: (FAILURE): num = %u, nbits = %u, flags = %u, EXPECT = %s, RESULT = %s / %s / %s\n", TEST_8_INPUT[i], nbits, flags, expected, single, TEST_8_SCALAR + (i * stride), TEST_8_RESULT + (i * stride));
+						return_code = EXIT_TEST_FAILURE;
+					}
+				}
+			}
+		}
+	}
+
+#ifdef BITOPS_X86
+	checked_ssse3 = __builtin_cpu_supports("ssse3");
+#endif
+	printf("test_uint_to_hexstr_many: %u rounds x nbits 4/8/16/32 x 4 flag sets x %u values, ssse3 %s\n", TEST_8_ROUNDS, TEST_8_VALUES, checked_ssse3 ? "checked" : "skipped");
+
+	return return_code;
+}
+
+/**
+ * \fn twiggle_bit_reference(uint32_t input, int bit, operation_t operation)
+ * \brief Bit-at-a-time model of twiggle_bit used to check the batch kernels
+ *
+ * \return The transformed 32-bit value
+ */
+static uint32_t twiggle_bit_reference(uint32_t input, int bit, operation_t operation) {
+	int i;
+	uint32_t output = 0;
+	uint32_t value;
+
+	for (i = 0; i < UINT32_T_BITS; i++) {
+		value = (input >> i) & 1u;
+		if (i == bit) {
+			value = (operation == CLEAR) ? 0u : ((operation == SET) ? 1u : (value ^ 1u));
+		}
+		output |= value << i;
+	}
+
+	return output;
+}
+
+int test_twiggle_bit_many(void) {
+	uint32_t state = TEST_9_SEED;
+	uint32_t round;
+	uint32_t i;
+	int op;
+	int bit;
+	int k;
+	int return_code = EXIT_TEST_SUCCESS;
+	const char* op_names[] = { "CLEAR", "SET", "TOGGLE" };
+	const char* kernel_names[] = { "scalar", "sse2", "avx2", "avx512" };
+	void (*many_kernels[4])(uint32_t*, size_t, uint32_t, uint32_t, uint32_t) = { twiggle_many_scalar, NULL, NULL, NULL };
+	void (*each_kernels[4])(uint32_t*, size_t, const int*, uint32_t, uint32_t) = { twiggle_each_scalar, NULL, NULL, NULL };
+
+#ifdef BITOPS_X86
+	__builtin_cpu_init();
+	if (__builtin_cpu_supports("sse2")) {
+		many_kernels[1] = twiggle_many_sse2;
+		each_kernels[1] = twiggle_each_sse2;
+	}
+	if (__builtin_cpu_supports("avx2")) {
+		many_kernels[2] = twiggle_many_avx2;
+		each_kernels[2] = twiggle_each_avx2;
+	}
+	if (__builtin_cpu_supports("avx512f")) {
+		many_kernels[3] = twiggle_many_avx512;
+		each_kernels[3] = twiggle_each_avx512;
+	}
+#endif
 
-	uint32_t output = 0;
+	for (round = 0; round < TEST_9_ROUNDS; round++) {
+		for (i = 0; i < TEST_9_WORDS; i++) {
+			TEST_9_INPUT[i] = test_rand32(&state);
+			TEST_9_BITS[i] = (int)(test_rand32(&state) % UINT32_T_BITS);
+		}
 
-	output = ((input & (1 << (start_bit))) | (input & (1 << (start_bit + 1))) | (input & (1 << (start_bit + 2)))) >> start_bit;
+		for (op = CLEAR; op <= TOGGLE; op++) {
+			for (k = 0; k < 4; k++) {
+				if (many_kernels[k] == NULL) {
+					continue;
+				}
+
+				bit = (int)((round * 3 + (uint32_t)op) % UINT32_T_BITS);
+				for (i = 0; i < TEST_9_WORDS; i++) {
+					TEST_9_EXPECTED[i] = twiggle_bit_reference(TEST_9_INPUT[i], bit, (operation_t)op);
+				}
+				memcpy(TEST_9_RESULT, TEST_9_INPUT, sizeof(TEST_9_RESULT));
+				many_kernels[k](TEST_9_RESULT, TEST_9_WORDS, (uint32_t)1 << bit, TWIGGLE_KEEP(op), TWIGGLE_FLIP(op));
+
+				if (memcmp(TEST_9_RESULT, TEST_9_EXPECTED, sizeof(TEST_9_RESULT)) != 0) {
+					printf("test_twiggle_bit_many: (FAILURE): %s, one bit, bit = %d, operation = %s\n", kernel_names[k], bit, op_names[op]);
+					return_code = EXIT_TEST_FAILURE;
+				}
+
+				for (i = 0; i < TEST_9_WORDS; i++) {
+					TEST_9_EXPECTED[i] = twiggle_bit_reference(TEST_9_INPUT[i], TEST_9_BITS[i], (operation_t)op);
+				}
+				memcpy(TEST_9_RESULT, TEST_9_INPUT, sizeof(TEST_9_RESULT));
+				each_kernels[k](TEST_9_RESULT, TEST_9_WORDS, TEST_9_BITS, TWIGGLE_KEEP(op), TWIGGLE_FLIP(op));
+
+				if (memcmp(TEST_9_RESULT, TEST_9_EXPECTED, sizeof(TEST_9_RESULT)) != 0) {
+					printf("test_twiggle_bit_many: (FAILURE): %s, per-word bits, operation = %s\n", kernel_names[k], op_names[op]);
+					return_code = EXIT_TEST_FAILURE;
+				}
+			}
+
+			///< The public entry points must agree with the reference too
+			memcpy(TEST_9_RESULT, TEST_9_INPUT, sizeof(TEST_9_RESULT));
+			twiggle_bits_many(TEST_9_RESULT, TEST_9_WORDS, TEST_9_BITS, (operation_t)op);
+			for (i = 0; i < TEST_9_WORDS; i++) {
+				if ((TEST_9_RESULT[i] != TEST_9_EXPECTED[i]) || (twiggle_bit(TEST_9_INPUT[i], TEST_9_BITS[i], (operation_t)op) != TEST_9_EXPECTED[i])) {
+					printf("test_twiggle_bit_many: (FAILURE): input = %u, bit = %d, operation = %s, EXPECT = %u, RESULT = %u\n", TEST_9_INPUT[i], TEST_9_BITS[i], op_names[op], TEST_9_EXPECTED[i], TEST_9_RESULT[i]);
+					return_code = EXIT_TEST_FAILURE;
+					break;
+				}
+			}
+		}
+	}
 
-	return output;
+	printf("test_twiggle_bit_many: %u rounds x 3 operations x %u words, sse2 %s, avx2 %s, avx512 %s\n", TEST_9_ROUNDS, TEST_9_WORDS, (many_kernels[1] != NULL) ? "checked" : "skipped", (many_kernels[2] != NULL) ? "checked" : "skipped", (many_kernels[3] != NULL) ? "checked" : "skipped");
+
+	return return_code;
 }
 
 /**
- * \fn hexdump(char* str, size_t size, const void* loc, size_t nbytes)
- * \brief Returns a string representing a dump of nbytes of memory starting at loc. Bytes are printed up to 16 bytes per line, separate by newlines. Each row will begin with the offset in bytes from loc, in hex.
- *
- * \param str Pointer to a char array
- * \param size Num of bytes of the char array pointed to by str
- * \param loc Starting location of memory to begin dumping bytes from
- * \param nbytes The number of bytes to read from loc
+ * \fn extract_bits_reference(uint32_t input, int start_bit, int width)
+ * \brief Bit-at-a-time model of extract_bits
  *
- * \return If successful, returns the char* str which facilitates daisy-chaining this function into other string manipulation functions (such as puts). In the case of an error (i.e. str is not large enough to hold the requested hex dump), str will be set to empty.
+ * \return The field, shifted down to bit 0
  */
-char* hexdump(char* str, size_t size, const void* loc, size_t nbytes) {
-	return NULL;
-}
-
-int test_uint_to_binstr(char* str, size_t size, uint32_t num, uint8_t nbits) {
+static uint32_t extract_bits_reference(uint32_t input, int start_bit, int width) {
 	int i;
-	int num_chars;
-	int return_code = EXIT_TEST_SUCCESS;
-
-	num_chars = uint_to_binstr(str, size, (uint32_t)TEST_1A_DEC, TEST_1A_BITS);
+	uint32_t output = 0;
 
-	if (num_chars != (int)TEST_1A_RETURN) {
-		return_code = EXIT_TEST_FAILURE;
+	for (i = 0; i < width; i++) {
+		output |= ((input >> (start_bit + i)) & 1u) << i;
 	}
 
-	for (i = 0; i < num_chars; i++) {
-		if (str[i] != TEST_1A_EXPECTED[i]) {
-			printf("test_uint_to_binstr: TEST_A (FAILURE): num = %u, nbits = %u, EXPECT[%d] = %c, return value = %d\n", (uint32_t)TEST_1A_DEC, (uint8_t)TEST_1A_BITS, i, TEST_1A_EXPECTED[i], (int)TEST_1A_RETURN);
-			printf("                                       num = %u, nbits = %u, RESULT[%d] = %c, return value = %d\n", (uint32_t)TEST_1A_DEC, (uint8_t)TEST_1A_BITS, i, str[i], num_chars);
-			return_code = EXIT_TEST_FAILURE;
-		}
-	}
+	return output;
+}
 
-	printf("test_uint_to_binstr: TEST_A (EXPECT) : num = %u, nbits = %u, EXPECT = %s, return value = %d\n", (uint32_t)TEST_1A_DEC, (uint8_t)TEST_1A_BITS, TEST_1A_EXPECTED, (int)TEST_1A_RETURN);
-	printf("test_uint_to_binstr: TEST_A (RESULT) : num = %u, nbits = %u, RESULT = %s, return value = %d\n", (uint32_t)TEST_1A_DEC, (uint8_t)TEST_1A_BITS, str,num_chars);
+int test_extract_bits(void) {
+	uint32_t state = TEST_10_SEED;
+	uint32_t round;
+	uint32_t input;
+	uint32_t value;
+	uint32_t expected;
+	uint32_t fields_out[TEST_10_NFIELDS];
+	uint32_t fields_in[TEST_10_NFIELDS];
+	size_t f;
+	int start_bit;
+	int width;
+	int use_bmi2 = bitops_has_bmi2();
+	int return_code = EXIT_TEST_SUCCESS;
 
-	num_chars = uint_to_binstr(str, size, (uint32_t)TEST_1B_DEC, TEST_1B_BITS);
+	for (round = 0; round < TEST_10_ROUNDS; round++) {
+		input = test_rand32(&state);
+		value = test_rand32(&state);
+
+		for (start_bit = 0; start_bit < UINT32_T_BITS; start_bit++) {
+			for (width = 1; start_bit + width <= UINT32_T_BITS; width++) {
+				expected = extract_bits_reference(input, start_bit, width);
+				if ((extract_bits(input, start_bit, width) != expected) || (extract_bits_scalar(input, start_bit, width) != expected)) {
+					printf("test_extract_bits: (FAILURE): input = %u, start_bit = %d, width = %d, EXPECT = %u, RESULT = %u\n", input, start_bit, width, expected, extract_bits(input, start_bit, width));
+					return_code = EXIT_TEST_FAILURE;
+				}
+
+				///< Depositing a value and extracting it again must round-trip and leave the other bits alone
+				expected = deposit_bits(input, value, start_bit, width);
+				if ((deposit_bits_scalar(input, value, start_bit, width) != expected) ||
+					(extract_bits_reference(expected, start_bit, width) != (value & FIELD_MASK(width))) ||
+					((expected ^ input) & ~(FIELD_MASK(width) << start_bit))) {
+					printf("test_extract_bits: (FAILURE): deposit input = %u, value = %u, start_bit = %d, width = %d, RESULT = %u\n", input, value, start_bit, width, expected);
+					return_code = EXIT_TEST_FAILURE;
+				}
+			}
+
+			if ((start_bit <= UINT32_T_BITS - 3) && (grab_three_bits(input, start_bit) != extract_bits_reference(input, start_bit, 3))) {
+				return_code = EXIT_TEST_FAILURE;
+			}
+		}
 
-	if (num_chars != (int)TEST_1B_RETURN) {
-		return_code = EXIT_TEST_FAILURE;
-	}
+		extract_fields(input, TEST_10_FIELDS, TEST_10_NFIELDS, fields_out);
+		for (f = 0; f < TEST_10_NFIELDS; f++) {
+			if (fields_out[f] != extract_bits_reference(input, TEST_10_FIELDS[f].start_bit, TEST_10_FIELDS[f].width)) {
+				printf("test_extract_bits: (FAILURE): fields input = %u, field = %u\n", input, (uint32_t)f);
+				return_code = EXIT_TEST_FAILURE;
+			}
+		}
 
-	for (i = 0; i < num_chars; i++) {
-		if (str[i] != TEST_1B_EXPECTED[i]) {
-			printf("test_uint_to_binstr: TEST_B (FAILURE): num = %u, nbits = %u, EXPECT[%d] = %c, return value = %d\n", (uint32_t)TEST_1B_DEC, (uint8_t)TEST_1B_BITS, i, TEST_1B_EXPECTED[i], (int)TEST_1B_RETURN);
-			printf("                                       num = %u, nbits = %u, RESULT[%d] = %c, return value = %d\n", (uint32_t)TEST_1B_DEC, (uint8_t)TEST_1B_BITS, i, str[i], num_chars);
-			return_code = EXIT_TEST_FAILURE;
+		///< Skip the final whole-word field so the earlier ones survive
+		for (f = 0; f < TEST_10_NFIELDS - 1; f++) {
+			fields_in[f] = test_rand32(&state);
+		}
+		expected = deposit_fields(input, TEST_10_FIELDS, TEST_10_NFIELDS - 1, fields_in);
+		extract_fields(expected, TEST_10_FIELDS, TEST_10_NFIELDS - 1, fields_out);
+		for (f = 0; f < TEST_10_NFIELDS - 1; f++) {
+			if (fields_out[f] != (fields_in[f] & FIELD_MASK(TEST_10_FIELDS[f].width))) {
+				printf("test_extract_bits: (FAILURE): deposit_fields input = %u, field = %u\n", input, (uint32_t)f);
+				return_code = EXIT_TEST_FAILURE;
+			}
 		}
 	}
-	printf("test_uint_to_binstr: TEST_B (EXPECT) : num = %u, nbits = %u, EXPECT = %s, return value = %d\n", (uint32_t)TEST_1B_DEC, (uint8_t)TEST_1B_BITS, TEST_1B_EXPECTED, (int)TEST_1B_RETURN);
-	printf("test_uint_to_binstr: TEST_B (RESULT) : num = %u, nbits = %u, RESULT = %s, return value = %d\n", (uint32_t)TEST_1B_DEC, (uint8_t)TEST_1B_BITS, str, num_chars);
 
-	num_chars = uint_to_binstr(str, size, (uint32_t)TEST_1C_DEC, TEST_1C_BITS);
+	printf("test_extract_bits: %u rounds x every start_bit/width, bmi2 %s\n", TEST_10_ROUNDS, use_bmi2 ? "checked" : "skipped");
 
-	if (num_chars != (int)TEST_1C_RETURN) {
-		return_code = EXIT_TEST_FAILURE;
-	}
+	return return_code;
+}
 
-	for (i = 0; i < num_chars; i++) {
-		if (str[i] != TEST_1C_EXPECTED[i]) {
-			printf("test_uint_to_binstr: TEST_C (FAILURE): num = %u, nbits = %u, EXPECT[%d] = %c, return value = %d\n", (uint32_t)TEST_1C_DEC, (uint8_t)TEST_1C_BITS, i, TEST_1C_EXPECTED[i], (int)TEST_1C_RETURN);
-			printf("                                       num = %u, nbits = %u, RESULT[%d] = %c, return value = %d\n", (uint32_t)TEST_1C_DEC, (uint8_t)TEST_1C_BITS, i, str[i], num_chars);
-			return_code = EXIT_TEST_FAILURE;
+int test_fixed_width(void) {
+	uint32_t state = TEST_11_SEED;
+	uint32_t round;
+	uint32_t num;
+	int k;
+	int nbits;
+	int expected_chars;
+	int num_chars;
+	int return_code = EXIT_TEST_SUCCESS;
+	char expected[PREFIX_BYTES_BIN + UINT32_T_BITS + NULL_TERMINATOR_BYTE];
+	char result[PREFIX_BYTES_BIN + UINT32_T_BITS + NULL_TERMINATOR_BYTE];
+	char bits[UINT32_T_BITS];
+
+	for (round = 0; round < TEST_11_ROUNDS; round++) {
+		num = test_rand32(&state);
+		///< Narrow most values so the 8- and 16-bit range checks see both outcomes
+		if (round & 1) {
+			num >>= (round >> 1) % UINT32_T_BITS;
+		}
+
+		for (k = 0; k < 3; k++) {
+			nbits = 8 << k;
+
+			///< Reference: the portable 32-character kernel, cut down to nbits
+			binstr32_scalar(bits, num << (UINT32_T_BITS - nbits));
+			if (num > (0xFFFFFFFF >> (UINT32_T_BITS - nbits))) {
+				expected[0] = '\0';
+				expected_chars = EXIT_FAILURE_N;
+			}
+			else {
+				expected_chars = sprintf(expected, "0b%.*s", nbits, bits);
+			}
+
+			num_chars = (k == 0) ? uint_to_binstr8(result, sizeof(result), num) : ((k == 1) ? uint_to_binstr16(result, sizeof(result), num) : uint_to_binstr32(result, sizeof(result), num));
+			if ((num_chars != expected_chars) || (strcmp(result, expected) != 0)) {
+				printf("test_fixed_width: (FAILURE): uint_to_binstr%d, num = %u, EXPECT = %s, RESULT = %s\n", nbits, num, expected, result);
+				return_code = EXIT_TEST_FAILURE;
+			}
+
+			expected_chars = sprintf(expected, "0b%.*s", nbits, bits);
+			num_chars = (k == 0) ? int_to_binstr8(result, sizeof(result), (int32_t)num) : ((k == 1) ? int_to_binstr16(result, sizeof(result), (int32_t)num) : int_to_binstr32(result, sizeof(result), (int32_t)num));
+			if ((num_chars != expected_chars) || (strcmp(result, expected) != 0)) {
+				printf("test_fixed_width: (FAILURE): int_to_binstr%d, num = %d, EXPECT = %s, RESULT = %s\n", nbits, (int32_t)num, expected, result);
+				return_code = EXIT_TEST_FAILURE;
+			}
+
+			expected_chars = sprintf(expected, "0x%0*X", nbits / BITS_PER_NIBBLE, num & (0xFFFFFFFF >> (UINT32_T_BITS - nbits)));
+			num_chars = (k == 0) ? uint_to_hexstr8(result, sizeof(result), num) : ((k == 1) ? uint_to_hexstr16(result, sizeof(result), num) : uint_to_hexstr32(result, sizeof(result), num));
+			if ((num_chars != expected_chars) || (strcmp(result, expected) != 0)) {
+				printf("test_fixed_width: (FAILURE): uint_to_hexstr%d, num = %u, EXPECT = %s, RESULT = %s\n", nbits, num, expected, result);
+				return_code = EXIT_TEST_FAILURE;
+			}
 		}
 	}
-	printf("test_uint_to_binstr: TEST_C (EXPECT) : num = %u, nbits = %u, EXPECT = %s, return value = %d\n", (uint32_t)TEST_1C_DEC, (uint8_t)TEST_1C_BITS, TEST_1C_EXPECTED, (int)TEST_1C_RETURN);
-	printf("test_uint_to_binstr: TEST_C (RESULT) : num = %u, nbits = %u, RESULT = %s, return value = %d\n", (uint32_t)TEST_1C_DEC, (uint8_t)TEST_1C_BITS, str, num_chars);
+
+	printf("test_fixed_width: %u values x widths 8/16/32 x binary/signed binary/hex\n", TEST_11_ROUNDS);
 
 	return return_code;
 }
 
-int test_int_to_binstr(char* str, size_t size, int32_t num, uint8_t nbits) {
-	int i;
-	int num_chars;
+int test_hexdump_parallel(void) {
+	size_t sizes[] = { 0, 15, 16, TEST_12_NBYTES - 7u, TEST_12_NBYTES };
+	int wide_threads[] = { 0, -1, INT_MIN, INT_MAX };
+	size_t chars;
+	size_t i;
+	size_t k;
+	int nthreads;
+	uint8_t* data = malloc(TEST_12_NBYTES);
+	char* expected = malloc(hexdump_len(TEST_12_NBYTES) + NULL_TERMINATOR_BYTE);
+	char* result = malloc(hexdump_len(TEST_12_NBYTES) + NULL_TERMINATOR_BYTE);
 	int return_code = EXIT_TEST_SUCCESS;
 
-	num_chars = int_to_binstr(str, size, (uint32_t)TEST_2A_DEC, TEST_2A_BITS);
+	if ((data == NULL) || (expected == NULL) || (result == NULL)) {
+		free(data);
+		free(expected);
+		free(result);
+		return EXIT_TEST_FAILURE;
+	}
 
-	if (num_chars != (int)TEST_2A_RETURN) {
-		return_code = EXIT_TEST_FAILURE;
+	for (i = 0; i < TEST_12_NBYTES; i++) {
+		data[i] = (uint8_t)((i * 131u) ^ (i >> 9));
 	}
 
-	for (i = 0; i < num_chars; i++) {
-		if (str[i] != TEST_2A_EXPECTED[i]) {
-			printf("test_int_to_binstr: TEST_A (FAILURE): num = %d, nbits = %u, EXPECT[%d] = %c, return value = %d\n", (uint32_t)TEST_2A_DEC, (uint8_t)TEST_2A_BITS, i, TEST_2A_EXPECTED[i], (int)TEST_2A_RETURN);
-			printf("                                      num = %d, nbits = %u, RESULT[%d] = %c, return value = %d\n", (uint32_t)TEST_2A_DEC, (uint8_t)TEST_2A_BITS, i, str[i], num_chars);
-			return_code = EXIT_TEST_FAILURE;
+	for (k = 0; k < sizeof(sizes) / sizeof(sizes[0]); k++) {
+		chars = hexdump_len(sizes[k]);
+		hexdump(expected, chars + NULL_TERMINATOR_BYTE, data, sizes[k]);
+
+		for (nthreads = 1; nthreads <= TEST_12_MAX_THREADS; nthreads++) {
+			memset(result, '?', chars + NULL_TERMINATOR_BYTE);
+			hexdump_parallel(result, chars + NULL_TERMINATOR_BYTE, data, sizes[k], nthreads);
+
+			if (memcmp(result, expected, chars + NULL_TERMINATOR_BYTE) != 0) {
+				printf("test_hexdump_parallel: (FAILURE): nbytes = %u, nthreads = %d\n", (uint32_t)sizes[k], nthreads);
+				return_code = EXIT_TEST_FAILURE;
+			}
 		}
 	}
-	printf("test_int_to_binstr: TEST_A (EXPECT) : num = %d, nbits = %u, EXPECT = %s, return value = %d\n", (uint32_t)TEST_2A_DEC, (uint8_t)TEST_2A_BITS, TEST_2A_EXPECTED, (int)TEST_2A_RETURN);
-	printf("test_int_to_binstr: TEST_A (RESULT) : num = %d, nbits = %u, RESULT = %s, return value = %d\n", (uint32_t)TEST_2A_DEC, (uint8_t)TEST_2A_BITS, str, num_chars);
-
-	num_chars = int_to_binstr(str, size, (uint32_t)TEST_2B_DEC, TEST_2B_BITS);
 
-	if (num_chars != (int)TEST_2B_RETURN) {
+	///< Too small by one byte must give the empty string, like hexdump
+	hexdump_parallel(result, hexdump_len(TEST_12_NBYTES), data, TEST_12_NBYTES, TEST_12_MAX_THREADS);
+	if (result[0] != '\0') {
 		return_code = EXIT_TEST_FAILURE;
 	}
 
-	for (i = 0; i < num_chars; i++) {
-		if (str[i] != TEST_2B_EXPECTED[i]) {
-			printf("test_int_to_binstr: TEST_B (FAILURE): num = %d, nbits = %u, EXPECT[%d] = %c, return value = %d\n", (uint32_t)TEST_2B_DEC, (uint8_t)TEST_2B_BITS, i, TEST_2B_EXPECTED[i], (int)TEST_2B_RETURN);
-			printf("                                      num = %d, nbits = %u, RESULT[%d] = %c, return value = %d\n", (uint32_t)TEST_2B_DEC, (uint8_t)TEST_2B_BITS, i, str[i], num_chars);
-			return_code = EXIT_TEST_FAILURE;
+	printf("test_hexdump_parallel: %u sizes up to %u bytes x 1..%d threads compared with hexdump\n", (uint32_t)(sizeof(sizes) / sizeof(sizes[0])), TEST_12_NBYTES, TEST_12_MAX_THREADS);
+
+	free(data);
+	free(expected);
+	free(result);
+
+	///< On an input with room for more than HEXDUMP_PARALLEL_MAX_THREADS chunks, nthreads below 1 must mean one thread and a huge nthreads the maximum
+	data = malloc(TEST_12_WIDE_NBYTES);
+	expected = malloc(hexdump_len(TEST_12_WIDE_NBYTES) + NULL_TERMINATOR_BYTE);
+	result = malloc(hexdump_len(TEST_12_WIDE_NBYTES) + NULL_TERMINATOR_BYTE);
+	if ((data == NULL) || (expected == NULL) || (result == NULL)) {
+		return_code = EXIT_TEST_FAILURE;
+	}
+	else {
+		for (i = 0; i < TEST_12_WIDE_NBYTES; i++) {
+			data[i] = (uint8_t)((i * 131u) ^ (i >> 9));
+		}
+		chars = hexdump_len(TEST_12_WIDE_NBYTES);
+		hexdump(expected, chars + NULL_TERMINATOR_BYTE, data, TEST_12_WIDE_NBYTES);
+
+		for (k = 0; k < sizeof(wide_threads) / sizeof(wide_threads[0]); k++) {
+			memset(result, '?', chars + NULL_TERMINATOR_BYTE);
+			hexdump_parallel(result, chars + NULL_TERMINATOR_BYTE, data, TEST_12_WIDE_NBYTES, wide_threads[k]);
+			if (memcmp(result, expected, chars + NULL_TERMINATOR_BYTE) != 0) {
+				printf("test_hexdump_parallel: (FAILURE): nbytes = %u, nthreads = %d\n", TEST_12_WIDE_NBYTES, wide_threads[k]);
+				return_code = EXIT_TEST_FAILURE;
+			}
 		}
+		printf("test_hexdump_parallel: %u bytes with nthreads 0, -1, INT_MIN and INT_MAX compared with hexdump\n", TEST_12_WIDE_NBYTES);
 	}
-	printf("test_int_to_binstr: TEST_B (EXPECT) : num = %d, nbits = %u, EXPECT = %s, return value = %d\n", (uint32_t)TEST_2B_DEC, (uint8_t)TEST_2B_BITS, TEST_2B_EXPECTED, (int)TEST_2B_RETURN);
-	printf("test_int_to_binstr: TEST_B (RESULT) : num = %d, nbits = %u, RESULT = %s, return value = %d\n", (uint32_t)TEST_2B_DEC, (uint8_t)TEST_2B_BITS, str, num_chars);
 
-	num_chars = int_to_binstr(str, size, (uint32_t)TEST_2C_DEC, TEST_2C_BITS);
+	free(data);
+	free(expected);
+	free(result);
 
-	if (num_chars != (int)TEST_2C_RETURN) {
-		return_code = EXIT_TEST_FAILURE;
+	return return_code;
+}
+
+int test_int_to_binstr_many(void) {
+	uint32_t state = TEST_13_SEED;
+	uint32_t i;
+	uint32_t flags;
+	uint8_t nbits;
+	int k;
+	int32_t value;
+	int expected_failures;
+	int failures;
+	int fits;
+	int return_code = EXIT_TEST_SUCCESS;
+	char expected[PREFIX_BYTES_BIN + UINT32_T_BITS + NULL_TERMINATOR_BYTE];
+	const char* slot;
+
+	for (i = 0; i < TEST_13_VALUES; i++) {
+		///< Spread magnitudes so every nbits sees values both inside and outside its range
+		value = (int32_t)test_rand32(&state) >> (i % UINT32_T_BITS);
+		TEST_13_INPUT8[i] = (int8_t)value;
+		TEST_13_INPUT16[i] = (int16_t)value;
+		TEST_13_INPUT32[i] = value;
 	}
 
-	for (i = 0; i < num_chars; i++) {
-		if (str[i] != TEST_2C_EXPECTED[i]) {
-			printf("test_int_to_binstr: TEST_C (FAILURE): num = %d, nbits = %u, EXPECT[%d] = %c, return value = %d\n", (uint32_t)TEST_2C_DEC, (uint8_t)TEST_2C_BITS, i, TEST_2C_EXPECTED[i], (int)TEST_2C_RETURN);
-			printf("                                      num = %d, nbits = %u, RESULT[%d] = %c, return value = %d\n", (uint32_t)TEST_2C_DEC, (uint8_t)TEST_2C_BITS, i, str[i], num_chars);
-			return_code = EXIT_TEST_FAILURE;
+	for (k = 0; k < 3; k++) {
+		for (nbits = 1; nbits <= UINT32_T_BITS; nbits++) {
+			for (flags = 0; flags <= BINSTR_RANGE_CHECK; flags++) {
+				if (k == 0) {
+					failures = int8_to_binstr_many(TEST_13_INPUT8, TEST_13_VALUES, TEST_13_RESULT, TEST_13_VALUES * BINSTR_SLOT_BYTES(nbits), nbits, flags);
+				}
+				else if (k == 1) {
+					failures = int16_to_binstr_many(TEST_13_INPUT16, TEST_13_VALUES, TEST_13_RESULT, TEST_13_VALUES * BINSTR_SLOT_BYTES(nbits), nbits, flags);
+				}
+				else {
+					failures = int32_to_binstr_many(TEST_13_INPUT32, TEST_13_VALUES, TEST_13_RESULT, TEST_13_VALUES * BINSTR_SLOT_BYTES(nbits), nbits, flags);
+				}
+
+				expected_failures = 0;
+				for (i = 0; i < TEST_13_VALUES; i++) {
+					value = (k == 0) ? TEST_13_INPUT8[i] : ((k == 1) ? TEST_13_INPUT16[i] : TEST_13_INPUT32[i]);
+					fits = (nbits == UINT32_T_BITS) || ((value >= -((int64_t)1 << (nbits - 1))) && (value < ((int64_t)1 << (nbits - 1))));
+
+					if ((flags & BINSTR_RANGE_CHECK) && !fits) {
+						expected[0] = '\0';
+						expected_failures++;
+					}
+					else {
+						int_to_binstr(expected, sizeof(expected), value, nbits);
+					}
+
+					slot = TEST_13_RESULT + (i * BINSTR_SLOT_BYTES(nbits));
+					if (strcmp(expected, slot) != 0) {
+						printf("test_int_to_binstr_many: (FAILURE): int%d, num = %d, nbits = %u, flags = %u, EXPECT = %s, RESULT = %s\n", 8 << k, value, nbits, flags, expected, slot);
+						return_code = EXIT_TEST_FAILURE;
+					}
+				}
+
+				if (failures != expected_failures) {
+					printf("test_int_to_binstr_many: (FAILURE): int%d, nbits = %u, flags = %u, EXPECT failures = %d, RESULT failures = %d\n", 8 << k, nbits, flags, expected_failures, failures);
+					return_code = EXIT_TEST_FAILURE;
+				}
+			}
 		}
 	}
-	printf("test_int_to_binstr: TEST_C (EXPECT) : num = %d, nbits = %u, EXPECT = %s, return value = %d\n", (uint32_t)TEST_2C_DEC, (uint8_t)TEST_2C_BITS, TEST_2C_EXPECTED, (int)TEST_2C_RETURN);
-	printf("test_int_to_binstr: TEST_C (RESULT) : num = %d, nbits = %u, RESULT = %s, return value = %d\n", (uint32_t)TEST_2C_DEC, (uint8_t)TEST_2C_BITS, str, num_chars);
+
+	printf("test_int_to_binstr_many: int8/int16/int32 x nbits 1..32 x range check on/off x %u values\n", TEST_13_VALUES);
 
 	return return_code;
 }
 
-int test_uint_to_hexstr(char* str, size_t size, uint32_t num, uint8_t nbits) {
-	int i;
-	int num_chars;
+/**
+ * \fn test_dispatch_run(char* bin, char* hex, uint32_t* words)
+ * \brief Runs every dispatched batch and bit-field function on the TEST_19 inputs with whatever tier is selected
+ *
+ * \return A checksum of the extract_bits and deposit_bits results
+ */
+static uint32_t test_dispatch_run(char* bin, char* hex, uint32_t* words) {
+	bitfield_t fields[] = { { 0, 5 }, { 5, 11 }, { 16, 16 } };
+	uint32_t values[3];
+	uint32_t sum = 0;
+	uint32_t i;
+
+	memset(bin, '?', TEST_19_BIN_BYTES);
+	memset(hex, '?', TEST_19_HEX_BYTES);
+	uint_to_binstr_many(TEST_19_INPUT, TEST_19_VALUES, bin, TEST_19_BIN_BYTES, 32);
+	uint_to_hexstr_many(TEST_19_INPUT, TEST_19_VALUES, hex, TEST_19_HEX_BYTES, 32, HEXSTR_LOWER);
+
+	memcpy(words, TEST_19_INPUT, sizeof(TEST_19_INPUT));
+	twiggle_bit_many(words, TEST_19_VALUES, 7, TOGGLE);
+	twiggle_bits_many(words, TEST_19_VALUES, TEST_19_BITS, SET);
+
+	for (i = 0; i < TEST_19_VALUES; i++) {
+		sum = (sum * 31u) + extract_bits(TEST_19_INPUT[i], i % 29, 3) + grab_three_bits(TEST_19_INPUT[i], i % 30);
+		sum ^= deposit_bits(TEST_19_INPUT[i], i, i % 17, 15);
+		extract_fields(TEST_19_INPUT[i], fields, 3, values);
+		sum += values[0] + values[1] + values[2] + deposit_fields(TEST_19_INPUT[i], fields, 3, values);
+	}
+
+	return sum;
+}
+
+int test_dispatch(void) {
+	bitops_isa_t initial = bitops_isa();
+	bitops_isa_t max_isa = bitops_isa_max_supported();
+	uint32_t state = TEST_19_SEED;
+	uint32_t expected_sum;
+	uint32_t sum;
+	uint32_t i;
+	int isa;
 	int return_code = EXIT_TEST_SUCCESS;
 
-	num_chars = uint_to_hexstr(str, size, (uint32_t)TEST_3A_DEC, TEST_3A_BITS);
+	for (i = 0; i < TEST_19_VALUES; i++) {
+		TEST_19_INPUT[i] = test_rand32(&state);
+		TEST_19_BITS[i] = (int)(test_rand32(&state) % UINT32_T_BITS);
+	}
 
-	if (num_chars != (int)TEST_3A_RETURN) {
+	///< The scalar tier is the reference for every other tier the CPU supports
+	bitops_set_isa(BITOPS_ISA_SCALAR);
+	if ((bitops_isa() != BITOPS_ISA_SCALAR) || (bitops_cpu_features() != 0)) {
+		printf("test_dispatch: (FAILURE): scalar tier still enables features 0x%X\n", bitops_cpu_features());
 		return_code = EXIT_TEST_FAILURE;
 	}
+	expected_sum = test_dispatch_run(TEST_19_SCALAR, TEST_19_HEX_SCALAR, TEST_19_WORDS_SCALAR);
 
-	for (i = 0; i < num_chars; i++) {
-		if (str[i] != TEST_3A_EXPECTED[i]) {
-			printf("test_uint_to_hexstr: TEST_A (FAILURE): num = %u, nbits = %u, EXPECT[%d] = %c, return value = %d\n", (uint32_t)TEST_3A_DEC, (uint8_t)TEST_3A_BITS, i, TEST_3A_EXPECTED[i], (int)TEST_3A_RETURN);
-			printf("                                       num = %u, nbits = %u, RESULT[%d] = %c, return value = %d\n", (uint32_t)TEST_3A_DEC, (uint8_t)TEST_3A_BITS, i, str[i], num_chars);
+	for (isa = BITOPS_ISA_SSE2; isa <= (int)max_isa; isa++) {
+		if (bitops_set_isa((bitops_isa_t)isa) != (bitops_isa_t)isa) {
+			printf("test_dispatch: (FAILURE): could not select %s\n", bitops_isa_name((bitops_isa_t)isa));
 			return_code = EXIT_TEST_FAILURE;
+			continue;
 		}
-	}
-	printf("test_uint_to_hexstr: TEST_A (EXPECT) : num = %u, nbits = %u, EXPECT = %s, return value = %d\n", (uint32_t)TEST_3A_DEC, (uint8_t)TEST_3A_BITS, TEST_3A_EXPECTED, (int)TEST_3A_RETURN);
-	printf("test_uint_to_hexstr: TEST_A (RESULT) : num = %u, nbits = %u, RESULT = %s, return value = %d\n", (uint32_t)TEST_3A_DEC, (uint8_t)TEST_3A_BITS, str, num_chars);
 
-	num_chars = uint_to_hexstr(str, size, (uint32_t)TEST_3B_DEC, TEST_3B_BITS);
+		sum = test_dispatch_run(TEST_19_RESULT, TEST_19_HEX_RESULT, TEST_19_WORDS);
+		if ((sum != expected_sum) || (memcmp(TEST_19_RESULT, TEST_19_SCALAR, TEST_19_BIN_BYTES) != 0) || (memcmp(TEST_19_HEX_RESULT, TEST_19_HEX_SCALAR, TEST_19_HEX_BYTES) != 0)
+			|| (memcmp(TEST_19_WORDS, TEST_19_WORDS_SCALAR, sizeof(TEST_19_WORDS)) != 0)) {
+			printf("test_dispatch: (FAILURE): %s results differ from scalar\n", bitops_isa_name((bitops_isa_t)isa));
+			return_code = EXIT_TEST_FAILURE;
+		}
+	}
 
-	if (num_chars != (int)TEST_3B_RETURN) {
+	///< Asking for more than the CPU has gives the best supported tier
+	if (bitops_set_isa(BITOPS_ISA_AVX512) != max_isa) {
+		printf("test_dispatch: (FAILURE): avx512 request was not lowered to %s\n", bitops_isa_name(max_isa));
 		return_code = EXIT_TEST_FAILURE;
 	}
 
-	for (i = 0; i < num_chars; i++) {
-		if (str[i] != TEST_3B_EXPECTED[i]) {
-			printf("test_uint_to_hexstr: TEST_B (FAILURE): num = %u, nbits = %u, EXPECT[%d] = %c, return value = %d\n", (uint32_t)TEST_3B_DEC, (uint8_t)TEST_3B_BITS, i, TEST_3B_EXPECTED[i], (int)TEST_3B_RETURN);
-			printf("                                       num = %u, nbits = %u, RESULT[%d] = %c, return value = %d\n", (uint32_t)TEST_3B_DEC, (uint8_t)TEST_3B_BITS, i, str[i], num_chars);
+	for (isa = BITOPS_ISA_SCALAR; isa <= BITOPS_ISA_AVX512; isa++) {
+		if (bitops_isa_parse(bitops_isa_name((bitops_isa_t)isa)) != isa) {
 			return_code = EXIT_TEST_FAILURE;
 		}
 	}
-	printf("test_uint_to_hexstr: TEST_B (EXPECT) : num = %u, nbits = %u, EXPECT = %s, return value = %d\n", (uint32_t)TEST_3B_DEC, (uint8_t)TEST_3B_BITS, TEST_3B_EXPECTED, (int)TEST_3B_RETURN);
-	printf("test_uint_to_hexstr: TEST_B (RESULT) : num = %u, nbits = %u, RESULT = %s, return value = %d\n", (uint32_t)TEST_3B_DEC, (uint8_t)TEST_3B_BITS, str, num_chars);
-
-	num_chars = uint_to_hexstr(str, size, (uint32_t)TEST_3C_DEC, TEST_3C_BITS);
-
-	if (num_chars != (int)TEST_3C_RETURN) {
+	if ((bitops_isa_parse("avx") >= 0) || (bitops_isa_parse("") >= 0) || (strcmp(bitops_isa_name((bitops_isa_t)7), "unknown") != 0)) {
+		printf("test_dispatch: (FAILURE): BITOPS_ISA name parsing\n");
 		return_code = EXIT_TEST_FAILURE;
 	}
 
-	for (i = 0; i < num_chars; i++) {
-		if (str[i] != TEST_3C_EXPECTED[i]) {
-			printf("test_uint_to_hexstr: TEST_C (FAILURE): num = %u, nbits = %u, EXPECT[%d] = %c, return value = %d\n", (uint32_t)TEST_3C_DEC, (uint8_t)TEST_3C_BITS, i, TEST_3C_EXPECTED[i], (int)TEST_3C_RETURN);
-			printf("                                       num = %u, nbits = %u, RESULT[%d] = %c, return value = %d\n", (uint32_t)TEST_3C_DEC, (uint8_t)TEST_3C_BITS, i, str[i], num_chars);
-			return_code = EXIT_TEST_FAILURE;
+	bitops_set_isa(initial);
+
+	printf("test_dispatch: tiers scalar..%s compared with scalar, running on %s\n", bitops_isa_name(max_isa), bitops_isa_name(bitops_isa()));
+
+	return return_code;
+}
+
+/**
+ * \fn test_permute_reference(uint32_t input, const int8_t* table)
+ * \brief Applies a permutation table one bit at a time
+ *
+ * \return The permuted value
+ */
+static uint32_t test_permute_reference(uint32_t input, const int8_t* table) {
+	uint32_t result = 0;
+	int i;
+
+	for (i = 0; i < BITPERM_BITS; i++) {
+		if (table[i] != BITPERM_ZERO) {
+			result |= ((input >> table[i]) & 1u) << i;
 		}
 	}
-	printf("test_uint_to_hexstr: TEST_C (EXPECT) : num = %u, nbits = %u, EXPECT = %s, return value = %d\n", (uint32_t)TEST_3C_DEC, (uint8_t)TEST_3C_BITS, TEST_3C_EXPECTED, (int)TEST_3C_RETURN);
-	printf("test_uint_to_hexstr: TEST_C (RESULT) : num = %u, nbits = %u, RESULT = %s, return value = %d\n", (uint32_t)TEST_3C_DEC, (uint8_t)TEST_3C_BITS, str, num_chars);
 
-	return return_code;
+	return result;
 }
 
-int test_twiggle_bit(uint32_t input, int bit, operation_t operation) {
-	uint32_t output;
+int test_permute(void) {
+	static const uint32_t hex_flags[] = { 0, HEXSTR_REVERSED, HEXSTR_BIG_ENDIAN, HEXSTR_REVERSED | HEXSTR_BIG_ENDIAN | HEXSTR_UPPER };
+	static const uint8_t hex_nbits[] = { 8, 16, 32 };
+	bitops_isa_t initial = bitops_isa();
+	bitops_isa_t max_isa = bitops_isa_max_supported();
+	int8_t tables[TEST_25_TABLES][BITPERM_BITS];
+	int8_t bad[BITPERM_BITS];
+	bitperm_t perm;
+	uint32_t state = TEST_25_SEED;
+	uint32_t expected;
+	uint32_t flags;
+	char expected_str[PREFIX_BYTES_BIN + UINT32_T_BITS + NULL_TERMINATOR_BYTE];
+	char str[PREFIX_BYTES_BIN + UINT32_T_BITS + NULL_TERMINATOR_BYTE];
+	size_t stride;
+	uint32_t i;
+	int isa;
+	int t;
+	int k;
+	int f;
 	int return_code = EXIT_TEST_SUCCESS;
 
-	output = twiggle_bit((uint32_t)TEST_4A_DEC, (int)TEST_4A_BIT, (operation_t)TEST_4A_OP);
+	for (i = 0; i < TEST_25_VALUES; i++) {
+		TEST_25_INPUT[i] = test_rand32(&state);
+	}
 
-	if (output != TEST_4A_EXPECTED) {
-		return_code = EXIT_TEST_FAILURE;
+	///< Identity, full reversal, a nibble shuffle and random tables with clear and repeated bits
+	for (k = 0; k < BITPERM_BITS; k++) {
+		tables[0][k] = (int8_t)k;
+		tables[1][k] = (int8_t)(BITPERM_BITS - 1 - k);
+		tables[2][k] = (int8_t)((((k / BITS_PER_NIBBLE) * 5 + 3) % 8) * BITS_PER_NIBBLE + (k % BITS_PER_NIBBLE));
+	}
+	for (t = 3; t < TEST_25_TABLES; t++) {
+		for (k = 0; k < BITPERM_BITS; k++) {
+			tables[t][k] = ((test_rand32(&state) % 8) == 0) ? BITPERM_ZERO : (int8_t)(test_rand32(&state) % BITPERM_BITS);
+		}
 	}
 
-	printf("test_twiggle_bit: TEST_A (EXPECT) : input = %u, bit = %d, operation = %s EXPECT = %u\n", (uint32_t)TEST_4A_DEC, (int)TEST_4A_BIT, ((TEST_4A_OP == CLEAR) ? "CLEAR" : ((TEST_4A_OP == SET) ? "SET" : ((TEST_4A_OP == TOGGLE) ? "TOGGLE" : "UNKNOWN"))), TEST_4A_EXPECTED);
-	printf("test_twiggle_bit: TEST_A (RESULT) : input = %u, bit = %d, operation = %s RESULT = %u\n", (uint32_t)TEST_4A_DEC, (int)TEST_4A_BIT, ((TEST_4A_OP == CLEAR) ? "CLEAR" : ((TEST_4A_OP == SET) ? "SET" : ((TEST_4A_OP == TOGGLE) ? "TOGGLE" : "UNKNOWN"))), output);
+	for (isa = BITOPS_ISA_SCALAR; isa <= (int)max_isa; isa++) {
+		bitops_set_isa((bitops_isa_t)isa);
+
+		for (t = 0; t < TEST_25_TABLES; t++) {
+			if (bitperm_compile(&perm, tables[t]) < 0) {
+				printf("test_permute: (FAILURE): %s, table %d did not compile\n", bitops_isa_name((bitops_isa_t)isa), t);
+				return_code = EXIT_TEST_FAILURE;
+				continue;
+			}
+
+			memcpy(TEST_25_RESULT, TEST_25_INPUT, sizeof(TEST_25_INPUT));
+			permute_bits_many(TEST_25_RESULT, TEST_25_VALUES, &perm);
+			for (i = 0; i < TEST_25_VALUES; i++) {
+				expected = test_permute_reference(TEST_25_INPUT[i], tables[t]);
+				if ((permute_bits(TEST_25_INPUT[i], &perm) != expected) || (TEST_25_RESULT[i] != expected)) {
+					printf("test_permute: (FAILURE): %s, table %d, input = 0x%08X, EXPECT = 0x%08X, RESULT = 0x%08X / 0x%08X\n", bitops_isa_name((bitops_isa_t)isa), t, TEST_25_INPUT[i], expected, permute_bits(TEST_25_INPUT[i], &perm), TEST_25_RESULT[i]);
+					return_code = EXIT_TEST_FAILURE;
+					break;
+				}
+			}
+		}
 
-	output = twiggle_bit((uint32_t)TEST_4B_DEC, (int)TEST_4B_BIT, (operation_t)TEST_4B_OP);
+		memcpy(TEST_25_RESULT, TEST_25_INPUT, sizeof(TEST_25_INPUT));
+		reverse_bits_many(TEST_25_RESULT, TEST_25_VALUES);
+		for (i = 0; i < TEST_25_VALUES; i++) {
+			if (TEST_25_RESULT[i] != test_permute_reference(TEST_25_INPUT[i], tables[1])) {
+				printf("test_permute: (FAILURE): %s, reverse_bits_many input = 0x%08X, RESULT = 0x%08X\n", bitops_isa_name((bitops_isa_t)isa), TEST_25_INPUT[i], TEST_25_RESULT[i]);
+				return_code = EXIT_TEST_FAILURE;
+				break;
+			}
+		}
 
-	if (output != TEST_4B_EXPECTED) {
-		return_code = EXIT_TEST_FAILURE;
+		memcpy(TEST_25_RESULT, TEST_25_INPUT, sizeof(TEST_25_INPUT));
+		swap_bytes_many(TEST_25_RESULT, TEST_25_VALUES);
+		for (i = 0; i < TEST_25_VALUES; i++) {
+			expected = (TEST_25_INPUT[i] << 24) | ((TEST_25_INPUT[i] & 0xFF00u) << 8) | ((TEST_25_INPUT[i] >> 8) & 0xFF00u) | (TEST_25_INPUT[i] >> 24);
+			if (TEST_25_RESULT[i] != expected) {
+				printf("test_permute: (FAILURE): %s, swap_bytes_many input = 0x%08X, RESULT = 0x%08X\n", bitops_isa_name((bitops_isa_t)isa), TEST_25_INPUT[i], TEST_25_RESULT[i]);
+				return_code = EXIT_TEST_FAILURE;
+				break;
+			}
+		}
+
+		///< The folded batch must print what the single-value formatter prints for each flag combination
+		for (f = 0; f < (int)(sizeof(hex_flags) / sizeof(hex_flags[0])); f++) {
+			for (k = 0; k < (int)sizeof(hex_nbits); k++) {
+				flags = hex_flags[f];
+				stride = HEXSTR_SLOT_BYTES(hex_nbits[k], flags);
+				if (uint_to_hexstr_many(TEST_25_INPUT, TEST_25_VALUES, TEST_25_HEX, sizeof(TEST_25_HEX), hex_nbits[k], flags) < 0) {
+					printf("test_permute: (FAILURE): %s, uint_to_hexstr_many nbits = %u, flags = 0x%X failed\n", bitops_isa_name((bitops_isa_t)isa), hex_nbits[k], flags);
+					return_code = EXIT_TEST_FAILURE;
+					continue;
+				}
+				for (i = 0; i < TEST_25_VALUES; i++) {
+					uint_to_hexstr_fmt(expected_str, sizeof(expected_str), TEST_25_INPUT[i] & (0xFFFFFFFFu >> (UINT32_T_BITS - hex_nbits[k])), hex_nbits[k], flags);
+					if (strcmp(expected_str, TEST_25_HEX + (i * stride)) != 0) {
+						printf("test_permute: (FAILURE): %s, uint_to_hexstr_many nbits = %u, flags = 0x%X, EXPECT = %s, RESULT = %s\n", bitops_isa_name((bitops_isa_t)isa), hex_nbits[k], flags, expected_str, TEST_25_HEX + (i * stride));
+						return_code = EXIT_TEST_FAILURE;
+						break;
+					}
+				}
+			}
+		}
+
+		if (int32_to_binstr_many((const int32_t*)TEST_25_INPUT, TEST_25_VALUES, TEST_25_BIN, sizeof(TEST_25_BIN), UINT32_T_BITS, BINSTR_REVERSED | BINSTR_BIG_ENDIAN) != 0) {
+			return_code = EXIT_TEST_FAILURE;
+		}
+		for (i = 0; i < TEST_25_VALUES; i++) {
+			uint_to_binstr_fmt(expected_str, sizeof(expected_str), TEST_25_INPUT[i], UINT32_T_BITS, BINSTR_REVERSED | BINSTR_BIG_ENDIAN);
+			if (strcmp(expected_str, TEST_25_BIN + (i * BINSTR_SLOT_BYTES(UINT32_T_BITS))) != 0) {
+				printf("test_permute: (FAILURE): %s, int32_to_binstr_many reversed big-endian, EXPECT = %s, RESULT = %s\n", bitops_isa_name((bitops_isa_t)isa), expected_str, TEST_25_BIN + (i * BINSTR_SLOT_BYTES(UINT32_T_BITS)));
+				return_code = EXIT_TEST_FAILURE;
+				break;
+			}
+		}
 	}
 
-	printf("test_twiggle_bit: TEST_B (EXPECT) : input = %u, bit = %d, operation = %s EXPECT = %u\n", (uint32_t)TEST_4B_DEC, (int)TEST_4B_BIT, ((TEST_4B_OP == CLEAR) ? "CLEAR" : ((TEST_4B_OP == SET) ? "SET" : ((TEST_4B_OP == TOGGLE) ? "TOGGLE" : "UNKNOWN"))), TEST_4B_EXPECTED);
-	printf("test_twiggle_bit: TEST_B (RESULT) : input = %u, bit = %d, operation = %s RESULT = %u\n", (uint32_t)TEST_4B_DEC, (int)TEST_4B_BIT, ((TEST_4B_OP == CLEAR) ? "CLEAR" : ((TEST_4B_OP == SET) ? "SET" : ((TEST_4B_OP == TOGGLE) ? "TOGGLE" : "UNKNOWN"))), output);
+	bitops_set_isa(initial);
 
-	output = twiggle_bit((uint32_t)TEST_4C_DEC, (int)TEST_4C_BIT, (operation_t)TEST_4C_OP);
+	///< Known answers for the formatter flags
+	uint_to_hexstr_fmt(str, sizeof(str), 0x12345678u, 32, HEXSTR_LOWER | HEXSTR_BIG_ENDIAN);
+	if (strcmp(str, "0x78563412") != 0) {
+		printf("test_permute: (FAILURE): big-endian hex, EXPECT = 0x78563412, RESULT = %s\n", str);
+		return_code = EXIT_TEST_FAILURE;
+	}
+	uint_to_hexstr_fmt(str, sizeof(str), 0x1u, 4, HEXSTR_LOWER | HEXSTR_REVERSED);
+	if (strcmp(str, "0x8") != 0) {
+		printf("test_permute: (FAILURE): reversed 4-bit hex, EXPECT = 0x8, RESULT = %s\n", str);
+		return_code = EXIT_TEST_FAILURE;
+	}
+	uint_to_binstr_fmt(str, sizeof(str), 0x1u, 8, BINSTR_REVERSED);
+	if (strcmp(str, "0b10000000") != 0) {
+		printf("test_permute: (FAILURE): reversed binary, EXPECT = 0b10000000, RESULT = %s\n", str);
+		return_code = EXIT_TEST_FAILURE;
+	}
+	uint_to_binstr_fmt(str, sizeof(str), 0x0180u, 16, BINSTR_BIG_ENDIAN);
+	if (strcmp(str, "0b1000000000000001") != 0) {
+		printf("test_permute: (FAILURE): big-endian binary, EXPECT = 0b1000000000000001, RESULT = %s\n", str);
+		return_code = EXIT_TEST_FAILURE;
+	}
+	if ((reverse_bits(0x3u, 5) != 0x18u) || (reverse_bits(0x80000000u, 32) != 0x1u)) {
+		printf("test_permute: (FAILURE): reverse_bits\n");
+		return_code = EXIT_TEST_FAILURE;
+	}
 
-	if (output != TEST_4C_EXPECTED) {
+	///< Errors: big-endian needs whole bytes, values must fit, table entries must be bits or BITPERM_ZERO
+	if ((uint_to_binstr_fmt(str, sizeof(str), 0x1u, 12, BINSTR_BIG_ENDIAN) >= 0) || (str[0] != '\0')
+		|| (uint_to_binstr_fmt(str, sizeof(str), 0x100u, 8, BINSTR_REVERSED) >= 0) || (str[0] != '\0')
+		|| (uint_to_hexstr_fmt(str, sizeof(str), 0x1u, 4, HEXSTR_BIG_ENDIAN) >= 0) || (str[0] != '\0')
+		|| (uint_to_hexstr_many(TEST_25_INPUT, 1, TEST_25_HEX, sizeof(TEST_25_HEX), 4, HEXSTR_BIG_ENDIAN) >= 0) || (TEST_25_HEX[0] != '\0')) {
+		printf("test_permute: (FAILURE): big-endian flag accepted a partial byte\n");
+		return_code = EXIT_TEST_FAILURE;
+	}
+	memcpy(bad, tables[0], sizeof(bad));
+	bad[7] = BITPERM_BITS;
+	if ((bitperm_compile(&perm, bad) >= 0) || (permute_bits(0xFFFFFFFFu, &perm) != 0)) {
+		printf("test_permute: (FAILURE): bitperm_compile accepted source bit %d\n", BITPERM_BITS);
+		return_code = EXIT_TEST_FAILURE;
+	}
+	if ((bitperm_compile(&perm, tables[0]) != 1) || (perm.nchains != 1) || (bitperm_compile(&perm, tables[1]) != BITPERM_BITS / 2)) {
+		printf("test_permute: (FAILURE): group or chain count\n");
 		return_code = EXIT_TEST_FAILURE;
 	}
 
-	printf("test_twiggle_bit: TEST_C (EXPECT) : input = %u, bit = %d, operation = %s EXPECT = %u\n", (uint32_t)TEST_4C_DEC, (int)TEST_4C_BIT, ((TEST_4C_OP == CLEAR) ? "CLEAR" : ((TEST_4C_OP == SET) ? "SET" : ((TEST_4C_OP == TOGGLE) ? "TOGGLE" : "UNKNOWN"))), TEST_4C_EXPECTED);
-	printf("test_twiggle_bit: TEST_C (RESULT) : input = %u, bit = %d, operation = %s RESULT = %u\n", (uint32_t)TEST_4C_DEC, (int)TEST_4C_BIT, ((TEST_4C_OP == CLEAR) ? "CLEAR" : ((TEST_4C_OP == SET) ? "SET" : ((TEST_4C_OP == TOGGLE) ? "TOGGLE" : "UNKNOWN"))), output);
+	printf("test_permute: %d tables x %u values, bit reversal, byte swap and folded formatter flags on tiers scalar..%s\n", TEST_25_TABLES, TEST_25_VALUES, bitops_isa_name(max_isa));
 
 	return return_code;
 }
 
-int test_grab_three_bits(uint32_t input, int start_bit) {
-	uint32_t output;
+/**
+ * \fn test_cache_worker(void* arg)
+ * \brief Waits at the barrier so every thread asks for the tables at once, then formats the TEST_26 values at 32 bits and compares them with the computed strings
+ *
+ * \return arg, pointing at 1 if every string matched and 0 otherwise
+ */
+static void* test_cache_worker(void* arg) {
+	int* ok = (int*)arg;
+	char str[PREFIX_BYTES_BIN + UINT32_T_BITS + NULL_TERMINATOR_BYTE];
+	uint32_t i;
+
+	pthread_barrier_wait(&TEST_26_BARRIER);
+
+	*ok = 1;
+	for (i = 0; i < TEST_26_VALUES; i++) {
+		uint_to_binstr(str, sizeof(str), TEST_26_INPUT[i], 32);
+		if (strcmp(str, TEST_26_BIN[i]) != 0) {
+			*ok = 0;
+		}
+		uint_to_hexstr(str, sizeof(str), TEST_26_INPUT[i], 32);
+		if (strcmp(str, TEST_26_HEX[i]) != 0) {
+			*ok = 0;
+		}
+	}
+
+	return arg;
+}
+
+int test_cache(void) {
+	static const uint8_t widths[] = { 8, 16, 32 };
+	static const uint32_t modes[] = { BITOPS_CACHE_8, BITOPS_CACHE_16 };
+	pthread_t threads[TEST_26_THREADS];
+	int ok[TEST_26_THREADS];
+	char expected[PREFIX_BYTES_BIN + UINT32_T_BITS + NULL_TERMINATOR_BYTE];
+	char result[PREFIX_BYTES_BIN + UINT32_T_BITS + NULL_TERMINATOR_BYTE];
+	uint32_t initial = bitops_cache();
+	uint32_t selected;
+	size_t footprint;
+	uint32_t state = TEST_26_SEED;
+	uint32_t num;
+	uint32_t flags;
+	uint32_t i;
+	int expected_len;
+	int len;
+	int m;
+	int k;
+	int t;
 	int return_code = EXIT_TEST_SUCCESS;
 
-	output = grab_three_bits((uint32_t)TEST_5A_DEC, (int)TEST_5A_SBIT);
+	bitops_set_cache(BITOPS_CACHE_OFF);
+	for (i = 0; i < TEST_26_VALUES; i++) {
+		TEST_26_INPUT[i] = test_rand32(&state);
+		uint_to_binstr(TEST_26_BIN[i], sizeof(TEST_26_BIN[i]), TEST_26_INPUT[i], 32);
+		uint_to_hexstr(TEST_26_HEX[i], sizeof(TEST_26_HEX[i]), TEST_26_INPUT[i], 32);
+	}
 
-	if (output != TEST_5A_EXPECTED) {
+	///< Every thread's first call finds the 16-bit tables requested but not built, so they race to build them
+	selected = bitops_set_cache(BITOPS_CACHE_16);
+	footprint = (selected != BITOPS_CACHE_OFF) ? BITOPS_CACHE_8_BYTES + BITOPS_CACHE_16_BYTES : 0;
+	pthread_barrier_init(&TEST_26_BARRIER, NULL, TEST_26_THREADS);
+	for (t = 0; t < TEST_26_THREADS; t++) {
+		ok[t] = 0;
+		if (pthread_create(&threads[t], NULL, test_cache_worker, &ok[t]) != 0) {
+			printf("test_cache: (FAILURE): could not start thread %d\n", t);
+			return EXIT_TEST_FAILURE;
+		}
+	}
+	for (t = 0; t < TEST_26_THREADS; t++) {
+		pthread_join(threads[t], NULL);
+		if (!ok[t]) {
+			printf("test_cache: (FAILURE): thread %d formatted a value differently while the tables were built\n", t);
+			return_code = EXIT_TEST_FAILURE;
+		}
+	}
+	pthread_barrier_destroy(&TEST_26_BARRIER);
+
+	///< A NOCACHE=1 build selects nothing and holds nothing
+	if ((bitops_cache() != selected) || (bitops_cache_footprint() != footprint)) {
+		printf("test_cache: (FAILURE): tables 0x%X, footprint = %zu, EXPECT %zu\n", bitops_cache(), bitops_cache_footprint(), footprint);
 		return_code = EXIT_TEST_FAILURE;
 	}
 
-	printf("test_grab_three_bits: TEST_A (EXPECT) : input = %u, start_bit = %d, EXPECT = %u\n", (uint32_t)TEST_5A_DEC, (int)TEST_5A_SBIT, TEST_5A_EXPECTED);
-	printf("test_grab_three_bits: TEST_A (RESULT) : input = %u, start_bit = %d, RESULT = %u\n", (uint32_t)TEST_5A_DEC, (int)TEST_5A_SBIT, output);
+	///< Each table mode must print exactly what the computed path prints, for every formatter, width and hex flag
+	for (m = 0; m < (int)(sizeof(modes) / sizeof(modes[0])); m++) {
+		for (i = 0; i < TEST_26_ROUNDS; i++) {
+			k = (int)(i % sizeof(widths));
+			num = test_rand32(&state) >> (UINT32_T_BITS - widths[k]);
+			flags = (i / sizeof(widths)) % 16;
+
+			bitops_set_cache(BITOPS_CACHE_OFF);
+			expected_len = uint_to_binstr(expected, sizeof(expected), num, widths[k]);
+			bitops_set_cache(modes[m]);
+			len = uint_to_binstr(result, sizeof(result), num, widths[k]);
+			if ((len != expected_len) || (strcmp(result, expected) != 0)) {
+				printf("test_cache: (FAILURE): uint_to_binstr tables 0x%X, num = %u, nbits = %u, EXPECT = %s, RESULT = %s\n", modes[m], num, widths[k], expected, result);
+				return_code = EXIT_TEST_FAILURE;
+			}
+
+			bitops_set_cache(BITOPS_CACHE_OFF);
+			expected_len = int_to_binstr(expected, sizeof(expected), (int32_t)(num * 2654435761u), widths[k]);
+			bitops_set_cache(modes[m]);
+			len = int_to_binstr(result, sizeof(result), (int32_t)(num * 2654435761u), widths[k]);
+			if ((len != expected_len) || (strcmp(result, expected) != 0)) {
+				printf("test_cache: (FAILURE): int_to_binstr tables 0x%X, num = %d, nbits = %u, EXPECT = %s, RESULT = %s\n", modes[m], (int32_t)(num * 2654435761u), widths[k], expected, result);
+				return_code = EXIT_TEST_FAILURE;
+			}
+
+			bitops_set_cache(BITOPS_CACHE_OFF);
+			expected_len = uint_to_hexstr_fmt(expected, sizeof(expected), num, widths[k], flags);
+			bitops_set_cache(modes[m]);
+			len = uint_to_hexstr_fmt(result, sizeof(result), num, widths[k], flags);
+			if ((len != expected_len) || (strcmp(result, expected) != 0)) {
+				printf("test_cache: (FAILURE): uint_to_hexstr_fmt tables 0x%X, num = %u, nbits = %u, flags = 0x%X, EXPECT = %s, RESULT = %s\n", modes[m], num, widths[k], flags, expected, result);
+				return_code = EXIT_TEST_FAILURE;
+			}
+		}
 
-	output = grab_three_bits((uint32_t)TEST_5B_DEC, (int)TEST_5B_SBIT);
+		///< Values too wide for nbits are refused the same way with the tables
+		if ((uint_to_binstr(result, sizeof(result), 256u, 8) >= 0) || (result[0] != '\0') || (uint_to_binstr(result, sizeof(result), 65536u, 16) >= 0) || (result[0] != '\0')) {
+			printf("test_cache: (FAILURE): tables 0x%X accepted a value wider than nbits\n", modes[m]);
+			return_code = EXIT_TEST_FAILURE;
+		}
+		uint_to_hexstr(result, sizeof(result), 0xBEEFu, 16);
+		if (strcmp(result, "0xBEEF") != 0) {
+			printf("test_cache: (FAILURE): tables 0x%X, uint_to_hexstr(0xBEEF, 16) = %s\n", modes[m], result);
+			return_code = EXIT_TEST_FAILURE;
+		}
+	}
 
-	if (output != TEST_5B_EXPECTED) {
+	///< Turning the tables off keeps them allocated but stops their use
+	bitops_set_cache(BITOPS_CACHE_OFF);
+	if ((bitops_cache() != BITOPS_CACHE_OFF) || (bitops_cache_footprint() != footprint)) {
+		printf("test_cache: (FAILURE): tables 0x%X after turning them off\n", bitops_cache());
 		return_code = EXIT_TEST_FAILURE;
 	}
 
-	printf("test_grab_three_bits: TEST_B (EXPECT) : input = %u, start_bit = %d, EXPECT = %u\n", (uint32_t)TEST_5B_DEC, (int)TEST_5B_SBIT, TEST_5B_EXPECTED);
-	printf("test_grab_three_bits: TEST_B (RESULT) : input = %u, start_bit = %d, RESULT = %u\n", (uint32_t)TEST_5B_DEC, (int)TEST_5B_SBIT, output);
-
-	return return_code;
-}
-
-int test_hexdump(char* str, size_t size, const void* loc, size_t nbytes) {
-	int return_code = EXIT_TEST_SUCCESS;
+	bitops_set_cache(initial);
 
-	return_code = EXIT_TEST_FAILURE;
+	printf("test_cache: %d threads building the tables at once, %u values x 8/16/32 bits x 8-bit and 16-bit tables, footprint %zu bytes\n", TEST_26_THREADS, TEST_26_ROUNDS, bitops_cache_footprint());
 
 	return return_code;
-}
\ No newline at end of file
+}
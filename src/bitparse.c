@@ -0,0 +1,601 @@
+#include <assert.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "bitops.h"
+
+#if defined(__x86_64__) || defined(__i386__)
+#define BITOPS_X86 (1)
+#include <immintrin.h>
+#endif
+
+#define EXIT_FAILURE_N (-1)
+#define EXIT_TEST_SUCCESS (1)
+#define EXIT_TEST_FAILURE (0)
+
+#define BITS_PER_NIBBLE (4)
+#define NULL_TERMINATOR_BYTE (1)
+#define PREFIX_BYTES_BIN (2)
+#define PREFIX_BYTES_HEX (2)
+#define UINT32_T_BITS (32)
+#define HEX_DIGITS_MAX (UINT32_T_BITS / BITS_PER_NIBBLE)
+
+#define HEXDUMP_OFFSET_CHARS (8)
+#define HEXDUMP_GUTTER_CHARS (2)
+#define HEX_PAIR_STRIDE (3)
+
+#define TEST_14_SEED (2718u)
+#define TEST_14_ROUNDS (20000u)
+#define TEST_14_DUMP_BYTES (4099u)
+
+uint8_t TEST_14_DATA[TEST_14_DUMP_BYTES];
+uint8_t TEST_14_PARSED[TEST_14_DUMP_BYTES];
+char TEST_14_TEXT[(TEST_14_DUMP_BYTES / HEXDUMP_BYTES_PER_ROW + 1) * HEXDUMP_ROW_CHARS + NULL_TERMINATOR_BYTE];
+
+/**
+ * \fn hex_value(char c)
+ * \brief Maps one hex digit of either case to its value
+ *
+ * \return The digit value (0 to 15), or -1 if c is not a hex digit
+ */
+static inline int hex_value(char c) {
+	if ((c >= '0') && (c <= '9')) {
+		return c - '0';
+	}
+	if ((c >= 'A') && (c <= 'F')) {
+		return c - 'A' + 10;
+	}
+	if ((c >= 'a') && (c <= 'f')) {
+		return c - 'a' + 10;
+	}
+
+	return -1;
+}
+
+/**
+ * \fn bin_digits_scalar(const char* digits, size_t n, uint32_t* num)
+ * \brief Portable parser for 1 to 32 binary digits
+ *
+ * \return -1 if every digit is valid (num is set), otherwise the index of the first invalid digit
+ */
+static int bin_digits_scalar(const char* digits, size_t n, uint32_t* num) {
+	size_t i;
+	uint32_t value = 0;
+
+	for (i = 0; i < n; i++) {
+		if ((digits[i] != '0') && (digits[i] != '1')) {
+			return (int)i;
+		}
+		value = (value << 1) | (uint32_t)(digits[i] - '0');
+	}
+
+	*num = value;
+
+	return -1;
+}
+
+/**
+ * \fn hex_digits_scalar(const char* digits, size_t n, uint32_t* num)
+ * \brief Portable parser for 1 to 8 hex digits
+ *
+ * \return -1 if every digit is valid (num is set), otherwise the index of the first invalid digit
+ */
+static int hex_digits_scalar(const char* digits, size_t n, uint32_t* num) {
+	size_t i;
+	int nibble;
+	uint32_t value = 0;
+
+	for (i = 0; i < n; i++) {
+		nibble = hex_value(digits[i]);
+		if (nibble < 0) {
+			return (int)i;
+		}
+		value = (value << BITS_PER_NIBBLE) | (uint32_t)nibble;
+	}
+
+	*num = value;
+
+	return -1;
+}
+
+#ifdef BITOPS_X86
+/**
+ * \fn bin_digits_sse2(const char* digits, size_t n, uint32_t* num)
+ * \brief SSE2 parser for 1 to 32 binary digits. The digits are right-aligned in a '0'-padded block, compared against '0' and '1', and pmovmskb turns the '1' lanes straight into the value (bit-reversed, since lane 0 holds the most significant digit)
+ *
+ * \return -1 if every digit is valid (num is set), otherwise the index of the first invalid digit
+ */
+static __attribute__((target("sse2"))) int bin_digits_sse2(const char* digits, size_t n, uint32_t* num) {
+	char block[UINT32_T_BITS];
+	__m128i lo;
+	__m128i hi;
+	uint32_t ones;
+	uint32_t zeros;
+	uint32_t invalid;
+
+	memset(block, '0', sizeof(block));
+	memcpy(block + UINT32_T_BITS - n, digits, n);
+
+	lo = _mm_loadu_si128((const __m128i*)block);
+	hi = _mm_loadu_si128((const __m128i*)(block + 16));
+	ones = (uint32_t)_mm_movemask_epi8(_mm_cmpeq_epi8(lo, _mm_set1_epi8('1'))) | ((uint32_t)_mm_movemask_epi8(_mm_cmpeq_epi8(hi, _mm_set1_epi8('1'))) << 16);
+	zeros = (uint32_t)_mm_movemask_epi8(_mm_cmpeq_epi8(lo, _mm_set1_epi8('0'))) | ((uint32_t)_mm_movemask_epi8(_mm_cmpeq_epi8(hi, _mm_set1_epi8('0'))) << 16);
+	invalid = ~(ones | zeros);
+
+	if (invalid != 0) {
+		return __builtin_ctz(invalid) - (int)(UINT32_T_BITS - n);
+	}
+
+	*num = reverse_bits32(ones);
+
+	return -1;
+}
+
+/**
+ * \fn hex_decode16_ssse3(__m128i chars, uint32_t* invalid)
+ * \brief Classifies 16 hex characters and packs them pairwise into 8 bytes, most significant digit first
+ *
+ * \param chars 16 ASCII characters
+ * \param invalid Set to a mask with bit i set when chars lane i is not a hex digit
+ *
+ * \return The 8 decoded bytes in the low half of the vector
+ */
+static inline __attribute__((target("ssse3"))) __m128i hex_decode16_ssse3(__m128i chars, uint32_t* invalid) {
+	__m128i lower = _mm_or_si128(chars, _mm_set1_epi8(0x20));
+	__m128i is_digit = _mm_and_si128(_mm_cmpgt_epi8(chars, _mm_set1_epi8('0' - 1)), _mm_cmplt_epi8(chars, _mm_set1_epi8('9' + 1)));
+	__m128i is_alpha = _mm_and_si128(_mm_cmpgt_epi8(lower, _mm_set1_epi8('a' - 1)), _mm_cmplt_epi8(lower, _mm_set1_epi8('f' + 1)));
+	__m128i value = _mm_or_si128(_mm_and_si128(is_digit, _mm_sub_epi8(chars, _mm_set1_epi8('0'))), _mm_and_si128(is_alpha, _mm_sub_epi8(lower, _mm_set1_epi8('a' - 10))));
+
+	*invalid = ~(uint32_t)_mm_movemask_epi8(_mm_or_si128(is_digit, is_alpha)) & 0xFFFFu;
+
+	///< Each pair becomes high * 16 + low, then the 16-bit results are narrowed to bytes
+	return _mm_packus_epi16(_mm_maddubs_epi16(value, _mm_set1_epi16(0x0110)), _mm_setzero_si128());
+}
+
+/**
+ * \fn hex_digits_ssse3(const char* digits, size_t n, uint32_t* num)
+ * \brief SSSE3 parser for 1 to 8 hex digits
+ *
+ * \return -1 if every digit is valid (num is set), otherwise the index of the first invalid digit
+ */
+static __attribute__((target("ssse3"))) int hex_digits_ssse3(const char* digits, size_t n, uint32_t* num) {
+	char block[16];
+	uint32_t invalid;
+	__m128i packed;
+
+	memset(block, '0', sizeof(block));
+	memcpy(block + HEX_DIGITS_MAX - n, digits, n);
+
+	packed = hex_decode16_ssse3(_mm_loadu_si128((const __m128i*)block), &invalid);
+	invalid &= 0xFFu;
+
+	if (invalid != 0) {
+		return __builtin_ctz(invalid) - (int)(HEX_DIGITS_MAX - n);
+	}
+
+	*num = __builtin_bswap32((uint32_t)_mm_cvtsi128_si32(packed));
+
+	return -1;
+}
+
+/**
+ * \fn hexdump_row_ssse3(const char* row, uint32_t offset, uint8_t* out)
+ * \brief Decodes one complete 58-character hexdump row. The 32 digit characters are gathered out of the "XX " groups with pshufb and decoded 16 at a time; offset, spacing and newline are checked against a template
+ *
+ * \return 1 if the row is well formed and carries offset (out holds its 16 bytes), 0 otherwise
+ */
+static __attribute__((target("ssse3"))) int hexdump_row_ssse3(const char* row, uint32_t offset, uint8_t* out) {
+	const char* digits = row + HEXDUMP_OFFSET_CHARS + HEXDUMP_GUTTER_CHARS;
+	__m128i a = _mm_loadu_si128((const __m128i*)digits);
+	__m128i b = _mm_loadu_si128((const __m128i*)(digits + 16));
+	__m128i c = _mm_loadu_si128((const __m128i*)(digits + 32));
+	__m128i first;
+	__m128i second;
+	__m128i head;
+	uint32_t invalid;
+	uint32_t bad = 0;
+	uint32_t row_offset;
+
+	///< Separator lanes must be ' ' and the final lane '\n'
+	if ((((uint32_t)_mm_movemask_epi8(_mm_cmpeq_epi8(a, _mm_set1_epi8(' '))) & 0x4924u) != 0x4924u) ||
+		(((uint32_t)_mm_movemask_epi8(_mm_cmpeq_epi8(b, _mm_set1_epi8(' '))) & 0x2492u) != 0x2492u) ||
+		(((uint32_t)_mm_movemask_epi8(_mm_cmpeq_epi8(c, _mm_setr_epi8(' ', 0, 0, ' ', 0, 0, ' ', 0, 0, ' ', 0, 0, ' ', 0, 0, '\n'))) & 0x9249u) != 0x9249u) ||
+		(row[HEXDUMP_OFFSET_CHARS] != ' ') || (row[HEXDUMP_OFFSET_CHARS + 1] != ' ')) {
+		return 0;
+	}
+
+	head = hex_decode16_ssse3(_mm_loadu_si128((const __m128i*)row), &invalid);
+	bad |= invalid & 0xFFu;
+	row_offset = __builtin_bswap32((uint32_t)_mm_cvtsi128_si32(head));
+
+	first = _mm_or_si128(_mm_shuffle_epi8(a, _mm_setr_epi8(0, 1, 3, 4, 6, 7, 9, 10, 12, 13, 15, -128, -128, -128, -128, -128)),
+		_mm_shuffle_epi8(b, _mm_setr_epi8(-128, -128, -128, -128, -128, -128, -128, -128, -128, -128, -128, 0, 2, 3, 5, 6)));
+	second = _mm_or_si128(_mm_shuffle_epi8(b, _mm_setr_epi8(8, 9, 11, 12, 14, 15, -128, -128, -128, -128, -128, -128, -128, -128, -128, -128)),
+		_mm_shuffle_epi8(c, _mm_setr_epi8(-128, -128, -128, -128, -128, -128, 1, 2, 4, 5, 7, 8, 10, 11, 13, 14)));
+
+	first = hex_decode16_ssse3(first, &invalid);
+	bad |= invalid;
+	second = hex_decode16_ssse3(second, &invalid);
+	bad |= invalid;
+
+	if ((bad != 0) || (row_offset != offset)) {
+		return 0;
+	}
+
+	_mm_storel_epi64((__m128i*)out, first);
+	_mm_storel_epi64((__m128i*)(out + 8), second);
+
+	return 1;
+}
+
+/**
+ * \fn bitops_has_sse2(void)
+ * \brief Reports whether SSE2 instructions are enabled in the chosen ISA tier
+ *
+ * \return 1 if SSE2 instructions may be used, 0 otherwise
+ */
+static int bitops_has_sse2(void) {
+	return (bitops_cpu_features() & BITOPS_CPU_SSE2) ? 1 : 0;
+}
+#endif
+
+/**
+ * \fn bitops_has_ssse3(void)
+ * \brief Reports whether SSSE3 instructions are enabled in the chosen ISA tier
+ *
+ * \return 1 if SSSE3 instructions may be used, 0 otherwise
+ */
+static int bitops_has_ssse3(void) {
+	return (bitops_cpu_features() & BITOPS_CPU_SSSE3) ? 1 : 0;
+}
+
+/**
+ * \fn parse_prefix(const char* str, size_t len, char letter, size_t max_digits, size_t* error_pos)
+ * \brief Checks the "0b"/"0x" prefix and the digit count shared by both integer parsers
+ *
+ * \return The number of digits after the prefix, or 0 if str is malformed (error_pos is set)
+ */
+static size_t parse_prefix(const char* str, size_t len, char letter, size_t max_digits, size_t* error_pos) {
+	if ((len < 1) || (str[0] != '0')) {
+		*error_pos = 0;
+		return 0;
+	}
+	if ((len < 2) || (str[1] != letter)) {
+		*error_pos = 1;
+		return 0;
+	}
+	if (len == 2) {
+		*error_pos = 2;
+		return 0;
+	}
+
+	return (len - 2 > max_digits) ? max_digits + 1 : len - 2;
+}
+
+/**
+ * \fn binstr_to_uint(const char* str, size_t len, uint32_t* num, size_t* error_pos)
+ * \brief Parses a "0b" binary string, as written by uint_to_binstr, back into a 32-bit unsigned int
+ *
+ * \param str Pointer to the characters to parse (no terminal \0 is needed)
+ * \param len The number of characters in str, which must all belong to the number
+ * \param num Set to the parsed value on success
+ * \param error_pos On failure, set to the index in str of the first character that makes it malformed (len if it ended too early)
+ *
+ * \return If successful, returns the number of binary digits parsed (1 to 32). If str is malformed, returns a negative value.
+ */
+int binstr_to_uint(const char* str, size_t len, uint32_t* num, size_t* error_pos) {
+	assert((str != NULL) || (len == 0));
+	assert(num != NULL);
+	assert(error_pos != NULL);
+
+	size_t ndigits = parse_prefix(str, len, 'b', UINT32_T_BITS, error_pos);
+	size_t checked;
+	int bad;
+
+	if (ndigits == 0) {
+		return EXIT_FAILURE_N;
+	}
+
+	checked = (ndigits > UINT32_T_BITS) ? UINT32_T_BITS : ndigits;
+
+#ifdef BITOPS_X86
+	if (bitops_has_sse2()) {
+		bad = bin_digits_sse2(str + PREFIX_BYTES_BIN, checked, num);
+	}
+	else {
+		bad = bin_digits_scalar(str + PREFIX_BYTES_BIN, checked, num);
+	}
+#else
+	bad = bin_digits_scalar(str + PREFIX_BYTES_BIN, checked, num);
+#endif
+
+	if (bad >= 0) {
+		*error_pos = PREFIX_BYTES_BIN + (size_t)bad;
+		return EXIT_FAILURE_N;
+	}
+	if (ndigits > UINT32_T_BITS) {
+		*error_pos = PREFIX_BYTES_BIN + UINT32_T_BITS;
+		return EXIT_FAILURE_N;
+	}
+
+	return (int)ndigits;
+}
+
+/**
+ * \fn hexstr_to_uint(const char* str, size_t len, uint32_t* num, size_t* error_pos)
+ * \brief Parses a "0x" hex string of either case, as written by uint_to_hexstr, back into a 32-bit unsigned int
+ *
+ * \param str Pointer to the characters to parse (no terminal \0 is needed)
+ * \param len The number of characters in str, which must all belong to the number
+ * \param num Set to the parsed value on success
+ * \param error_pos On failure, set to the index in str of the first character that makes it malformed (len if it ended too early)
+ *
+ * \return If successful, returns the number of bits parsed (4 times the number of hex digits, up to 32). If str is malformed, returns a negative value.
+ */
+int hexstr_to_uint(const char* str, size_t len, uint32_t* num, size_t* error_pos) {
+	assert((str != NULL) || (len == 0));
+	assert(num != NULL);
+	assert(error_pos != NULL);
+
+	size_t ndigits = parse_prefix(str, len, 'x', HEX_DIGITS_MAX, error_pos);
+	size_t checked;
+	int bad;
+
+	if (ndigits == 0) {
+		return EXIT_FAILURE_N;
+	}
+
+	checked = (ndigits > HEX_DIGITS_MAX) ? HEX_DIGITS_MAX : ndigits;
+
+#ifdef BITOPS_X86
+	if (bitops_has_ssse3()) {
+		bad = hex_digits_ssse3(str + PREFIX_BYTES_HEX, checked, num);
+	}
+	else {
+		bad = hex_digits_scalar(str + PREFIX_BYTES_HEX, checked, num);
+	}
+#else
+	bad = hex_digits_scalar(str + PREFIX_BYTES_HEX, checked, num);
+#endif
+
+	if (bad >= 0) {
+		*error_pos = PREFIX_BYTES_HEX + (size_t)bad;
+		return EXIT_FAILURE_N;
+	}
+	if (ndigits > HEX_DIGITS_MAX) {
+		*error_pos = PREFIX_BYTES_HEX + HEX_DIGITS_MAX;
+		return EXIT_FAILURE_N;
+	}
+
+	return (int)(ndigits * BITS_PER_NIBBLE);
+}
+
+/**
+ * \fn hexdump_row_scalar(const char* row, size_t len, uint32_t offset, uint8_t* out, size_t out_size, size_t* row_bytes, size_t* row_chars)
+ * \brief Parses one hexdump row of 1 to 16 bytes character by character, finding the exact position of any error
+ *
+ * \param row Pointer to the start of the row
+ * \param len Characters available from row to the end of the text
+ * \param offset The offset the row must be labeled with
+ * \param out Pointer to where the row's bytes go
+ * \param out_size Bytes available at out
+ * \param row_bytes Set to the number of bytes in the row
+ * \param row_chars Set to the number of characters in the row, including its newline if present
+ *
+ * \return -1 if the row is well formed, otherwise the index in row of the first bad character
+ */
+static int hexdump_row_scalar(const char* row, size_t len, uint32_t offset, uint8_t* out, size_t out_size, size_t* row_bytes, size_t* row_chars) {
+	size_t pos;
+	size_t n = 0;
+	uint32_t row_offset;
+	int bad;
+	int hi;
+	int lo;
+
+	if (len < HEXDUMP_OFFSET_CHARS) {
+		bad = hex_digits_scalar(row, len, &row_offset);
+		return (bad >= 0) ? bad : (int)len;
+	}
+
+	bad = hex_digits_scalar(row, HEXDUMP_OFFSET_CHARS, &row_offset);
+	if (bad >= 0) {
+		return bad;
+	}
+	if (row_offset != offset) {
+		return 0;
+	}
+
+	for (pos = HEXDUMP_OFFSET_CHARS; pos < HEXDUMP_OFFSET_CHARS + HEXDUMP_GUTTER_CHARS; pos++) {
+		if ((pos >= len) || (row[pos] != ' ')) {
+			return (int)pos;
+		}
+	}
+
+	for (;;) {
+		hi = (pos < len) ? hex_value(row[pos]) : -1;
+		if (hi < 0) {
+			return (int)pos;
+		}
+		lo = (pos + 1 < len) ? hex_value(row[pos + 1]) : -1;
+		if (lo < 0) {
+			return (int)(pos + 1);
+		}
+		if (n >= out_size) {
+			return (int)pos;
+		}
+
+		out[n++] = (uint8_t)((hi << BITS_PER_NIBBLE) | lo);
+		pos += 2;
+
+		///< A row ends at a newline, or at the end of the text without one
+		if ((pos == len) || (row[pos] == '\n')) {
+			*row_bytes = n;
+			*row_chars = (pos == len) ? pos : pos + 1;
+			return -1;
+		}
+		if ((row[pos] != ' ') || (n == HEXDUMP_BYTES_PER_ROW)) {
+			return (int)pos;
+		}
+		pos++;
+	}
+}
+
+/**
+ * \fn hexdump_parse(const char* text, size_t len, uint8_t* out, size_t out_size, size_t* nbytes, size_t* error_pos)
+ * \brief Rebuilds the original bytes from hexdump output. Rows must carry consecutive offsets starting at 0 and only the last row may be shorter than 16 bytes
+ *
+ * \param text Pointer to the dump text (no terminal \0 is needed)
+ * \param len The number of characters in text
+ * \param out Pointer to where the bytes go
+ * \param out_size Num of bytes of the array pointed to by out
+ * \param nbytes Set to the number of bytes written to out, including on failure
+ * \param error_pos On failure, set to the index in text of the first bad character, or of the first byte that does not fit in out
+ *
+ * \return If successful, returns 0. If text is malformed or out is too small, returns a negative value.
+ */
+int hexdump_parse(const char* text, size_t len, uint8_t* out, size_t out_size, size_t* nbytes, size_t* error_pos) {
+	assert((text != NULL) || (len == 0));
+	assert((out != NULL) || (out_size == 0));
+	assert(nbytes != NULL);
+	assert(error_pos != NULL);
+
+	size_t pos = 0;
+	size_t written = 0;
+	size_t row_bytes;
+	size_t row_chars;
+	int bad;
+#ifdef BITOPS_X86
+	int use_ssse3 = bitops_has_ssse3();
+#endif
+
+	while (pos < len) {
+#ifdef BITOPS_X86
+		///< A bad row falls through to the scalar parser, which finds the exact position
+		if (use_ssse3 && (len - pos >= HEXDUMP_ROW_CHARS) && (out_size - written >= HEXDUMP_BYTES_PER_ROW) &&
+			hexdump_row_ssse3(text + pos, (uint32_t)written, out + written)) {
+			pos += HEXDUMP_ROW_CHARS;
+			written += HEXDUMP_BYTES_PER_ROW;
+			continue;
+		}
+#endif
+		bad = hexdump_row_scalar(text + pos, len - pos, (uint32_t)written, out + written, out_size - written, &row_bytes, &row_chars);
+		if (bad >= 0) {
+			*nbytes = written;
+			*error_pos = pos + (size_t)bad;
+			return EXIT_FAILURE_N;
+		}
+
+		pos += row_chars;
+		written += row_bytes;
+
+		if ((row_bytes < HEXDUMP_BYTES_PER_ROW) && (pos < len)) {
+			*nbytes = written;
+			*error_pos = pos;
+			return EXIT_FAILURE_N;
+		}
+	}
+
+	*nbytes = written;
+
+	return 0;
+}
+
+int test_parsers(void) {
+	uint32_t state = TEST_14_SEED;
+	uint32_t round;
+	uint32_t value;
+	uint32_t parsed;
+	uint32_t scalar;
+	uint8_t nbits;
+	size_t error_pos;
+	size_t expected_pos;
+	size_t nbytes;
+	size_t len;
+	size_t i;
+	int num_chars;
+	int return_code = EXIT_TEST_SUCCESS;
+	char str[PREFIX_BYTES_BIN + UINT32_T_BITS + NULL_TERMINATOR_BYTE];
+
+	for (round = 0; round < TEST_14_ROUNDS; round++) {
+		nbits = (uint8_t)(round % UINT32_T_BITS + 1);
+		value = test_rand32(&state) & (0xFFFFFFFF >> (UINT32_T_BITS - nbits));
+
+		num_chars = uint_to_binstr(str, sizeof(str), value, nbits);
+		if ((binstr_to_uint(str, (size_t)num_chars, &parsed, &error_pos) != nbits) || (parsed != value) ||
+			(bin_digits_scalar(str + PREFIX_BYTES_BIN, nbits, &scalar) >= 0) || (scalar != value)) {
+			printf("test_parsers: (FAILURE): binstr_to_uint(%s) = %u\n", str, parsed);
+			return_code = EXIT_TEST_FAILURE;
+		}
+
+		///< Corrupt one digit and expect exactly its position back
+		expected_pos = PREFIX_BYTES_BIN + (test_rand32(&state) % nbits);
+		str[expected_pos] = (round & 1) ? '2' : 'b';
+		if ((binstr_to_uint(str, (size_t)num_chars, &parsed, &error_pos) >= 0) || (error_pos != expected_pos)) {
+			printf("test_parsers: (FAILURE): binstr_to_uint(%s) error_pos = %u, EXPECT %u\n", str, (uint32_t)error_pos, (uint32_t)expected_pos);
+			return_code = EXIT_TEST_FAILURE;
+		}
+
+		nbits = (uint8_t)(BITS_PER_NIBBLE << (round % 4));
+		value &= 0xFFFFFFFF >> (UINT32_T_BITS - nbits);
+		num_chars = uint_to_hexstr_fmt(str, sizeof(str), value, nbits, round & HEXSTR_LOWER);
+		if ((hexstr_to_uint(str, (size_t)num_chars, &parsed, &error_pos) != nbits) || (parsed != value) ||
+			(hex_digits_scalar(str + PREFIX_BYTES_HEX, nbits / BITS_PER_NIBBLE, &scalar) >= 0) || (scalar != value)) {
+			printf("test_parsers: (FAILURE): hexstr_to_uint(%s) = %u\n", str, parsed);
+			return_code = EXIT_TEST_FAILURE;
+		}
+
+		expected_pos = PREFIX_BYTES_HEX + (test_rand32(&state) % (nbits / BITS_PER_NIBBLE));
+		str[expected_pos] = (round & 1) ? 'g' : ':';
+		if ((hexstr_to_uint(str, (size_t)num_chars, &parsed, &error_pos) >= 0) || (error_pos != expected_pos)) {
+			printf("test_parsers: (FAILURE): hexstr_to_uint(%s) error_pos = %u, EXPECT %u\n", str, (uint32_t)error_pos, (uint32_t)expected_pos);
+			return_code = EXIT_TEST_FAILURE;
+		}
+	}
+
+	///< Too many digits and a missing prefix are reported at the first offending character
+	if ((binstr_to_uint("0b000000000000000000000000000000001", 35, &parsed, &error_pos) >= 0) || (error_pos != 34) ||
+		(hexstr_to_uint("0X12", 4, &parsed, &error_pos) >= 0) || (error_pos != 1) ||
+		(hexstr_to_uint("0x", 2, &parsed, &error_pos) >= 0) || (error_pos != 2)) {
+		printf("test_parsers: (FAILURE): prefix / length errors\n");
+		return_code = EXIT_TEST_FAILURE;
+	}
+
+	for (i = 0; i < TEST_14_DUMP_BYTES; i++) {
+		TEST_14_DATA[i] = (uint8_t)test_rand32(&state);
+	}
+
+	for (len = 0; len <= TEST_14_DUMP_BYTES; len += (len < 40) ? 1 : 997) {
+		hexdump(TEST_14_TEXT, sizeof(TEST_14_TEXT), TEST_14_DATA, len);
+		if ((hexdump_parse(TEST_14_TEXT, strlen(TEST_14_TEXT), TEST_14_PARSED, sizeof(TEST_14_PARSED), &nbytes, &error_pos) != 0) ||
+			(nbytes != len) || (memcmp(TEST_14_PARSED, TEST_14_DATA, len) != 0)) {
+			printf("test_parsers: (FAILURE): hexdump_parse round trip, nbytes = %u\n", (uint32_t)len);
+			return_code = EXIT_TEST_FAILURE;
+		}
+	}
+
+	///< Corrupt a digit, a separator and an offset deep in the dump; each must be found exactly
+	hexdump(TEST_14_TEXT, sizeof(TEST_14_TEXT), TEST_14_DATA, TEST_14_DUMP_BYTES);
+	len = strlen(TEST_14_TEXT);
+	for (i = 0; i < 3; i++) {
+		expected_pos = (i == 0) ? (HEXDUMP_ROW_CHARS * 100 + 20) : ((i == 1) ? (HEXDUMP_ROW_CHARS * 200 + 15) : (HEXDUMP_ROW_CHARS * 250 + 3));
+		if (i == 2) {
+			TEST_14_TEXT[expected_pos] = (TEST_14_TEXT[expected_pos] == '9') ? '8' : '9';
+		}
+		else {
+			TEST_14_TEXT[expected_pos] = (i == 0) ? 'x' : '-';
+		}
+		if (i == 2) {
+			///< A valid digit with the wrong value is reported at the start of the offset
+			expected_pos = HEXDUMP_ROW_CHARS * 250;
+		}
+		if ((hexdump_parse(TEST_14_TEXT, len, TEST_14_PARSED, sizeof(TEST_14_PARSED), &nbytes, &error_pos) >= 0) || (error_pos != expected_pos)) {
+			printf("test_parsers: (FAILURE): hexdump_parse error_pos = %u, EXPECT %u\n", (uint32_t)error_pos, (uint32_t)expected_pos);
+			return_code = EXIT_TEST_FAILURE;
+		}
+		hexdump(TEST_14_TEXT, sizeof(TEST_14_TEXT), TEST_14_DATA, TEST_14_DUMP_BYTES);
+	}
+
+	printf("test_parsers: %u binstr/hexstr round trips with corrupted digits, hexdump_parse round trips up to %u bytes, ssse3 %s\n", TEST_14_ROUNDS, TEST_14_DUMP_BYTES, bitops_has_ssse3() ? "checked" : "skipped");
+
+	return return_code;
+}
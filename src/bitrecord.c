@@ -0,0 +1,397 @@
+#include <errno.h>
+#include <stdio.h>
+#include <string.h>
+#include <unistd.h>
+#include "bitrecord.h"
+
+#define EXIT_FAILURE_N (-1)
+#define EXIT_TEST_SUCCESS (1)
+#define EXIT_TEST_FAILURE (0)
+
+#define PREFIX_BYTES_BIN (2)
+#define PREFIX_BYTES_HEX (2)
+#define BITS_PER_NIBBLE (4)
+#define UINT32_T_BITS (32)
+
+#define TEST_17_SEED (9001u)
+#define TEST_17_RECORDS (200)
+#define TEST_17_BUFFER_BYTES (4096)
+#define TEST_17_LINE_BYTES (512)
+#define TEST_17_DUMP_BYTES (20)
+
+char TEST_17_BUFFER[TEST_17_BUFFER_BYTES];
+char TEST_17_EXPECTED[TEST_17_LINE_BYTES];
+char TEST_17_RESULT[TEST_17_LINE_BYTES];
+
+///< Constant segments shared by every record; the iovecs point at these instead of copying them
+static const char bitrec_prefix_bin[] = "0b";
+static const char bitrec_prefix_hex[] = "0x";
+static const char bitrec_newline[] = "\n";
+
+/**
+ * \fn bitrec_init(bitrec_t* rec, char* buffer, size_t size, const char* separator)
+ * \brief Sets up an empty record builder over a caller-owned buffer for the formatted digits
+ *
+ * \param rec Pointer to the builder to set up
+ * \param buffer Pointer to the storage for formatted fields, reused by every record
+ * \param size Num of bytes of the storage pointed to by buffer
+ * \param separator Null-terminated string placed between fields (NULL for none). It is referenced, not copied, so it must outlive the builder
+ *
+ * \return None
+ */
+void bitrec_init(bitrec_t* rec, char* buffer, size_t size, const char* separator) {
+	assert(rec != NULL);
+
+	bitops_arena_init(&rec->arena, buffer, size);
+	rec->separator = separator;
+	rec->separator_len = (separator == NULL) ? 0 : strlen(separator);
+	bitrec_reset(rec);
+}
+
+/**
+ * \fn bitrec_reset(bitrec_t* rec)
+ * \brief Drops every segment so the builder can start the next batch of records in O(1)
+ *
+ * \return None
+ */
+void bitrec_reset(bitrec_t* rec) {
+	assert(rec != NULL);
+
+	bitops_arena_reset(&rec->arena);
+	rec->iovcnt = 0;
+	rec->nbytes = 0;
+	rec->need_separator = 0;
+	rec->failed = 0;
+}
+
+/**
+ * \fn bitrec_push(bitrec_t* rec, const char* base, size_t len)
+ * \brief Adds one segment, extending the previous one instead when base continues it in memory
+ *
+ * \return 0 if successful, or a negative value if the segment list is full (the builder is then marked failed)
+ */
+static int bitrec_push(bitrec_t* rec, const char* base, size_t len) {
+	struct iovec* last = (rec->iovcnt > 0) ? &rec->iov[rec->iovcnt - 1] : NULL;
+
+	if (len == 0) {
+		return 0;
+	}
+
+	if ((last != NULL) && ((const char*)last->iov_base + last->iov_len == base)) {
+		last->iov_len += len;
+	}
+	else if (rec->iovcnt < BITREC_MAX_SEGMENTS) {
+		rec->iov[rec->iovcnt].iov_base = (void*)base;
+		rec->iov[rec->iovcnt].iov_len = len;
+		rec->iovcnt++;
+	}
+	else {
+		rec->failed = 1;
+		return EXIT_FAILURE_N;
+	}
+
+	rec->nbytes += len;
+
+	return 0;
+}
+
+/**
+ * \fn bitrec_field(bitrec_t* rec, const char* prefix)
+ * \brief Starts a field: emits the separator if a field came before it in this record, then the constant prefix
+ *
+ * \return 0 if successful, or a negative value if the builder has failed
+ */
+static int bitrec_field(bitrec_t* rec, const char* prefix) {
+	if (rec->failed) {
+		return EXIT_FAILURE_N;
+	}
+
+	if (rec->need_separator && (bitrec_push(rec, rec->separator, rec->separator_len) != 0)) {
+		return EXIT_FAILURE_N;
+	}
+	rec->need_separator = 1;
+
+	return (prefix == NULL) ? 0 : bitrec_push(rec, prefix, PREFIX_BYTES_BIN);
+}
+
+/**
+ * \fn bitrec_digits(bitrec_t* rec, bitops_view_t view, size_t skip)
+ * \brief Adds the part of a freshly formatted arena string after its skip-byte prefix
+ *
+ * \return 0 if successful, or a negative value (the builder is then marked failed)
+ */
+static int bitrec_digits(bitrec_t* rec, bitops_view_t view, size_t skip) {
+	if (view.str == NULL) {
+		rec->failed = 1;
+		return EXIT_FAILURE_N;
+	}
+
+	return bitrec_push(rec, view.str + skip, view.len - skip);
+}
+
+/**
+ * \fn bitrec_static(bitrec_t* rec, const char* str, size_t len)
+ * \brief Adds a constant segment such as a label. Nothing is copied, so str must stay valid until the record is written
+ *
+ * \return 0 if successful, or a negative value if the builder has failed
+ */
+int bitrec_static(bitrec_t* rec, const char* str, size_t len) {
+	assert(rec != NULL);
+	assert((str != NULL) || (len == 0));
+
+	return rec->failed ? EXIT_FAILURE_N : bitrec_push(rec, str, len);
+}
+
+/**
+ * \fn bitrec_end(bitrec_t* rec)
+ * \brief Ends the current record with a newline; the next field starts a new record without a leading separator
+ *
+ * \return 0 if successful, or a negative value if the builder has failed
+ */
+int bitrec_end(bitrec_t* rec) {
+	assert(rec != NULL);
+
+	rec->need_separator = 0;
+
+	return bitrec_static(rec, bitrec_newline, sizeof(bitrec_newline) - 1);
+}
+
+/**
+ * \fn bitrec_binstr(bitrec_t* rec, uint32_t num, uint8_t nbits)
+ * \brief Adds a field holding the binary representation of num, as uint_to_binstr would write it
+ *
+ * \return 0 if successful, or a negative value if the field could not be added (i.e. num does not fit in nbits, or the buffer or segment list is full). The builder then stays failed until reset
+ */
+int bitrec_binstr(bitrec_t* rec, uint32_t num, uint8_t nbits) {
+	assert(rec != NULL);
+
+	if (bitrec_field(rec, bitrec_prefix_bin) != 0) {
+		return EXIT_FAILURE_N;
+	}
+
+	///< The formatter's own "0b" is skipped; the segment before it points at the shared constant
+	return bitrec_digits(rec, uint_to_binstr_arena(&rec->arena, num, nbits), PREFIX_BYTES_BIN);
+}
+
+/**
+ * \fn bitrec_int_binstr(bitrec_t* rec, int32_t num, uint8_t nbits)
+ * \brief Adds a field holding the two's complement binary representation of num, as int_to_binstr would write it
+ *
+ * \return 0 if successful, or a negative value if the field could not be added. The builder then stays failed until reset
+ */
+int bitrec_int_binstr(bitrec_t* rec, int32_t num, uint8_t nbits) {
+	assert(rec != NULL);
+
+	if (bitrec_field(rec, bitrec_prefix_bin) != 0) {
+		return EXIT_FAILURE_N;
+	}
+
+	return bitrec_digits(rec, int_to_binstr_arena(&rec->arena, num, nbits), PREFIX_BYTES_BIN);
+}
+
+/**
+ * \fn bitrec_hexstr(bitrec_t* rec, uint32_t num, uint8_t nbits)
+ * \brief Adds a field holding the hex representation of num, as uint_to_hexstr would write it
+ *
+ * \return 0 if successful, or a negative value if the field could not be added (i.e. nbits is not 4, 8, 16 or 32, or the buffer or segment list is full). The builder then stays failed until reset
+ */
+int bitrec_hexstr(bitrec_t* rec, uint32_t num, uint8_t nbits) {
+	assert(rec != NULL);
+
+	bitops_arena_t* arena = &rec->arena;
+	size_t ndigits = (size_t)nbits / BITS_PER_NIBBLE;
+
+	if (bitrec_field(rec, bitrec_prefix_hex) != 0) {
+		return EXIT_FAILURE_N;
+	}
+
+	///< uint_to_hexstr_fmt touches the first two bytes even without a prefix, so require that much room
+	if (((nbits != 4) && (nbits != 8) && (nbits != 16) && (nbits != 32)) || (arena->size - arena->used <= ndigits + PREFIX_BYTES_HEX)) {
+		rec->failed = 1;
+		return EXIT_FAILURE_N;
+	}
+
+	uint_to_hexstr_fmt(arena->base + arena->used, arena->size - arena->used, num, nbits, HEXSTR_UPPER | HEXSTR_NO_PREFIX);
+	arena->used += ndigits;
+
+	return bitrec_push(rec, arena->base + arena->used - ndigits, ndigits);
+}
+
+/**
+ * \fn bitrec_hexdump(bitrec_t* rec, const void* loc, size_t nbytes)
+ * \brief Adds the hexdump rows of nbytes at loc as one segment. Rows already end in a newline, so the record's separator state is reset
+ *
+ * \return 0 if successful, or a negative value if the dump could not be added. The builder then stays failed until reset
+ */
+int bitrec_hexdump(bitrec_t* rec, const void* loc, size_t nbytes) {
+	assert(rec != NULL);
+
+	if (bitrec_field(rec, NULL) != 0) {
+		return EXIT_FAILURE_N;
+	}
+	rec->need_separator = 0;
+
+	return bitrec_digits(rec, hexdump_arena(&rec->arena, loc, nbytes), 0);
+}
+
+/**
+ * \fn bitrec_iov(const bitrec_t* rec, int* iovcnt)
+ * \brief Returns the segments of every record built since the last reset, ready for writev
+ *
+ * \param rec Pointer to the builder
+ * \param iovcnt Set to the number of segments
+ *
+ * \return Pointer to the segment array, or NULL (with *iovcnt set to 0) if any field failed since the last reset
+ */
+const struct iovec* bitrec_iov(const bitrec_t* rec, int* iovcnt) {
+	assert((rec != NULL) && (iovcnt != NULL));
+
+	*iovcnt = rec->failed ? 0 : rec->iovcnt;
+
+	return rec->failed ? NULL : rec->iov;
+}
+
+/**
+ * \fn bitrec_writev(int fd, bitrec_t* rec)
+ * \brief Writes every record with as few writev calls as possible, retrying after short writes and interrupts, then resets the builder
+ *
+ * \return 0 if successful, or a negative value if the builder has failed or a write error occurred (errno is set)
+ */
+int bitrec_writev(int fd, bitrec_t* rec) {
+	assert(rec != NULL);
+
+	struct iovec* iov = rec->iov;
+	int iovcnt = rec->iovcnt;
+	ssize_t written;
+
+	if (rec->failed) {
+		return EXIT_FAILURE_N;
+	}
+
+	while (iovcnt > 0) {
+		written = writev(fd, iov, iovcnt);
+		if (written < 0) {
+			if (errno == EINTR) {
+				continue;
+			}
+			return EXIT_FAILURE_N;
+		}
+
+		while ((iovcnt > 0) && ((size_t)written >= iov->iov_len)) {
+			written -= (ssize_t)iov->iov_len;
+			iov++;
+			iovcnt--;
+		}
+		if (iovcnt > 0) {
+			iov->iov_base = (char*)iov->iov_base + written;
+			iov->iov_len -= (size_t)written;
+		}
+	}
+
+	bitrec_reset(rec);
+
+	return 0;
+}
+
+/**
+ * \fn test_record_flatten(const bitrec_t* rec, char* out)
+ * \brief Concatenates the builder's segments into out, the way writev would send them
+ *
+ * \return The number of bytes written to out
+ */
+static size_t test_record_flatten(const bitrec_t* rec, char* out) {
+	const struct iovec* iov;
+	size_t len = 0;
+	int iovcnt;
+	int i;
+
+	iov = bitrec_iov(rec, &iovcnt);
+	for (i = 0; i < iovcnt; i++) {
+		memcpy(out + len, iov[i].iov_base, iov[i].iov_len);
+		len += iov[i].iov_len;
+	}
+
+	return len;
+}
+
+int test_record(void) {
+	static const uint8_t widths[] = { 4, 8, 16, 32 };
+	bitrec_t rec;
+	uint8_t dump_input[TEST_17_DUMP_BYTES];
+	uint32_t state = TEST_17_SEED;
+	uint32_t value;
+	uint8_t bin_bits;
+	uint8_t hex_bits;
+	size_t expected_len;
+	size_t len;
+	int fds[2];
+	int i;
+	int return_code = EXIT_TEST_SUCCESS;
+
+	bitrec_init(&rec, TEST_17_BUFFER, sizeof(TEST_17_BUFFER), ", ");
+
+	for (i = 0; i < TEST_17_RECORDS; i++) {
+		value = test_rand32(&state);
+		bin_bits = (uint8_t)(1 + (value >> 27));
+		hex_bits = widths[value >> 30];
+
+		bitrec_reset(&rec);
+		bitrec_static(&rec, "reg ", 4);
+		bitrec_hexstr(&rec, value & (0xFFFFFFFF >> (UINT32_T_BITS - hex_bits)), hex_bits);
+		bitrec_binstr(&rec, value & (0xFFFFFFFF >> (UINT32_T_BITS - bin_bits)), bin_bits);
+		bitrec_int_binstr(&rec, (int32_t)value, bin_bits);
+		bitrec_end(&rec);
+
+		expected_len = (size_t)sprintf(TEST_17_EXPECTED, "reg ");
+		expected_len += (size_t)uint_to_hexstr(TEST_17_EXPECTED + expected_len, TEST_17_LINE_BYTES - expected_len, value & (0xFFFFFFFF >> (UINT32_T_BITS - hex_bits)), hex_bits);
+		expected_len += (size_t)sprintf(TEST_17_EXPECTED + expected_len, ", ");
+		expected_len += (size_t)uint_to_binstr(TEST_17_EXPECTED + expected_len, TEST_17_LINE_BYTES - expected_len, value & (0xFFFFFFFF >> (UINT32_T_BITS - bin_bits)), bin_bits);
+		expected_len += (size_t)sprintf(TEST_17_EXPECTED + expected_len, ", ");
+		expected_len += (size_t)int_to_binstr(TEST_17_EXPECTED + expected_len, TEST_17_LINE_BYTES - expected_len, (int32_t)value, bin_bits);
+		expected_len += (size_t)sprintf(TEST_17_EXPECTED + expected_len, "\n");
+
+		len = test_record_flatten(&rec, TEST_17_RESULT);
+		if ((len != expected_len) || (rec.nbytes != expected_len) || (memcmp(TEST_17_RESULT, TEST_17_EXPECTED, len) != 0)) {
+			TEST_17_RESULT[len] = '\0';
+			printf("test_record: (FAILURE): record %d\nEXPECT = %sRESULT = %s", i, TEST_17_EXPECTED, TEST_17_RESULT);
+			return_code = EXIT_TEST_FAILURE;
+		}
+	}
+
+	///< A hexdump field is one segment holding complete rows
+	for (i = 0; i < TEST_17_DUMP_BYTES; i++) {
+		dump_input[i] = (uint8_t)test_rand32(&state);
+	}
+	bitrec_reset(&rec);
+	bitrec_hexdump(&rec, dump_input, TEST_17_DUMP_BYTES);
+	hexdump(TEST_17_EXPECTED, sizeof(TEST_17_EXPECTED), dump_input, TEST_17_DUMP_BYTES);
+	len = test_record_flatten(&rec, TEST_17_RESULT);
+	if ((rec.iovcnt != 1) || (len != strlen(TEST_17_EXPECTED)) || (memcmp(TEST_17_RESULT, TEST_17_EXPECTED, len) != 0)) {
+		printf("test_record: (FAILURE): hexdump field\n");
+		return_code = EXIT_TEST_FAILURE;
+	}
+
+	///< A bad field fails the whole batch until reset
+	bitrec_reset(&rec);
+	bitrec_hexstr(&rec, 1, 8);
+	if ((bitrec_binstr(&rec, 0x100, 8) == 0) || (bitrec_hexstr(&rec, 1, 8) == 0) || (bitrec_iov(&rec, &i) != NULL) || (i != 0)) {
+		printf("test_record: (FAILURE): failed field did not stick\n");
+		return_code = EXIT_TEST_FAILURE;
+	}
+
+	///< Round trip through a pipe with a single writev
+	bitrec_reset(&rec);
+	bitrec_hexstr(&rec, 0xBEEF, 16);
+	bitrec_int_binstr(&rec, -2, 4);
+	bitrec_end(&rec);
+	if ((pipe(fds) != 0) || (bitrec_writev(fds[1], &rec) != 0) || (read(fds[0], TEST_17_RESULT, sizeof(TEST_17_RESULT)) != 15) || (memcmp(TEST_17_RESULT, "0xBEEF, 0b1110\n", 15) != 0) || (rec.iovcnt != 0)) {
+		printf("test_record: (FAILURE): writev round trip\n");
+		return_code = EXIT_TEST_FAILURE;
+	}
+	close(fds[0]);
+	close(fds[1]);
+
+	printf("test_record: %d records compared with the concatenated formatter output\n", TEST_17_RECORDS);
+
+	return return_code;
+}
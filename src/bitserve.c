@@ -0,0 +1,1284 @@
+#define _GNU_SOURCE			///< accept4
+
+#include <assert.h>
+#include <errno.h>
+#include <pthread.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/uio.h>
+#include <sys/un.h>
+#include <unistd.h>
+#include "bitserve.h"
+
+#define EXIT_FAILURE_N (-1)
+#define EXIT_TEST_SUCCESS (1)
+#define EXIT_TEST_FAILURE (0)
+
+#define UINT32_T_BITS (32)
+#define UINT32_T_BYTES (4)
+#define NULL_TERMINATOR_BYTE (1)
+
+#define BITSERVE_READ_CHUNK (64 * 1024)		///< Free space made in a connection's input buffer before each read
+#define BITSERVE_JOB_MIN_BYTES (256)
+#define BITSERVE_EPOLL_EVENTS (64)
+
+#define TEST_27_WORKERS (3)
+#define TEST_27_CLIENTS (4)
+#define TEST_27_ROUNDS (150)
+#define TEST_27_MAX_WORDS (600)
+#define TEST_27_MAX_BYTES (TEST_27_MAX_WORDS * UINT32_T_BYTES)
+#define TEST_27_OUT_BYTES (TEST_27_MAX_WORDS * BINSTR_SLOT_BYTES(UINT32_T_BITS))
+#define TEST_27_PIPELINE (BITSERVE_MAX_INFLIGHT)
+
+typedef struct bitserve_conn bitserve_conn_t;
+
+typedef struct bitserve_job {
+	struct bitserve_job* next;
+	bitserve_conn_t* conn;
+	uint64_t seq;			///< Position of the request on its connection
+	bitserve_request_t request;
+	bitserve_reply_t reply;
+	uint8_t* in;			///< Request payload, kept with the job and reused
+	size_t in_cap;
+	uint8_t* out;			///< Reply output, kept with the job and reused
+	size_t out_cap;
+	size_t written;			///< Bytes of reply header and output sent so far
+} bitserve_job_t;
+
+struct bitserve_conn {
+	bitserve_conn_t* prev;
+	bitserve_conn_t* next;
+	int fd;				///< -1 once closed; the connection is freed when no worker holds one of its jobs
+	uint32_t events;		///< Events registered with epoll
+	int eof;			///< The client will send no more requests
+	int blocked;			///< The last write would have blocked, so EPOLLOUT is wanted
+	uint8_t* in;			///< Bytes read and not yet split into requests
+	size_t in_len;
+	size_t in_cap;
+	uint64_t next_seq;		///< seq of the next request read
+	uint64_t send_seq;		///< seq of the next reply to write
+	int inflight;			///< Requests read and not yet written
+	int at_workers;			///< Jobs queued for or held by a worker
+	bitserve_job_t* ready;		///< Finished jobs, in seq order
+};
+
+struct bitserve_server {
+	int listen_fd;
+	int epoll_fd;
+	int event_fd;			///< Counts batches of finished jobs, and wakes the epoll thread to stop
+	int stopping;
+	int loop_started;
+	pthread_t loop;
+	pthread_t workers[BITSERVE_MAX_WORKERS];
+	int nworkers;			///< Workers started
+	pthread_mutex_t lock;
+	pthread_cond_t work_cond;
+	int workers_stop;		///< Guarded by lock
+	bitserve_job_t* work_head;	///< Guarded by lock
+	bitserve_job_t* work_tail;	///< Guarded by lock
+	bitserve_job_t* done;		///< Guarded by lock, in any order
+	bitserve_job_t* free_jobs;	///< Epoll thread only
+	bitserve_conn_t* conns;		///< Epoll thread only
+	int dead_conns;			///< Closed connections waiting to be freed
+	int bound;			///< path is ours to unlink
+	char path[sizeof(((struct sockaddr_un*)0)->sun_path)];
+};
+
+/**
+ * \fn bitserve_reply_bytes(uint8_t op, uint8_t nbits, uint16_t flags, size_t in_len)
+ * \brief Computes the output the server sends back for a request
+ *
+ * \param op BITSERVE_BINSTR, BITSERVE_HEXSTR or BITSERVE_HEXDUMP
+ * \param nbits The nbits of the request
+ * \param flags The flags of the request
+ * \param in_len Payload bytes of the request
+ *
+ * \return The bytes of output after the reply header, or BITSERVE_INVALID if the server refuses the request
+ */
+size_t bitserve_reply_bytes(uint8_t op, uint8_t nbits, uint16_t flags, size_t in_len) {
+	if (in_len > BITSERVE_MAX_PAYLOAD) {
+		return BITSERVE_INVALID;
+	}
+
+	switch (op) {
+		case BITSERVE_BINSTR:
+			if ((in_len % UINT32_T_BYTES != 0) || (nbits == 0) || (nbits > UINT32_T_BITS) || (flags != 0)) {
+				return BITSERVE_INVALID;
+			}
+			return (in_len / UINT32_T_BYTES) * BINSTR_SLOT_BYTES(nbits);
+		case BITSERVE_HEXSTR:
+			if ((in_len % UINT32_T_BYTES != 0) || ((nbits != 4) && (nbits != 8) && (nbits != 16) && (nbits != 32))) {
+				return BITSERVE_INVALID;
+			}
+			if ((flags & ~(HEXSTR_LOWER | HEXSTR_NO_PREFIX | HEXSTR_REVERSED | HEXSTR_BIG_ENDIAN)) || ((flags & HEXSTR_BIG_ENDIAN) && (nbits < 8))) {
+				return BITSERVE_INVALID;
+			}
+			return (in_len / UINT32_T_BYTES) * HEXSTR_SLOT_BYTES(nbits, flags);
+		case BITSERVE_HEXDUMP:
+			if ((nbits != 0) || (flags != 0)) {
+				return BITSERVE_INVALID;
+			}
+			return hexdump_len(in_len) + NULL_TERMINATOR_BYTE;
+		default:
+			return BITSERVE_INVALID;
+	}
+}
+
+/**
+ * \fn bitserve_reserve(uint8_t** buf, size_t* cap, size_t need)
+ * \brief Grows a buffer, doubling it, until it holds need bytes. Buffers never shrink
+ *
+ * \return 0 if successful, -1 if memory ran out (the buffer is left as it was)
+ */
+static int bitserve_reserve(uint8_t** buf, size_t* cap, size_t need) {
+	size_t new_cap = *cap;
+	uint8_t* grown;
+
+	if (need <= *cap) {
+		return 0;
+	}
+	while (new_cap < need) {
+		new_cap *= 2;
+	}
+	grown = realloc(*buf, new_cap);
+	if (grown == NULL) {
+		return EXIT_FAILURE_N;
+	}
+	*buf = grown;
+	*cap = new_cap;
+
+	return 0;
+}
+
+/**
+ * \fn bitserve_format(bitserve_job_t* job)
+ * \brief Runs a checked request through the formatter it names and fills in the reply. Called by the workers
+ */
+static void bitserve_format(bitserve_job_t* job) {
+	const bitserve_request_t* request = &job->request;
+	size_t need = bitserve_reply_bytes(request->op, request->nbits, request->flags, request->length);
+	size_t n = request->length / UINT32_T_BYTES;
+	size_t i;
+	int status = 0;
+
+	if (bitserve_reserve(&job->out, &job->out_cap, need) != 0) {
+		job->reply.status = EXIT_FAILURE_N;
+		job->reply.length = 0;
+		return;
+	}
+
+	switch (request->op) {
+		case BITSERVE_BINSTR:
+			status = uint_to_binstr_many((const uint32_t*)job->in, n, (char*)job->out, job->out_cap, request->nbits);
+			break;
+		case BITSERVE_HEXSTR:
+			status = uint_to_hexstr_many((const uint32_t*)job->in, n, (char*)job->out, job->out_cap, request->nbits, request->flags);
+			break;
+		default:
+			hexdump((char*)job->out, job->out_cap, job->in, request->length);
+			break;
+	}
+
+	///< A refused value leaves only a \0 in its slot, so clear the rest rather than send bytes of an earlier request
+	if ((request->op == BITSERVE_BINSTR) && (status > 0)) {
+		for (i = 0; i < need; i += BINSTR_SLOT_BYTES(request->nbits)) {
+			if (job->out[i] == '\0') {
+				memset(job->out + i, 0, BINSTR_SLOT_BYTES(request->nbits));
+			}
+		}
+	}
+
+	job->reply.status = status;
+	job->reply.length = (status < 0) ? 0 : (uint32_t)need;
+}
+
+/**
+ * \fn bitserve_worker(void* arg)
+ * \brief Worker thread: takes jobs off the work queue, formats them and hands them back to the epoll thread
+ */
+static void* bitserve_worker(void* arg) {
+	bitserve_server_t* server = arg;
+	bitserve_job_t* job;
+	uint64_t one = 1;
+	int wake;
+
+	pthread_mutex_lock(&server->lock);
+	for (;;) {
+		while ((server->work_head == NULL) && !server->workers_stop) {
+			pthread_cond_wait(&server->work_cond, &server->lock);
+		}
+		if (server->workers_stop) {
+			break;
+		}
+		job = server->work_head;
+		server->work_head = job->next;
+		if (server->work_head == NULL) {
+			server->work_tail = NULL;
+		}
+		pthread_mutex_unlock(&server->lock);
+
+		bitserve_format(job);
+
+		pthread_mutex_lock(&server->lock);
+		///< The epoll thread reads event_fd before it takes the done list, so only a push onto an empty list needs a wakeup
+		wake = (server->done == NULL);
+		job->next = server->done;
+		server->done = job;
+		if (wake) {
+			pthread_mutex_unlock(&server->lock);
+			if (write(server->event_fd, &one, sizeof(one)) < 0) {
+				///< The counter cannot overflow from one write per batch; nothing to do
+			}
+			pthread_mutex_lock(&server->lock);
+		}
+	}
+	pthread_mutex_unlock(&server->lock);
+
+	return NULL;
+}
+
+/**
+ * \fn bitserve_job_get(bitserve_server_t* server)
+ * \brief Takes a job off the free list, or makes a new one with small buffers
+ *
+ * \return Pointer to the job, or NULL if memory ran out
+ */
+static bitserve_job_t* bitserve_job_get(bitserve_server_t* server) {
+	bitserve_job_t* job = server->free_jobs;
+
+	if (job != NULL) {
+		server->free_jobs = job->next;
+		return job;
+	}
+
+	job = calloc(1, sizeof(*job));
+	if (job == NULL) {
+		return NULL;
+	}
+	job->in = malloc(BITSERVE_JOB_MIN_BYTES);
+	job->out = malloc(BITSERVE_JOB_MIN_BYTES);
+	if ((job->in == NULL) || (job->out == NULL)) {
+		free(job->in);
+		free(job->out);
+		free(job);
+		return NULL;
+	}
+	job->in_cap = BITSERVE_JOB_MIN_BYTES;
+	job->out_cap = BITSERVE_JOB_MIN_BYTES;
+
+	return job;
+}
+
+/**
+ * \fn bitserve_job_put(bitserve_server_t* server, bitserve_job_t* job)
+ * \brief Returns a job to the free list with its buffers, for the next request. Epoll thread only
+ */
+static void bitserve_job_put(bitserve_server_t* server, bitserve_job_t* job) {
+	job->conn = NULL;
+	job->next = server->free_jobs;
+	server->free_jobs = job;
+}
+
+/**
+ * \fn bitserve_job_free_list(bitserve_job_t* job)
+ * \brief Frees a list of jobs linked through next, with their buffers
+ */
+static void bitserve_job_free_list(bitserve_job_t* job) {
+	bitserve_job_t* next;
+
+	while (job != NULL) {
+		next = job->next;
+		free(job->in);
+		free(job->out);
+		free(job);
+		job = next;
+	}
+}
+
+/**
+ * \fn bitserve_conn_ready(bitserve_conn_t* conn, bitserve_job_t* job)
+ * \brief Adds a finished job to the connection's replies, keeping them in request order
+ */
+static void bitserve_conn_ready(bitserve_conn_t* conn, bitserve_job_t* job) {
+	bitserve_job_t** link = &conn->ready;
+
+	while ((*link != NULL) && ((*link)->seq < job->seq)) {
+		link = &(*link)->next;
+	}
+	job->next = *link;
+	*link = job;
+}
+
+/**
+ * \fn bitserve_conn_close(bitserve_server_t* server, bitserve_conn_t* conn)
+ * \brief Closes a connection and drops its unsent replies. The connection itself is freed after the current batch of events, once no worker holds one of its jobs
+ */
+static void bitserve_conn_close(bitserve_server_t* server, bitserve_conn_t* conn) {
+	bitserve_job_t* job;
+
+	if (conn->fd < 0) {
+		return;
+	}
+	epoll_ctl(server->epoll_fd, EPOLL_CTL_DEL, conn->fd, NULL);
+	close(conn->fd);
+	conn->fd = -1;
+	while (conn->ready != NULL) {
+		job = conn->ready;
+		conn->ready = job->next;
+		bitserve_job_put(server, job);
+	}
+	server->dead_conns++;
+}
+
+/**
+ * \fn bitserve_conn_parse(bitserve_server_t* server, bitserve_conn_t* conn)
+ * \brief Splits whole requests off the connection's input while fewer than BITSERVE_MAX_INFLIGHT are outstanding. Good requests go to the workers in one batch, refused ones straight to the replies
+ *
+ * \return 0 if successful, -1 if the connection must be closed (bad magic, oversized payload or no memory)
+ */
+static int bitserve_conn_parse(bitserve_server_t* server, bitserve_conn_t* conn) {
+	bitserve_job_t* head = NULL;
+	bitserve_job_t* tail = NULL;
+	bitserve_job_t* job;
+	bitserve_request_t request;
+	size_t pos = 0;
+	int queued = 0;
+	int status = 0;
+
+	while ((conn->inflight < BITSERVE_MAX_INFLIGHT) && (conn->in_len - pos >= sizeof(request))) {
+		memcpy(&request, conn->in + pos, sizeof(request));
+		if ((request.magic != BITSERVE_MAGIC) || (request.length > BITSERVE_MAX_PAYLOAD)) {
+			status = EXIT_FAILURE_N;
+			break;
+		}
+		if (conn->in_len - pos - sizeof(request) < request.length) {
+			break;
+		}
+		job = bitserve_job_get(server);
+		if (job == NULL) {
+			status = EXIT_FAILURE_N;
+			break;
+		}
+
+		job->conn = conn;
+		job->seq = conn->next_seq++;
+		job->request = request;
+		job->reply.magic = BITSERVE_MAGIC;
+		job->reply.status = 0;
+		job->reply.id = request.id;
+		job->reply.length = 0;
+		job->written = 0;
+		job->next = NULL;
+		conn->inflight++;
+
+		if ((bitserve_reply_bytes(request.op, request.nbits, request.flags, request.length) == BITSERVE_INVALID) || (bitserve_reserve(&job->in, &job->in_cap, request.length) != 0)) {
+			job->reply.status = EXIT_FAILURE_N;
+			bitserve_conn_ready(conn, job);
+		}
+		else {
+			memcpy(job->in, conn->in + pos + sizeof(request), request.length);
+			conn->at_workers++;
+			if (tail == NULL) {
+				head = job;
+			}
+			else {
+				tail->next = job;
+			}
+			tail = job;
+			queued++;
+		}
+		pos += sizeof(request) + request.length;
+	}
+
+	if (pos > 0) {
+		memmove(conn->in, conn->in + pos, conn->in_len - pos);
+		conn->in_len -= pos;
+	}
+
+	if (queued > 0) {
+		pthread_mutex_lock(&server->lock);
+		if (server->work_tail == NULL) {
+			server->work_head = head;
+		}
+		else {
+			server->work_tail->next = head;
+		}
+		server->work_tail = tail;
+		if (queued == 1) {
+			pthread_cond_signal(&server->work_cond);
+		}
+		else {
+			pthread_cond_broadcast(&server->work_cond);
+		}
+		pthread_mutex_unlock(&server->lock);
+	}
+
+	return status;
+}
+
+/**
+ * \fn bitserve_conn_flush(bitserve_server_t* server, bitserve_conn_t* conn)
+ * \brief Writes finished replies in request order until one is missing or the socket is full
+ *
+ * \return The number of replies completed, or -1 if the connection must be closed
+ */
+static int bitserve_conn_flush(bitserve_server_t* server, bitserve_conn_t* conn) {
+	struct iovec iov[2];
+	struct msghdr msg;
+	bitserve_job_t* job;
+	ssize_t sent;
+	size_t header = sizeof(bitserve_reply_t);
+	int completed = 0;
+
+	conn->blocked = 0;
+	while ((conn->ready != NULL) && (conn->ready->seq == conn->send_seq)) {
+		job = conn->ready;
+
+		memset(&msg, 0, sizeof(msg));
+		msg.msg_iov = iov;
+		if (job->written < header) {
+			iov[0].iov_base = (uint8_t*)&job->reply + job->written;
+			iov[0].iov_len = header - job->written;
+			iov[1].iov_base = job->out;
+			iov[1].iov_len = job->reply.length;
+			msg.msg_iovlen = 2;
+		}
+		else {
+			iov[0].iov_base = job->out + (job->written - header);
+			iov[0].iov_len = job->reply.length - (job->written - header);
+			msg.msg_iovlen = 1;
+		}
+
+		sent = sendmsg(conn->fd, &msg, MSG_NOSIGNAL);
+		if (sent < 0) {
+			if (errno == EINTR) {
+				continue;
+			}
+			if ((errno == EAGAIN) || (errno == EWOULDBLOCK)) {
+				conn->blocked = 1;
+				break;
+			}
+			return EXIT_FAILURE_N;
+		}
+
+		job->written += (size_t)sent;
+		if (job->written == header + job->reply.length) {
+			conn->ready = job->next;
+			conn->send_seq++;
+			conn->inflight--;
+			bitserve_job_put(server, job);
+			completed++;
+		}
+	}
+
+	return completed;
+}
+
+/**
+ * \fn bitserve_conn_service(bitserve_server_t* server, bitserve_conn_t* conn)
+ * \brief Splits and writes until neither makes progress, then asks epoll for the events the connection now needs
+ */
+static void bitserve_conn_service(bitserve_server_t* server, bitserve_conn_t* conn) {
+	struct epoll_event event;
+	uint32_t events = 0;
+	int completed;
+
+	do {
+		if (bitserve_conn_parse(server, conn) != 0) {
+			bitserve_conn_close(server, conn);
+			return;
+		}
+		completed = bitserve_conn_flush(server, conn);
+		if (completed < 0) {
+			bitserve_conn_close(server, conn);
+			return;
+		}
+	} while ((completed > 0) && !conn->blocked);
+
+	if (conn->eof && (conn->inflight == 0)) {
+		bitserve_conn_close(server, conn);
+		return;
+	}
+
+	if (!conn->eof && (conn->inflight < BITSERVE_MAX_INFLIGHT)) {
+		events |= EPOLLIN;
+	}
+	if (conn->blocked) {
+		events |= EPOLLOUT;
+	}
+	if (events != conn->events) {
+		event.events = events;
+		event.data.ptr = conn;
+		epoll_ctl(server->epoll_fd, EPOLL_CTL_MOD, conn->fd, &event);
+		conn->events = events;
+	}
+}
+
+/**
+ * \fn bitserve_conn_read(bitserve_server_t* server, bitserve_conn_t* conn)
+ * \brief Reads what the client has sent (epoll is level-triggered, so one read per event is enough) and services the connection
+ */
+static void bitserve_conn_read(bitserve_server_t* server, bitserve_conn_t* conn) {
+	ssize_t got;
+
+	if (bitserve_reserve(&conn->in, &conn->in_cap, conn->in_len + BITSERVE_READ_CHUNK) != 0) {
+		bitserve_conn_close(server, conn);
+		return;
+	}
+
+	got = read(conn->fd, conn->in + conn->in_len, conn->in_cap - conn->in_len);
+	if (got < 0) {
+		if ((errno == EINTR) || (errno == EAGAIN) || (errno == EWOULDBLOCK)) {
+			return;
+		}
+		bitserve_conn_close(server, conn);
+		return;
+	}
+	if (got == 0) {
+		conn->eof = 1;
+	}
+	conn->in_len += (size_t)got;
+
+	bitserve_conn_service(server, conn);
+}
+
+/**
+ * \fn bitserve_accept(bitserve_server_t* server)
+ * \brief Accepts every pending connection and registers each for EPOLLIN. A connection that cannot be set up is closed
+ */
+static void bitserve_accept(bitserve_server_t* server) {
+	struct epoll_event event;
+	bitserve_conn_t* conn;
+	int fd;
+
+	for (;;) {
+		fd = accept4(server->listen_fd, NULL, NULL, SOCK_NONBLOCK | SOCK_CLOEXEC);
+		if (fd < 0) {
+			if (errno == EINTR) {
+				continue;
+			}
+			return;
+		}
+
+		conn = calloc(1, sizeof(*conn));
+		if ((conn == NULL) || ((conn->in = malloc(BITSERVE_READ_CHUNK)) == NULL)) {
+			free(conn);
+			close(fd);
+			continue;
+		}
+		conn->in_cap = BITSERVE_READ_CHUNK;
+		conn->fd = fd;
+		conn->events = EPOLLIN;
+
+		event.events = EPOLLIN;
+		event.data.ptr = conn;
+		if (epoll_ctl(server->epoll_fd, EPOLL_CTL_ADD, fd, &event) != 0) {
+			free(conn->in);
+			free(conn);
+			close(fd);
+			continue;
+		}
+
+		conn->next = server->conns;
+		if (server->conns != NULL) {
+			server->conns->prev = conn;
+		}
+		server->conns = conn;
+	}
+}
+
+/**
+ * \fn bitserve_complete(bitserve_server_t* server)
+ * \brief Takes the jobs the workers have finished and writes what can be written
+ */
+static void bitserve_complete(bitserve_server_t* server) {
+	bitserve_job_t* job;
+	bitserve_job_t* next;
+	bitserve_conn_t* conn;
+	uint64_t count;
+
+	if (read(server->event_fd, &count, sizeof(count)) < 0) {
+		///< EAGAIN: another pass already took the list
+	}
+
+	pthread_mutex_lock(&server->lock);
+	job = server->done;
+	server->done = NULL;
+	pthread_mutex_unlock(&server->lock);
+
+	while (job != NULL) {
+		next = job->next;
+		conn = job->conn;
+		conn->at_workers--;
+		if (conn->fd < 0) {
+			bitserve_job_put(server, job);
+		}
+		else {
+			bitserve_conn_ready(conn, job);
+			if (job == conn->ready) {
+				bitserve_conn_service(server, conn);
+			}
+		}
+		job = next;
+	}
+}
+
+/**
+ * \fn bitserve_conn_free(bitserve_server_t* server, bitserve_conn_t* conn)
+ * \brief Unlinks a closed connection from the server and frees it with its unsent replies
+ */
+static void bitserve_conn_free(bitserve_server_t* server, bitserve_conn_t* conn) {
+	if (conn->prev != NULL) {
+		conn->prev->next = conn->next;
+	}
+	else {
+		server->conns = conn->next;
+	}
+	if (conn->next != NULL) {
+		conn->next->prev = conn->prev;
+	}
+	bitserve_job_free_list(conn->ready);
+	free(conn->in);
+	free(conn);
+}
+
+/**
+ * \fn bitserve_sweep(bitserve_server_t* server)
+ * \brief Frees closed connections no worker holds a job of. Run between batches of events, so no event left in a batch points at a freed connection
+ */
+static void bitserve_sweep(bitserve_server_t* server) {
+	bitserve_conn_t* conn = server->conns;
+	bitserve_conn_t* next;
+
+	while ((conn != NULL) && (server->dead_conns > 0)) {
+		next = conn->next;
+		if ((conn->fd < 0) && (conn->at_workers == 0)) {
+			bitserve_conn_free(server, conn);
+			server->dead_conns--;
+		}
+		conn = next;
+	}
+}
+
+/**
+ * \fn bitserve_loop(void* arg)
+ * \brief Epoll thread: accepts connections, reads and splits requests, collects finished jobs and writes replies until bitserve_stop
+ */
+static void* bitserve_loop(void* arg) {
+	bitserve_server_t* server = arg;
+	struct epoll_event events[BITSERVE_EPOLL_EVENTS];
+	bitserve_conn_t* conn;
+	int nevents;
+	int i;
+
+	while (!__atomic_load_n(&server->stopping, __ATOMIC_ACQUIRE)) {
+		nevents = epoll_wait(server->epoll_fd, events, BITSERVE_EPOLL_EVENTS, -1);
+		if (nevents < 0) {
+			if (errno == EINTR) {
+				continue;
+			}
+			break;
+		}
+
+		for (i = 0; i < nevents; i++) {
+			if (events[i].data.ptr == &server->listen_fd) {
+				bitserve_accept(server);
+			}
+			else if (events[i].data.ptr == &server->event_fd) {
+				bitserve_complete(server);
+			}
+			else {
+				conn = events[i].data.ptr;
+				if (conn->fd < 0) {
+					continue;
+				}
+				if (events[i].events & EPOLLIN) {
+					bitserve_conn_read(server, conn);
+				}
+				else if (events[i].events & (EPOLLERR | EPOLLHUP)) {
+					bitserve_conn_close(server, conn);
+				}
+				if ((conn->fd >= 0) && (events[i].events & EPOLLOUT)) {
+					bitserve_conn_service(server, conn);
+				}
+			}
+		}
+
+		bitserve_sweep(server);
+	}
+
+	return NULL;
+}
+
+/**
+ * \fn bitserve_stop(bitserve_server_t* server)
+ * \brief Stops the epoll thread and the workers, closes every connection (unsent replies are dropped), removes the socket file and frees the server
+ *
+ * \param server Pointer returned by bitserve_start
+ */
+void bitserve_stop(bitserve_server_t* server) {
+	uint64_t one = 1;
+	int i;
+
+	assert(server != NULL);
+
+	__atomic_store_n(&server->stopping, 1, __ATOMIC_RELEASE);
+	if (server->loop_started) {
+		if (write(server->event_fd, &one, sizeof(one)) < 0) {
+			///< The epoll thread is woken by the counter being nonzero, which it already is
+		}
+		pthread_join(server->loop, NULL);
+	}
+
+	pthread_mutex_lock(&server->lock);
+	server->workers_stop = 1;
+	pthread_cond_broadcast(&server->work_cond);
+	pthread_mutex_unlock(&server->lock);
+	for (i = 0; i < server->nworkers; i++) {
+		pthread_join(server->workers[i], NULL);
+	}
+
+	while (server->conns != NULL) {
+		if (server->conns->fd >= 0) {
+			close(server->conns->fd);
+		}
+		bitserve_conn_free(server, server->conns);
+	}
+	bitserve_job_free_list(server->work_head);
+	bitserve_job_free_list(server->done);
+	bitserve_job_free_list(server->free_jobs);
+
+	if (server->event_fd >= 0) {
+		close(server->event_fd);
+	}
+	if (server->epoll_fd >= 0) {
+		close(server->epoll_fd);
+	}
+	if (server->listen_fd >= 0) {
+		close(server->listen_fd);
+	}
+	if (server->bound) {
+		unlink(server->path);
+	}
+	pthread_cond_destroy(&server->work_cond);
+	pthread_mutex_destroy(&server->lock);
+	free(server);
+}
+
+/**
+ * \fn bitserve_start(const char* path, int nworkers)
+ * \brief Listens on a Unix domain socket at path and starts the epoll thread and nworkers workers. A socket file left at path by a server that is gone is replaced; a live one is not
+ *
+ * \param path File system path of the socket
+ * \param nworkers The number of worker threads (1 to BITSERVE_MAX_WORKERS)
+ *
+ * \return Pointer to the running server, or NULL on error (errno is set by the call that failed, or EADDRINUSE / ENAMETOOLONG)
+ */
+bitserve_server_t* bitserve_start(const char* path, int nworkers) {
+	struct sockaddr_un addr;
+	struct epoll_event event;
+	struct stat st;
+	bitserve_server_t* server;
+	int probe;
+	int i;
+
+	assert(path != NULL);
+	assert((nworkers > 0) && (nworkers <= BITSERVE_MAX_WORKERS));
+
+	if (strlen(path) >= sizeof(addr.sun_path)) {
+		errno = ENAMETOOLONG;
+		return NULL;
+	}
+
+	server = calloc(1, sizeof(*server));
+	if (server == NULL) {
+		return NULL;
+	}
+	server->listen_fd = -1;
+	server->epoll_fd = -1;
+	server->event_fd = -1;
+	strcpy(server->path, path);
+	pthread_mutex_init(&server->lock, NULL);
+	pthread_cond_init(&server->work_cond, NULL);
+
+	if ((lstat(path, &st) == 0) && S_ISSOCK(st.st_mode)) {
+		probe = bitserve_connect(path);
+		if (probe >= 0) {
+			close(probe);
+			bitserve_stop(server);
+			errno = EADDRINUSE;
+			return NULL;
+		}
+		unlink(path);
+	}
+
+	memset(&addr, 0, sizeof(addr));
+	addr.sun_family = AF_UNIX;
+	strcpy(addr.sun_path, path);
+
+	server->listen_fd = socket(AF_UNIX, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+	if ((server->listen_fd < 0) || (bind(server->listen_fd, (struct sockaddr*)&addr, sizeof(addr)) != 0)) {
+		goto fail;
+	}
+	server->bound = 1;
+	if (listen(server->listen_fd, SOMAXCONN) != 0) {
+		goto fail;
+	}
+
+	server->epoll_fd = epoll_create1(EPOLL_CLOEXEC);
+	server->event_fd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+	if ((server->epoll_fd < 0) || (server->event_fd < 0)) {
+		goto fail;
+	}
+	event.events = EPOLLIN;
+	event.data.ptr = &server->listen_fd;
+	if (epoll_ctl(server->epoll_fd, EPOLL_CTL_ADD, server->listen_fd, &event) != 0) {
+		goto fail;
+	}
+	event.data.ptr = &server->event_fd;
+	if (epoll_ctl(server->epoll_fd, EPOLL_CTL_ADD, server->event_fd, &event) != 0) {
+		goto fail;
+	}
+
+	for (i = 0; i < nworkers; i++) {
+		if (pthread_create(&server->workers[i], NULL, bitserve_worker, server) != 0) {
+			goto fail;
+		}
+		server->nworkers++;
+	}
+	if (pthread_create(&server->loop, NULL, bitserve_loop, server) != 0) {
+		goto fail;
+	}
+	server->loop_started = 1;
+
+	return server;
+
+fail:
+	i = errno;
+	bitserve_stop(server);
+	errno = i;
+	return NULL;
+}
+
+/**
+ * \fn bitserve_sendmsg_all(int fd, struct iovec* iov, int iovcnt)
+ * \brief Sends every byte described by iov, retrying after short writes and interrupts, without raising SIGPIPE
+ *
+ * \return 0 if successful, -1 on a write error (errno is set)
+ */
+static int bitserve_sendmsg_all(int fd, struct iovec* iov, int iovcnt) {
+	struct msghdr msg;
+	ssize_t sent;
+
+	while (iovcnt > 0) {
+		memset(&msg, 0, sizeof(msg));
+		msg.msg_iov = iov;
+		msg.msg_iovlen = (size_t)iovcnt;
+		sent = sendmsg(fd, &msg, MSG_NOSIGNAL);
+		if (sent < 0) {
+			if (errno == EINTR) {
+				continue;
+			}
+			return EXIT_FAILURE_N;
+		}
+
+		while ((iovcnt > 0) && ((size_t)sent >= iov->iov_len)) {
+			sent -= (ssize_t)iov->iov_len;
+			iov++;
+			iovcnt--;
+		}
+		if (iovcnt > 0) {
+			iov->iov_base = (char*)iov->iov_base + sent;
+			iov->iov_len -= (size_t)sent;
+		}
+	}
+
+	return 0;
+}
+
+/**
+ * \fn bitserve_read_all(int fd, void* buf, size_t len)
+ * \brief Reads exactly len bytes, retrying after short reads and interrupts
+ *
+ * \return 0 if successful, -1 on a read error or if the server closed the connection first
+ */
+static int bitserve_read_all(int fd, void* buf, size_t len) {
+	uint8_t* at = buf;
+	ssize_t got;
+
+	while (len > 0) {
+		got = read(fd, at, len);
+		if (got < 0) {
+			if (errno == EINTR) {
+				continue;
+			}
+			return EXIT_FAILURE_N;
+		}
+		if (got == 0) {
+			return EXIT_FAILURE_N;
+		}
+		at += got;
+		len -= (size_t)got;
+	}
+
+	return 0;
+}
+
+/**
+ * \fn bitserve_connect(const char* path)
+ * \brief Connects to a server listening at path
+ *
+ * \return The connected socket (blocking; close it with close), or -1 on error (errno is set)
+ */
+int bitserve_connect(const char* path) {
+	struct sockaddr_un addr;
+	int fd;
+
+	assert(path != NULL);
+
+	if (strlen(path) >= sizeof(addr.sun_path)) {
+		errno = ENAMETOOLONG;
+		return EXIT_FAILURE_N;
+	}
+	memset(&addr, 0, sizeof(addr));
+	addr.sun_family = AF_UNIX;
+	strcpy(addr.sun_path, path);
+
+	fd = socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+	if (fd < 0) {
+		return EXIT_FAILURE_N;
+	}
+	if (connect(fd, (struct sockaddr*)&addr, sizeof(addr)) != 0) {
+		close(fd);
+		return EXIT_FAILURE_N;
+	}
+
+	return fd;
+}
+
+/**
+ * \fn bitserve_send(int fd, uint8_t op, uint8_t nbits, uint16_t flags, uint32_t id, const void* in, size_t in_len)
+ * \brief Sends one request without waiting for its reply. Up to BITSERVE_MAX_INFLIGHT requests may be sent ahead of bitserve_recv
+ *
+ * \param fd Socket returned by bitserve_connect
+ * \param op BITSERVE_BINSTR, BITSERVE_HEXSTR or BITSERVE_HEXDUMP
+ * \param nbits The nbits for the formatter (0 for BITSERVE_HEXDUMP)
+ * \param flags The flags for the formatter
+ * \param id Returned in the reply
+ * \param in Pointer to the payload (uint32_t values, or raw bytes for BITSERVE_HEXDUMP)
+ * \param in_len Bytes of payload (at most BITSERVE_MAX_PAYLOAD)
+ *
+ * \return 0 if successful, -1 on a write error (errno is set)
+ */
+int bitserve_send(int fd, uint8_t op, uint8_t nbits, uint16_t flags, uint32_t id, const void* in, size_t in_len) {
+	bitserve_request_t request;
+	struct iovec iov[2];
+
+	assert((in != NULL) || (in_len == 0));
+	assert(in_len <= BITSERVE_MAX_PAYLOAD);
+
+	request.magic = BITSERVE_MAGIC;
+	request.op = op;
+	request.nbits = nbits;
+	request.flags = flags;
+	request.id = id;
+	request.length = (uint32_t)in_len;
+
+	iov[0].iov_base = &request;
+	iov[0].iov_len = sizeof(request);
+	iov[1].iov_base = (void*)in;
+	iov[1].iov_len = in_len;
+
+	return bitserve_sendmsg_all(fd, iov, 2);
+}
+
+/**
+ * \fn bitserve_recv(int fd, bitserve_reply_t* reply, void* out, size_t out_size)
+ * \brief Waits for the next reply and reads its output into out. Replies come in the order the requests were sent
+ *
+ * \param fd Socket returned by bitserve_connect
+ * \param reply Pointer to the reply header to fill in
+ * \param out Pointer to the buffer for the output
+ * \param out_size Bytes in the buffer pointed to by out
+ *
+ * \return 0 if successful, -1 on a read error, a bad reply or an output bigger than out_size (the connection is then out of step and should be closed)
+ */
+int bitserve_recv(int fd, bitserve_reply_t* reply, void* out, size_t out_size) {
+	assert(reply != NULL);
+	assert((out != NULL) || (out_size == 0));
+
+	if (bitserve_read_all(fd, reply, sizeof(*reply)) != 0) {
+		return EXIT_FAILURE_N;
+	}
+	if ((reply->magic != BITSERVE_MAGIC) || (reply->length > out_size)) {
+		return EXIT_FAILURE_N;
+	}
+
+	return bitserve_read_all(fd, out, reply->length);
+}
+
+/**
+ * \fn bitserve_call(int fd, uint8_t op, uint8_t nbits, uint16_t flags, const void* in, size_t in_len, void* out, size_t out_size, size_t* out_len)
+ * \brief Sends one request and waits for its reply. Must not be mixed with bitserve_send calls still waiting for their replies
+ *
+ * \param out_len Set to the bytes of output written to out (0 on error)
+ *
+ * \return The status of the reply: the formatter's result, or negative if the request was refused or the connection failed
+ */
+int bitserve_call(int fd, uint8_t op, uint8_t nbits, uint16_t flags, const void* in, size_t in_len, void* out, size_t out_size, size_t* out_len) {
+	bitserve_reply_t reply;
+
+	assert(out_len != NULL);
+
+	*out_len = 0;
+	if ((bitserve_send(fd, op, nbits, flags, 0, in, in_len) != 0) || (bitserve_recv(fd, &reply, out, out_size) != 0) || (reply.id != 0)) {
+		return EXIT_FAILURE_N;
+	}
+	*out_len = reply.length;
+
+	return reply.status;
+}
+
+typedef struct {
+	const char* path;
+	uint32_t seed;
+	int errors;
+} test_serve_client_t;
+
+/**
+ * \fn test_serve_round(int fd, uint32_t* state, uint32_t* words, char* want, char* got)
+ * \brief Makes one random call and compares the reply with calling the formatter directly
+ *
+ * \return 0 if the reply matches, 1 otherwise
+ */
+static int test_serve_round(int fd, uint32_t* state, uint32_t* words, char* want, char* got) {
+	static const uint8_t hex_nbits[] = { 4, 8, 16, 32 };
+	size_t n;
+	size_t len;
+	size_t i;
+	uint8_t nbits;
+	uint16_t flags;
+	int want_status;
+	int status;
+
+	switch (test_rand32(state) % 3) {
+		case 0:
+			n = test_rand32(state) % (TEST_27_MAX_WORDS + 1);
+			nbits = (uint8_t)(1 + test_rand32(state) % UINT32_T_BITS);
+			for (i = 0; i < n; i++) {
+				words[i] = test_rand32(state) >> (test_rand32(state) % UINT32_T_BITS);
+			}
+			want_status = uint_to_binstr_many(words, n, want, TEST_27_OUT_BYTES, nbits);
+			status = bitserve_call(fd, BITSERVE_BINSTR, nbits, 0, words, n * UINT32_T_BYTES, got, TEST_27_OUT_BYTES, &len);
+			if ((status != want_status) || (len != n * BINSTR_SLOT_BYTES(nbits))) {
+				return 1;
+			}
+			///< Slots of refused values must be cleared to their end
+			for (i = 0; i < len; i += BINSTR_SLOT_BYTES(nbits)) {
+				if ((strcmp(got + i, want + i) != 0) || ((got[i] == '\0') && (memcmp(got + i, got + i + 1, BINSTR_SLOT_BYTES(nbits) - 1) != 0))) {
+					return 1;
+				}
+			}
+			return 0;
+		case 1:
+			n = test_rand32(state) % (TEST_27_MAX_WORDS + 1);
+			nbits = hex_nbits[test_rand32(state) % 4];
+			flags = (uint16_t)(test_rand32(state) & (HEXSTR_LOWER | HEXSTR_NO_PREFIX | HEXSTR_REVERSED | HEXSTR_BIG_ENDIAN));
+			for (i = 0; i < n; i++) {
+				words[i] = test_rand32(state) & (uint32_t)((1ull << nbits) - 1);
+			}
+			status = bitserve_call(fd, BITSERVE_HEXSTR, nbits, flags, words, n * UINT32_T_BYTES, got, TEST_27_OUT_BYTES, &len);
+			if ((flags & HEXSTR_BIG_ENDIAN) && (nbits < 8)) {
+				return (status >= 0) || (len != 0);
+			}
+			want_status = uint_to_hexstr_many(words, n, want, TEST_27_OUT_BYTES, nbits, flags);
+			return (status != want_status) || (len != n * HEXSTR_SLOT_BYTES(nbits, flags)) || (memcmp(got, want, len) != 0);
+		default:
+			n = test_rand32(state) % (TEST_27_MAX_BYTES + 1);
+			for (i = 0; i < n; i++) {
+				((uint8_t*)words)[i] = (uint8_t)test_rand32(state);
+			}
+			hexdump(want, TEST_27_OUT_BYTES, words, n);
+			status = bitserve_call(fd, BITSERVE_HEXDUMP, 0, 0, words, n, got, TEST_27_OUT_BYTES, &len);
+			return (status != 0) || (len != hexdump_len(n) + NULL_TERMINATOR_BYTE) || (memcmp(got, want, len) != 0);
+	}
+}
+
+/**
+ * \fn test_serve_client(void* arg)
+ * \brief Client thread of test_serve: makes TEST_27_ROUNDS random calls on its own connection and counts the mismatches in errors
+ */
+static void* test_serve_client(void* arg) {
+	test_serve_client_t* client = arg;
+	uint32_t* words = malloc(TEST_27_MAX_WORDS * sizeof(uint32_t));
+	char* want = malloc(TEST_27_OUT_BYTES);
+	char* got = malloc(TEST_27_OUT_BYTES);
+	uint32_t state = client->seed;
+	int fd = bitserve_connect(client->path);
+	int r;
+
+	if ((fd < 0) || (words == NULL) || (want == NULL) || (got == NULL)) {
+		client->errors++;
+	}
+	else {
+		for (r = 0; r < TEST_27_ROUNDS; r++) {
+			client->errors += test_serve_round(fd, &state, words, want, got);
+		}
+	}
+
+	if (fd >= 0) {
+		close(fd);
+	}
+	free(words);
+	free(want);
+	free(got);
+
+	return NULL;
+}
+
+/**
+ * \fn test_serve(void)
+ * \brief Runs a server on a temporary socket and checks its replies against direct calls: concurrent clients, a full pipeline, refused and malformed requests, and a client that half-closes
+ *
+ * \return EXIT_TEST_SUCCESS if all checks pass, EXIT_TEST_FAILURE otherwise
+ */
+int test_serve(void) {
+	static uint32_t words[TEST_27_MAX_WORDS];
+	static char want[TEST_27_OUT_BYTES];
+	static char got[TEST_27_OUT_BYTES];
+	test_serve_client_t clients[TEST_27_CLIENTS];
+	pthread_t threads[TEST_27_CLIENTS];
+	bitserve_server_t* server;
+	bitserve_request_t bad;
+	bitserve_reply_t reply;
+	char path[64];
+	uint32_t state = 0x5EB5E27u;
+	size_t n;
+	size_t len;
+	int started = 0;
+	int fd;
+	int t;
+	int k;
+	int return_code = EXIT_TEST_SUCCESS;
+
+	snprintf(path, sizeof(path), "/tmp/bitserve_test_%d.sock", (int)getpid());
+	server = bitserve_start(path, TEST_27_WORKERS);
+	if (server == NULL) {
+		return EXIT_TEST_FAILURE;
+	}
+
+	///< A second server on a live socket must be refused
+	if (bitserve_start(path, 1) != NULL) {
+		return_code = EXIT_TEST_FAILURE;
+	}
+
+	for (t = 0; t < TEST_27_CLIENTS; t++) {
+		clients[t].path = path;
+		clients[t].seed = 0x9E3779B9u * (uint32_t)(t + 1);
+		clients[t].errors = 0;
+		if (pthread_create(&threads[t], NULL, test_serve_client, &clients[t]) != 0) {
+			break;
+		}
+		started++;
+	}
+	for (t = 0; t < started; t++) {
+		pthread_join(threads[t], NULL);
+		if (clients[t].errors != 0) {
+			return_code = EXIT_TEST_FAILURE;
+		}
+	}
+	if (started != TEST_27_CLIENTS) {
+		return_code = EXIT_TEST_FAILURE;
+	}
+
+	fd = bitserve_connect(path);
+	if (fd < 0) {
+		bitserve_stop(server);
+		return EXIT_TEST_FAILURE;
+	}
+
+	///< A full pipeline: request k formats the first k * 7 words at 32 bits, and the replies must come back in order
+	for (n = 0; n < TEST_27_MAX_WORDS; n++) {
+		words[n] = test_rand32(&state);
+	}
+	for (k = 0; k < TEST_27_PIPELINE; k++) {
+		if (bitserve_send(fd, BITSERVE_HEXSTR, 32, HEXSTR_LOWER, 1000 + k, words, (size_t)(k * 7) * UINT32_T_BYTES) != 0) {
+			return_code = EXIT_TEST_FAILURE;
+		}
+	}
+	for (k = 0; k < TEST_27_PIPELINE; k++) {
+		n = (size_t)(k * 7);
+		uint_to_hexstr_many(words, n, want, sizeof(want), 32, HEXSTR_LOWER);
+		if ((bitserve_recv(fd, &reply, got, sizeof(got)) != 0) || (reply.id != (uint32_t)(1000 + k)) || (reply.status != 0)) {
+			return_code = EXIT_TEST_FAILURE;
+			break;
+		}
+		if ((reply.length != n * HEXSTR_SLOT_BYTES(32, HEXSTR_LOWER)) || (memcmp(got, want, reply.length) != 0)) {
+			return_code = EXIT_TEST_FAILURE;
+		}
+	}
+
+	///< Refused requests get a negative status and no output, and the connection carries on
+	if ((bitserve_call(fd, BITSERVE_BINSTR, 33, 0, words, UINT32_T_BYTES, got, sizeof(got), &len) >= 0) || (len != 0)) {
+		return_code = EXIT_TEST_FAILURE;
+	}
+	if ((bitserve_call(fd, BITSERVE_HEXSTR, 8, 0, words, 3, got, sizeof(got), &len) >= 0) || (len != 0)) {
+		return_code = EXIT_TEST_FAILURE;
+	}
+	if ((bitserve_call(fd, 0, 8, 0, words, UINT32_T_BYTES, got, sizeof(got), &len) >= 0) || (len != 0)) {
+		return_code = EXIT_TEST_FAILURE;
+	}
+	words[0] = 0xFFFFFFFFu;
+	if ((bitserve_call(fd, BITSERVE_BINSTR, 4, 0, words, UINT32_T_BYTES, got, sizeof(got), &len) != 1) || (len != BINSTR_SLOT_BYTES(4)) || (got[0] != '\0')) {
+		return_code = EXIT_TEST_FAILURE;
+	}
+	words[0] = 0x12345678u;
+	if ((bitserve_call(fd, BITSERVE_HEXSTR, 32, HEXSTR_BIG_ENDIAN, words, UINT32_T_BYTES, got, sizeof(got), &len) != 0) || (strcmp(got, "0x78563412") != 0)) {
+		return_code = EXIT_TEST_FAILURE;
+	}
+
+	///< Requests sent before a half-close are still answered
+	for (k = 0; k < 3; k++) {
+		if (bitserve_send(fd, BITSERVE_HEXDUMP, 0, 0, k, words, 16) != 0) {
+			return_code = EXIT_TEST_FAILURE;
+		}
+	}
+	shutdown(fd, SHUT_WR);
+	for (k = 0; k < 3; k++) {
+		if ((bitserve_recv(fd, &reply, got, sizeof(got)) != 0) || (reply.id != (uint32_t)k) || (reply.length != HEXDUMP_ROW_CHARS + NULL_TERMINATOR_BYTE)) {
+			return_code = EXIT_TEST_FAILURE;
+		}
+	}
+	if (read(fd, got, 1) != 0) {
+		return_code = EXIT_TEST_FAILURE;
+	}
+	close(fd);
+
+	///< A bad magic closes the connection
+	fd = bitserve_connect(path);
+	if (fd >= 0) {
+		memset(&bad, 0, sizeof(bad));
+		bad.magic = ~BITSERVE_MAGIC;
+		if ((write(fd, &bad, sizeof(bad)) != (ssize_t)sizeof(bad)) || (bitserve_recv(fd, &reply, got, sizeof(got)) == 0)) {
+			return_code = EXIT_TEST_FAILURE;
+		}
+		close(fd);
+	}
+	else {
+		return_code = EXIT_TEST_FAILURE;
+	}
+
+	bitserve_stop(server);
+	if (access(path, F_OK) == 0) {
+		return_code = EXIT_TEST_FAILURE;
+	}
+
+	printf("test_serve: %d clients of %d calls each, a %d-request pipeline, refused and malformed requests and a half-close against %d workers\n", TEST_27_CLIENTS, TEST_27_ROUNDS, TEST_27_PIPELINE, TEST_27_WORKERS);
+
+	return return_code;
+}
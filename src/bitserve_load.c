@@ -0,0 +1,284 @@
+#include <errno.h>
+#include <pthread.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include "bitserve.h"
+
+#define LOAD_DEFAULT_WORKERS (2)
+#define LOAD_DEFAULT_DEPTH (16)
+#define LOAD_DEFAULT_CLIENTS (1)
+#define LOAD_DEFAULT_SECONDS (1.0)
+#define LOAD_MAX_CLIENTS (64)
+#define NS_PER_SEC (1000000000.0)
+#define NS_PER_US (1000.0)
+#define BYTES_PER_MB (1000000.0)
+
+static const size_t load_batch_words[] = { 1, 16, 256, 4096, 65536 };
+
+typedef struct {
+	const char* path;
+	uint8_t op;
+	uint8_t nbits;
+	uint16_t flags;
+	size_t in_len;			///< Payload bytes per request
+	size_t out_size;		///< Output bytes per reply
+	int depth;			///< Requests kept outstanding
+	uint64_t deadline_ns;
+	uint64_t* latencies;		///< Send to receive, in ns, one per reply
+	size_t nlatencies;
+	size_t cap;
+	uint64_t end_ns;
+	int errors;
+} load_client_t;
+
+/**
+ * \fn load_now_ns(void)
+ * \brief Reads the monotonic clock
+ *
+ * \return The time in nanoseconds
+ */
+static uint64_t load_now_ns(void) {
+	struct timespec ts;
+
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+
+	return ((uint64_t)ts.tv_sec * 1000000000ull) + (uint64_t)ts.tv_nsec;
+}
+
+static int load_compare_u64(const void* a, const void* b) {
+	uint64_t x = *(const uint64_t*)a;
+	uint64_t y = *(const uint64_t*)b;
+
+	return (x > y) - (x < y);
+}
+
+static void load_usage(const char* name) {
+	fprintf(stderr, "usage: %s [--socket path | --workers 1-%d] [--op binstr|hexstr|hexdump] [--depth 1-%d] [--clients 1-%d] [--seconds s]\n", name, BITSERVE_MAX_WORKERS, BITSERVE_MAX_INFLIGHT, LOAD_MAX_CLIENTS);
+}
+
+/**
+ * \fn load_client(void* arg)
+ * \brief Client thread: keeps depth requests outstanding on its own connection until the deadline, timing each from send to reply
+ */
+static void* load_client(void* arg) {
+	load_client_t* client = arg;
+	uint64_t* sent_ns = malloc((size_t)client->depth * sizeof(uint64_t));
+	uint8_t* in = malloc(client->in_len + 1);
+	uint8_t* out = malloc(client->out_size + 1);
+	uint64_t* grown;
+	bitserve_reply_t reply;
+	uint32_t sent = 0;
+	uint32_t received = 0;
+	uint64_t now;
+	size_t i;
+	int fd = bitserve_connect(client->path);
+
+	if ((fd < 0) || (sent_ns == NULL) || (in == NULL) || (out == NULL)) {
+		client->errors++;
+		goto done;
+	}
+	for (i = 0; i < client->in_len; i++) {
+		in[i] = (uint8_t)(i * 0x9Du + (i >> 8));
+	}
+
+	for (;;) {
+		now = load_now_ns();
+		while ((sent - received < (uint32_t)client->depth) && (now < client->deadline_ns)) {
+			sent_ns[sent % (uint32_t)client->depth] = now;
+			if (bitserve_send(fd, client->op, client->nbits, client->flags, sent, in, client->in_len) != 0) {
+				client->errors++;
+				goto done;
+			}
+			sent++;
+			now = load_now_ns();
+		}
+		if (received == sent) {
+			break;
+		}
+
+		if ((bitserve_recv(fd, &reply, out, client->out_size + 1) != 0) || (reply.id != received) || (reply.status < 0)) {
+			client->errors++;
+			goto done;
+		}
+		now = load_now_ns();
+		if (client->nlatencies == client->cap) {
+			client->cap = (client->cap == 0) ? 1024 : client->cap * 2;
+			grown = realloc(client->latencies, client->cap * sizeof(uint64_t));
+			if (grown == NULL) {
+				client->errors++;
+				goto done;
+			}
+			client->latencies = grown;
+		}
+		client->latencies[client->nlatencies++] = now - sent_ns[received % (uint32_t)client->depth];
+		received++;
+	}
+
+done:
+	client->end_ns = load_now_ns();
+	if (fd >= 0) {
+		close(fd);
+	}
+	free(sent_ns);
+	free(in);
+	free(out);
+
+	return NULL;
+}
+
+int main(int argc, char** argv) {
+	static load_client_t clients[LOAD_MAX_CLIENTS];
+	static pthread_t threads[LOAD_MAX_CLIENTS];
+	const char* path = NULL;
+	const char* op_name = "hexstr";
+	char own_path[64];
+	bitserve_server_t* server = NULL;
+	uint64_t* all;
+	uint64_t start_ns;
+	uint64_t end_ns;
+	size_t total;
+	size_t words;
+	size_t b;
+	double seconds = LOAD_DEFAULT_SECONDS;
+	double elapsed;
+	uint8_t op = BITSERVE_HEXSTR;
+	uint8_t nbits = 32;
+	int nworkers = LOAD_DEFAULT_WORKERS;
+	int depth = LOAD_DEFAULT_DEPTH;
+	int nclients = LOAD_DEFAULT_CLIENTS;
+	int started;
+	int errors;
+	int c;
+	int i;
+	int return_code = EXIT_SUCCESS;
+
+	for (i = 1; i < argc; i++) {
+		if ((strcmp(argv[i], "--socket") == 0) && (i + 1 < argc)) {
+			path = argv[++i];
+		}
+		else if ((strcmp(argv[i], "--workers") == 0) && (i + 1 < argc)) {
+			nworkers = atoi(argv[++i]);
+		}
+		else if ((strcmp(argv[i], "--depth") == 0) && (i + 1 < argc)) {
+			depth = atoi(argv[++i]);
+		}
+		else if ((strcmp(argv[i], "--clients") == 0) && (i + 1 < argc)) {
+			nclients = atoi(argv[++i]);
+		}
+		else if ((strcmp(argv[i], "--seconds") == 0) && (i + 1 < argc)) {
+			seconds = atof(argv[++i]);
+		}
+		else if ((strcmp(argv[i], "--op") == 0) && (i + 1 < argc)) {
+			op_name = argv[++i];
+			if (strcmp(op_name, "binstr") == 0) {
+				op = BITSERVE_BINSTR;
+				nbits = 32;
+			}
+			else if (strcmp(op_name, "hexstr") == 0) {
+				op = BITSERVE_HEXSTR;
+				nbits = 32;
+			}
+			else if (strcmp(op_name, "hexdump") == 0) {
+				op = BITSERVE_HEXDUMP;
+				nbits = 0;
+			}
+			else {
+				load_usage(argv[0]);
+				return EXIT_FAILURE;
+			}
+		}
+		else {
+			load_usage(argv[0]);
+			return EXIT_FAILURE;
+		}
+	}
+	if ((nworkers < 1) || (nworkers > BITSERVE_MAX_WORKERS) || (depth < 1) || (depth > BITSERVE_MAX_INFLIGHT) || (nclients < 1) || (nclients > LOAD_MAX_CLIENTS) || !(seconds > 0)) {
+		load_usage(argv[0]);
+		return EXIT_FAILURE;
+	}
+
+	///< Without --socket, run a server in this process
+	if (path == NULL) {
+		snprintf(own_path, sizeof(own_path), "/tmp/bitserve_load_%d.sock", (int)getpid());
+		path = own_path;
+		server = bitserve_start(path, nworkers);
+		if (server == NULL) {
+			fprintf(stderr, "%s: %s: %s\n", argv[0], path, strerror(errno));
+			return EXIT_FAILURE;
+		}
+	}
+
+	printf("%-8s %8s %6s %8s %12s %14s %10s %10s %10s\n", "op", "batch", "depth", "clients", "requests/s", "values/s", "MB/s", "p50_us", "p99_us");
+	for (b = 0; b < sizeof(load_batch_words) / sizeof(load_batch_words[0]); b++) {
+		words = load_batch_words[b];
+		start_ns = load_now_ns();
+		for (c = 0; c < nclients; c++) {
+			memset(&clients[c], 0, sizeof(clients[c]));
+			clients[c].path = path;
+			clients[c].op = op;
+			clients[c].nbits = nbits;
+			clients[c].in_len = words * sizeof(uint32_t);
+			clients[c].out_size = bitserve_reply_bytes(op, nbits, 0, clients[c].in_len);
+			clients[c].depth = depth;
+			clients[c].deadline_ns = start_ns + (uint64_t)(seconds * NS_PER_SEC);
+		}
+		started = 0;
+		for (c = 0; c < nclients; c++) {
+			if (pthread_create(&threads[c], NULL, load_client, &clients[c]) != 0) {
+				break;
+			}
+			started++;
+		}
+
+		total = 0;
+		errors = (started == nclients) ? 0 : 1;
+		end_ns = start_ns;
+		for (c = 0; c < started; c++) {
+			pthread_join(threads[c], NULL);
+			total += clients[c].nlatencies;
+			errors += clients[c].errors;
+			if (clients[c].end_ns > end_ns) {
+				end_ns = clients[c].end_ns;
+			}
+		}
+
+		all = malloc((total + 1) * sizeof(uint64_t));
+		if ((all == NULL) || (errors != 0) || (total == 0)) {
+			fprintf(stderr, "%s: batch of %zu failed\n", argv[0], words);
+			return_code = EXIT_FAILURE;
+		}
+		else {
+			total = 0;
+			for (c = 0; c < started; c++) {
+				memcpy(all + total, clients[c].latencies, clients[c].nlatencies * sizeof(uint64_t));
+				total += clients[c].nlatencies;
+			}
+			qsort(all, total, sizeof(uint64_t), load_compare_u64);
+			elapsed = (double)(end_ns - start_ns) / NS_PER_SEC;
+
+			printf("%-8s %8zu %6d %8d %12.0f %14.0f %10.1f %10.1f %10.1f\n", op_name, words, depth, nclients,
+				(double)total / elapsed,
+				(double)(total * words) / elapsed,
+				(double)(total * clients[0].out_size) / elapsed / BYTES_PER_MB,
+				(double)all[total / 2] / NS_PER_US,
+				(double)all[(total * 99) / 100] / NS_PER_US);
+			fflush(stdout);
+		}
+		free(all);
+		for (c = 0; c < nclients; c++) {
+			free(clients[c].latencies);
+		}
+		if (return_code != EXIT_SUCCESS) {
+			break;
+		}
+	}
+
+	if (server != NULL) {
+		bitserve_stop(server);
+	}
+
+	return return_code;
+}
@@ -0,0 +1,58 @@
+#include <errno.h>
+#include <pthread.h>
+#include <signal.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "bitserve.h"
+
+#define BITSERVED_DEFAULT_WORKERS (4)
+
+static void bitserved_usage(const char* name) {
+	fprintf(stderr, "usage: %s [--socket path] [--workers 1-%d]\n", name, BITSERVE_MAX_WORKERS);
+}
+
+int main(int argc, char** argv) {
+	const char* path = BITSERVE_DEFAULT_SOCKET;
+	int nworkers = BITSERVED_DEFAULT_WORKERS;
+	bitserve_server_t* server;
+	sigset_t signals;
+	char* end;
+	int sig;
+	int i;
+
+	for (i = 1; i < argc; i++) {
+		if ((strcmp(argv[i], "--socket") == 0) && (i + 1 < argc)) {
+			path = argv[++i];
+		}
+		else if ((strcmp(argv[i], "--workers") == 0) && (i + 1 < argc)) {
+			nworkers = (int)strtol(argv[++i], &end, 10);
+			if ((*end != '\0') || (nworkers < 1) || (nworkers > BITSERVE_MAX_WORKERS)) {
+				bitserved_usage(argv[0]);
+				return EXIT_FAILURE;
+			}
+		}
+		else {
+			bitserved_usage(argv[0]);
+			return EXIT_FAILURE;
+		}
+	}
+
+	///< Blocked before the server threads start so they inherit the mask and only sigwait sees the signals
+	sigemptyset(&signals);
+	sigaddset(&signals, SIGINT);
+	sigaddset(&signals, SIGTERM);
+	pthread_sigmask(SIG_BLOCK, &signals, NULL);
+
+	server = bitserve_start(path, nworkers);
+	if (server == NULL) {
+		fprintf(stderr, "%s: %s: %s\n", argv[0], path, strerror(errno));
+		return EXIT_FAILURE;
+	}
+	fprintf(stderr, "%s: listening on %s with %d workers\n", argv[0], path, nworkers);
+
+	sigwait(&signals, &sig);
+	bitserve_stop(server);
+
+	return EXIT_SUCCESS;
+}
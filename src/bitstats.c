@@ -0,0 +1,410 @@
+#include <assert.h>
+#include <pthread.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include "bitops.h"
+#include "bitstats.h"
+
+#if defined(__x86_64__) || defined(__i386__)
+#define BITOPS_X86 (1)
+#include <x86intrin.h>
+#endif
+
+#define EXIT_TEST_SUCCESS (1)
+#define EXIT_TEST_FAILURE (0)
+
+#define NULL_TERMINATOR_BYTE (1)
+#define PREFIX_BYTES_BIN (2)
+#define UINT32_T_BITS (32)
+
+#define TEST_20_CALLS (100u)
+#define TEST_20_THREADS (4)
+#define TEST_20_ROUNDS (25)		///< Rounds of TEST_20_THREADS short-lived threads
+
+static const char* const bitops_stat_names[BITOPS_STAT_COUNT] = {
+	"uint_to_binstr",
+	"int_to_binstr",
+	"uint_to_hexstr",
+	"uint_to_binstr_many",
+	"uint_to_hexstr_many",
+	"hexdump",
+	"twiggle_bit",
+	"grab_three_bits"
+};
+
+#ifdef BITOPS_STATS
+///< One block per live thread that has called an instrumented function. When a thread exits its counts are folded into bitops_stats_retired and its block is freed
+typedef struct bitops_stats_block {
+	bitops_stat_t stats[BITOPS_STAT_COUNT];
+	struct bitops_stats_block* next;
+} bitops_stats_block_t;
+
+static __thread bitops_stats_block_t* bitops_stats_local;
+static bitops_stats_block_t* bitops_stats_blocks;
+static bitops_stat_t bitops_stats_retired[BITOPS_STAT_COUNT];	///< Totals of exited threads, only touched under bitops_stats_lock
+static pthread_mutex_t bitops_stats_lock = PTHREAD_MUTEX_INITIALIZER;
+static pthread_once_t bitops_stats_once = PTHREAD_ONCE_INIT;
+static pthread_key_t bitops_stats_key;
+static int bitops_stats_key_ok;
+
+///< Only the owning thread writes a block, so a relaxed load/store pair is enough; readers may see a count one call behind
+#define BITOPS_STAT_ADD(field, value) __atomic_store_n(&(field), __atomic_load_n(&(field), __ATOMIC_RELAXED) + (value), __ATOMIC_RELAXED)
+
+/**
+ * \fn bitops_stat_clock(void)
+ * \brief Reads the time stamp counter (or the monotonic clock in nanoseconds on CPUs without one)
+ *
+ * \return The current count
+ */
+uint64_t bitops_stat_clock(void) {
+#ifdef BITOPS_X86
+	return __rdtsc();
+#else
+	struct timespec ts;
+
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+
+	return ((uint64_t)ts.tv_sec * 1000000000ull) + (uint64_t)ts.tv_nsec;
+#endif
+}
+
+/**
+ * \fn bitops_stats_add(bitops_stat_t dst[BITOPS_STAT_COUNT], const bitops_stat_t src[BITOPS_STAT_COUNT])
+ * \brief Adds one set of counters to another. src may still be counting in its own thread
+ *
+ * \param dst Counters receiving the sum
+ * \param src Counters to add
+ *
+ * \return None
+ */
+static void bitops_stats_add(bitops_stat_t dst[BITOPS_STAT_COUNT], const bitops_stat_t src[BITOPS_STAT_COUNT]) {
+	const uint64_t* from = (const uint64_t*)src;
+	uint64_t* to = (uint64_t*)dst;
+	size_t k;
+
+	for (k = 0; k < BITOPS_STAT_COUNT * (sizeof(bitops_stat_t) / sizeof(uint64_t)); k++) {
+		to[k] += __atomic_load_n(&from[k], __ATOMIC_RELAXED);
+	}
+}
+
+/**
+ * \fn bitops_stats_retire(void* arg)
+ * \brief Thread exit destructor: folds the thread's counts into bitops_stats_retired, then unlinks and frees its block
+ *
+ * \param arg The exiting thread's block
+ *
+ * \return None
+ */
+static void bitops_stats_retire(void* arg) {
+	bitops_stats_block_t* block = arg;
+	bitops_stats_block_t** link;
+
+	pthread_mutex_lock(&bitops_stats_lock);
+	bitops_stats_add(bitops_stats_retired, block->stats);
+	for (link = &bitops_stats_blocks; *link != NULL; link = &(*link)->next) {
+		if (*link == block) {
+			*link = block->next;
+			break;
+		}
+	}
+	pthread_mutex_unlock(&bitops_stats_lock);
+
+	///< A later destructor that calls an instrumented function gets a fresh block, retired on the next destructor pass
+	bitops_stats_local = NULL;
+	free(block);
+}
+
+static void bitops_stats_key_init(void) {
+	bitops_stats_key_ok = (pthread_key_create(&bitops_stats_key, bitops_stats_retire) == 0);
+}
+
+/**
+ * \fn bitops_stats_block(void)
+ * \brief Returns the calling thread's block, allocating and registering it on first use. The block is retired when the thread exits
+ *
+ * \return Pointer to the block, or NULL if it could not be allocated (the call then goes uncounted)
+ */
+static bitops_stats_block_t* bitops_stats_block(void) {
+	bitops_stats_block_t* block = bitops_stats_local;
+
+	if (block == NULL) {
+		pthread_once(&bitops_stats_once, bitops_stats_key_init);
+		block = calloc(1, sizeof(*block));
+		if (block == NULL) {
+			return NULL;
+		}
+		pthread_mutex_lock(&bitops_stats_lock);
+		block->next = bitops_stats_blocks;
+		bitops_stats_blocks = block;
+		pthread_mutex_unlock(&bitops_stats_lock);
+		bitops_stats_local = block;
+
+		///< Without the key the block simply stays registered, as if the thread never exited
+		if (bitops_stats_key_ok) {
+			pthread_setspecific(bitops_stats_key, block);
+		}
+	}
+
+	return block;
+}
+
+/**
+ * \fn bitops_stat_record(bitops_stat_id_t id, unsigned nbits, uint64_t bytes, int failed, uint64_t cycles)
+ * \brief Adds one call to the calling thread's counters for function id
+ *
+ * \param id The instrumented function
+ * \param nbits The width the call was made with, or 0 if it has none
+ * \param bytes The number of characters (or bytes) the call produced
+ * \param failed Nonzero if the call took its error path
+ * \param cycles Time stamp counter ticks spent in the call
+ *
+ * \return None
+ */
+void bitops_stat_record(bitops_stat_id_t id, unsigned nbits, uint64_t bytes, int failed, uint64_t cycles) {
+	bitops_stats_block_t* block = bitops_stats_block();
+	bitops_stat_t* stat;
+
+	if (block == NULL) {
+		return;
+	}
+
+	stat = &block->stats[id];
+	BITOPS_STAT_ADD(stat->calls, 1);
+	BITOPS_STAT_ADD(stat->bytes, bytes);
+	BITOPS_STAT_ADD(stat->failures, failed ? 1 : 0);
+	BITOPS_STAT_ADD(stat->cycles, cycles);
+	BITOPS_STAT_ADD(stat->nbits[(nbits < BITOPS_STAT_NBITS_BUCKETS) ? nbits : 0], 1);
+}
+#endif
+
+/**
+ * \fn bitops_stats_enabled(void)
+ * \brief Reports whether this build was made with STATS=1
+ *
+ * \return 1 if the counters are compiled in, 0 otherwise
+ */
+int bitops_stats_enabled(void) {
+#ifdef BITOPS_STATS
+	return 1;
+#else
+	return 0;
+#endif
+}
+
+/**
+ * \fn bitops_stats_snapshot(bitops_stat_t stats[BITOPS_STAT_COUNT])
+ * \brief Adds up the counters of every thread, including threads that have exited
+ *
+ * \param stats Array receiving one total per instrumented function (all zero when the counters are not compiled in)
+ *
+ * \return None
+ */
+void bitops_stats_snapshot(bitops_stat_t stats[BITOPS_STAT_COUNT]) {
+	assert(stats != NULL);
+
+	memset(stats, 0, BITOPS_STAT_COUNT * sizeof(bitops_stat_t));
+
+#ifdef BITOPS_STATS
+	const bitops_stats_block_t* block;
+
+	pthread_mutex_lock(&bitops_stats_lock);
+	bitops_stats_add(stats, bitops_stats_retired);
+	for (block = bitops_stats_blocks; block != NULL; block = block->next) {
+		bitops_stats_add(stats, block->stats);
+	}
+	pthread_mutex_unlock(&bitops_stats_lock);
+#endif
+}
+
+/**
+ * \fn bitops_stats_reset(void)
+ * \brief Zeroes the counters of every thread, including the totals of exited threads. Calls running at the same time may be lost or half counted
+ *
+ * \return None
+ */
+void bitops_stats_reset(void) {
+#ifdef BITOPS_STATS
+	bitops_stats_block_t* block;
+	uint64_t* words;
+	size_t k;
+
+	pthread_mutex_lock(&bitops_stats_lock);
+	memset(bitops_stats_retired, 0, sizeof(bitops_stats_retired));
+	for (block = bitops_stats_blocks; block != NULL; block = block->next) {
+		words = (uint64_t*)block->stats;
+		for (k = 0; k < BITOPS_STAT_COUNT * (sizeof(bitops_stat_t) / sizeof(uint64_t)); k++) {
+			__atomic_store_n(&words[k], 0, __ATOMIC_RELAXED);
+		}
+	}
+	pthread_mutex_unlock(&bitops_stats_lock);
+#endif
+}
+
+/**
+ * \fn bitops_stats_nblocks(void)
+ * \brief Counts the registered blocks, one per live thread that has counted a call
+ *
+ * \return The number of blocks (0 when the counters are not compiled in)
+ */
+static size_t bitops_stats_nblocks(void) {
+	size_t n = 0;
+
+#ifdef BITOPS_STATS
+	const bitops_stats_block_t* block;
+
+	pthread_mutex_lock(&bitops_stats_lock);
+	for (block = bitops_stats_blocks; block != NULL; block = block->next) {
+		n++;
+	}
+	pthread_mutex_unlock(&bitops_stats_lock);
+#endif
+
+	return n;
+}
+
+/**
+ * \fn bitops_stat_name(bitops_stat_id_t id)
+ * \brief Names an instrumented function
+ *
+ * \return The function name, or "unknown"
+ */
+const char* bitops_stat_name(bitops_stat_id_t id) {
+	return ((id >= 0) && (id < BITOPS_STAT_COUNT)) ? bitops_stat_names[id] : "unknown";
+}
+
+/**
+ * \fn bitops_stats_dump(FILE* f)
+ * \brief Prints the totals of every function that has been called: calls, bytes, failures, cycles per call, and the nbits values used
+ *
+ * \return None
+ */
+void bitops_stats_dump(FILE* f) {
+	assert(f != NULL);
+
+	bitops_stat_t stats[BITOPS_STAT_COUNT];
+	int i;
+	int k;
+
+	if (!bitops_stats_enabled()) {
+		fprintf(f, "bitops statistics are not compiled in (build with make STATS=1)\n");
+		return;
+	}
+
+	bitops_stats_snapshot(stats);
+
+	fprintf(f, "%-20s %12s %14s %10s %14s  %s\n", "function", "calls", "bytes", "failures", "cycles/call", "nbits:calls");
+	for (i = 0; i < BITOPS_STAT_COUNT; i++) {
+		if (stats[i].calls == 0) {
+			continue;
+		}
+
+		fprintf(f, "%-20s %12llu %14llu %10llu %14.1f ", bitops_stat_names[i], (unsigned long long)stats[i].calls, (unsigned long long)stats[i].bytes,
+			(unsigned long long)stats[i].failures, (double)stats[i].cycles / (double)stats[i].calls);
+		for (k = 0; k < BITOPS_STAT_NBITS_BUCKETS; k++) {
+			if (stats[i].nbits[k] != 0) {
+				fprintf(f, " %d:%llu", k, (unsigned long long)stats[i].nbits[k]);
+			}
+		}
+		fprintf(f, "\n");
+	}
+}
+
+/**
+ * \fn test_stats_worker(void* arg)
+ * \brief Makes TEST_20_CALLS 8-bit uint_to_binstr calls from its own thread
+ *
+ * \return NULL
+ */
+static void* test_stats_worker(void* arg) {
+	char str[PREFIX_BYTES_BIN + UINT32_T_BITS + NULL_TERMINATOR_BYTE];
+	uint32_t i;
+
+	(void)arg;
+	for (i = 0; i < TEST_20_CALLS; i++) {
+		uint_to_binstr(str, sizeof(str), i, 8);
+	}
+
+	return NULL;
+}
+
+int test_stats(void) {
+	char str[PREFIX_BYTES_BIN + UINT32_T_BITS + NULL_TERMINATOR_BYTE];
+	char dump[HEXDUMP_ROW_CHARS * 2 + NULL_TERMINATOR_BYTE];
+	bitops_stat_t stats[BITOPS_STAT_COUNT];
+	pthread_t threads[TEST_20_THREADS];
+	uint64_t expected_calls = (uint64_t)TEST_20_CALLS * ((TEST_20_THREADS * TEST_20_ROUNDS) + 1);
+	size_t nblocks = 0;
+	uint32_t i;
+	int round;
+	int t;
+	int return_code = EXIT_TEST_SUCCESS;
+
+	bitops_stats_reset();
+
+	///< Known calls from this thread and from TEST_20_ROUNDS rounds of TEST_20_THREADS short-lived others, including failures
+	for (i = 0; i < TEST_20_CALLS; i++) {
+		uint_to_binstr(str, sizeof(str), i, 8);
+		uint_to_hexstr(str, sizeof(str), i, 16);
+	}
+	uint_to_binstr(str, sizeof(str), 0x100, 8);
+	uint_to_binstr(str, sizeof(str), 5, 3);
+	hexdump(dump, sizeof(dump), str, 20);
+	nblocks = bitops_stats_nblocks();
+	for (round = 0; round < TEST_20_ROUNDS; round++) {
+		for (t = 0; t < TEST_20_THREADS; t++) {
+			if (pthread_create(&threads[t], NULL, test_stats_worker, NULL) != 0) {
+				return EXIT_TEST_FAILURE;
+			}
+		}
+		for (t = 0; t < TEST_20_THREADS; t++) {
+			pthread_join(threads[t], NULL);
+		}
+	}
+
+	bitops_stats_snapshot(stats);
+
+	if (!bitops_stats_enabled()) {
+		for (i = 0; i < BITOPS_STAT_COUNT; i++) {
+			if (stats[i].calls != 0) {
+				return_code = EXIT_TEST_FAILURE;
+			}
+		}
+		printf("test_stats: counters not compiled in, checked the snapshot is empty (make STATS=1 to test them)\n");
+		return return_code;
+	}
+
+	if ((stats[BITOPS_STAT_UINT_TO_BINSTR].calls != expected_calls + 2) || (stats[BITOPS_STAT_UINT_TO_BINSTR].failures != 1)
+		|| (stats[BITOPS_STAT_UINT_TO_BINSTR].nbits[8] != expected_calls + 1) || (stats[BITOPS_STAT_UINT_TO_BINSTR].nbits[3] != 1)
+		|| (stats[BITOPS_STAT_UINT_TO_BINSTR].bytes != (expected_calls * 10) + 5)) {
+		printf("test_stats: (FAILURE): uint_to_binstr calls = %llu, failures = %llu, bytes = %llu\n", (unsigned long long)stats[BITOPS_STAT_UINT_TO_BINSTR].calls,
+			(unsigned long long)stats[BITOPS_STAT_UINT_TO_BINSTR].failures, (unsigned long long)stats[BITOPS_STAT_UINT_TO_BINSTR].bytes);
+		return_code = EXIT_TEST_FAILURE;
+	}
+	///< Joined threads have run their destructors, so their blocks are gone and only their counts remain
+	if (bitops_stats_nblocks() > nblocks) {
+		printf("test_stats: (FAILURE): %zu blocks registered after the threads exited, %zu before\n", bitops_stats_nblocks(), nblocks);
+		return_code = EXIT_TEST_FAILURE;
+	}
+	if ((stats[BITOPS_STAT_UINT_TO_HEXSTR].calls != TEST_20_CALLS) || (stats[BITOPS_STAT_UINT_TO_HEXSTR].nbits[16] != TEST_20_CALLS) || (stats[BITOPS_STAT_UINT_TO_HEXSTR].bytes != TEST_20_CALLS * 6)) {
+		printf("test_stats: (FAILURE): uint_to_hexstr counters\n");
+		return_code = EXIT_TEST_FAILURE;
+	}
+	if ((stats[BITOPS_STAT_HEXDUMP].calls != 1) || (stats[BITOPS_STAT_HEXDUMP].bytes != hexdump_len(20)) || (stats[BITOPS_STAT_HEXDUMP].nbits[0] != 1)) {
+		printf("test_stats: (FAILURE): hexdump counters\n");
+		return_code = EXIT_TEST_FAILURE;
+	}
+
+	bitops_stats_dump(stdout);
+
+	bitops_stats_reset();
+	bitops_stats_snapshot(stats);
+	if (stats[BITOPS_STAT_UINT_TO_BINSTR].calls != 0) {
+		printf("test_stats: (FAILURE): reset left counts behind\n");
+		return_code = EXIT_TEST_FAILURE;
+	}
+
+	printf("test_stats: counters checked across %d threads, %zu block(s) registered after they exited\n", (TEST_20_THREADS * TEST_20_ROUNDS) + 1, bitops_stats_nblocks());
+
+	return return_code;
+}
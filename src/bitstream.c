@@ -0,0 +1,472 @@
+#include <assert.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "bitstream.h"
+
+#if defined(__x86_64__) || defined(__i386__)
+#define BITOPS_X86 (1)
+#include <immintrin.h>
+#endif
+
+#define EXIT_FAILURE_N (-1)
+#define EXIT_TEST_SUCCESS (1)
+#define EXIT_TEST_FAILURE (0)
+
+#define BITS_PER_BYTE (8)
+#define UINT64_T_BYTES (8)
+#define UINT64_T_BITS (64)
+#define FIELDS_PER_GROUP (8)			///< Fields unpacked per AVX2 step; 8 fields of nbits bits span exactly nbits bytes
+#define GROUP_LOAD_BYTES (32)
+
+#define TEST_23_SEED (0xB175u)
+#define TEST_23_FIELDS (3000u)
+#define TEST_23_BYTES ((TEST_23_FIELDS * BITSTREAM_MAX_BITS / BITS_PER_BYTE) + 1u)
+#define TEST_23_ROUNDS (8u)
+
+uint8_t TEST_23_STREAM[TEST_23_BYTES];
+uint8_t TEST_23_EXPECTED[TEST_23_BYTES];
+uint64_t TEST_23_VALUES[TEST_23_FIELDS];
+uint8_t TEST_23_WIDTHS[TEST_23_FIELDS];
+uint32_t TEST_23_MANY[TEST_23_FIELDS];
+
+/**
+ * \fn bitstream_mask(uint8_t nbits)
+ * \brief Mask of the low nbits bits, nbits being 1 to 64
+ *
+ * \return The mask
+ */
+static inline uint64_t bitstream_mask(uint8_t nbits) {
+	return ~0ull >> (UINT64_T_BITS - nbits);
+}
+
+/**
+ * \fn bitstream_load64(const uint8_t* p, size_t avail)
+ * \brief Loads 8 bytes as a little-endian word, of which only the first avail bytes exist; the rest read as zero
+ *
+ * \return The word
+ */
+static inline uint64_t bitstream_load64(const uint8_t* p, size_t avail) {
+	uint64_t word = 0;
+
+	if (avail >= UINT64_T_BYTES) {
+		memcpy(&word, p, sizeof(word));
+#if defined(__BYTE_ORDER__) && (__BYTE_ORDER__ == __ORDER_BIG_ENDIAN__)
+		word = __builtin_bswap64(word);
+#endif
+		return word;
+	}
+
+	while (avail > 0) {
+		avail--;
+		word = (word << BITS_PER_BYTE) | p[avail];
+	}
+
+	return word;
+}
+
+/**
+ * \fn bitstream_refill(bitstream_t* bs)
+ * \brief Reloads a reader's buffer with the bits from bitpos on: at least 57 of them unless the stream ends sooner
+ *
+ * \return None
+ */
+static inline void bitstream_refill(bitstream_t* bs) {
+	size_t byte = bs->bitpos / BITS_PER_BYTE;
+	uint8_t shift = (uint8_t)(bs->bitpos % BITS_PER_BYTE);
+	size_t avail = bs->size - byte;
+
+	bs->cache = bitstream_load64(bs->buf + byte, avail) >> shift;
+	bs->cached = (avail >= UINT64_T_BYTES) ? (uint8_t)(UINT64_T_BITS - shift) : (uint8_t)((avail * BITS_PER_BYTE) - shift);
+}
+
+/**
+ * \fn bitstream_init_reader(bitstream_t* bs, const void* buf, size_t size)
+ * \brief Sets up a reader at the first bit of buf
+ *
+ * \return None
+ */
+void bitstream_init_reader(bitstream_t* bs, const void* buf, size_t size) {
+	assert(bs != NULL);
+	assert((buf != NULL) || (size == 0));
+
+	bs->buf = (uint8_t*)buf;
+	bs->size = size;
+	bs->bitpos = 0;
+	bs->cache = 0;
+	bs->cached = 0;
+	bs->writing = 0;
+}
+
+/**
+ * \fn bitstream_init_writer(bitstream_t* bs, void* buf, size_t size)
+ * \brief Sets up a writer at the first bit of buf. Bytes of buf past the bits written so far may be overwritten with zeros before they are reached
+ *
+ * \return None
+ */
+void bitstream_init_writer(bitstream_t* bs, void* buf, size_t size) {
+	bitstream_init_reader(bs, buf, size);
+	bs->writing = 1;
+}
+
+/**
+ * \fn bitstream_read(bitstream_t* bs, uint8_t nbits, uint64_t* value)
+ * \brief Reads the next field
+ *
+ * \param bs Pointer to a reader
+ * \param nbits The width of the field, 1 to BITSTREAM_MAX_BITS
+ * \param value Pointer to where the field is stored
+ *
+ * \return If successful, returns 0. If fewer than nbits bits remain, returns a negative value and the reader does not move.
+ */
+int bitstream_read(bitstream_t* bs, uint8_t nbits, uint64_t* value) {
+	assert((bs != NULL) && (value != NULL));
+	assert(!bs->writing);
+	assert((nbits >= 1) && (nbits <= BITSTREAM_MAX_BITS));
+
+	if (nbits > bs->cached) {
+		if ((bs->size * BITS_PER_BYTE) - bs->bitpos < nbits) {
+			return EXIT_FAILURE_N;
+		}
+		bitstream_refill(bs);
+	}
+
+	*value = bs->cache & bitstream_mask(nbits);
+	bs->cache >>= nbits;
+	bs->cached -= nbits;
+	bs->bitpos += nbits;
+
+	return 0;
+}
+
+/**
+ * \fn bitstream_write(bitstream_t* bs, uint64_t value, uint8_t nbits)
+ * \brief Appends the low nbits bits of value
+ *
+ * \param bs Pointer to a writer
+ * \param value The field. Bits above nbits are ignored
+ * \param nbits The width of the field, 1 to BITSTREAM_MAX_BITS
+ *
+ * \return If successful, returns 0. If fewer than nbits bits of space remain, returns a negative value and nothing is written.
+ */
+int bitstream_write(bitstream_t* bs, uint64_t value, uint8_t nbits) {
+	size_t byte;
+	size_t nbytes;
+	size_t k;
+
+	assert(bs != NULL);
+	assert(bs->writing);
+	assert((nbits >= 1) && (nbits <= BITSTREAM_MAX_BITS));
+
+	if ((bs->size * BITS_PER_BYTE) - bs->bitpos < nbits) {
+		return EXIT_FAILURE_N;
+	}
+
+	///< Fewer than 8 bits are held back, so the buffer never holds more than 64
+	bs->cache |= (value & bitstream_mask(nbits)) << bs->cached;
+	bs->cached += nbits;
+	bs->bitpos += nbits;
+	if (bs->cached < BITS_PER_BYTE) {
+		return 0;
+	}
+
+	byte = (bs->bitpos - bs->cached) / BITS_PER_BYTE;
+	nbytes = bs->cached / BITS_PER_BYTE;
+	if (byte + UINT64_T_BYTES <= bs->size) {
+#if defined(__BYTE_ORDER__) && (__BYTE_ORDER__ == __ORDER_BIG_ENDIAN__)
+		value = __builtin_bswap64(bs->cache);
+#else
+		value = bs->cache;
+#endif
+		memcpy(bs->buf + byte, &value, sizeof(value));
+	}
+	else {
+		for (k = 0; k < nbytes; k++) {
+			bs->buf[byte + k] = (uint8_t)(bs->cache >> (k * BITS_PER_BYTE));
+		}
+	}
+
+	bs->cache = (nbytes == UINT64_T_BYTES) ? 0 : (bs->cache >> (nbytes * BITS_PER_BYTE));
+	bs->cached %= BITS_PER_BYTE;
+
+	return 0;
+}
+
+#ifdef BITOPS_X86
+/**
+ * \fn bitstream_unpack_avx2(const uint8_t* buf, size_t size, size_t bitpos, uint32_t* out, size_t n, uint8_t nbits)
+ * \brief Unpacks groups of 8 fields from bitpos on. Each group is one 32-byte load; vpermd picks the two dwords each field lies in and variable shifts line it up
+ *
+ * \return The number of fields unpacked, a multiple of 8. It stops short of n where a load would pass the end of buf
+ */
+static __attribute__((target("avx2"))) size_t bitstream_unpack_avx2(const uint8_t* buf, size_t size, size_t bitpos, uint32_t* out, size_t n, uint8_t nbits) {
+	uint32_t first = (uint32_t)(bitpos % BITS_PER_BYTE);
+	size_t byte = bitpos / BITS_PER_BYTE;
+	__m256i lane = _mm256_setr_epi32(0, 1, 2, 3, 4, 5, 6, 7);
+	__m256i offset = _mm256_add_epi32(_mm256_set1_epi32((int)first), _mm256_mullo_epi32(lane, _mm256_set1_epi32(nbits)));
+	__m256i lo_index = _mm256_srli_epi32(offset, 5);
+	__m256i hi_index = _mm256_add_epi32(lo_index, _mm256_set1_epi32(1));
+	__m256i lo_shift = _mm256_and_si256(offset, _mm256_set1_epi32(31));
+	__m256i hi_shift = _mm256_sub_epi32(_mm256_set1_epi32(32), lo_shift);
+	__m256i mask = _mm256_set1_epi32((int)(0xFFFFFFFFu >> (32 - nbits)));
+	__m256i v;
+	__m256i field;
+	size_t done = 0;
+
+	///< A 32-bit field starting mid-byte spans 33 bytes; leave it to the scalar loop
+	if ((nbits == 32) && (first != 0)) {
+		return 0;
+	}
+
+	for (; (done + FIELDS_PER_GROUP <= n) && (byte + GROUP_LOAD_BYTES <= size); done += FIELDS_PER_GROUP, byte += nbits) {
+		v = _mm256_loadu_si256((const __m256i*)(buf + byte));
+		///< A hi_shift of 32 shifts to zero, and a hi dword past the field only sets bits the mask clears
+		field = _mm256_or_si256(_mm256_srlv_epi32(_mm256_permutevar8x32_epi32(v, lo_index), lo_shift), _mm256_sllv_epi32(_mm256_permutevar8x32_epi32(v, hi_index), hi_shift));
+		_mm256_storeu_si256((__m256i*)(out + done), _mm256_and_si256(field, mask));
+	}
+
+	return done;
+}
+#endif
+
+/**
+ * \fn bitstream_read_many(bitstream_t* bs, uint32_t* out, size_t n, uint8_t nbits)
+ * \brief Reads the next n fields of the same width into out, 8 at a time with AVX2 when the ISA tier allows it
+ *
+ * \param bs Pointer to a reader
+ * \param out Pointer to n values
+ * \param n The number of fields
+ * \param nbits The width of each field, 1 to BITSTREAM_MAX_MANY_BITS
+ *
+ * \return If successful, returns 0. If fewer than n * nbits bits remain, returns a negative value and nothing is read.
+ */
+int bitstream_read_many(bitstream_t* bs, uint32_t* out, size_t n, uint8_t nbits) {
+	uint64_t value;
+	size_t bitpos;
+	size_t done = 0;
+	size_t byte;
+
+	assert(bs != NULL);
+	assert(!bs->writing);
+	assert((out != NULL) || (n == 0));
+	assert((nbits >= 1) && (nbits <= BITSTREAM_MAX_MANY_BITS));
+
+	if ((n > 0) && ((((bs->size * BITS_PER_BYTE) - bs->bitpos) / nbits) < n)) {
+		return EXIT_FAILURE_N;
+	}
+
+	bitpos = bs->bitpos;
+#ifdef BITOPS_X86
+	if (bitops_cpu_features() & BITOPS_CPU_AVX2) {
+		done = bitstream_unpack_avx2(bs->buf, bs->size, bitpos, out, n, nbits);
+		bitpos += done * nbits;
+	}
+#endif
+
+	///< One unaligned load, shift and mask per field while 8 bytes remain, then the refilling reader
+	for (; done < n; done++) {
+		byte = bitpos / BITS_PER_BYTE;
+		if (byte + UINT64_T_BYTES > bs->size) {
+			break;
+		}
+		out[done] = (uint32_t)((bitstream_load64(bs->buf + byte, UINT64_T_BYTES) >> (bitpos % BITS_PER_BYTE)) & bitstream_mask(nbits));
+		bitpos += nbits;
+	}
+
+	bs->bitpos = bitpos;
+	bs->cached = 0;
+	for (; done < n; done++) {
+		bitstream_read(bs, nbits, &value);
+		out[done] = (uint32_t)value;
+	}
+
+	return 0;
+}
+
+/**
+ * \fn bitstream_seek(bitstream_t* bs, size_t bitpos)
+ * \brief Moves a reader to bit bitpos
+ *
+ * \return If successful, returns 0. If bitpos lies past the end of the stream or bs is a writer, returns a negative value.
+ */
+int bitstream_seek(bitstream_t* bs, size_t bitpos) {
+	assert(bs != NULL);
+
+	if (bs->writing || (bitpos > bs->size * BITS_PER_BYTE)) {
+		return EXIT_FAILURE_N;
+	}
+
+	bs->bitpos = bitpos;
+	bs->cache = 0;
+	bs->cached = 0;
+
+	return 0;
+}
+
+/**
+ * \fn bitstream_tell(const bitstream_t* bs)
+ * \brief Reports how far a reader or writer has got
+ *
+ * \return The number of bits read or written so far
+ */
+size_t bitstream_tell(const bitstream_t* bs) {
+	assert(bs != NULL);
+
+	return bs->bitpos;
+}
+
+/**
+ * \fn bitstream_flush(bitstream_t* bs)
+ * \brief Stores a writer's held-back bits, zero-padded to a whole byte. Writing can carry on afterwards
+ *
+ * \return The number of bytes the stream covers so far
+ */
+size_t bitstream_flush(bitstream_t* bs) {
+	assert(bs != NULL);
+
+	if (bs->writing && (bs->cached > 0)) {
+		bs->buf[bs->bitpos / BITS_PER_BYTE] = (uint8_t)bs->cache;
+	}
+
+	return (bs->bitpos + BITS_PER_BYTE - 1) / BITS_PER_BYTE;
+}
+
+/**
+ * \fn test_bitstream_get_bit(const uint8_t* buf, size_t bit)
+ * \brief Reference reader: one bit at a time
+ *
+ * \return Bit bit of the stream
+ */
+static uint64_t test_bitstream_get_bit(const uint8_t* buf, size_t bit) {
+	return (buf[bit / BITS_PER_BYTE] >> (bit % BITS_PER_BYTE)) & 1u;
+}
+
+/**
+ * \fn test_bitstream(void)
+ * \brief Writes and reads streams of random fields of random widths, and reads same-width runs under every ISA tier, against a bit-at-a-time reference
+ *
+ * \return If successful, returns EXIT_TEST_SUCCESS. If unsuccessful, returns EXIT_TEST_FAILURE.
+ */
+int test_bitstream(void) {
+	bitstream_t bs;
+	bitops_isa_t saved_isa = bitops_isa();
+	bitops_isa_t max_isa = bitops_isa_max_supported();
+	bitops_isa_t isa;
+	uint32_t state = TEST_23_SEED;
+	uint32_t round;
+	uint64_t value;
+	uint64_t expected;
+	size_t bit;
+	size_t nbytes;
+	size_t start;
+	size_t n;
+	size_t k;
+	size_t j;
+	uint8_t nbits;
+	int return_code = EXIT_TEST_SUCCESS;
+
+	///< Mixed widths, 1 to BITSTREAM_MAX_BITS, written and read back
+	for (round = 0; round < TEST_23_ROUNDS; round++) {
+		memset(TEST_23_EXPECTED, 0, sizeof(TEST_23_EXPECTED));
+		memset(TEST_23_STREAM, 0xEE, sizeof(TEST_23_STREAM));
+		bit = 0;
+		for (k = 0; k < TEST_23_FIELDS; k++) {
+			TEST_23_WIDTHS[k] = (round % 2 == 0) ? (uint8_t)(1 + (test_rand32(&state) % BITSTREAM_MAX_BITS)) : (uint8_t)((k % 3 == 0) ? 3 : ((k % 3 == 1) ? 5 : 13));
+			TEST_23_VALUES[k] = ((uint64_t)test_rand32(&state) << 32) | test_rand32(&state);
+			for (j = 0; j < TEST_23_WIDTHS[k]; j++, bit++) {
+				TEST_23_EXPECTED[bit / BITS_PER_BYTE] |= (uint8_t)(((TEST_23_VALUES[k] >> j) & 1u) << (bit % BITS_PER_BYTE));
+			}
+		}
+		nbytes = (bit + BITS_PER_BYTE - 1) / BITS_PER_BYTE;
+
+		bitstream_init_writer(&bs, TEST_23_STREAM, nbytes);
+		for (k = 0; k < TEST_23_FIELDS; k++) {
+			if (bitstream_write(&bs, TEST_23_VALUES[k], TEST_23_WIDTHS[k]) != 0) {
+				printf("test_bitstream: (FAILURE): round %u, write of field %zu refused\n", round, k);
+				return_code = EXIT_TEST_FAILURE;
+				break;
+			}
+		}
+		if ((bitstream_flush(&bs) != nbytes) || (memcmp(TEST_23_STREAM, TEST_23_EXPECTED, nbytes) != 0)) {
+			printf("test_bitstream: (FAILURE): round %u, written stream differs from the reference\n", round);
+			return_code = EXIT_TEST_FAILURE;
+		}
+		if (bitstream_write(&bs, 0, BITS_PER_BYTE) == 0) {
+			printf("test_bitstream: (FAILURE): round %u, write past the end accepted\n", round);
+			return_code = EXIT_TEST_FAILURE;
+		}
+
+		bitstream_init_reader(&bs, TEST_23_EXPECTED, nbytes);
+		for (k = 0; k < TEST_23_FIELDS; k++) {
+			if ((bitstream_read(&bs, TEST_23_WIDTHS[k], &value) != 0) || (value != (TEST_23_VALUES[k] & (~0ull >> (UINT64_T_BITS - TEST_23_WIDTHS[k]))))) {
+				printf("test_bitstream: (FAILURE): round %u, field %zu (%u bits) read back wrong\n", round, k, TEST_23_WIDTHS[k]);
+				return_code = EXIT_TEST_FAILURE;
+				break;
+			}
+		}
+		if ((bitstream_tell(&bs) != bit) || (bitstream_read(&bs, BITS_PER_BYTE, &value) == 0)) {
+			printf("test_bitstream: (FAILURE): round %u, reader ended at bit %zu of %zu or read past the end\n", round, bitstream_tell(&bs), bit);
+			return_code = EXIT_TEST_FAILURE;
+		}
+	}
+
+	///< Same-width runs at every width and starting bit, against the reference, under each ISA tier
+	for (k = 0; k < TEST_23_BYTES; k++) {
+		TEST_23_STREAM[k] = (uint8_t)test_rand32(&state);
+	}
+	for (isa = BITOPS_ISA_SCALAR; isa <= max_isa; isa++) {
+		bitops_set_isa(isa);
+		for (nbits = 1; nbits <= BITSTREAM_MAX_MANY_BITS; nbits++) {
+			start = test_rand32(&state) % 64;
+			nbytes = TEST_23_BYTES - (test_rand32(&state) % 64);
+			n = (nbytes * BITS_PER_BYTE - start) / nbits;
+			n = (n > TEST_23_FIELDS) ? TEST_23_FIELDS : n;
+			///< Reading to the very end of a stream exercises the slow tail
+			if (nbits % 4 == 0) {
+				nbytes = ((start + (n * nbits)) + BITS_PER_BYTE - 1) / BITS_PER_BYTE;
+			}
+
+			bitstream_init_reader(&bs, TEST_23_STREAM, nbytes);
+			bitstream_seek(&bs, start);
+			if (bitstream_read_many(&bs, TEST_23_MANY, n, nbits) != 0) {
+				printf("test_bitstream: (FAILURE) [%s]: %zu fields of %u bits refused\n", bitops_isa_name(isa), n, nbits);
+				return_code = EXIT_TEST_FAILURE;
+				continue;
+			}
+			for (k = 0; k < n; k++) {
+				expected = 0;
+				for (j = 0; j < nbits; j++) {
+					expected |= test_bitstream_get_bit(TEST_23_STREAM, start + (k * nbits) + j) << j;
+				}
+				if (TEST_23_MANY[k] != expected) {
+					printf("test_bitstream: (FAILURE) [%s]: field %zu of %u bits from bit %zu is 0x%X, expected 0x%llX\n", bitops_isa_name(isa), k, nbits, start, TEST_23_MANY[k], (unsigned long long)expected);
+					return_code = EXIT_TEST_FAILURE;
+					break;
+				}
+			}
+			if (bitstream_tell(&bs) != start + (n * nbits)) {
+				printf("test_bitstream: (FAILURE) [%s]: %u-bit run ended at bit %zu\n", bitops_isa_name(isa), nbits, bitstream_tell(&bs));
+				return_code = EXIT_TEST_FAILURE;
+			}
+			if (bitstream_read_many(&bs, TEST_23_MANY, ((nbytes * BITS_PER_BYTE) - bitstream_tell(&bs)) / nbits + 1, nbits) == 0) {
+				printf("test_bitstream: (FAILURE) [%s]: %u-bit run past the end accepted\n", bitops_isa_name(isa), nbits);
+				return_code = EXIT_TEST_FAILURE;
+			}
+		}
+	}
+	bitops_set_isa(saved_isa);
+
+	///< A known answer: a 3-bit and a 5-bit field share a byte, a 13-bit field crosses two
+	bitstream_init_writer(&bs, TEST_23_STREAM, 3);
+	bitstream_write(&bs, 5, 3);
+	bitstream_write(&bs, 0x13, 5);
+	bitstream_write(&bs, 0x1ABC, 13);
+	if ((bitstream_flush(&bs) != 3) || (TEST_23_STREAM[0] != 0x9D) || (TEST_23_STREAM[1] != 0xBC) || (TEST_23_STREAM[2] != 0x1A)) {
+		printf("test_bitstream: (FAILURE): known answer 0x%02X 0x%02X 0x%02X\n", TEST_23_STREAM[0], TEST_23_STREAM[1], TEST_23_STREAM[2]);
+		return_code = EXIT_TEST_FAILURE;
+	}
+
+	printf("test_bitstream: %u mixed-width streams and %u-bit runs checked under ISA tiers scalar to %s\n", TEST_23_ROUNDS, BITSTREAM_MAX_MANY_BITS, bitops_isa_name(max_isa));
+
+	return return_code;
+}
@@ -0,0 +1,540 @@
+#include <assert.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "bitvec.h"
+
+#if defined(__x86_64__) || defined(__i386__)
+#define BITOPS_X86 (1)
+#include <immintrin.h>
+#endif
+
+#define EXIT_FAILURE_N (-1)
+#define EXIT_TEST_SUCCESS (1)
+#define EXIT_TEST_FAILURE (0)
+
+#define NULL_TERMINATOR_BYTE (1)
+#define PREFIX_BYTES_BIN (2)
+#define BITS_PER_BYTE (8)
+
+#define TEST_15_SEED (31337u)
+#define TEST_15_BITS (5000u)
+#define TEST_15_ROUNDS (2000u)
+
+uint8_t TEST_15_MODEL_A[TEST_15_BITS];
+uint8_t TEST_15_MODEL_B[TEST_15_BITS];
+char TEST_15_STR[PREFIX_BYTES_BIN + TEST_15_BITS + NULL_TERMINATOR_BYTE];
+
+typedef enum {
+	BITVEC_AND,
+	BITVEC_OR,
+	BITVEC_XOR,
+	BITVEC_ANDNOT
+} bitvec_logic_t;
+
+/**
+ * \fn bitvec_tail_mask(size_t nbits)
+ * \brief Mask of the bits of the last word that lie inside a vector of nbits
+ *
+ * \return The mask (all ones when nbits is a multiple of 64)
+ */
+static inline uint64_t bitvec_tail_mask(size_t nbits) {
+	return ((nbits % BITVEC_WORD_BITS) == 0) ? ~0ull : ((1ull << (nbits % BITVEC_WORD_BITS)) - 1);
+}
+
+/**
+ * \fn bitvec_has_avx2(void)
+ * \brief Reports whether AVX2 instructions are enabled in the chosen ISA tier
+ *
+ * \return 1 if AVX2 instructions may be used, 0 otherwise
+ */
+static int bitvec_has_avx2(void) {
+	return (bitops_cpu_features() & BITOPS_CPU_AVX2) ? 1 : 0;
+}
+
+/**
+ * \fn bitvec_init(bitvec_t* bv, size_t nbits)
+ * \brief Allocates a zeroed bit vector of nbits bits in BITVEC_WORDS(nbits) words, the same storage bitvec_wrap takes
+ *
+ * \param bv Pointer to the vector to set up
+ * \param nbits The number of bits in the vector
+ *
+ * \return If successful, returns 0. If the storage cannot be allocated, returns a negative value.
+ */
+int bitvec_init(bitvec_t* bv, size_t nbits) {
+	assert(bv != NULL);
+
+	bv->words = calloc(BITVEC_WORDS(nbits), sizeof(uint64_t));
+	bv->nbits = nbits;
+	bv->owned = 1;
+
+	///< calloc may return NULL for an empty vector, which, as with bitvec_wrap, is never read
+	return ((bv->words == NULL) && (nbits > 0)) ? EXIT_FAILURE_N : 0;
+}
+
+/**
+ * \fn bitvec_wrap(bitvec_t* bv, uint64_t* words, size_t nbits)
+ * \brief Sets up a vector over caller-owned storage of BITVEC_WORDS(nbits) words. Any bits above nbits in the last word are cleared
+ *
+ * \return None
+ */
+void bitvec_wrap(bitvec_t* bv, uint64_t* words, size_t nbits) {
+	assert(bv != NULL);
+	assert((words != NULL) || (nbits == 0));
+
+	bv->words = words;
+	bv->nbits = nbits;
+	bv->owned = 0;
+
+	if (nbits > 0) {
+		words[BITVEC_WORDS(nbits) - 1] &= bitvec_tail_mask(nbits);
+	}
+}
+
+/**
+ * \fn bitvec_free(bitvec_t* bv)
+ * \brief Releases storage allocated by bitvec_init (wrapped storage is left alone)
+ *
+ * \return None
+ */
+void bitvec_free(bitvec_t* bv) {
+	assert(bv != NULL);
+
+	if (bv->owned) {
+		free(bv->words);
+	}
+	bv->words = NULL;
+	bv->nbits = 0;
+}
+
+/**
+ * \fn bitvec_get(const bitvec_t* bv, size_t bit)
+ * \brief Reads a single bit
+ *
+ * \return 1 if bit is set, 0 otherwise
+ */
+int bitvec_get(const bitvec_t* bv, size_t bit) {
+	assert(bit < bv->nbits);
+
+	return (int)((bv->words[bit / BITVEC_WORD_BITS] >> (bit % BITVEC_WORD_BITS)) & 1u);
+}
+
+/**
+ * \fn bitvec_twiggle(bitvec_t* bv, size_t bit, operation_t operation)
+ * \brief Changes exactly a single bit of the vector, like twiggle_bit does for one word
+ *
+ * \return None
+ */
+void bitvec_twiggle(bitvec_t* bv, size_t bit, operation_t operation) {
+	bitvec_twiggle_range(bv, bit, 1, operation);
+}
+
+/**
+ * \fn bitvec_apply(uint64_t* word, uint64_t mask, operation_t operation)
+ * \brief Applies operation to the bits of word selected by mask
+ *
+ * \return None
+ */
+static inline void bitvec_apply(uint64_t* word, uint64_t mask, operation_t operation) {
+	switch (operation) {
+		case CLEAR:
+			*word &= ~mask;
+			break;
+		case SET:
+			*word |= mask;
+			break;
+		case TOGGLE:
+			*word ^= mask;
+			break;
+		default:
+			break;
+	}
+}
+
+/**
+ * \fn bitvec_twiggle_range(bitvec_t* bv, size_t start_bit, size_t count, operation_t operation)
+ * \brief Applies CLEAR, SET or TOGGLE to count consecutive bits starting at start_bit. Whole words in the middle of the range are handled 64 bits at a time (with memset for CLEAR and SET)
+ *
+ * \param bv Pointer to the vector
+ * \param start_bit The first bit of the range
+ * \param count The number of bits in the range (start_bit + count must not exceed the vector length)
+ * \param operation The type of operation to perform on the range
+ *
+ * \return None
+ */
+void bitvec_twiggle_range(bitvec_t* bv, size_t start_bit, size_t count, operation_t operation) {
+	assert(bv != NULL);
+	assert((start_bit <= bv->nbits) && (count <= bv->nbits - start_bit));
+	assert((operation == CLEAR) || (operation == SET) || (operation == TOGGLE));
+
+	size_t first = start_bit / BITVEC_WORD_BITS;
+	size_t last;
+	size_t end_bit = start_bit + count;
+	uint64_t head_mask;
+	uint64_t tail_mask;
+	size_t i;
+
+	if (count == 0) {
+		return;
+	}
+
+	last = (end_bit - 1) / BITVEC_WORD_BITS;
+	head_mask = ~0ull << (start_bit % BITVEC_WORD_BITS);
+	tail_mask = bitvec_tail_mask(end_bit);
+
+	if (first == last) {
+		bitvec_apply(&bv->words[first], head_mask & tail_mask, operation);
+		return;
+	}
+
+	bitvec_apply(&bv->words[first], head_mask, operation);
+
+	if (operation == TOGGLE) {
+		for (i = first + 1; i < last; i++) {
+			bv->words[i] = ~bv->words[i];
+		}
+	}
+	else {
+		memset(&bv->words[first + 1], (operation == SET) ? 0xFF : 0x00, (last - first - 1) * sizeof(uint64_t));
+	}
+
+	bitvec_apply(&bv->words[last], tail_mask, operation);
+}
+
+#ifdef BITOPS_X86
+/**
+ * \fn bitvec_popcount_avx2(const uint64_t* words, size_t n)
+ * \brief Counts set bits 256 at a time with the nibble-table pshufb method, summing byte counts with vpsadbw
+ *
+ * \return The number of set bits in the first n words
+ */
+static __attribute__((target("avx2"))) size_t bitvec_popcount_avx2(const uint64_t* words, size_t n) {
+	const __m256i table = _mm256_setr_epi8(0, 1, 1, 2, 1, 2, 2, 3, 1, 2, 2, 3, 2, 3, 3, 4, 0, 1, 1, 2, 1, 2, 2, 3, 1, 2, 2, 3, 2, 3, 3, 4);
+	const __m256i low_nibble = _mm256_set1_epi8(0x0F);
+	__m256i total = _mm256_setzero_si256();
+	__m256i v;
+	__m256i counts;
+	uint64_t lanes[4];
+	size_t count = 0;
+	size_t i = 0;
+
+	for (; i + 4 <= n; i += 4) {
+		v = _mm256_loadu_si256((const __m256i*)(words + i));
+		counts = _mm256_add_epi8(_mm256_shuffle_epi8(table, _mm256_and_si256(v, low_nibble)), _mm256_shuffle_epi8(table, _mm256_and_si256(_mm256_srli_epi16(v, 4), low_nibble)));
+		total = _mm256_add_epi64(total, _mm256_sad_epu8(counts, _mm256_setzero_si256()));
+	}
+
+	_mm256_storeu_si256((__m256i*)lanes, total);
+	count = (size_t)(lanes[0] + lanes[1] + lanes[2] + lanes[3]);
+
+	for (; i < n; i++) {
+		count += (size_t)__builtin_popcountll(words[i]);
+	}
+
+	return count;
+}
+
+/**
+ * \fn bitvec_logic_avx2(uint64_t* dst, const uint64_t* a, const uint64_t* b, size_t n, bitvec_logic_t logic)
+ * \brief AVX2 loop for the vector-vector logic operations, 256 bits per iteration
+ *
+ * \return The number of words processed (a multiple of 4); the caller finishes the rest
+ */
+static __attribute__((target("avx2"))) size_t bitvec_logic_avx2(uint64_t* dst, const uint64_t* a, const uint64_t* b, size_t n, bitvec_logic_t logic) {
+	size_t i = 0;
+	__m256i x;
+	__m256i y;
+
+	for (; i + 4 <= n; i += 4) {
+		x = _mm256_loadu_si256((const __m256i*)(a + i));
+		y = _mm256_loadu_si256((const __m256i*)(b + i));
+		switch (logic) {
+			case BITVEC_AND:
+				x = _mm256_and_si256(x, y);
+				break;
+			case BITVEC_OR:
+				x = _mm256_or_si256(x, y);
+				break;
+			case BITVEC_XOR:
+				x = _mm256_xor_si256(x, y);
+				break;
+			default:
+				x = _mm256_andnot_si256(y, x);
+				break;
+		}
+		_mm256_storeu_si256((__m256i*)(dst + i), x);
+	}
+
+	return i;
+}
+#endif
+
+/**
+ * \fn bitvec_popcount(const bitvec_t* bv)
+ * \brief Counts the set bits of the vector
+ *
+ * \return The number of set bits
+ */
+size_t bitvec_popcount(const bitvec_t* bv) {
+	assert(bv != NULL);
+
+	size_t n = BITVEC_WORDS(bv->nbits);
+	size_t count = 0;
+	size_t i;
+
+#ifdef BITOPS_X86
+	if (bitvec_has_avx2()) {
+		return bitvec_popcount_avx2(bv->words, n);
+	}
+#endif
+	for (i = 0; i < n; i++) {
+		count += (size_t)__builtin_popcountll(bv->words[i]);
+	}
+
+	return count;
+}
+
+/**
+ * \fn bitvec_find_next_set(const bitvec_t* bv, size_t from_bit)
+ * \brief Finds the lowest set bit at or above from_bit, skipping clear words whole and using ctz inside the first non-zero one
+ *
+ * \return The bit number, or BITVEC_NONE if no bit at or above from_bit is set
+ */
+size_t bitvec_find_next_set(const bitvec_t* bv, size_t from_bit) {
+	assert(bv != NULL);
+
+	size_t n = BITVEC_WORDS(bv->nbits);
+	size_t i = from_bit / BITVEC_WORD_BITS;
+	uint64_t word;
+
+	if (from_bit >= bv->nbits) {
+		return BITVEC_NONE;
+	}
+
+	word = bv->words[i] & (~0ull << (from_bit % BITVEC_WORD_BITS));
+
+	while (word == 0) {
+		if (++i >= n) {
+			return BITVEC_NONE;
+		}
+		word = bv->words[i];
+	}
+
+	return (i * BITVEC_WORD_BITS) + (size_t)__builtin_ctzll(word);
+}
+
+/**
+ * \fn bitvec_find_first_set(const bitvec_t* bv)
+ * \brief Finds the lowest set bit of the vector
+ *
+ * \return The bit number, or BITVEC_NONE if no bit is set
+ */
+size_t bitvec_find_first_set(const bitvec_t* bv) {
+	return bitvec_find_next_set(bv, 0);
+}
+
+/**
+ * \fn bitvec_logic(bitvec_t* dst, const bitvec_t* a, const bitvec_t* b, bitvec_logic_t logic)
+ * \brief Shared body of the vector-vector operations. All three vectors must have the same length; dst may be a or b
+ *
+ * \return None
+ */
+static void bitvec_logic(bitvec_t* dst, const bitvec_t* a, const bitvec_t* b, bitvec_logic_t logic) {
+	assert((dst != NULL) && (a != NULL) && (b != NULL));
+	assert((dst->nbits == a->nbits) && (a->nbits == b->nbits));
+
+	size_t n = BITVEC_WORDS(dst->nbits);
+	size_t i = 0;
+
+#ifdef BITOPS_X86
+	if (bitvec_has_avx2()) {
+		i = bitvec_logic_avx2(dst->words, a->words, b->words, n, logic);
+	}
+#endif
+	for (; i < n; i++) {
+		switch (logic) {
+			case BITVEC_AND:
+				dst->words[i] = a->words[i] & b->words[i];
+				break;
+			case BITVEC_OR:
+				dst->words[i] = a->words[i] | b->words[i];
+				break;
+			case BITVEC_XOR:
+				dst->words[i] = a->words[i] ^ b->words[i];
+				break;
+			default:
+				dst->words[i] = a->words[i] & ~b->words[i];
+				break;
+		}
+	}
+}
+
+/**
+ * \fn bitvec_and(bitvec_t* dst, const bitvec_t* a, const bitvec_t* b)
+ * \fn bitvec_or(bitvec_t* dst, const bitvec_t* a, const bitvec_t* b)
+ * \fn bitvec_xor(bitvec_t* dst, const bitvec_t* a, const bitvec_t* b)
+ * \fn bitvec_andnot(bitvec_t* dst, const bitvec_t* a, const bitvec_t* b)
+ * \brief dst = a AND b, a OR b, a XOR b, or a AND NOT b. All three vectors must have the same length; dst may be a or b
+ *
+ * \return None
+ */
+void bitvec_and(bitvec_t* dst, const bitvec_t* a, const bitvec_t* b) {
+	bitvec_logic(dst, a, b, BITVEC_AND);
+}
+
+void bitvec_or(bitvec_t* dst, const bitvec_t* a, const bitvec_t* b) {
+	bitvec_logic(dst, a, b, BITVEC_OR);
+}
+
+void bitvec_xor(bitvec_t* dst, const bitvec_t* a, const bitvec_t* b) {
+	bitvec_logic(dst, a, b, BITVEC_XOR);
+}
+
+void bitvec_andnot(bitvec_t* dst, const bitvec_t* a, const bitvec_t* b) {
+	bitvec_logic(dst, a, b, BITVEC_ANDNOT);
+}
+
+/**
+ * \fn bitvec_to_binstr(char* str, size_t size, const bitvec_t* bv)
+ * \brief Stores the binary representation of the whole vector into a null-terminated string, highest bit first, in the same "0b..." form as uint_to_binstr
+ *
+ * \param str Pointer to a char array
+ * \param size Num of bytes of the char array pointed to by str
+ * \param bv Pointer to the vector to be converted
+ *
+ * \return If successful, returns the number of characters written to str, not including the terminal \0. In the case of an error (i.e. str is too small or the vector is empty), the function returns a negative value, and str is set to the empty string.
+ */
+int bitvec_to_binstr(char* str, size_t size, const bitvec_t* bv) {
+	assert(str != NULL);
+	assert(bv != NULL);
+
+	size_t bit = bv->nbits;
+	size_t current_byte = PREFIX_BYTES_BIN;
+	uint8_t byte;
+
+	if ((bv->nbits == 0) || (size < PREFIX_BYTES_BIN + bv->nbits + NULL_TERMINATOR_BYTE)) {
+		if (size > 0) {
+			str[0] = '\0';
+		}
+		return EXIT_FAILURE_N;
+	}
+
+	str[0] = '0';
+	str[1] = 'b';
+
+	///< Leading bits that do not fill a byte, then whole bytes from high to low
+	while (bit % BITS_PER_BYTE != 0) {
+		bit--;
+		str[current_byte++] = (char)('0' + bitvec_get(bv, bit));
+	}
+
+	while (bit > 0) {
+		bit -= BITS_PER_BYTE;
+		byte = (uint8_t)(bv->words[bit / BITVEC_WORD_BITS] >> (bit % BITVEC_WORD_BITS));
+		BITOPS_BIN_BYTE(str + current_byte, byte);
+		current_byte += BITS_PER_BYTE;
+	}
+
+	///< Terminate str with NULL
+	str[current_byte] = '\0';
+
+	return (int)current_byte;
+}
+
+/**
+ * \fn bitvec_hexdump(char* str, size_t size, const bitvec_t* bv)
+ * \brief Dumps the vector's storage with hexdump. Byte k of the dump holds bits 8k to 8k + 7 on little-endian hosts
+ *
+ * \return The char* str, set to empty if it is too small for the dump
+ */
+char* bitvec_hexdump(char* str, size_t size, const bitvec_t* bv) {
+	assert(bv != NULL);
+
+	return hexdump(str, size, bv->words, (bv->nbits + BITS_PER_BYTE - 1) / BITS_PER_BYTE);
+}
+
+int test_bitvec(void) {
+	bitvec_t a;
+	bitvec_t b;
+	bitvec_t c;
+	uint32_t state = TEST_15_SEED;
+	uint32_t round;
+	size_t start;
+	size_t count;
+	size_t i;
+	size_t expected;
+	operation_t operation;
+	bitvec_logic_t logic;
+	int return_code = EXIT_TEST_SUCCESS;
+
+	if ((bitvec_init(&a, TEST_15_BITS) != 0) || (bitvec_init(&b, TEST_15_BITS) != 0) || (bitvec_init(&c, TEST_15_BITS) != 0)) {
+		return EXIT_TEST_FAILURE;
+	}
+	memset(TEST_15_MODEL_A, 0, sizeof(TEST_15_MODEL_A));
+	memset(TEST_15_MODEL_B, 0, sizeof(TEST_15_MODEL_B));
+
+	for (round = 0; round < TEST_15_ROUNDS; round++) {
+		///< Random range operation on a or b, mirrored in a one-byte-per-bit model
+		start = test_rand32(&state) % (TEST_15_BITS + 1);
+		count = (round % 5 == 0) ? (test_rand32(&state) % (TEST_15_BITS - start + 1)) : (test_rand32(&state) % 130 % (TEST_15_BITS - start + 1));
+		operation = (operation_t)(test_rand32(&state) % 3);
+		bitvec_twiggle_range((round & 1) ? &b : &a, start, count, operation);
+		for (i = start; i < start + count; i++) {
+			uint8_t* model = (round & 1) ? TEST_15_MODEL_B : TEST_15_MODEL_A;
+			model[i] = (operation == CLEAR) ? 0 : ((operation == SET) ? 1 : (model[i] ^ 1));
+		}
+
+		expected = 0;
+		for (i = 0; i < TEST_15_BITS; i++) {
+			expected += TEST_15_MODEL_A[i];
+			if (bitvec_get(&a, i) != TEST_15_MODEL_A[i]) {
+				printf("test_bitvec: (FAILURE): round = %u, bit = %u, EXPECT = %u\n", round, (uint32_t)i, TEST_15_MODEL_A[i]);
+				return_code = EXIT_TEST_FAILURE;
+				break;
+			}
+		}
+		if (bitvec_popcount(&a) != expected) {
+			printf("test_bitvec: (FAILURE): round = %u, popcount EXPECT = %u, RESULT = %u\n", round, (uint32_t)expected, (uint32_t)bitvec_popcount(&a));
+			return_code = EXIT_TEST_FAILURE;
+		}
+
+		start = test_rand32(&state) % TEST_15_BITS;
+		for (expected = start; (expected < TEST_15_BITS) && !TEST_15_MODEL_A[expected]; expected++) {
+		}
+		if (bitvec_find_next_set(&a, start) != ((expected < TEST_15_BITS) ? expected : BITVEC_NONE)) {
+			printf("test_bitvec: (FAILURE): round = %u, find_next_set(%u)\n", round, (uint32_t)start);
+			return_code = EXIT_TEST_FAILURE;
+		}
+
+		logic = (bitvec_logic_t)(round % 4);
+		bitvec_logic(&c, &a, &b, logic);
+		for (i = 0; i < TEST_15_BITS; i++) {
+			expected = (logic == BITVEC_AND) ? (TEST_15_MODEL_A[i] & TEST_15_MODEL_B[i]) : ((logic == BITVEC_OR) ? (TEST_15_MODEL_A[i] | TEST_15_MODEL_B[i]) :
+				((logic == BITVEC_XOR) ? (TEST_15_MODEL_A[i] ^ TEST_15_MODEL_B[i]) : (TEST_15_MODEL_A[i] & !TEST_15_MODEL_B[i])));
+			if ((size_t)bitvec_get(&c, i) != expected) {
+				printf("test_bitvec: (FAILURE): round = %u, logic = %d, bit = %u\n", round, (int)logic, (uint32_t)i);
+				return_code = EXIT_TEST_FAILURE;
+				break;
+			}
+		}
+	}
+
+	if ((bitvec_to_binstr(TEST_15_STR, sizeof(TEST_15_STR), &a) != (int)(PREFIX_BYTES_BIN + TEST_15_BITS)) || (strncmp(TEST_15_STR, "0b", PREFIX_BYTES_BIN) != 0)) {
+		return_code = EXIT_TEST_FAILURE;
+	}
+	for (i = 0; i < TEST_15_BITS; i++) {
+		if (TEST_15_STR[PREFIX_BYTES_BIN + i] != (char)('0' + TEST_15_MODEL_A[TEST_15_BITS - 1 - i])) {
+			printf("test_bitvec: (FAILURE): bitvec_to_binstr digit %u\n", (uint32_t)i);
+			return_code = EXIT_TEST_FAILURE;
+			break;
+		}
+	}
+
+	printf("test_bitvec: %u random range operations on %u-bit vectors, avx2 %s\n", TEST_15_ROUNDS, TEST_15_BITS, bitvec_has_avx2() ? "checked" : "skipped");
+
+	bitvec_free(&a);
+	bitvec_free(&b);
+	bitvec_free(&c);
+
+	return return_code;
+}
@@ -0,0 +1,988 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <strings.h>
+#include "bitops.h"
+#include "bitgeneric.h"
+#include "bitvec.h"
+
+/*
+ * Randomized differential tests ("make check"). Every public function is run on random
+ * inputs and compared against a deliberately naive reference model written here, one bit or
+ * one character at a time. Functions with SIMD kernels are checked again under every ISA
+ * tier the CPU supports. The default round count finishes in a few seconds; --rounds and
+ * --seed reproduce or widen a run.
+ */
+
+#define NULL_TERMINATOR_BYTE (1)
+#define PREFIX_BYTES_BIN (2)
+#define PREFIX_BYTES_HEX (2)
+#define BITS_PER_NIBBLE (4)
+#define UINT32_T_BITS (32)
+#define UINT64_T_BITS (64)
+#define EXIT_FAILURE_N (-1)
+#define STR_BYTES (PREFIX_BYTES_BIN + UINT64_T_BITS + NULL_TERMINATOR_BYTE)
+
+#define CHECK_DEFAULT_ROUNDS (1u << 18)
+#define CHECK_DEFAULT_SEED (0x9E3779B97F4A7C15ull)
+#define CHECK_MAX_REPORTS (10)
+#define CHECK_BATCH_VALUES (67)
+#define CHECK_MAX_FIELDS (6)
+#define CHECK_DUMP_MAX_BYTES (300)
+#define CHECK_DUMP_CHARS ((CHECK_DUMP_MAX_BYTES / HEXDUMP_BYTES_PER_ROW + 1) * HEXDUMP_ROW_CHARS + NULL_TERMINATOR_BYTE)
+#define CHECK_PARSE_MAX_CHARS (40)
+#define CHECK_PARALLEL_BYTES (HEXDUMP_BYTES_PER_ROW * 4096 * 3 + 5)
+#define CHECK_BITVEC_MAX_BITS (1100)
+
+///< Counts a mismatch and prints the first CHECK_MAX_REPORTS of them
+#define CHECK_EXPECT(cond, ...) do { \
+	if (!(cond)) { \
+		if (check_failures++ < CHECK_MAX_REPORTS) { \
+			printf("check: (FAILURE) [%s] ", bitops_isa_name(bitops_isa())); \
+			printf(__VA_ARGS__); \
+			printf("\n"); \
+		} \
+	} \
+} while (0)
+
+static unsigned long check_failures;
+static uint64_t check_state;
+
+static const char check_parse_alphabet[] = "0123456789abcdefABCDEFgxXb \n";
+
+/**
+ * \fn check_rand64(void)
+ * \brief xorshift64* generator, so any failing run can be repeated with --seed
+ *
+ * \return The next 64-bit pseudo-random value
+ */
+static uint64_t check_rand64(void) {
+	check_state ^= check_state >> 12;
+	check_state ^= check_state << 25;
+	check_state ^= check_state >> 27;
+
+	return check_state * 0x2545F4914F6CDD1Dull;
+}
+
+/**
+ * \fn check_rand_below(uint32_t n)
+ * \brief Picks a value in [0, n)
+ *
+ * \return The value
+ */
+static uint32_t check_rand_below(uint32_t n) {
+	return (uint32_t)((check_rand64() >> 32) % n);
+}
+
+/**
+ * \fn check_value32(void)
+ * \brief Picks a 32-bit input, biased toward the edges: 0, all ones, single bits, and values narrowed to a random width
+ *
+ * \return The value
+ */
+static uint32_t check_value32(void) {
+	uint32_t x = (uint32_t)check_rand64();
+
+	switch (check_rand_below(8)) {
+		case 0:
+			return 0;
+		case 1:
+			return 0xFFFFFFFF;
+		case 2:
+			return (uint32_t)1 << (x % UINT32_T_BITS);
+		case 3:
+			return ((uint32_t)1 << (x % UINT32_T_BITS)) - 1;
+		case 4:
+		case 5:
+			return x >> check_rand_below(UINT32_T_BITS);
+		default:
+			return x;
+	}
+}
+
+/**
+ * \fn check_value64(void)
+ * \brief 64-bit version of check_value32
+ *
+ * \return The value
+ */
+static uint64_t check_value64(void) {
+	uint64_t x = check_rand64();
+
+	switch (check_rand_below(6)) {
+		case 0:
+			return 0;
+		case 1:
+			return ~(uint64_t)0;
+		case 2:
+		case 3:
+			return x >> check_rand_below(UINT64_T_BITS);
+		default:
+			return x;
+	}
+}
+
+/**
+ * \fn ref_binstr(char* str, uint64_t num, int nbits)
+ * \brief Reference binary formatter: "0b" and then nbits digits, one bit at a time
+ *
+ * \return The number of characters written, or -1 with str empty if num does not fit in nbits
+ */
+static int ref_binstr(char* str, uint64_t num, int nbits) {
+	int i;
+	int n = 0;
+
+	if ((nbits < UINT64_T_BITS) && ((num >> nbits) != 0)) {
+		str[0] = '\0';
+		return -1;
+	}
+
+	str[n++] = '0';
+	str[n++] = 'b';
+	for (i = nbits - 1; i >= 0; i--) {
+		str[n++] = ((num >> i) & 1) ? '1' : '0';
+	}
+	str[n] = '\0';
+
+	return n;
+}
+
+/**
+ * \fn ref_low_bits(uint64_t num, int nbits)
+ * \brief Keeps the nbits least significant bits of num
+ *
+ * \return The truncated value
+ */
+static uint64_t ref_low_bits(uint64_t num, int nbits) {
+	return (nbits >= UINT64_T_BITS) ? num : (num & (((uint64_t)1 << nbits) - 1));
+}
+
+/**
+ * \fn ref_hexstr(char* str, uint64_t num, int nbits, uint32_t flags)
+ * \brief Reference hex formatter: optional "0x" and then nbits / 4 digits, one nibble at a time
+ *
+ * \return The number of characters written
+ */
+static int ref_hexstr(char* str, uint64_t num, int nbits, uint32_t flags) {
+	const char* digits = (flags & HEXSTR_LOWER) ? "0123456789abcdef" : "0123456789ABCDEF";
+	int i;
+	int n = 0;
+
+	if (!(flags & HEXSTR_NO_PREFIX)) {
+		str[n++] = '0';
+		str[n++] = 'x';
+	}
+	for (i = nbits - BITS_PER_NIBBLE; i >= 0; i -= BITS_PER_NIBBLE) {
+		str[n++] = digits[(num >> i) & 0xF];
+	}
+	str[n] = '\0';
+
+	return n;
+}
+
+/**
+ * \fn ref_reorder(uint32_t num, int nbits, uint32_t reversed, uint32_t big_endian)
+ * \brief Reference for the REVERSED and BIG_ENDIAN formatter flags on the low nbits bits of num: bytes swapped first, then bits reversed, one bit at a time
+ *
+ * \return The reordered value
+ */
+static uint32_t ref_reorder(uint32_t num, int nbits, uint32_t reversed, uint32_t big_endian) {
+	uint32_t result = 0;
+	int i;
+
+	num = (uint32_t)ref_low_bits(num, nbits);
+	if (big_endian) {
+		for (i = 0; i < nbits; i++) {
+			result |= ((num >> i) & 1u) << ((nbits - 8 - (i / 8) * 8) + (i % 8));
+		}
+		num = result;
+		result = 0;
+	}
+	if (reversed) {
+		for (i = 0; i < nbits; i++) {
+			result |= ((num >> i) & 1u) << (nbits - 1 - i);
+		}
+		num = result;
+	}
+
+	return num;
+}
+
+/**
+ * \fn ref_permute(uint32_t input, const int8_t* table)
+ * \brief Reference bit permutation: output bit i is input bit table[i], or clear for BITPERM_ZERO
+ *
+ * \return The permuted value
+ */
+static uint32_t ref_permute(uint32_t input, const int8_t* table) {
+	uint32_t result = 0;
+	int i;
+
+	for (i = 0; i < BITPERM_BITS; i++) {
+		if (table[i] != BITPERM_ZERO) {
+			result |= ((input >> table[i]) & 1u) << i;
+		}
+	}
+
+	return result;
+}
+
+/**
+ * \fn ref_twiggle(uint64_t input, int bit, operation_t operation)
+ * \brief Reference single-bit update, written out per operation
+ *
+ * \return The updated value
+ */
+static uint64_t ref_twiggle(uint64_t input, int bit, operation_t operation) {
+	uint64_t old = (input >> bit) & 1;
+	uint64_t want = (operation == SET) ? 1 : ((operation == CLEAR) ? 0 : !old);
+
+	return (want == old) ? input : (input ^ ((uint64_t)1 << bit));
+}
+
+/**
+ * \fn ref_extract(uint32_t input, int start_bit, int width)
+ * \brief Reference field read, one bit at a time
+ *
+ * \return The field, shifted down to bit 0
+ */
+static uint32_t ref_extract(uint32_t input, int start_bit, int width) {
+	uint32_t field = 0;
+	int i;
+
+	for (i = width - 1; i >= 0; i--) {
+		field = (field << 1) | ((input >> (start_bit + i)) & 1u);
+	}
+
+	return field;
+}
+
+/**
+ * \fn ref_deposit(uint32_t input, uint32_t value, int start_bit, int width)
+ * \brief Reference field write, one bit at a time
+ *
+ * \return input with the field replaced by the low width bits of value
+ */
+static uint32_t ref_deposit(uint32_t input, uint32_t value, int start_bit, int width) {
+	int i;
+
+	for (i = 0; i < width; i++) {
+		input &= ~((uint32_t)1 << (start_bit + i));
+		input |= ((value >> i) & 1u) << (start_bit + i);
+	}
+
+	return input;
+}
+
+/**
+ * \fn ref_hexdump(char* str, const uint8_t* data, size_t nbytes)
+ * \brief Reference dump built with snprintf: "OOOOOOOO  XX XX ... XX\n" per row of up to 16 bytes
+ *
+ * \return The number of characters written
+ */
+static size_t ref_hexdump(char* str, const uint8_t* data, size_t nbytes) {
+	size_t n = 0;
+	size_t i;
+
+	for (i = 0; i < nbytes; i++) {
+		if (i % HEXDUMP_BYTES_PER_ROW == 0) {
+			n += (size_t)sprintf(str + n, "%08X  ", (unsigned)i);
+		}
+		n += (size_t)sprintf(str + n, "%02X%c", data[i], ((i % HEXDUMP_BYTES_PER_ROW == HEXDUMP_BYTES_PER_ROW - 1) || (i + 1 == nbytes)) ? '\n' : ' ');
+	}
+	str[n] = '\0';
+
+	return n;
+}
+
+/**
+ * \fn ref_parse(const char* str, size_t len, int hex, uint32_t* num, size_t* error_pos)
+ * \brief Reference for binstr_to_uint / hexstr_to_uint: the prefix, then 1 to 32 binary or 1 to 8 hex digits of either case, and nothing else
+ *
+ * \return The digit count (binary) or 4 times the digit count (hex) on success, -1 on failure with error_pos set
+ */
+static int ref_parse(const char* str, size_t len, int hex, uint32_t* num, size_t* error_pos) {
+	size_t max_digits = hex ? (UINT32_T_BITS / BITS_PER_NIBBLE) : UINT32_T_BITS;
+	size_t i;
+	uint32_t value = 0;
+	int digit;
+	char c;
+
+	if ((len < 1) || (str[0] != '0')) {
+		*error_pos = 0;
+		return -1;
+	}
+	if ((len < 2) || (str[1] != (hex ? 'x' : 'b'))) {
+		*error_pos = 1;
+		return -1;
+	}
+	if (len == 2) {
+		*error_pos = 2;
+		return -1;
+	}
+
+	for (i = 2; i < len; i++) {
+		if (i - 2 == max_digits) {
+			*error_pos = i;
+			return -1;
+		}
+
+		c = str[i];
+		if ((c >= '0') && (c <= (hex ? '9' : '1'))) {
+			digit = c - '0';
+		}
+		else if (hex && (c >= 'a') && (c <= 'f')) {
+			digit = c - 'a' + 10;
+		}
+		else if (hex && (c >= 'A') && (c <= 'F')) {
+			digit = c - 'A' + 10;
+		}
+		else {
+			*error_pos = i;
+			return -1;
+		}
+
+		value = hex ? ((value << BITS_PER_NIBBLE) | (uint32_t)digit) : ((value << 1) | (uint32_t)digit);
+	}
+
+	*num = value;
+
+	return (int)((len - 2) * (hex ? BITS_PER_NIBBLE : 1));
+}
+
+/**
+ * \fn check_formatters(uint32_t rounds)
+ * \brief uint_to_binstr, int_to_binstr, uint_to_hexstr and uint_to_hexstr_fmt over every nbits and flag combination
+ *
+ * \return None
+ */
+static void check_formatters(uint32_t rounds) {
+	char expected[STR_BYTES];
+	char result[STR_BYTES];
+	uint32_t round;
+	uint32_t num;
+	uint32_t flags;
+	int nbits;
+	int expected_chars;
+	int num_chars;
+
+	for (round = 0; round < rounds; round++) {
+		num = check_value32();
+		nbits = 1 + (int)(round % UINT32_T_BITS);
+
+		expected_chars = ref_binstr(expected, num, nbits);
+		num_chars = uint_to_binstr(result, sizeof(result), num, (uint8_t)nbits);
+		CHECK_EXPECT((num_chars == expected_chars) && (strcmp(result, expected) == 0), "uint_to_binstr(%u, %d): EXPECT = %d \"%s\", RESULT = %d \"%s\"", num, nbits, expected_chars, expected, num_chars, result);
+
+		expected_chars = ref_binstr(expected, ref_low_bits(num, nbits), nbits);
+		num_chars = int_to_binstr(result, sizeof(result), (int32_t)num, (uint8_t)nbits);
+		CHECK_EXPECT((num_chars == expected_chars) && (strcmp(result, expected) == 0), "int_to_binstr(%d, %d): EXPECT = \"%s\", RESULT = \"%s\"", (int32_t)num, nbits, expected, result);
+
+		flags = (round >> 5) % 4;
+		flags = ((flags & 1) ? BINSTR_REVERSED : 0) | ((flags & 2) ? BINSTR_BIG_ENDIAN : 0);
+		if ((flags & BINSTR_BIG_ENDIAN) && ((nbits % 8) != 0)) {
+			expected[0] = '\0';
+			expected_chars = EXIT_FAILURE_N;
+		}
+		else {
+			expected_chars = ref_binstr(expected, ref_reorder(num, nbits, flags & BINSTR_REVERSED, flags & BINSTR_BIG_ENDIAN), nbits);
+		}
+		num_chars = uint_to_binstr_fmt(result, sizeof(result), (uint32_t)ref_low_bits(num, nbits), (uint8_t)nbits, flags);
+		CHECK_EXPECT((num_chars == expected_chars) && (strcmp(result, expected) == 0), "uint_to_binstr_fmt(%u, %d, 0x%X): EXPECT = \"%s\", RESULT = \"%s\"", num, nbits, flags, expected, result);
+
+		nbits = BITS_PER_NIBBLE << (round % 4);
+		flags = (round >> 2) % 16;
+
+		expected_chars = ref_hexstr(expected, ref_low_bits(num, nbits), nbits, HEXSTR_UPPER);
+		num_chars = uint_to_hexstr(result, sizeof(result), num, (uint8_t)nbits);
+		CHECK_EXPECT((num_chars == expected_chars) && (strcmp(result, expected) == 0), "uint_to_hexstr(%u, %d): EXPECT = \"%s\", RESULT = \"%s\"", num, nbits, expected, result);
+
+		if ((flags & HEXSTR_BIG_ENDIAN) && (nbits < 8)) {
+			expected[0] = '\0';
+			expected_chars = EXIT_FAILURE_N;
+		}
+		else {
+			expected_chars = ref_hexstr(expected, ref_reorder(num, nbits, flags & HEXSTR_REVERSED, flags & HEXSTR_BIG_ENDIAN), nbits, flags);
+		}
+		num_chars = uint_to_hexstr_fmt(result, sizeof(result), num, (uint8_t)nbits, flags);
+		CHECK_EXPECT((num_chars == expected_chars) && (strcmp(result, expected) == 0), "uint_to_hexstr_fmt(%u, %d, 0x%X): EXPECT = \"%s\", RESULT = \"%s\"", num, nbits, flags, expected, result);
+	}
+}
+
+/**
+ * \fn check_bit_functions(uint32_t rounds)
+ * \brief twiggle_bit for every bit and operation, grab_three_bits for every start bit, and extract_bits / deposit_bits for every field
+ *
+ * \return None
+ */
+static void check_bit_functions(uint32_t rounds) {
+	uint32_t round;
+	uint32_t input;
+	uint32_t value;
+	uint32_t output;
+	int op;
+	int bit;
+	int width;
+
+	for (round = 0; round < rounds; round++) {
+		input = check_value32();
+		value = check_value32();
+		bit = (int)(round % UINT32_T_BITS);
+
+		for (op = CLEAR; op <= TOGGLE; op++) {
+			output = twiggle_bit(input, bit, (operation_t)op);
+			CHECK_EXPECT(output == (uint32_t)ref_twiggle(input, bit, (operation_t)op), "twiggle_bit(0x%08X, %d, %d) = 0x%08X", input, bit, op, output);
+		}
+
+		if (bit <= UINT32_T_BITS - 3) {
+			output = grab_three_bits(input, bit);
+			CHECK_EXPECT(output == ref_extract(input, bit, 3), "grab_three_bits(0x%08X, %d) = 0x%X", input, bit, output);
+		}
+
+		width = 1 + (int)check_rand_below((uint32_t)(UINT32_T_BITS - bit));
+		output = extract_bits(input, bit, width);
+		CHECK_EXPECT(output == ref_extract(input, bit, width), "extract_bits(0x%08X, %d, %d) = 0x%X", input, bit, width, output);
+		output = deposit_bits(input, value, bit, width);
+		CHECK_EXPECT(output == ref_deposit(input, value, bit, width), "deposit_bits(0x%08X, 0x%08X, %d, %d) = 0x%08X", input, value, bit, width, output);
+	}
+}
+
+/**
+ * \fn check_fields(uint32_t rounds)
+ * \brief extract_fields / deposit_fields on random field lists, against one extract_bits / deposit_bits reference per field
+ *
+ * \return None
+ */
+static void check_fields(uint32_t rounds) {
+	bitfield_t fields[CHECK_MAX_FIELDS];
+	uint32_t values[CHECK_MAX_FIELDS];
+	uint32_t out[CHECK_MAX_FIELDS];
+	uint32_t round;
+	uint32_t input;
+	uint32_t expected;
+	uint32_t output;
+	size_t nfields;
+	size_t i;
+
+	for (round = 0; round < rounds; round++) {
+		input = check_value32();
+		nfields = check_rand_below(CHECK_MAX_FIELDS + 1);
+		expected = input;
+
+		for (i = 0; i < nfields; i++) {
+			fields[i].start_bit = (uint8_t)check_rand_below(UINT32_T_BITS);
+			fields[i].width = (uint8_t)(1 + check_rand_below(UINT32_T_BITS - fields[i].start_bit));
+			values[i] = check_value32();
+			///< Fields may overlap; the later field wins, as documented for deposit_fields
+			expected = ref_deposit(expected, values[i], fields[i].start_bit, fields[i].width);
+		}
+
+		extract_fields(input, fields, nfields, out);
+		for (i = 0; i < nfields; i++) {
+			CHECK_EXPECT(out[i] == ref_extract(input, fields[i].start_bit, fields[i].width), "extract_fields field %zu (%u, %u) of 0x%08X = 0x%X", i, fields[i].start_bit, fields[i].width, input, out[i]);
+		}
+
+		output = deposit_fields(input, fields, nfields, values);
+		CHECK_EXPECT(output == expected, "deposit_fields(0x%08X, %zu fields) = 0x%08X, EXPECT = 0x%08X", input, nfields, output, expected);
+	}
+}
+
+/**
+ * \fn check_batches(uint32_t rounds)
+ * \brief The _many batch formatters, twiggle kernels and bit reordering kernels against the reference models, slot by slot
+ *
+ * \return None
+ */
+static void check_batches(uint32_t rounds) {
+	static uint32_t in[CHECK_BATCH_VALUES];
+	static int8_t in8[CHECK_BATCH_VALUES];
+	static int16_t in16[CHECK_BATCH_VALUES];
+	static int32_t in32[CHECK_BATCH_VALUES];
+	static int bits[CHECK_BATCH_VALUES];
+	static uint32_t words[CHECK_BATCH_VALUES];
+	static char out[CHECK_BATCH_VALUES * STR_BYTES];
+	char expected[STR_BYTES];
+	int8_t table[BITPERM_BITS];
+	bitperm_t perm;
+	uint32_t round;
+	uint32_t flags;
+	size_t n;
+	size_t i;
+	size_t stride;
+	int nbits;
+	int width;
+	int expected_failures;
+	int failures;
+	int op;
+	int32_t value;
+
+	for (round = 0; round < rounds; round++) {
+		n = check_rand_below(CHECK_BATCH_VALUES + 1);
+		for (i = 0; i < n; i++) {
+			in[i] = check_value32();
+			bits[i] = (int)check_rand_below(UINT32_T_BITS);
+		}
+
+		nbits = 1 + (int)(round % UINT32_T_BITS);
+		stride = BINSTR_SLOT_BYTES(nbits);
+		expected_failures = 0;
+		failures = uint_to_binstr_many(in, n, out, n * stride, (uint8_t)nbits);
+		for (i = 0; i < n; i++) {
+			expected_failures += (ref_binstr(expected, in[i], nbits) < 0);
+			CHECK_EXPECT(strcmp(out + (i * stride), expected) == 0, "uint_to_binstr_many slot %zu (%u, %d): EXPECT = \"%s\", RESULT = \"%s\"", i, in[i], nbits, expected, out + (i * stride));
+		}
+		CHECK_EXPECT(failures == expected_failures, "uint_to_binstr_many(n = %zu, nbits = %d) = %d, EXPECT = %d", n, nbits, failures, expected_failures);
+
+		///< Signed batches: width is the input type, flags toggles the range check
+		width = 8 << (round % 3);
+		flags = (round >> 2) & BINSTR_RANGE_CHECK;
+		for (i = 0; i < n; i++) {
+			in8[i] = (int8_t)in[i];
+			in16[i] = (int16_t)in[i];
+			in32[i] = (int32_t)in[i];
+		}
+		failures = (width == 8) ? int8_to_binstr_many(in8, n, out, n * stride, (uint8_t)nbits, flags)
+			: ((width == 16) ? int16_to_binstr_many(in16, n, out, n * stride, (uint8_t)nbits, flags) : int32_to_binstr_many(in32, n, out, n * stride, (uint8_t)nbits, flags));
+		expected_failures = 0;
+		for (i = 0; i < n; i++) {
+			value = (width == 8) ? in8[i] : ((width == 16) ? in16[i] : in32[i]);
+			if ((flags & BINSTR_RANGE_CHECK) && (nbits < UINT32_T_BITS) && ((value < -((int64_t)1 << (nbits - 1))) || (value >= ((int64_t)1 << (nbits - 1))))) {
+				expected[0] = '\0';
+				expected_failures++;
+			}
+			else {
+				ref_binstr(expected, ref_low_bits((uint32_t)value, nbits), nbits);
+			}
+			CHECK_EXPECT(strcmp(out + (i * stride), expected) == 0, "int%d_to_binstr_many slot %zu (%d, %d, 0x%X): EXPECT = \"%s\", RESULT = \"%s\"", width, i, value, nbits, flags, expected, out + (i * stride));
+		}
+		CHECK_EXPECT(failures == expected_failures, "int%d_to_binstr_many(n = %zu, nbits = %d) = %d, EXPECT = %d", width, n, nbits, failures, expected_failures);
+
+		nbits = BITS_PER_NIBBLE << (round % 4);
+		flags = (round >> 2) % 16;
+		if (nbits < 8) {
+			flags &= ~HEXSTR_BIG_ENDIAN;
+		}
+		stride = HEXSTR_SLOT_BYTES(nbits, flags);
+		failures = uint_to_hexstr_many(in, n, out, n * stride, (uint8_t)nbits, flags);
+		CHECK_EXPECT(failures == 0, "uint_to_hexstr_many(n = %zu) = %d", n, failures);
+		for (i = 0; i < n; i++) {
+			ref_hexstr(expected, ref_reorder(in[i], nbits, flags & HEXSTR_REVERSED, flags & HEXSTR_BIG_ENDIAN), nbits, flags);
+			CHECK_EXPECT(strcmp(out + (i * stride), expected) == 0, "uint_to_hexstr_many slot %zu (%u, %d, 0x%X): EXPECT = \"%s\", RESULT = \"%s\"", i, in[i], nbits, flags, expected, out + (i * stride));
+		}
+
+		op = (int)(round % 3);
+		memcpy(words, in, n * sizeof(uint32_t));
+		twiggle_bit_many(words, n, bits[0], (operation_t)op);
+		for (i = 0; i < n; i++) {
+			CHECK_EXPECT(words[i] == (uint32_t)ref_twiggle(in[i], bits[0], (operation_t)op), "twiggle_bit_many word %zu (0x%08X, %d, %d) = 0x%08X", i, in[i], bits[0], op, words[i]);
+		}
+
+		memcpy(words, in, n * sizeof(uint32_t));
+		twiggle_bits_many(words, n, bits, (operation_t)op);
+		for (i = 0; i < n; i++) {
+			CHECK_EXPECT(words[i] == (uint32_t)ref_twiggle(in[i], bits[i], (operation_t)op), "twiggle_bits_many word %zu (0x%08X, %d, %d) = 0x%08X", i, in[i], bits[i], op, words[i]);
+		}
+
+		///< Bit reversal, byte swap and a random permutation; bits[] doubles as the table, with the odd entry cleared
+		memcpy(words, in, n * sizeof(uint32_t));
+		reverse_bits_many(words, n);
+		for (i = 0; i < n; i++) {
+			CHECK_EXPECT(words[i] == ref_reorder(in[i], UINT32_T_BITS, 1, 0), "reverse_bits_many word %zu (0x%08X) = 0x%08X", i, in[i], words[i]);
+		}
+
+		memcpy(words, in, n * sizeof(uint32_t));
+		swap_bytes_many(words, n);
+		for (i = 0; i < n; i++) {
+			CHECK_EXPECT(words[i] == ref_reorder(in[i], UINT32_T_BITS, 0, 1), "swap_bytes_many word %zu (0x%08X) = 0x%08X", i, in[i], words[i]);
+		}
+
+		for (i = 0; i < BITPERM_BITS; i++) {
+			table[i] = ((i < n) && (bits[i] % 7 != 0)) ? (int8_t)bits[i] : (int8_t)((i < n) ? BITPERM_ZERO : i);
+		}
+		bitperm_compile(&perm, table);
+		memcpy(words, in, n * sizeof(uint32_t));
+		permute_bits_many(words, n, &perm);
+		for (i = 0; i < n; i++) {
+			CHECK_EXPECT((words[i] == ref_permute(in[i], table)) && (permute_bits(in[i], &perm) == words[i]), "permute_bits_many word %zu (0x%08X) = 0x%08X, EXPECT = 0x%08X", i, in[i], words[i], ref_permute(in[i], table));
+		}
+	}
+}
+
+/**
+ * \fn check_parsers(uint32_t rounds)
+ * \brief binstr_to_uint / hexstr_to_uint on formatter output (round trip), on mutated output, and on random strings, against ref_parse
+ *
+ * \return None
+ */
+static void check_parsers(uint32_t rounds) {
+	char str[CHECK_PARSE_MAX_CHARS];
+	uint32_t round;
+	uint32_t num;
+	uint32_t expected_num;
+	size_t len;
+	size_t i;
+	size_t error_pos;
+	size_t expected_pos;
+	int hex;
+	int nbits;
+	int expected_ret;
+	int ret;
+
+	for (round = 0; round < rounds; round++) {
+		hex = (int)(round & 1);
+		num = check_value32();
+
+		switch ((round >> 1) % 3) {
+			case 0:
+				///< Well-formed: what the formatters write, in either case
+				nbits = hex ? (BITS_PER_NIBBLE * (1 + (int)check_rand_below(8))) : (1 + (int)check_rand_below(UINT32_T_BITS));
+				len = hex ? (size_t)ref_hexstr(str, ref_low_bits(num, nbits), nbits, round & 4 ? HEXSTR_LOWER : HEXSTR_UPPER) : (size_t)ref_binstr(str, ref_low_bits(num, nbits), nbits);
+				break;
+			case 1:
+				///< One character of a well-formed string replaced, or the string cut short or run long
+				nbits = hex ? UINT32_T_BITS : (1 + (int)check_rand_below(UINT32_T_BITS));
+				len = hex ? (size_t)ref_hexstr(str, num, nbits, HEXSTR_UPPER) : (size_t)ref_binstr(str, ref_low_bits(num, nbits), nbits);
+				str[check_rand_below((uint32_t)len)] = check_parse_alphabet[check_rand_below(sizeof(check_parse_alphabet) - 1)];
+				len = (size_t)((int)len + (int)check_rand_below(3) - 1);
+				break;
+			default:
+				len = check_rand_below(CHECK_PARSE_MAX_CHARS);
+				for (i = 0; i < len; i++) {
+					str[i] = check_parse_alphabet[check_rand_below(sizeof(check_parse_alphabet) - 1)];
+				}
+				if ((len > 1) && (round & 2)) {
+					str[0] = '0';
+					str[1] = hex ? 'x' : 'b';
+				}
+				break;
+		}
+
+		expected_num = 0;
+		num = 0;
+		expected_pos = 0;
+		error_pos = 0;
+		expected_ret = ref_parse(str, len, hex, &expected_num, &expected_pos);
+		ret = hex ? hexstr_to_uint(str, len, &num, &error_pos) : binstr_to_uint(str, len, &num, &error_pos);
+
+		if (expected_ret < 0) {
+			CHECK_EXPECT((ret < 0) && (error_pos == expected_pos), "%s(\"%.*s\") = %d at %zu, EXPECT failure at %zu", hex ? "hexstr_to_uint" : "binstr_to_uint", (int)len, str, ret, error_pos, expected_pos);
+		}
+		else {
+			CHECK_EXPECT((ret == expected_ret) && (num == expected_num), "%s(\"%.*s\") = %d (0x%X), EXPECT = %d (0x%X)", hex ? "hexstr_to_uint" : "binstr_to_uint", (int)len, str, ret, num, expected_ret, expected_num);
+		}
+	}
+}
+
+/**
+ * \fn check_hexdump(uint32_t rounds)
+ * \brief hexdump and the streaming API (random chunking) against ref_hexdump, then hexdump_parse on the output and on mutated output
+ *
+ * \return None
+ */
+static void check_hexdump(uint32_t rounds) {
+	static uint8_t data[CHECK_DUMP_MAX_BYTES];
+	static uint8_t parsed[CHECK_DUMP_MAX_BYTES];
+	static char expected[CHECK_DUMP_CHARS];
+	static char result[CHECK_DUMP_CHARS];
+	static char redump[CHECK_DUMP_CHARS];
+	hexdump_stream_t stream;
+	uint32_t round;
+	size_t nbytes;
+	size_t chars;
+	size_t fed;
+	size_t chunk;
+	size_t consumed;
+	size_t written;
+	size_t parsed_bytes;
+	size_t error_pos;
+	size_t pos;
+	size_t i;
+	int ret;
+
+	for (round = 0; round < rounds; round++) {
+		nbytes = check_rand_below(CHECK_DUMP_MAX_BYTES + 1);
+		for (i = 0; i < nbytes; i++) {
+			data[i] = (uint8_t)check_rand64();
+		}
+
+		chars = ref_hexdump(expected, data, nbytes);
+		CHECK_EXPECT(hexdump_len(nbytes) == chars, "hexdump_len(%zu) = %zu, EXPECT = %zu", nbytes, hexdump_len(nbytes), chars);
+
+		hexdump(result, sizeof(result), data, nbytes);
+		CHECK_EXPECT(strcmp(result, expected) == 0, "hexdump of %zu bytes differs from the reference", nbytes);
+
+		///< Too small by one byte: must come back empty
+		if (nbytes > 0) {
+			hexdump(result, chars, data, nbytes);
+			CHECK_EXPECT(result[0] == '\0', "hexdump of %zu bytes into %zu chars was not rejected", nbytes, chars);
+		}
+
+		hexdump_init(&stream);
+		written = 0;
+		for (fed = 0; fed < nbytes; fed += consumed) {
+			chunk = 1 + check_rand_below((uint32_t)(nbytes - fed));
+			written += hexdump_feed(&stream, result + written, sizeof(result) - written, data + fed, chunk, &consumed);
+			CHECK_EXPECT(consumed == chunk, "hexdump_feed consumed %zu of %zu with room to spare", consumed, chunk);
+			if (consumed != chunk) {
+				break;
+			}
+		}
+		written += hexdump_finish(&stream, result + written, sizeof(result) - written);
+		result[written] = '\0';
+		CHECK_EXPECT(strcmp(result, expected) == 0, "streamed hexdump of %zu bytes differs from the reference", nbytes);
+
+		ret = hexdump_parse(expected, chars, parsed, sizeof(parsed), &parsed_bytes, &error_pos);
+		CHECK_EXPECT((ret == 0) && (parsed_bytes == nbytes) && (memcmp(parsed, data, nbytes) == 0), "hexdump_parse round trip of %zu bytes = %d, %zu bytes", nbytes, ret, parsed_bytes);
+
+		if (chars == 0) {
+			continue;
+		}
+
+		///< One character replaced: either the parse fails no earlier than the row holding it, or the bytes it returns dump back to the mutated text (ignoring digit case)
+		pos = check_rand_below((uint32_t)chars);
+		expected[pos] = check_parse_alphabet[check_rand_below(sizeof(check_parse_alphabet) - 1)];
+		ret = hexdump_parse(expected, chars, parsed, sizeof(parsed), &parsed_bytes, &error_pos);
+		if (ret < 0) {
+			CHECK_EXPECT((error_pos >= pos - (pos % HEXDUMP_ROW_CHARS)) && (error_pos <= chars), "hexdump_parse of text changed at %zu failed at %zu", pos, error_pos);
+		}
+		else {
+			ref_hexdump(redump, parsed, parsed_bytes);
+			CHECK_EXPECT((strlen(redump) == chars) && (strncasecmp(redump, expected, chars) == 0), "hexdump_parse accepted text changed at %zu that does not dump back", pos);
+		}
+	}
+}
+
+/**
+ * \fn check_hexdump_parallel(void)
+ * \brief hexdump_parallel against hexdump for a size above the threading threshold and 1 to 8 threads
+ *
+ * \return None
+ */
+static void check_hexdump_parallel(void) {
+	size_t chars = hexdump_len(CHECK_PARALLEL_BYTES) + NULL_TERMINATOR_BYTE;
+	uint8_t* data = malloc(CHECK_PARALLEL_BYTES);
+	char* expected = malloc(chars);
+	char* result = malloc(chars);
+	size_t i;
+	int nthreads;
+
+	if ((data == NULL) || (expected == NULL) || (result == NULL)) {
+		CHECK_EXPECT(0, "out of memory for the hexdump_parallel check");
+	}
+	else {
+		for (i = 0; i < CHECK_PARALLEL_BYTES; i++) {
+			data[i] = (uint8_t)check_rand64();
+		}
+
+		hexdump(expected, chars, data, CHECK_PARALLEL_BYTES);
+		for (nthreads = 1; nthreads <= 8; nthreads++) {
+			hexdump_parallel(result, chars, data, CHECK_PARALLEL_BYTES, nthreads);
+			CHECK_EXPECT(strcmp(result, expected) == 0, "hexdump_parallel with %d threads differs from hexdump", nthreads);
+		}
+	}
+
+	free(data);
+	free(expected);
+	free(result);
+}
+
+/**
+ * \fn check_generic(uint32_t rounds)
+ * \brief The 8, 16 and 64-bit versions from bitgeneric.h against the same reference models
+ *
+ * \return None
+ */
+static void check_generic(uint32_t rounds) {
+	char expected[STR_BYTES];
+	char result[STR_BYTES];
+	uint32_t round;
+	uint64_t num;
+	int width;
+	int nbits;
+	int bit;
+	int op;
+	int expected_chars;
+	int num_chars;
+	uint64_t output;
+
+	for (round = 0; round < rounds; round++) {
+		width = (round % 3 == 0) ? 8 : ((round % 3 == 1) ? 16 : UINT64_T_BITS);
+		num = ref_low_bits(check_value64(), width);
+		nbits = 1 + (int)check_rand_below((uint32_t)width);
+		bit = (int)check_rand_below((uint32_t)width);
+		op = (int)check_rand_below(3);
+
+		expected_chars = ref_binstr(expected, num, nbits);
+		num_chars = (width == 8) ? uint_to_binstr_u8(result, sizeof(result), (uint8_t)num, (uint8_t)nbits)
+			: ((width == 16) ? uint_to_binstr_u16(result, sizeof(result), (uint16_t)num, (uint8_t)nbits) : uint_to_binstr_u64(result, sizeof(result), num, (uint8_t)nbits));
+		CHECK_EXPECT((num_chars == expected_chars) && (strcmp(result, expected) == 0), "uint_to_binstr_u%d(0x%llX, %d): EXPECT = \"%s\", RESULT = \"%s\"", width, (unsigned long long)num, nbits, expected, result);
+
+		expected_chars = ref_binstr(expected, ref_low_bits(num, nbits), nbits);
+		num_chars = (width == 8) ? int_to_binstr_s8(result, sizeof(result), (int8_t)num, (uint8_t)nbits)
+			: ((width == 16) ? int_to_binstr_s16(result, sizeof(result), (int16_t)num, (uint8_t)nbits) : int_to_binstr_s64(result, sizeof(result), (int64_t)num, (uint8_t)nbits));
+		CHECK_EXPECT((num_chars == expected_chars) && (strcmp(result, expected) == 0), "int_to_binstr_s%d(0x%llX, %d): EXPECT = \"%s\", RESULT = \"%s\"", width, (unsigned long long)num, nbits, expected, result);
+
+		nbits = BITS_PER_NIBBLE * (1 + (int)check_rand_below((uint32_t)width / BITS_PER_NIBBLE));
+		if ((nbits < UINT64_T_BITS) && ((num >> nbits) != 0)) {
+			expected[0] = '\0';
+			expected_chars = -1;
+		}
+		else {
+			expected_chars = ref_hexstr(expected, num, nbits, HEXSTR_UPPER);
+		}
+		num_chars = (width == 8) ? uint_to_hexstr_u8(result, sizeof(result), (uint8_t)num, (uint8_t)nbits)
+			: ((width == 16) ? uint_to_hexstr_u16(result, sizeof(result), (uint16_t)num, (uint8_t)nbits) : uint_to_hexstr_u64(result, sizeof(result), num, (uint8_t)nbits));
+		CHECK_EXPECT((num_chars == expected_chars) && (strcmp(result, expected) == 0), "uint_to_hexstr_u%d(0x%llX, %d): EXPECT = \"%s\", RESULT = \"%s\"", width, (unsigned long long)num, nbits, expected, result);
+
+		output = (width == 8) ? twiggle_bit_u8((uint8_t)num, bit, (operation_t)op)
+			: ((width == 16) ? twiggle_bit_u16((uint16_t)num, bit, (operation_t)op) : twiggle_bit_u64(num, bit, (operation_t)op));
+		CHECK_EXPECT(output == ref_twiggle(num, bit, (operation_t)op), "twiggle_bit_u%d(0x%llX, %d, %d) = 0x%llX", width, (unsigned long long)num, bit, op, (unsigned long long)output);
+
+		bit = (int)check_rand_below((uint32_t)width - 2);
+		output = (width == 8) ? grab_three_bits_u8((uint8_t)num, bit) : ((width == 16) ? grab_three_bits_u16((uint16_t)num, bit) : grab_three_bits_u64(num, bit));
+		CHECK_EXPECT(output == ((num >> bit) & 7), "grab_three_bits_u%d(0x%llX, %d) = 0x%llX", width, (unsigned long long)num, bit, (unsigned long long)output);
+	}
+}
+
+/**
+ * \fn check_bitvec(uint32_t rounds)
+ * \brief bitvec_t operations against a plain byte-per-bit array
+ *
+ * \return None
+ */
+static void check_bitvec(uint32_t rounds) {
+	static uint8_t ref_a[CHECK_BITVEC_MAX_BITS];
+	static uint8_t ref_b[CHECK_BITVEC_MAX_BITS];
+	bitvec_t a;
+	bitvec_t b;
+	bitvec_t dst;
+	uint32_t round;
+	size_t nbits;
+	size_t start;
+	size_t count;
+	size_t i;
+	size_t expected;
+	size_t found;
+	int op;
+	int which;
+	uint8_t bit;
+
+	for (round = 0; round < rounds; round++) {
+		nbits = 1 + check_rand_below(CHECK_BITVEC_MAX_BITS);
+		if ((bitvec_init(&a, nbits) < 0) || (bitvec_init(&b, nbits) < 0) || (bitvec_init(&dst, nbits) < 0)) {
+			CHECK_EXPECT(0, "bitvec_init(%zu) failed", nbits);
+			return;
+		}
+		memset(ref_a, 0, nbits);
+
+		///< A few random range updates, so runs of set and clear bits cross word boundaries
+		for (i = 0; i < 4; i++) {
+			op = (int)check_rand_below(3);
+			start = check_rand_below((uint32_t)nbits);
+			count = check_rand_below((uint32_t)(nbits - start + 1));
+			bitvec_twiggle_range(&a, start, count, (operation_t)op);
+			for (found = start; found < start + count; found++) {
+				ref_a[found] = (uint8_t)ref_twiggle(ref_a[found], 0, (operation_t)op);
+			}
+		}
+		for (i = 0; i < nbits; i++) {
+			ref_b[i] = (uint8_t)(check_rand64() & 1);
+			bitvec_twiggle(&b, i, ref_b[i] ? SET : CLEAR);
+		}
+
+		expected = 0;
+		for (i = 0; i < nbits; i++) {
+			expected += ref_a[i];
+			CHECK_EXPECT(bitvec_get(&a, i) == ref_a[i], "bitvec_get(%zu) of %zu bits after range updates", i, nbits);
+		}
+		CHECK_EXPECT(bitvec_popcount(&a) == expected, "bitvec_popcount of %zu bits = %zu, EXPECT = %zu", nbits, bitvec_popcount(&a), expected);
+
+		start = check_rand_below((uint32_t)nbits);
+		for (expected = start; (expected < nbits) && !ref_a[expected]; expected++) {
+		}
+		found = bitvec_find_next_set(&a, start);
+		CHECK_EXPECT(found == ((expected < nbits) ? expected : BITVEC_NONE), "bitvec_find_next_set(%zu) of %zu bits = %zu", start, nbits, found);
+
+		which = (int)(round % 4);
+		if (which == 0) {
+			bitvec_and(&dst, &a, &b);
+		}
+		else if (which == 1) {
+			bitvec_or(&dst, &a, &b);
+		}
+		else if (which == 2) {
+			bitvec_xor(&dst, &a, &b);
+		}
+		else {
+			bitvec_andnot(&dst, &a, &b);
+		}
+		for (i = 0; i < nbits; i++) {
+			bit = (which == 0) ? (ref_a[i] & ref_b[i]) : ((which == 1) ? (ref_a[i] | ref_b[i]) : ((which == 2) ? (ref_a[i] ^ ref_b[i]) : (ref_a[i] & !ref_b[i])));
+			if (bitvec_get(&dst, i) != bit) {
+				CHECK_EXPECT(0, "bitvec logic op %d of %zu bits differs at bit %zu", which, nbits, i);
+				break;
+			}
+		}
+
+		bitvec_free(&a);
+		bitvec_free(&b);
+		bitvec_free(&dst);
+	}
+}
+
+int main(int argc, char** argv) {
+	uint32_t rounds = CHECK_DEFAULT_ROUNDS;
+	uint64_t seed = CHECK_DEFAULT_SEED;
+	bitops_isa_t isa;
+	bitops_isa_t max_isa;
+	int i;
+
+	for (i = 1; i < argc; i++) {
+		if ((strcmp(argv[i], "--rounds") == 0) && (i + 1 < argc)) {
+			rounds = (uint32_t)strtoul(argv[++i], NULL, 0);
+		}
+		else if ((strcmp(argv[i], "--seed") == 0) && (i + 1 < argc)) {
+			seed = strtoull(argv[++i], NULL, 0);
+		}
+		else {
+			fprintf(stderr, "usage: %s [--rounds N] [--seed S]\n", argv[0]);
+			return EXIT_FAILURE;
+		}
+	}
+
+	check_state = (seed != 0) ? seed : CHECK_DEFAULT_SEED;
+	max_isa = bitops_isa_max_supported();
+
+	printf("check: %u rounds, seed 0x%llX, ISA tiers scalar to %s\n", rounds, (unsigned long long)seed, bitops_isa_name(max_isa));
+
+	///< Functions without SIMD kernels are checked once, the formatters also with each set of cached string tables
+	check_formatters(rounds);
+	bitops_set_cache(BITOPS_CACHE_8);
+	check_formatters(rounds);
+	bitops_set_cache(BITOPS_CACHE_16);
+	check_formatters(rounds);
+	bitops_set_cache(BITOPS_CACHE_OFF);
+	check_generic(rounds);
+	check_hexdump(rounds / 16);
+
+	for (isa = BITOPS_ISA_SCALAR; isa <= max_isa; isa++) {
+		bitops_set_isa(isa);
+		check_bit_functions(rounds);
+		check_fields(rounds / 4);
+		check_batches(rounds / 16);
+		check_parsers(rounds);
+		check_bitvec(rounds / 256);
+		check_hexdump_parallel();
+	}
+
+	bitops_set_isa(max_isa);
+
+	if (check_failures != 0) {
+		printf("check: %lu mismatches (first %d shown)\n", check_failures, CHECK_MAX_REPORTS);
+		return EXIT_FAILURE;
+	}
+
+	printf("check: all functions match their reference models\n");
+
+	return EXIT_SUCCESS;
+}
@@ -0,0 +1,217 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <strings.h>
+#include "bitops.h"
+
+/*
+ * Fuzz harness for hexdump and the parsers. The first input byte picks the target and the
+ * rest is its input; any broken property calls abort(), which libFuzzer and AFL report as a
+ * crash. Built three ways by the Makefile:
+ *	 make fuzz     : clang -fsanitize=fuzzer,address,undefined (libFuzzer drives LLVMFuzzerTestOneInput)
+ *	 make fuzz-afl : afl-clang-fast, with the main below reading one input from stdin
+ *	 make check    : gcc, with the main below replaying every file in fuzz_corpus
+ */
+
+#define NULL_TERMINATOR_BYTE (1)
+#define PREFIX_BYTES_BIN (2)
+#define PREFIX_BYTES_HEX (2)
+#define UINT32_T_BITS (32)
+
+#define FUZZ_MAX_INPUT (1 << 16)
+#define FUZZ_DUMP_CHARS(n) (hexdump_len(n) + HEXDUMP_ROW_CHARS + NULL_TERMINATOR_BYTE)
+
+typedef enum {
+	FUZZ_HEXDUMP,
+	FUZZ_HEXDUMP_PARSE,
+	FUZZ_BINSTR_TO_UINT,
+	FUZZ_HEXSTR_TO_UINT,
+	FUZZ_TARGETS
+} fuzz_target_t;
+
+///< abort() with a note on stderr, so the crash report says which property broke
+#define FUZZ_REQUIRE(cond) do { \
+	if (!(cond)) { \
+		fprintf(stderr, "fuzz: %s:%d: %s\n", __FILE__, __LINE__, #cond); \
+		abort(); \
+	} \
+} while (0)
+
+/**
+ * \fn fuzz_hexdump(const uint8_t* data, size_t size)
+ * \brief Dumps data whole and in two streamed pieces, checks both agree and that hexdump_parse gives data back
+ *
+ * \return None
+ */
+static void fuzz_hexdump(const uint8_t* data, size_t size) {
+	size_t chars = hexdump_len(size);
+	char* dump = malloc(FUZZ_DUMP_CHARS(size));
+	char* streamed = malloc(FUZZ_DUMP_CHARS(size));
+	uint8_t* parsed = malloc(size + 1);
+	hexdump_stream_t stream;
+	size_t split = (size > 0) ? (data[0] % size) : 0;
+	size_t consumed;
+	size_t written;
+	size_t nbytes;
+	size_t error_pos;
+
+	FUZZ_REQUIRE((dump != NULL) && (streamed != NULL) && (parsed != NULL));
+
+	hexdump(dump, chars + NULL_TERMINATOR_BYTE, data, size);
+	FUZZ_REQUIRE(strlen(dump) == chars);
+
+	hexdump_init(&stream);
+	written = hexdump_feed(&stream, streamed, chars + NULL_TERMINATOR_BYTE, data, split, &consumed);
+	FUZZ_REQUIRE(consumed == split);
+	written += hexdump_feed(&stream, streamed + written, chars + NULL_TERMINATOR_BYTE - written, data + split, size - split, &consumed);
+	FUZZ_REQUIRE(consumed == size - split);
+	written += hexdump_finish(&stream, streamed + written, chars + NULL_TERMINATOR_BYTE - written);
+	FUZZ_REQUIRE((written == chars) && (memcmp(streamed, dump, chars) == 0));
+
+	FUZZ_REQUIRE(hexdump_parse(dump, chars, parsed, size, &nbytes, &error_pos) == 0);
+	FUZZ_REQUIRE((nbytes == size) && (memcmp(parsed, data, size) == 0));
+
+	free(dump);
+	free(streamed);
+	free(parsed);
+}
+
+/**
+ * \fn fuzz_hexdump_parse(const char* text, size_t len)
+ * \brief Parses arbitrary text. On success the bytes must dump back to the text (ignoring digit case and a missing final newline); on failure error_pos must lie within it
+ *
+ * \return None
+ */
+static void fuzz_hexdump_parse(const char* text, size_t len) {
+	size_t out_size = (len / 2) + 1;
+	uint8_t* out = malloc(out_size);
+	char* redump;
+	size_t nbytes = 0;
+	size_t error_pos = 0;
+	size_t chars;
+
+	FUZZ_REQUIRE(out != NULL);
+
+	if (hexdump_parse(text, len, out, out_size, &nbytes, &error_pos) < 0) {
+		FUZZ_REQUIRE((error_pos <= len) && (nbytes <= out_size));
+		free(out);
+		return;
+	}
+
+	chars = hexdump_len(nbytes);
+	redump = malloc(chars + NULL_TERMINATOR_BYTE);
+	FUZZ_REQUIRE(redump != NULL);
+	hexdump(redump, chars + NULL_TERMINATOR_BYTE, out, nbytes);
+	FUZZ_REQUIRE((chars == len) || ((chars == len + 1) && (redump[len] == '\n')));
+	FUZZ_REQUIRE(strncasecmp(redump, text, len) == 0);
+
+	free(redump);
+	free(out);
+}
+
+/**
+ * \fn fuzz_int_parser(const char* text, size_t len, int hex)
+ * \brief Parses arbitrary text with binstr_to_uint or hexstr_to_uint. On success, formatting the value at the returned width must give the text back (ignoring digit case)
+ *
+ * \return None
+ */
+static void fuzz_int_parser(const char* text, size_t len, int hex) {
+	char str[PREFIX_BYTES_BIN + UINT32_T_BITS + NULL_TERMINATOR_BYTE];
+	uint32_t num = 0;
+	size_t error_pos = 0;
+	int nbits;
+
+	nbits = hex ? hexstr_to_uint(text, len, &num, &error_pos) : binstr_to_uint(text, len, &num, &error_pos);
+	if (nbits < 0) {
+		FUZZ_REQUIRE(error_pos <= len);
+		return;
+	}
+
+	FUZZ_REQUIRE((nbits > 0) && (nbits <= UINT32_T_BITS));
+	FUZZ_REQUIRE(len == (size_t)(hex ? (PREFIX_BYTES_HEX + (nbits / 4)) : (PREFIX_BYTES_BIN + nbits)));
+
+	if (hex) {
+		///< Hex widths that uint_to_hexstr does not take are compared digit by digit against the full 8-digit form
+		uint_to_hexstr_fmt(str, sizeof(str), num, UINT32_T_BITS, HEXSTR_NO_PREFIX);
+		FUZZ_REQUIRE((nbits == UINT32_T_BITS) || ((num >> nbits) == 0));
+		FUZZ_REQUIRE(strncasecmp(str + (UINT32_T_BITS - nbits) / 4, text + PREFIX_BYTES_HEX, (size_t)nbits / 4) == 0);
+	}
+	else {
+		FUZZ_REQUIRE(uint_to_binstr(str, sizeof(str), num, (uint8_t)nbits) == (int)len);
+		FUZZ_REQUIRE(memcmp(str, text, len) == 0);
+	}
+}
+
+int LLVMFuzzerTestOneInput(const uint8_t* data, size_t size) {
+	const char* text = (const char*)data + 1;
+
+	if (size == 0) {
+		return 0;
+	}
+
+	switch (data[0] % FUZZ_TARGETS) {
+		case FUZZ_HEXDUMP:
+			fuzz_hexdump(data + 1, size - 1);
+			break;
+		case FUZZ_HEXDUMP_PARSE:
+			fuzz_hexdump_parse(text, size - 1);
+			break;
+		case FUZZ_BINSTR_TO_UINT:
+			fuzz_int_parser(text, size - 1, 0);
+			break;
+		default:
+			fuzz_int_parser(text, size - 1, 1);
+			break;
+	}
+
+	return 0;
+}
+
+#ifndef BITOPS_LIBFUZZER
+/**
+ * \fn fuzz_run_file(FILE* f, const char* name)
+ * \brief Reads one input of up to FUZZ_MAX_INPUT bytes and runs it
+ *
+ * \return 0 if the input was read, -1 otherwise
+ */
+static int fuzz_run_file(FILE* f, const char* name) {
+	static uint8_t input[FUZZ_MAX_INPUT];
+	size_t size = fread(input, 1, sizeof(input), f);
+
+	if (ferror(f)) {
+		perror(name);
+		return -1;
+	}
+
+	LLVMFuzzerTestOneInput(input, size);
+
+	return 0;
+}
+
+int main(int argc, char** argv) {
+	FILE* f;
+	int i;
+
+	if (argc < 2) {
+		return (fuzz_run_file(stdin, "stdin") < 0) ? EXIT_FAILURE : EXIT_SUCCESS;
+	}
+
+	for (i = 1; i < argc; i++) {
+		f = fopen(argv[i], "rb");
+		if ((f == NULL) || (fuzz_run_file(f, argv[i]) < 0)) {
+			if (f == NULL) {
+				perror(argv[i]);
+			}
+			else {
+				fclose(f);
+			}
+			return EXIT_FAILURE;
+		}
+		fclose(f);
+	}
+
+	printf("fuzz: replayed %d inputs\n", argc - 1);
+
+	return EXIT_SUCCESS;
+}
+#endif
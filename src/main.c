@@ -1,6 +1,15 @@
 #include <stdio.h>
 #include <stdlib.h>
 #include "bitops.h"
+#include "bitatomic.h"
+#include "bitdiff.h"
+#include "bitgeneric.h"
+#include "bitlayout.h"
+#include "bitrecord.h"
+#include "bitserve.h"
+#include "bitstream.h"
+#include "bitstats.h"
+#include "bitvec.h"
 
 #define EXIT_TEST_SUCCESS (1)
 
@@ -9,10 +18,13 @@
 #define PREFIX_BYTES_HEX (2)
 #define UINT32_T_BITS (32)
 
+#define HEXDUMP_TEST_BYTES (4096)
+
 
 int main(void) {
 	int return_code;
 	char str[PREFIX_BYTES_BIN + UINT32_T_BITS + NULL_TERMINATOR_BYTE];
+	char dump[HEXDUMP_TEST_BYTES];
 	
 	return_code = test_uint_to_binstr(str, (size_t)PREFIX_BYTES_BIN + (size_t)UINT32_T_BITS + (size_t)NULL_TERMINATOR_BYTE, 0, (uint8_t)UINT32_T_BITS);
 	if (return_code == EXIT_TEST_SUCCESS) {
@@ -54,13 +66,181 @@ int main(void) {
 		printf("\ntest_grab_three_bits test failed...\n\n");
 	}
 
-	//return_code = test_hexdump(str, (size_t)PREFIX_BYTES_HEX + (size_t)UINT32_T_BITS + (size_t)NULL_TERMINATOR_BYTE, (const void *)0, (size_t)0);
-	//if (return_code == EXIT_TEST_SUCCESS) {
-	//	printf("\nAll test_hexdump tests were successful!\n\n");
-	//}
-	//else {
-	//	printf("\ntest_hexdump test failed...\n\n");
-	//}
+	return_code = test_hexdump(dump, (size_t)HEXDUMP_TEST_BYTES, (const void *)0, (size_t)0);
+	if (return_code == EXIT_TEST_SUCCESS) {
+		printf("\nAll test_hexdump tests were successful!\n\n");
+	}
+	else {
+		printf("\ntest_hexdump test failed...\n\n");
+	}
+
+	return_code = test_uint_to_binstr_many();
+	if (return_code == EXIT_TEST_SUCCESS) {
+		printf("\nAll test_uint_to_binstr_many tests were successful!\n\n");
+	}
+	else {
+		printf("\ntest_uint_to_binstr_many test failed...\n\n");
+	}
+
+	return_code = test_uint_to_hexstr_many();
+	if (return_code == EXIT_TEST_SUCCESS) {
+		printf("\nAll test_uint_to_hexstr_many tests were successful!\n\n");
+	}
+	else {
+		printf("\ntest_uint_to_hexstr_many test failed...\n\n");
+	}
+
+	return_code = test_twiggle_bit_many();
+	if (return_code == EXIT_TEST_SUCCESS) {
+		printf("\nAll test_twiggle_bit_many tests were successful!\n\n");
+	}
+	else {
+		printf("\ntest_twiggle_bit_many test failed...\n\n");
+	}
+
+	return_code = test_extract_bits();
+	if (return_code == EXIT_TEST_SUCCESS) {
+		printf("\nAll test_extract_bits tests were successful!\n\n");
+	}
+	else {
+		printf("\ntest_extract_bits test failed...\n\n");
+	}
+
+	return_code = test_fixed_width();
+	if (return_code == EXIT_TEST_SUCCESS) {
+		printf("\nAll test_fixed_width tests were successful!\n\n");
+	}
+	else {
+		printf("\ntest_fixed_width test failed...\n\n");
+	}
+
+	return_code = test_hexdump_parallel();
+	if (return_code == EXIT_TEST_SUCCESS) {
+		printf("\nAll test_hexdump_parallel tests were successful!\n\n");
+	}
+	else {
+		printf("\ntest_hexdump_parallel test failed...\n\n");
+	}
+
+	return_code = test_int_to_binstr_many();
+	if (return_code == EXIT_TEST_SUCCESS) {
+		printf("\nAll test_int_to_binstr_many tests were successful!\n\n");
+	}
+	else {
+		printf("\ntest_int_to_binstr_many test failed...\n\n");
+	}
+
+	return_code = test_parsers();
+	if (return_code == EXIT_TEST_SUCCESS) {
+		printf("\nAll test_parsers tests were successful!\n\n");
+	}
+	else {
+		printf("\ntest_parsers test failed...\n\n");
+	}
+
+	return_code = test_bitvec();
+	if (return_code == EXIT_TEST_SUCCESS) {
+		printf("\nAll test_bitvec tests were successful!\n\n");
+	}
+	else {
+		printf("\ntest_bitvec test failed...\n\n");
+	}
+
+	return_code = test_arena();
+	if (return_code == EXIT_TEST_SUCCESS) {
+		printf("\nAll test_arena tests were successful!\n\n");
+	}
+	else {
+		printf("\ntest_arena test failed...\n\n");
+	}
+
+	return_code = test_record();
+	if (return_code == EXIT_TEST_SUCCESS) {
+		printf("\nAll test_record tests were successful!\n\n");
+	}
+	else {
+		printf("\ntest_record test failed...\n\n");
+	}
+
+	return_code = test_generic();
+	if (return_code == EXIT_TEST_SUCCESS) {
+		printf("\nAll test_generic tests were successful!\n\n");
+	}
+	else {
+		printf("\ntest_generic test failed...\n\n");
+	}
+
+	return_code = test_dispatch();
+	if (return_code == EXIT_TEST_SUCCESS) {
+		printf("\nAll test_dispatch tests were successful!\n\n");
+	}
+	else {
+		printf("\ntest_dispatch test failed...\n\n");
+	}
+
+	return_code = test_stats();
+	if (return_code == EXIT_TEST_SUCCESS) {
+		printf("\nAll test_stats tests were successful!\n\n");
+	}
+	else {
+		printf("\ntest_stats test failed...\n\n");
+	}
+
+	return_code = test_layout();
+	if (return_code == EXIT_TEST_SUCCESS) {
+		printf("\nAll test_layout tests were successful!\n\n");
+	}
+	else {
+		printf("\ntest_layout test failed...\n\n");
+	}
+
+	return_code = test_diff();
+	if (return_code == EXIT_TEST_SUCCESS) {
+		printf("\nAll test_diff tests were successful!\n\n");
+	}
+	else {
+		printf("\ntest_diff test failed...\n\n");
+	}
+
+	return_code = test_bitstream();
+	if (return_code == EXIT_TEST_SUCCESS) {
+		printf("\nAll test_bitstream tests were successful!\n\n");
+	}
+	else {
+		printf("\ntest_bitstream test failed...\n\n");
+	}
+
+	return_code = test_atomic();
+	if (return_code == EXIT_TEST_SUCCESS) {
+		printf("\nAll test_atomic tests were successful!\n\n");
+	}
+	else {
+		printf("\ntest_atomic test failed...\n\n");
+	}
+
+	return_code = test_permute();
+	if (return_code == EXIT_TEST_SUCCESS) {
+		printf("\nAll test_permute tests were successful!\n\n");
+	}
+	else {
+		printf("\ntest_permute test failed...\n\n");
+	}
+
+	return_code = test_cache();
+	if (return_code == EXIT_TEST_SUCCESS) {
+		printf("\nAll test_cache tests were successful!\n\n");
+	}
+	else {
+		printf("\ntest_cache test failed...\n\n");
+	}
+
+	return_code = test_serve();
+	if (return_code == EXIT_TEST_SUCCESS) {
+		printf("\nAll test_serve tests were successful!\n\n");
+	}
+	else {
+		printf("\ntest_serve test failed...\n\n");
+	}
 
 	return EXIT_SUCCESS;
 }
\ No newline at end of file